@@ -0,0 +1,1481 @@
+// Headless render benchmark. Renders procedurally generated scenes along a
+// scripted camera path and reports the timings as JSON, after timing the
+// batch math kernels against plain GLM and the mesh processing on and off
+// the job system.
+//
+// Usage: Bench [--frames N] [--warmup N] [--instances N] [--rings N]
+//              [--shaders N] [--lights N] [--width N] [--height N]
+//              [--simd scalar|sse4|avx2|avx512] [--workers N]
+//              [--geometry-rings N] [--output file.json]
+
+// Windows libraries.
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <float.h>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// GL libraries.
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/constants.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+// Project libraries.
+#include <Memory.h>
+#include <CpuFeatures.h>
+#include <BatchMath.h>
+#include <Skinning.h>
+#include <JobSystem.h>
+#include <PipelineState.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
+#include <Mesh.h>
+#include <MeshProcessing.h>
+#include <Primitives.h>
+#include <Shader.h>
+#include <ResourceManager.h>
+#include <Input.h>
+#include <GL_Window.h>
+#include <Culling.h>
+#include <Camera.h>
+#include <FramePacer.h>
+#include <Profiler.h>
+#include <ClusteredLighting.h>
+#include <ShadowCascades.h>
+#include <RenderGraph.h>
+#include <PostProcess.h>
+#include <DynamicResolution.h>
+#include <TemporalAA.h>
+#include <Renderer.h>
+
+// Shader file locations.
+static const char* vertexShaderFile = "resources/vs/shader.vert";
+static const char* fragmentShaderFile = "resources/fs/shader.frag";
+
+// Field of view (y-direction).
+const float fieldOfView = 45.0f;
+
+// Benchmark settings.
+GLuint frameCount = 600;
+GLuint warmupFrames = 60;
+GLuint instanceCount = 10000;
+GLuint sphereRings = 1000;
+GLuint shaderVariants = 64;
+GLuint lightCount = 4096;
+GLint width = 1280;
+GLint height = 720;
+GLuint workerCount = 0;
+GLuint geometryRings = 1024;
+const char* pOutputFile = nullptr;
+
+// Pipeline states.
+PipelineCache pipelineCache;
+
+// GL state tracker.
+StateTracker stateTracker;
+
+// Frame pacing.
+FramePacer framePacer;
+
+// Frame timing.
+Profiler profiler;
+
+// Clustered forward renderer.
+Renderer renderer;
+
+// Shared geometry buffers of the pooled scene.
+GeometryPool geometryPool;
+
+// Camera. The world up must be set or the view matrix is not a number.
+Camera camera(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f, 0.0f, 0.0f);
+
+/// <summary> One object to draw with its own pipeline. </summary>
+struct UnlitItem
+{
+	Mesh* pMesh;
+	Shader* pShader;
+	const PipelineState* pPipeline;
+	glm::mat4 model;
+};
+
+/// <summary> Measurements of one scene. </summary>
+struct SceneResult
+{
+	std::string name;
+	GLuint frames;
+	double wallTime;
+	double cpuTime;
+	double gpuTime;
+	unsigned long long drawCalls;
+	unsigned long long triangles;
+	unsigned long long bytesUploaded;
+	unsigned long long setupBytes;
+	unsigned long long stateChanges;
+	double lightTime;
+	unsigned long long gBufferBytes;
+	unsigned long long shadowCascades;
+	unsigned long long fragmentsShaded;
+	unsigned long long transientBytes;
+	unsigned long long unaliasedBytes;
+	unsigned long long culledPasses;
+	unsigned long long culledItems;
+	unsigned long long culledMeshlets;
+	double resolutionScale;
+	unsigned long long geometryBuffers;
+	double poolUtilization;
+	double poolFragmentation;
+	unsigned long long heapAllocations;
+	unsigned long long arenaBytes;
+	unsigned long long resourceBytes;
+	unsigned long long sharedLoads;
+	unsigned long long evictions;
+};
+
+/// <summary> Timings of one batch kernel against plain GLM. </summary>
+struct MathResult
+{
+	std::string name;
+	size_t count;
+	double glmTime;
+	double levelTimes[(int)SimdLevel::Count];
+	double maxError;
+};
+
+/// <summary> Times every batch math kernel runs over the instances. </summary>
+const GLuint MATH_ITERATIONS = 50;
+
+/// <summary> Results of the batch math micro-benchmarks. </summary>
+std::vector<MathResult> mathResults;
+
+/// <summary> Timings of one mesh processing step on the caller alone and on the job system. </summary>
+struct GeometryResult
+{
+	std::string name;
+	size_t triangles;
+	size_t vertices;
+	double serialTime;
+	double parallelTime;
+	double maxError;
+};
+
+/// <summary> Results of the mesh processing benchmarks. </summary>
+std::vector<GeometryResult> geometryResults;
+
+/// <summary> Workers of the mesh processing benchmarks. </summary>
+JobSystem jobs;
+
+/// <summary> Meshes and shaders of every scene, allocated once. </summary>
+ObjectPool<Mesh> meshPool;
+ObjectPool<Shader> shaderPool;
+
+/// <summary> Meshes and shaders of the resource cache scene, shared by name and content. </summary>
+ResourceManager resources;
+
+/// <summary> Meshes of the scene being run. </summary>
+std::vector<Handle<Mesh>> meshes;
+std::vector<UnlitItem> drawItems;
+
+/// <summary> Items drawn through the renderer instead. </summary>
+std::vector<DrawItem> litItems;
+
+/// <summary> Fragmentation of the pool after the pooled scene's frees, before it defragments. </summary>
+double churnFragmentation = 0.0;
+
+/// <summary> Results of every scene. </summary>
+std::vector<SceneResult> results;
+
+Shader* CreateShader(const std::string& _defines)
+{
+	// Create a new shader.
+	Shader* pShader = shaderPool.get(shaderPool.create());
+
+	// Initialize the shader.
+	pShader->initialize();
+
+	// Each variant is a distinct program the driver cannot share.
+	pShader->setDefines(_defines);
+
+	// Load the vertex and fragment shaders.
+	pShader->load(GL_VERTEX_SHADER, vertexShaderFile);
+	pShader->load(GL_FRAGMENT_SHADER, fragmentShaderFile);
+
+	// Link the shaders.
+	pShader->link();
+
+	// Load the uniforms.
+	pShader->loadUniforms();
+
+	return pShader;
+}
+
+Mesh* CreateMesh()
+{
+	Handle<Mesh> handle = meshPool.create();
+	meshes.push_back(handle);
+
+	return meshPool.get(handle);
+}
+
+const PipelineState* CreatePipeline(Shader* _pShader)
+{
+	PipelineStateDesc desc;
+	desc.program = _pShader->getId();
+	desc.vertexLayout = VertexLayout::position();
+
+	return pipelineCache.create(desc);
+}
+
+glm::mat4 GridTransform(GLuint _index, GLuint _count)
+{
+	// Lay the instances out on a square grid in the xz plane.
+	GLuint side = (GLuint)ceil(sqrt((double)_count));
+	float spacing = 2.5f;
+	float offset = (side - 1) * spacing * 0.5f;
+
+	glm::vec3 position((_index % side) * spacing - offset, 0.0f, (_index / side) * spacing - offset);
+
+	glm::mat4 model(1.0f);
+	model = glm::translate(model, position);
+	model = glm::rotate(model, (float)_index, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	return model;
+}
+
+void GenerateSphereData(GLuint _rings, GLuint _segments, MeshData& _sphere)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	Primitives::generateSphere(_rings, _segments, vertices, indices);
+
+	MeshProcessing::loadPositions(vertices.data(), vertices.size(), 3, indices.data(), indices.size(), _sphere);
+
+	// Latitude and longitude mapping, with the seam's repeated vertices at both ends of u.
+	_sphere.uvs.resize(_sphere.getVertexCount());
+
+	for (size_t vertex = 0; vertex < _sphere.uvs.size(); vertex++)
+	{
+		_sphere.uvs[vertex] = glm::vec2((GLfloat)(vertex % (_segments + 1)) / _segments, (GLfloat)(vertex / (_segments + 1)) / _rings);
+	}
+}
+
+void CreateInstancesScene()
+{
+	Mesh* pMesh = CreateMesh();
+	Primitives::createTetrahedron(*pMesh);
+
+	Shader* pShader = CreateShader("");
+	const PipelineState* pPipeline = CreatePipeline(pShader);
+
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		drawItems.push_back({ pMesh, pShader, pPipeline, GridTransform(counter, instanceCount) });
+	}
+}
+
+void CreateLargeMeshScene()
+{
+	Mesh* pMesh = CreateMesh();
+	Primitives::createSphere(*pMesh, sphereRings, sphereRings * 2);
+
+	Shader* pShader = CreateShader("");
+
+	drawItems.push_back({ pMesh, pShader, CreatePipeline(pShader), glm::scale(glm::mat4(1.0f), glm::vec3(20.0f)) });
+}
+
+void CreateManyShadersScene()
+{
+	Mesh* pMesh = CreateMesh();
+	Primitives::createTetrahedron(*pMesh);
+
+	std::vector<Shader*> variants;
+	std::vector<const PipelineState*> pipelines;
+
+	for (GLuint counter = 0; counter < shaderVariants; counter++)
+	{
+		Shader* pShader = CreateShader("#define VARIANT " + std::to_string(counter));
+
+		variants.push_back(pShader);
+		pipelines.push_back(CreatePipeline(pShader));
+	}
+
+	// Interleave the variants so every draw switches program.
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		GLuint variant = counter % shaderVariants;
+
+		drawItems.push_back({ pMesh, variants[variant], pipelines[variant], GridTransform(counter, instanceCount) });
+	}
+}
+
+void CreateUniqueMeshesScene()
+{
+	Shader* pShader = CreateShader("");
+	const PipelineState* pPipeline = CreatePipeline(pShader);
+
+	// Every instance has its own mesh and buffers.
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		Mesh* pMesh = CreateMesh();
+		Primitives::createTetrahedron(*pMesh);
+
+		drawItems.push_back({ pMesh, pShader, pPipeline, GridTransform(counter, instanceCount) });
+	}
+}
+
+void CreatePooledMeshesScene()
+{
+	Shader* pShader = CreateShader("");
+	const PipelineState* pPipeline = CreatePipeline(pShader);
+
+	// Create twice the meshes and free every other one, leaving holes between the survivors.
+	std::vector<Handle<Mesh>> created;
+
+	for (GLuint counter = 0; counter < instanceCount * 2; counter++)
+	{
+		created.push_back(meshPool.create());
+		Primitives::createTetrahedron(*meshPool.get(created.back()), &geometryPool);
+	}
+
+	for (GLuint counter = 0; counter < instanceCount * 2; counter++)
+	{
+		if (counter % 2 == 1)
+		{
+			meshPool.destroy(created[counter]);
+		}
+		else
+		{
+			meshes.push_back(created[counter]);
+		}
+	}
+
+	churnFragmentation = geometryPool.getVertexStats().fragmentation;
+
+	// Pack the survivors so the free space is one block again.
+	geometryPool.defragment();
+
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		drawItems.push_back({ meshPool.get(meshes[counter]), pShader, pPipeline, GridTransform(counter, instanceCount) });
+	}
+}
+
+void CreateResourceCacheScene()
+{
+	const GLuint sphereVariants = 8;
+	const GLuint shaderCount = glm::min(shaderVariants, 4u);
+
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<Shader*> variants;
+	std::vector<const PipelineState*> pipelines;
+
+	for (GLuint counter = 0; counter < shaderCount; counter++)
+	{
+		Shader* pShader = resources.get(resources.loadShader(vertexShaderFile, fragmentShaderFile, "#define VARIANT " + std::to_string(counter)));
+
+		variants.push_back(pShader);
+		pipelines.push_back(CreatePipeline(pShader));
+	}
+
+	// Every instance requests its mesh and shader, as separately loaded objects would.
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		GLuint variant = counter % sphereVariants;
+		GLuint rings = 8 + variant * 4;
+
+		// Every other round requests the same content under a second name.
+		std::string name = ((counter / sphereVariants) % 2 == 0 ? "sphere_" : "alias_") + std::to_string(variant);
+
+		// Only generate the geometry when the name is not resident.
+		Handle<Mesh> mesh = resources.findMesh(name.c_str());
+
+		if (!mesh.isValid())
+		{
+			Primitives::generateSphere(rings, rings * 2, vertices, indices);
+			mesh = resources.loadMesh(name.c_str(), vertices, indices);
+		}
+
+		Shader* pShader = resources.get(resources.loadShader(vertexShaderFile, fragmentShaderFile, "#define VARIANT " + std::to_string(counter % shaderCount)));
+		const PipelineState* pPipeline = pipelines[counter % shaderCount];
+
+		drawItems.push_back({ resources.get(mesh), pShader, pPipeline, GridTransform(counter, instanceCount) });
+	}
+
+	// Transient assets loaded and released under a tight budget are evicted, oldest first.
+	resources.setBudget(resources.getStats().gpuBytes * 3 / 2);
+
+	for (GLuint counter = 0; counter < 16; counter++)
+	{
+		resources.beginFrame();
+
+		GLuint rings = 48 + counter;
+		Primitives::generateSphere(rings, rings * 2, vertices, indices);
+		resources.release(resources.loadMesh(("transient_" + std::to_string(counter)).c_str(), vertices, indices));
+	}
+}
+
+void CreateClusteredLightsScene()
+{
+	Mesh* pMesh = CreateMesh();
+	Primitives::createTetrahedron(*pMesh);
+
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		DrawItem item;
+		item.pMesh = pMesh;
+		item.model = GridTransform(counter, instanceCount);
+
+		litItems.push_back(item);
+	}
+
+	// Scatter the lights over the grid with a fixed seed.
+	float extent = (float)ceil(sqrt((double)instanceCount)) * 2.5f * 0.5f;
+
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<PointLight>& lights = renderer.getLights();
+
+	for (GLuint counter = 0; counter < lightCount; counter++)
+	{
+		PointLight light;
+		light.position = glm::vec3((unit(generator) * 2.0f - 1.0f) * extent, unit(generator) * 3.0f, (unit(generator) * 2.0f - 1.0f) * extent);
+		light.radius = 2.0f + unit(generator) * 4.0f;
+		light.color = glm::vec3(unit(generator), unit(generator), unit(generator));
+
+		lights.push_back(light);
+	}
+}
+
+void CreateDeferredLightsScene()
+{
+	// Same scene as the forward one, shaded through the G-buffer.
+	CreateClusteredLightsScene();
+
+	renderer.setPath(RenderPath::Deferred);
+}
+
+void CreatePrepassLightsScene()
+{
+	// Same scene as the forward one, shading only the visible fragments.
+	CreateClusteredLightsScene();
+
+	renderer.setDepthPrepass(true);
+}
+
+void CreateNoBloomLightsScene()
+{
+	// Same scene as the forward one. The graph culls the unread bloom passes.
+	CreateClusteredLightsScene();
+
+	renderer.setBloom(false);
+}
+
+void CreateDynamicResolutionScene()
+{
+	// Same scene as the forward one, scaled down until it meets the default GPU time target.
+	CreateClusteredLightsScene();
+
+	renderer.getResolution().setEnabled(true);
+}
+
+void CreateTemporalAAScene()
+{
+	// Same scene as the forward one with jitter, motion vectors and the history resolve.
+	CreateClusteredLightsScene();
+
+	renderer.setTemporalAA(true);
+}
+
+void CreateReverseZLightsScene()
+{
+	// Same scene as the deferred one with an infinite reverse-Z projection, rebuilding positions from float depth.
+	CreateDeferredLightsScene();
+
+	renderer.setReverseZ(true);
+}
+
+void CreateShadowsScene()
+{
+	Mesh* pMesh = CreateMesh();
+	Primitives::createTetrahedron(*pMesh);
+
+	Mesh* pGround = CreateMesh();
+	Primitives::createPlane(*pGround);
+
+	// Static instances on a static ground, so only the near cascades redraw every frame.
+	for (GLuint counter = 0; counter < instanceCount; counter++)
+	{
+		DrawItem item;
+		item.pMesh = pMesh;
+		item.model = GridTransform(counter, instanceCount);
+		item.staticGeometry = true;
+
+		litItems.push_back(item);
+	}
+
+	DrawItem ground;
+	ground.pMesh = pGround;
+	ground.model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)), glm::vec3((float)ceil(sqrt((double)instanceCount)) * 2.5f));
+	ground.staticGeometry = true;
+
+	litItems.push_back(ground);
+
+	renderer.getSun().intensity = 1.0f;
+	renderer.getShadows().invalidate();
+}
+
+void CreateMeshletScene()
+{
+	// The large sphere split into meshlets at import, then written in the binary mesh format and read back.
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	Primitives::generateSphere(sphereRings, sphereRings * 2, vertices, indices);
+
+	MeshData sphere;
+	MeshProcessing::loadPositions(vertices.data(), vertices.size(), 3, indices.data(), indices.size(), sphere);
+	MeshProcessing::buildMeshlets(sphere, &jobs);
+
+	std::vector<unsigned char> bytes;
+	MeshProcessing::writeMesh(sphere, bytes);
+
+	MeshData imported;
+	MeshProcessing::readMesh(bytes.data(), bytes.size(), imported);
+
+	Mesh* pMesh = CreateMesh();
+	pMesh->create((GLfloat*)imported.positions.data(), imported.indices.data(), (unsigned int)imported.positions.size() * 3, (unsigned int)imported.indices.size());
+	pMesh->setMeshlets(imported.meshlets);
+
+	// Seen from close by, so only part of the near side is in view.
+	DrawItem item;
+	item.pMesh = pMesh;
+	item.model = glm::scale(glm::mat4(1.0f), glm::vec3(20.0f));
+
+	litItems.push_back(item);
+}
+
+void CreateMeshletCullingOffScene()
+{
+	// Same scene drawing the whole sphere every frame.
+	CreateMeshletScene();
+
+	renderer.setMeshletCulling(false);
+}
+
+void CreateVertexStreamsScene(const VertexFormat& _format)
+{
+	// The large sphere with normals, imported into the given vertex format. The lit programs sample no textures, so
+	// texture coordinates would be uploaded and never fetched.
+	MeshData sphere;
+	GenerateSphereData(sphereRings, sphereRings * 2, sphere);
+	MeshProcessing::generateNormals(sphere, DEFAULT_CREASE_ANGLE, &jobs);
+	MeshProcessing::buildMeshlets(sphere, &jobs);
+	sphere.uvs.clear();
+
+	PackedVertices packed;
+	MeshProcessing::packVertices(sphere, _format, packed);
+
+	Mesh* pMesh = CreateMesh();
+	pMesh->create(packed, sphere.indices.data(), (unsigned int)sphere.indices.size());
+	pMesh->setMeshlets(sphere.meshlets);
+
+	DrawItem item;
+	item.pMesh = pMesh;
+	item.model = glm::scale(glm::mat4(1.0f), glm::vec3(20.0f));
+
+	litItems.push_back(item);
+
+	// The pre-pass reads positions only.
+	renderer.setDepthPrepass(true);
+}
+
+void CreateFloatStreamsScene()
+{
+	// Every attribute in floats, interleaved in one buffer.
+	VertexFormat format;
+	format.quantizePositions = false;
+	format.normalBits = 0;
+	format.halfUvs = false;
+
+	CreateVertexStreamsScene(format);
+}
+
+void CreateCompressedStreamsScene()
+{
+	// Quantized attributes, with the positions in a buffer of their own.
+	VertexFormat format;
+	format.splitPositions = true;
+
+	CreateVertexStreamsScene(format);
+}
+
+void DestroyScene()
+{
+	// Destroying the meshes returns their ranges to the geometry pool.
+	meshPool.clear();
+	shaderPool.clear();
+	resources.clear();
+	resources.setBudget(DEFAULT_RESOURCE_BUDGET);
+	churnFragmentation = 0.0;
+
+	meshes.clear();
+	drawItems.clear();
+	litItems.clear();
+	renderer.getLights().clear();
+	renderer.setPath(RenderPath::Forward);
+	renderer.setDepthPrepass(false);
+	renderer.setBloom(true);
+	renderer.getResolution().setEnabled(false);
+	renderer.setTemporalAA(false);
+	renderer.setReverseZ(false);
+	renderer.setMeshletCulling(true);
+	renderer.getSun() = DirectionalLight();
+}
+
+void PlaceCamera(GLuint _frame, GLuint _frames, float _radius)
+{
+	// Orbit the origin once over the run while bobbing up and down.
+	float angle = glm::two_pi<float>() * _frame / _frames;
+	glm::vec3 position(_radius * cosf(angle), _radius * 0.3f * sinf(angle * 2.0f), _radius * sinf(angle));
+
+	// Face the origin.
+	float yaw = glm::degrees(angle) + 180.0f;
+	float pitch = -glm::degrees(atan2f(position.y, _radius));
+
+	camera.setPose(position, yaw, pitch);
+}
+
+void RenderFrame(const glm::mat4& _projection)
+{
+	const Shader* pCurrentShader = nullptr;
+	glm::mat4 view = camera.calculateViewMatrix();
+
+	// Lit scenes go through the renderer.
+	if (!litItems.empty())
+	{
+		RenderView renderView;
+		renderView.view = view;
+		renderView.projection = _projection;
+		renderView.fieldOfView = glm::radians(fieldOfView);
+		renderView.nearPlane = 0.1f;
+		renderView.farPlane = 1000.0f;
+		renderView.width = width;
+		renderView.height = height;
+
+		renderer.render(renderView, litItems);
+		return;
+	}
+
+	// Clear the window to black.
+	stateTracker.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, 0.0f, 0.0f, 0.0f, 1.0f);
+
+	for (UnlitItem& item : drawItems)
+	{
+		// Bind the pipeline state, which uses the shader program.
+		stateTracker.bind(item.pPipeline);
+
+		// Camera uniforms only change with the program.
+		if (item.pShader != pCurrentShader)
+		{
+			glUniformMatrix4fv(item.pShader->getProjectionLocation(), 1, GL_FALSE, glm::value_ptr(_projection));
+			glUniformMatrix4fv(item.pShader->getViewLocation(), 1, GL_FALSE, glm::value_ptr(view));
+			Profiler::countUpload(sizeof(glm::mat4) * 2);
+
+			pCurrentShader = item.pShader;
+		}
+
+		glUniformMatrix4fv(item.pShader->getModelLocation(), 1, GL_FALSE, glm::value_ptr(item.model));
+		Profiler::countUpload(sizeof(glm::mat4));
+
+		item.pMesh->render();
+	}
+}
+
+void RunScene(const char* _pName, void (*_pCreate)(), float _cameraRadius, GL_Window& _window)
+{
+	// Count the bytes uploaded while building the scene.
+	FrameStats& stats = Profiler::stats();
+	stats = FrameStats();
+
+	_pCreate();
+
+	unsigned long long setupBytes = stats.bytesUploaded;
+	ResourceStats resourceStats = resources.getStats();
+
+	// Meshes outside the pool own a vertex and an index buffer each.
+	unsigned long long geometryBuffers = 0;
+	GpuAllocatorStats poolStats = geometryPool.getVertexStats();
+
+	for (Handle<Mesh> mesh : meshes)
+	{
+		geometryBuffers += meshPool.get(mesh)->getPool() ? 0 : 2;
+	}
+
+	geometryBuffers += poolStats.allocationCount > 0 ? 2 : 0;
+
+	camera.setReverseZ(renderer.getReverseZ());
+	camera.setProjection(glm::radians(fieldOfView), (GLfloat)width / (GLfloat)height, 0.1f, 1000.0f);
+	glm::mat4 projection = camera.getProjection();
+
+	// Warm up caches and drivers before measuring.
+	for (GLuint frame = 0; frame < warmupFrames; frame++)
+	{
+		framePacer.beginFrame();
+		PlaceCamera(frame, frameCount, _cameraRadius);
+		RenderFrame(projection);
+		framePacer.present(_window);
+	}
+
+	// Measure the scripted path.
+	glFinish();
+	profiler.resetTimes();
+	stats = FrameStats();
+	stateTracker.resetStateChangeCount();
+
+	AllocationStats allocationsBefore = AllocationCounter::snapshot();
+
+	double start = glfwGetTime();
+	double lightTime = 0.0;
+	unsigned long long gBufferBytes = 0;
+	unsigned long long shadowCascades = 0;
+	unsigned long long transientBytes = 0;
+	unsigned long long unaliasedBytes = 0;
+	unsigned long long culledPasses = 0;
+	unsigned long long culledItems = 0;
+	unsigned long long culledMeshlets = 0;
+	double resolutionScale = 0.0;
+
+	for (GLuint frame = 0; frame < frameCount; frame++)
+	{
+		framePacer.beginFrame();
+		profiler.beginFrame();
+
+		PlaceCamera(frame, frameCount, _cameraRadius);
+		RenderFrame(projection);
+
+		if (!litItems.empty())
+		{
+			lightTime += renderer.getLighting().getUpdateTime();
+			gBufferBytes += renderer.getPath() == RenderPath::Deferred ? renderer.getGBufferBytes() : 0;
+			shadowCascades += renderer.getSun().intensity > 0.0f ? renderer.getShadows().getRenderedCount() : 0;
+			transientBytes += renderer.getGraph().getTransientBytes();
+			unaliasedBytes += renderer.getGraph().getUnaliasedBytes();
+			culledPasses += renderer.getGraph().getCulledPassCount();
+			culledItems += renderer.getCulledItems();
+			culledMeshlets += renderer.getCulledMeshlets();
+			resolutionScale += renderer.getResolution().getScale();
+		}
+
+		profiler.endFrame();
+		framePacer.present(_window);
+	}
+
+	// Wait for the GPU before stopping the clock.
+	glFinish();
+	profiler.flush();
+
+	AllocationStats allocationsAfter = AllocationCounter::snapshot();
+
+	SceneResult result;
+	result.name = _pName;
+	result.frames = frameCount;
+	result.wallTime = (glfwGetTime() - start) * 1000.0;
+	result.cpuTime = profiler.getCpuTime();
+	result.gpuTime = profiler.getGpuTime();
+	result.drawCalls = stats.drawCalls;
+	result.triangles = stats.triangles;
+	result.bytesUploaded = stats.bytesUploaded;
+	result.setupBytes = setupBytes;
+	result.stateChanges = stateTracker.getStateChangeCount();
+	result.lightTime = lightTime;
+	result.gBufferBytes = gBufferBytes;
+	result.shadowCascades = shadowCascades;
+	result.fragmentsShaded = stats.fragmentsShaded;
+	result.transientBytes = transientBytes;
+	result.unaliasedBytes = unaliasedBytes;
+	result.culledPasses = culledPasses;
+	result.culledItems = culledItems;
+	result.culledMeshlets = culledMeshlets;
+	result.resolutionScale = litItems.empty() ? 1.0 : resolutionScale / frameCount;
+	result.geometryBuffers = geometryBuffers;
+	result.poolUtilization = poolStats.capacity > 0 && poolStats.allocationCount > 0 ? (double)poolStats.used / poolStats.capacity : 0.0;
+	result.poolFragmentation = poolStats.allocationCount > 0 ? churnFragmentation : 0.0;
+	result.heapAllocations = allocationsAfter.heapAllocations - allocationsBefore.heapAllocations;
+	result.arenaBytes = allocationsAfter.arenaBytes - allocationsBefore.arenaBytes;
+	result.resourceBytes = resourceStats.gpuBytes;
+	result.sharedLoads = resourceStats.sharedLoads;
+	result.evictions = resourceStats.evictions;
+
+	results.push_back(result);
+
+	// Progress goes to stderr so stdout stays valid JSON.
+	fprintf(stderr, "%s: %.1f fps\n", _pName, frameCount / (result.wallTime / 1000.0));
+
+	DestroyScene();
+
+	// Start the next scene from a known state.
+	stateTracker.reset();
+}
+
+double MaxDifference(const std::vector<glm::mat4>& _left, const std::vector<glm::mat4>& _right)
+{
+	double difference = 0.0;
+
+	for (size_t counter = 0; counter < _left.size(); counter++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			glm::vec4 delta = glm::abs(_left[counter][column] - _right[counter][column]);
+			difference = glm::max(difference, (double)glm::max(glm::max(delta.x, delta.y), glm::max(delta.z, delta.w)));
+		}
+	}
+
+	return difference;
+}
+
+double MaxDifference(const BoundsSoA& _left, const BoundsSoA& _right)
+{
+	double difference = 0.0;
+
+	for (size_t counter = 0; counter < _left.size(); counter++)
+	{
+		difference = glm::max(difference, (double)glm::abs(_left.minX[counter] - _right.minX[counter]));
+		difference = glm::max(difference, (double)glm::abs(_left.minY[counter] - _right.minY[counter]));
+		difference = glm::max(difference, (double)glm::abs(_left.minZ[counter] - _right.minZ[counter]));
+		difference = glm::max(difference, (double)glm::abs(_left.maxX[counter] - _right.maxX[counter]));
+		difference = glm::max(difference, (double)glm::abs(_left.maxY[counter] - _right.maxY[counter]));
+		difference = glm::max(difference, (double)glm::abs(_left.maxZ[counter] - _right.maxZ[counter]));
+	}
+
+	return difference;
+}
+
+double MaxDifference(const std::vector<glm::vec4>& _left, const std::vector<glm::vec4>& _right)
+{
+	double difference = 0.0;
+
+	for (size_t counter = 0; counter < _left.size(); counter++)
+	{
+		glm::vec4 delta = glm::abs(_left[counter] - _right[counter]);
+		difference = glm::max(difference, (double)glm::max(glm::max(delta.x, delta.y), glm::max(delta.z, delta.w)));
+	}
+
+	return difference;
+}
+
+double MaxDifference(const std::vector<GLuint>& _left, const std::vector<GLuint>& _right)
+{
+	// Index lists differ by whole entries: the number missing or different.
+	size_t common = glm::min(_left.size(), _right.size());
+	size_t difference = glm::max(_left.size(), _right.size()) - common;
+
+	for (size_t counter = 0; counter < common; counter++)
+	{
+		difference += _left[counter] != _right[counter] ? 1 : 0;
+	}
+
+	return (double)difference;
+}
+
+template<typename Function>
+double TimeIterations(const Function& _function)
+{
+	double start = glfwGetTime();
+
+	for (GLuint iteration = 0; iteration < MATH_ITERATIONS; iteration++)
+	{
+		_function();
+	}
+
+	return (glfwGetTime() - start) * 1000.0 / MATH_ITERATIONS;
+}
+
+template<typename Reference, typename Batch, typename Output>
+void RunMathBenchmark(const char* _pName, const Reference& _reference, const Batch& _batch, const Output& _expected, Output& _output)
+{
+	MathResult result;
+	result.name = _pName;
+	result.count = instanceCount;
+	result.glmTime = TimeIterations(_reference);
+	result.maxError = 0.0;
+
+	// Every level the CPU supports, compared with GLM's results.
+	SimdLevel active = CpuFeatures::getLevel();
+	SimdLevel supported = CpuFeatures::getSupportedLevel();
+
+	for (int level = 0; level < (int)SimdLevel::Count; level++)
+	{
+		result.levelTimes[level] = -1.0;
+
+		if (level > (int)supported)
+		{
+			continue;
+		}
+
+		CpuFeatures::setLevel((SimdLevel)level);
+		result.levelTimes[level] = TimeIterations(_batch);
+		result.maxError = glm::max(result.maxError, MaxDifference(_expected, _output));
+	}
+
+	CpuFeatures::setLevel(active);
+
+	fprintf(stderr, "%s: glm %.3f ms, %s %.3f ms\n", _pName, result.glmTime, CpuFeatures::getLevelName(active), result.levelTimes[(int)active]);
+
+	mathResults.push_back(result);
+}
+
+void RunMathBenchmarks()
+{
+	// Random transforms with a fixed seed so every run computes the same.
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	size_t count = instanceCount;
+	std::vector<glm::vec3> positions(count);
+	std::vector<glm::quat> rotations(count);
+	std::vector<glm::vec3> scales(count);
+	BoundsSoA localBounds;
+	localBounds.resize(count);
+
+	for (size_t counter = 0; counter < count; counter++)
+	{
+		positions[counter] = glm::vec3(unit(generator), unit(generator), unit(generator)) * 100.0f;
+		rotations[counter] = glm::normalize(glm::quat(unit(generator), unit(generator), unit(generator), unit(generator)));
+		scales[counter] = glm::vec3(unit(generator), unit(generator), unit(generator)) + 1.5f;
+
+		glm::vec3 center = glm::vec3(unit(generator), unit(generator), unit(generator));
+		glm::vec3 extent = glm::abs(glm::vec3(unit(generator), unit(generator), unit(generator))) + 0.1f;
+
+		localBounds.minX[counter] = center.x - extent.x;
+		localBounds.minY[counter] = center.y - extent.y;
+		localBounds.minZ[counter] = center.z - extent.z;
+		localBounds.maxX[counter] = center.x + extent.x;
+		localBounds.maxY[counter] = center.y + extent.y;
+		localBounds.maxZ[counter] = center.z + extent.z;
+	}
+
+	glm::mat4 viewProjection = glm::perspective(glm::radians(fieldOfView), (GLfloat)width / (GLfloat)height, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::vector<glm::mat4> models(count);
+	std::vector<glm::mat4> expected(count);
+	std::vector<glm::mat4> output(count);
+
+	// Per object translate, rotate and scale as the demo composes them.
+	RunMathBenchmark("compose", [&]()
+	{
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			expected[counter] = glm::translate(glm::mat4(1.0f), positions[counter]) * glm::mat4_cast(rotations[counter]) * glm::scale(glm::mat4(1.0f), scales[counter]);
+		}
+	}, [&]()
+	{
+		BatchMath::compose(positions.data(), rotations.data(), scales.data(), output.data(), count);
+	}, expected, output);
+
+	models = expected;
+
+	RunMathBenchmark("multiply_shared", [&]()
+	{
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			expected[counter] = viewProjection * models[counter];
+		}
+	}, [&]()
+	{
+		BatchMath::multiply(viewProjection, models.data(), output.data(), count);
+	}, expected, output);
+
+	std::vector<glm::mat4> others(models.rbegin(), models.rend());
+
+	RunMathBenchmark("multiply_pairs", [&]()
+	{
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			expected[counter] = models[counter] * others[counter];
+		}
+	}, [&]()
+	{
+		BatchMath::multiply(models.data(), others.data(), output.data(), count);
+	}, expected, output);
+
+	// Bounds of the eight transformed corners.
+	BoundsSoA expectedBounds;
+	BoundsSoA outputBounds;
+	expectedBounds.resize(count);
+
+	RunMathBenchmark("transform_bounds", [&]()
+	{
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			glm::vec3 minimum(FLT_MAX);
+			glm::vec3 maximum(-FLT_MAX);
+
+			for (int corner = 0; corner < 8; corner++)
+			{
+				glm::vec3 local((corner & 1) ? localBounds.maxX[counter] : localBounds.minX[counter], (corner & 2) ? localBounds.maxY[counter] : localBounds.minY[counter], (corner & 4) ? localBounds.maxZ[counter] : localBounds.minZ[counter]);
+				glm::vec3 world = glm::vec3(models[counter] * glm::vec4(local, 1.0f));
+
+				minimum = glm::min(minimum, world);
+				maximum = glm::max(maximum, world);
+			}
+
+			expectedBounds.minX[counter] = minimum.x;
+			expectedBounds.minY[counter] = minimum.y;
+			expectedBounds.minZ[counter] = minimum.z;
+			expectedBounds.maxX[counter] = maximum.x;
+			expectedBounds.maxY[counter] = maximum.y;
+			expectedBounds.maxZ[counter] = maximum.z;
+		}
+	}, [&]()
+	{
+		BatchMath::transformBounds(models.data(), localBounds, outputBounds);
+	}, expectedBounds, outputBounds);
+
+	// The world boxes against the frustum of the view projection, by the corner furthest along each plane.
+	glm::vec4 planes[(int)FrustumPlane::Count];
+	Culling::extractPlanes(viewProjection, false, planes);
+
+	std::vector<GLuint> expectedVisible(count);
+	std::vector<GLuint> outputVisible(count);
+
+	RunMathBenchmark("cull_bounds", [&]()
+	{
+		expectedVisible.clear();
+
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			bool visible = true;
+
+			for (int plane = 0; plane < (int)FrustumPlane::Count && visible; plane++)
+			{
+				glm::vec3 normal = glm::vec3(planes[plane]);
+				glm::vec3 corner(normal.x >= 0.0f ? expectedBounds.maxX[counter] : expectedBounds.minX[counter], normal.y >= 0.0f ? expectedBounds.maxY[counter] : expectedBounds.minY[counter], normal.z >= 0.0f ? expectedBounds.maxZ[counter] : expectedBounds.minZ[counter]);
+
+				visible = glm::dot(normal, corner) + planes[plane].w >= 0.0f;
+			}
+
+			if (visible)
+			{
+				expectedVisible.push_back((GLuint)counter);
+			}
+		}
+	}, [&]()
+	{
+		outputVisible.resize(count);
+		outputVisible.resize(Culling::cullBounds(planes, expectedBounds, outputVisible.data()));
+	}, expectedVisible, outputVisible);
+
+	// Random vertices moved by up to four of a skeleton's bones.
+	const size_t boneCount = glm::min(count, (size_t)64);
+	std::uniform_int_distribution<GLuint> boneIndex(0, (GLuint)boneCount - 1);
+
+	std::vector<glm::vec4> vertices(count);
+	std::vector<SkinWeights> weights(count);
+	std::vector<glm::vec4> expectedVertices(count);
+	std::vector<glm::vec4> outputVertices(count);
+
+	for (size_t counter = 0; counter < count; counter++)
+	{
+		vertices[counter] = glm::vec4(glm::vec3(unit(generator), unit(generator), unit(generator)) * 2.0f, 1.0f);
+
+		glm::vec4 weight = glm::abs(glm::vec4(unit(generator), unit(generator), unit(generator), unit(generator))) + 0.01f;
+		weights[counter].bones = glm::uvec4(boneIndex(generator), boneIndex(generator), boneIndex(generator), boneIndex(generator));
+		weights[counter].weights = weight / (weight.x + weight.y + weight.z + weight.w);
+	}
+
+	RunMathBenchmark("skin_positions", [&]()
+	{
+		for (size_t counter = 0; counter < count; counter++)
+		{
+			const SkinWeights& skin = weights[counter];
+
+			expectedVertices[counter] = (models[skin.bones.x] * vertices[counter]) * skin.weights.x + (models[skin.bones.y] * vertices[counter]) * skin.weights.y
+				+ (models[skin.bones.z] * vertices[counter]) * skin.weights.z + (models[skin.bones.w] * vertices[counter]) * skin.weights.w;
+		}
+	}, [&]()
+	{
+		Skinning::skinPositions(vertices.data(), weights.data(), models.data(), outputVertices.data(), count);
+	}, expectedVertices, outputVertices);
+}
+
+double MaxDifference(const MeshData& _left, const MeshData& _right)
+{
+	if (_left.getVertexCount() != _right.getVertexCount() || _left.indices != _right.indices)
+	{
+		return DBL_MAX;
+	}
+
+	double difference = 0.0;
+
+	for (size_t counter = 0; counter < _left.normals.size(); counter++)
+	{
+		glm::vec3 delta = glm::abs(_left.normals[counter] - _right.normals[counter]);
+		difference = glm::max(difference, (double)glm::max(delta.x, glm::max(delta.y, delta.z)));
+	}
+
+	for (size_t counter = 0; counter < _left.tangents.size(); counter++)
+	{
+		glm::vec4 delta = glm::abs(_left.tangents[counter] - _right.tangents[counter]);
+		difference = glm::max(difference, (double)glm::max(glm::max(delta.x, delta.y), glm::max(delta.z, delta.w)));
+	}
+
+	if (_left.meshlets.size() != _right.meshlets.size())
+	{
+		return DBL_MAX;
+	}
+
+	for (size_t counter = 0; counter < _left.meshlets.size(); counter++)
+	{
+		const Meshlet& left = _left.meshlets[counter];
+		const Meshlet& right = _right.meshlets[counter];
+
+		glm::vec3 delta = glm::abs(left.center - right.center);
+		difference = glm::max(difference, (double)glm::max(delta.x, glm::max(delta.y, delta.z)));
+		difference = glm::max(difference, (double)glm::abs(left.radius - right.radius));
+		difference = glm::max(difference, (double)glm::abs(left.coneCutoff - right.coneCutoff));
+	}
+
+	return difference;
+}
+
+template<typename Step>
+void RunGeometryBenchmark(const char* _pName, const MeshData& _input, const Step& _step)
+{
+	// Every run starts from a copy, since steps may split vertices.
+	MeshData serial = _input;
+	double start = glfwGetTime();
+	_step(serial, nullptr);
+	double serialTime = (glfwGetTime() - start) * 1000.0;
+
+	MeshData parallel = _input;
+	start = glfwGetTime();
+	_step(parallel, &jobs);
+	double parallelTime = (glfwGetTime() - start) * 1000.0;
+
+	GeometryResult result;
+	result.name = _pName;
+	result.triangles = _input.getTriangleCount();
+	result.vertices = parallel.getVertexCount();
+	result.serialTime = serialTime;
+	result.parallelTime = parallelTime;
+
+	// Partial sums are added in another order, so results differ by rounding only.
+	result.maxError = MaxDifference(serial, parallel);
+
+	fprintf(stderr, "%s: %.1f ms serial, %.1f ms on %u workers\n", _pName, serialTime, parallelTime, jobs.getWorkerCount());
+
+	geometryResults.push_back(result);
+}
+
+void RunGeometryBenchmarks()
+{
+	// A sphere dense enough to stand in for a scanned or sculpted import.
+	MeshData sphere;
+	GenerateSphereData(geometryRings, geometryRings, sphere);
+
+	RunGeometryBenchmark("normals_smooth", sphere, [](MeshData& _mesh, JobSystem* _pJobs)
+	{
+		MeshProcessing::generateNormals(_mesh, 180.0f, _pJobs);
+	});
+
+	RunGeometryBenchmark("normals_crease", sphere, [](MeshData& _mesh, JobSystem* _pJobs)
+	{
+		MeshProcessing::generateNormals(_mesh, DEFAULT_CREASE_ANGLE, _pJobs);
+	});
+
+	MeshProcessing::generateNormals(sphere, DEFAULT_CREASE_ANGLE, &jobs);
+
+	RunGeometryBenchmark("tangents", sphere, [](MeshData& _mesh, JobSystem* _pJobs)
+	{
+		MeshProcessing::generateTangents(_mesh, _pJobs);
+	});
+
+	RunGeometryBenchmark("meshlets", sphere, [](MeshData& _mesh, JobSystem* _pJobs)
+	{
+		MeshProcessing::buildMeshlets(_mesh, _pJobs);
+	});
+}
+
+void WriteResults(FILE* _pFile)
+{
+	fprintf(_pFile, "{\n");
+	fprintf(_pFile, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+	fprintf(_pFile, "  \"width\": %d,\n", width);
+	fprintf(_pFile, "  \"height\": %d,\n", height);
+	fprintf(_pFile, "  \"simd_level\": \"%s\",\n", CpuFeatures::getLevelName(CpuFeatures::getLevel()));
+	fprintf(_pFile, "  \"simd_supported\": \"%s\",\n", CpuFeatures::getLevelName(CpuFeatures::getSupportedLevel()));
+	fprintf(_pFile, "  \"math\": [\n");
+
+	for (size_t counter = 0; counter < mathResults.size(); counter++)
+	{
+		const MathResult& result = mathResults[counter];
+
+		fprintf(_pFile, "    {\n");
+		fprintf(_pFile, "      \"name\": \"%s\",\n", result.name.c_str());
+		fprintf(_pFile, "      \"count\": %zu,\n", result.count);
+		fprintf(_pFile, "      \"glm_ms\": %.4f,\n", result.glmTime);
+
+		// Levels the CPU lacks are left out.
+		for (int level = 0; level < (int)SimdLevel::Count; level++)
+		{
+			if (result.levelTimes[level] >= 0.0)
+			{
+				fprintf(_pFile, "      \"%s_ms\": %.4f,\n", CpuFeatures::getLevelName((SimdLevel)level), result.levelTimes[level]);
+			}
+		}
+
+		fprintf(_pFile, "      \"max_error\": %g\n", result.maxError);
+		fprintf(_pFile, "    }%s\n", counter + 1 < mathResults.size() ? "," : "");
+	}
+
+	fprintf(_pFile, "  ],\n");
+	fprintf(_pFile, "  \"workers\": %u,\n", jobs.getWorkerCount());
+	fprintf(_pFile, "  \"geometry\": [\n");
+
+	for (size_t counter = 0; counter < geometryResults.size(); counter++)
+	{
+		const GeometryResult& result = geometryResults[counter];
+
+		fprintf(_pFile, "    {\n");
+		fprintf(_pFile, "      \"name\": \"%s\",\n", result.name.c_str());
+		fprintf(_pFile, "      \"triangles\": %zu,\n", result.triangles);
+		fprintf(_pFile, "      \"vertices\": %zu,\n", result.vertices);
+		fprintf(_pFile, "      \"serial_ms\": %.3f,\n", result.serialTime);
+		fprintf(_pFile, "      \"parallel_ms\": %.3f,\n", result.parallelTime);
+		fprintf(_pFile, "      \"max_error\": %g\n", result.maxError);
+		fprintf(_pFile, "    }%s\n", counter + 1 < geometryResults.size() ? "," : "");
+	}
+
+	fprintf(_pFile, "  ],\n");
+	fprintf(_pFile, "  \"scenes\": [\n");
+
+	for (size_t counter = 0; counter < results.size(); counter++)
+	{
+		const SceneResult& result = results[counter];
+		double frames = (double)result.frames;
+
+		fprintf(_pFile, "    {\n");
+		fprintf(_pFile, "      \"name\": \"%s\",\n", result.name.c_str());
+		fprintf(_pFile, "      \"frames\": %u,\n", result.frames);
+		fprintf(_pFile, "      \"fps\": %.3f,\n", frames / (result.wallTime / 1000.0));
+		fprintf(_pFile, "      \"cpu_ms\": %.4f,\n", result.cpuTime / frames);
+		fprintf(_pFile, "      \"gpu_ms\": %.4f,\n", result.gpuTime / frames);
+		fprintf(_pFile, "      \"draw_calls\": %llu,\n", result.drawCalls / result.frames);
+		fprintf(_pFile, "      \"triangles\": %llu,\n", result.triangles / result.frames);
+		fprintf(_pFile, "      \"bytes_uploaded\": %llu,\n", result.bytesUploaded / result.frames);
+		fprintf(_pFile, "      \"setup_bytes_uploaded\": %llu,\n", result.setupBytes);
+		fprintf(_pFile, "      \"state_changes\": %llu,\n", result.stateChanges / result.frames);
+		fprintf(_pFile, "      \"light_assign_ms\": %.4f,\n", result.lightTime / frames);
+		fprintf(_pFile, "      \"gbuffer_mb\": %.3f,\n", result.gBufferBytes / frames / (1024.0 * 1024.0));
+		fprintf(_pFile, "      \"shadow_cascades\": %.3f,\n", result.shadowCascades / frames);
+		fprintf(_pFile, "      \"fragments_shaded\": %llu,\n", result.fragmentsShaded / result.frames);
+		fprintf(_pFile, "      \"transient_mb\": %.3f,\n", result.transientBytes / frames / (1024.0 * 1024.0));
+		fprintf(_pFile, "      \"transient_mb_unaliased\": %.3f,\n", result.unaliasedBytes / frames / (1024.0 * 1024.0));
+		fprintf(_pFile, "      \"culled_passes\": %.3f,\n", result.culledPasses / frames);
+		fprintf(_pFile, "      \"culled_items\": %.3f,\n", result.culledItems / frames);
+		fprintf(_pFile, "      \"culled_meshlets\": %.3f,\n", result.culledMeshlets / frames);
+		fprintf(_pFile, "      \"resolution_scale\": %.3f,\n", result.resolutionScale);
+		fprintf(_pFile, "      \"geometry_buffers\": %llu,\n", result.geometryBuffers);
+		fprintf(_pFile, "      \"pool_utilization\": %.3f,\n", result.poolUtilization);
+		fprintf(_pFile, "      \"pool_fragmentation\": %.3f,\n", result.poolFragmentation);
+		fprintf(_pFile, "      \"heap_allocations\": %.3f,\n", result.heapAllocations / frames);
+		fprintf(_pFile, "      \"arena_bytes\": %llu,\n", result.arenaBytes / result.frames);
+		fprintf(_pFile, "      \"resource_mb\": %.3f,\n", result.resourceBytes / (1024.0 * 1024.0));
+		fprintf(_pFile, "      \"resource_shared_loads\": %llu,\n", result.sharedLoads);
+		fprintf(_pFile, "      \"resource_evictions\": %llu\n", result.evictions);
+		fprintf(_pFile, "    }%s\n", counter + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(_pFile, "  ]\n");
+	fprintf(_pFile, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+	// Read the settings from the command line.
+	for (int counter = 1; counter < argc - 1; counter++)
+	{
+		const char* pArgument = argv[counter];
+		const char* pValue = argv[counter + 1];
+
+		if (strcmp(pArgument, "--frames") == 0)
+		{
+			frameCount = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--warmup") == 0)
+		{
+			warmupFrames = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--instances") == 0)
+		{
+			instanceCount = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--rings") == 0)
+		{
+			sphereRings = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--shaders") == 0)
+		{
+			shaderVariants = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--lights") == 0)
+		{
+			lightCount = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--width") == 0)
+		{
+			width = atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--height") == 0)
+		{
+			height = atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--output") == 0)
+		{
+			pOutputFile = pValue;
+		}
+		else if (strcmp(pArgument, "--workers") == 0)
+		{
+			workerCount = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--geometry-rings") == 0)
+		{
+			geometryRings = (GLuint)atoi(pValue);
+		}
+		else if (strcmp(pArgument, "--simd") == 0)
+		{
+			SimdLevel level;
+
+			if (CpuFeatures::parseLevel(pValue, level))
+			{
+				CpuFeatures::setLevel(level);
+			}
+			else
+			{
+				fprintf(stderr, "Unknown SIMD level %s!\n", pValue);
+			}
+		}
+		else
+		{
+			continue;
+		}
+
+		counter++;
+	}
+
+	// Guard against empty runs.
+	frameCount = glm::max(frameCount, 1u);
+	instanceCount = glm::max(instanceCount, 1u);
+	shaderVariants = glm::max(shaderVariants, 1u);
+	geometryRings = glm::max(geometryRings, 3u);
+
+	// Create a hidden window.
+	GL_Window window(width, height, false);
+
+	// Initialize the window.
+	if (window.initialize() != 0)
+	{
+		return 1;
+	}
+
+	// Render as fast as possible.
+	framePacer.initialize(DEFAULT_FRAMES_IN_FLIGHT, SwapMode::Uncapped);
+	profiler.initialize();
+	stateTracker.reset();
+	renderer.initialize(&stateTracker, &pipelineCache);
+	geometryPool.initialize(VertexLayout::position());
+
+	// The pooled scene creates twice the instances before freeing half.
+	meshPool.initialize(instanceCount * 2 + 16);
+	shaderPool.initialize(shaderVariants + 16);
+	resources.initialize(64, 16, DEFAULT_RESOURCE_BUDGET, &geometryPool);
+
+	// Batch kernels against plain GLM, before the GPU work.
+	fprintf(stderr, "SIMD: %s of %s\n", CpuFeatures::getLevelName(CpuFeatures::getLevel()), CpuFeatures::getLevelName(CpuFeatures::getSupportedLevel()));
+	RunMathBenchmarks();
+
+	// Mesh processing on the caller alone and on every worker.
+	jobs.initialize(workerCount);
+	RunGeometryBenchmarks();
+
+	// Meshlets are culled on the same workers.
+	renderer.setJobSystem(&jobs);
+
+	// Run every scene.
+	float gridRadius = (float)ceil(sqrt((double)instanceCount)) * 2.5f * 0.75f;
+
+	RunScene("instances", CreateInstancesScene, gridRadius, window);
+	RunScene("large_mesh", CreateLargeMeshScene, 60.0f, window);
+	RunScene("many_shaders", CreateManyShadersScene, gridRadius, window);
+	RunScene("unique_meshes", CreateUniqueMeshesScene, gridRadius, window);
+	RunScene("unique_meshes_pooled", CreatePooledMeshesScene, gridRadius, window);
+	RunScene("resource_cache", CreateResourceCacheScene, gridRadius, window);
+	RunScene("clustered_lights", CreateClusteredLightsScene, gridRadius, window);
+	RunScene("clustered_lights_deferred", CreateDeferredLightsScene, gridRadius, window);
+	RunScene("clustered_lights_prepass", CreatePrepassLightsScene, gridRadius, window);
+	RunScene("clustered_lights_no_bloom", CreateNoBloomLightsScene, gridRadius, window);
+	RunScene("dynamic_resolution", CreateDynamicResolutionScene, gridRadius, window);
+	RunScene("temporal_aa", CreateTemporalAAScene, gridRadius, window);
+	RunScene("clustered_lights_reverse_z", CreateReverseZLightsScene, gridRadius, window);
+	RunScene("shadows", CreateShadowsScene, gridRadius, window);
+	RunScene("meshlet_culling", CreateMeshletScene, 30.0f, window);
+	RunScene("meshlet_culling_off", CreateMeshletCullingOffScene, 30.0f, window);
+	RunScene("vertex_streams_float", CreateFloatStreamsScene, 30.0f, window);
+	RunScene("vertex_streams_compressed", CreateCompressedStreamsScene, 30.0f, window);
+
+	// Write the results.
+	WriteResults(stdout);
+
+	// Stdout only carries the results, so errors go to stderr.
+	int result = 0;
+
+	if (pOutputFile)
+	{
+		FILE* pFile = fopen(pOutputFile, "w");
+
+		if (!pFile)
+		{
+			fprintf(stderr, "Error opening '%s' for writing!\n", pOutputFile);
+			result = 1;
+		}
+		else
+		{
+			WriteResults(pFile);
+
+			// Close the file even when a write failed.
+			bool failed = ferror(pFile) != 0;
+			failed = fclose(pFile) != 0 || failed;
+
+			if (failed)
+			{
+				fprintf(stderr, "Error writing '%s'!\n", pOutputFile);
+				result = 1;
+			}
+		}
+	}
+
+	// Release GPU objects while the context exists.
+	profiler.clear();
+	framePacer.clear();
+	renderer.clear();
+	resources.clear();
+	geometryPool.clear();
+
+	// Return error code.
+	return result;
+}
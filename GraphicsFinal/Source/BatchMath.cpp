@@ -0,0 +1,698 @@
+#include <stdio.h>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include <CpuFeatures.h>
+#include <BatchMath.h>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	/// <summary> Kernels of one instruction set. </summary>
+	struct BatchKernels
+	{
+		void (*multiply)(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count);
+		void (*multiplyShared)(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count);
+		void (*compose)(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count);
+		void (*transformBounds)(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world);
+	};
+
+	void multiplyScalar(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			_pResult[index] = _pLeft[index] * _pRight[index];
+		}
+	}
+
+	void multiplySharedScalar(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		glm::mat4 left = _left;
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			_pResult[index] = left * _pRight[index];
+		}
+	}
+
+	void composeScalar(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			glm::mat4 matrix = glm::mat4_cast(_pRotations[index]);
+
+			matrix[0] *= _pScales[index].x;
+			matrix[1] *= _pScales[index].y;
+			matrix[2] *= _pScales[index].z;
+			matrix[3] = glm::vec4(_pPositions[index], 1.0f);
+
+			_pResult[index] = matrix;
+		}
+	}
+
+	void transformBoundsRange(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world, size_t _begin, size_t _end)
+	{
+		for (size_t index = _begin; index < _end; index++)
+		{
+			const glm::mat4& model = _pModels[index];
+
+			// The center moves with the model; the extent grows by the absolute rotation and scale (Arvo).
+			glm::vec3 center = glm::vec3(_local.minX[index] + _local.maxX[index], _local.minY[index] + _local.maxY[index], _local.minZ[index] + _local.maxZ[index]) * 0.5f;
+			glm::vec3 extent = glm::vec3(_local.maxX[index] - _local.minX[index], _local.maxY[index] - _local.minY[index], _local.maxZ[index] - _local.minZ[index]) * 0.5f;
+
+			glm::vec3 worldCenter = glm::vec3(model[3]) + glm::vec3(model[0]) * center.x + glm::vec3(model[1]) * center.y + glm::vec3(model[2]) * center.z;
+			glm::vec3 worldExtent = glm::abs(glm::vec3(model[0])) * extent.x + glm::abs(glm::vec3(model[1])) * extent.y + glm::abs(glm::vec3(model[2])) * extent.z;
+
+			_world.minX[index] = worldCenter.x - worldExtent.x;
+			_world.minY[index] = worldCenter.y - worldExtent.y;
+			_world.minZ[index] = worldCenter.z - worldExtent.z;
+			_world.maxX[index] = worldCenter.x + worldExtent.x;
+			_world.maxY[index] = worldCenter.y + worldExtent.y;
+			_world.maxZ[index] = worldCenter.z + worldExtent.z;
+		}
+	}
+
+	void transformBoundsScalar(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world)
+	{
+		transformBoundsRange(_pModels, _local, _world, 0, _local.size());
+	}
+
+#ifdef SIMD_X86
+	// SSE4: one matrix per iteration for products, four objects across the lanes for composing and bounds.
+
+	SIMD_TARGET_SSE4 inline void multiplySse4(const __m128 _left[4], const GLfloat* _pRight, GLfloat* _pResult)
+	{
+		// Every column of the result is the left columns weighted by one right column, as glm_mat4_mul() does.
+		__m128 right[4] = { _mm_loadu_ps(_pRight), _mm_loadu_ps(_pRight + 4), _mm_loadu_ps(_pRight + 8), _mm_loadu_ps(_pRight + 12) };
+
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 result = _mm_mul_ps(_left[0], _mm_shuffle_ps(right[column], right[column], _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm_add_ps(result, _mm_mul_ps(_left[1], _mm_shuffle_ps(right[column], right[column], _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(_left[2], _mm_shuffle_ps(right[column], right[column], _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(_left[3], _mm_shuffle_ps(right[column], right[column], _MM_SHUFFLE(3, 3, 3, 3))));
+
+			_mm_storeu_ps(_pResult + column * 4, result);
+		}
+	}
+
+	SIMD_TARGET_SSE4 void multiplySse4(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			const GLfloat* pLeft = &_pLeft[index][0][0];
+			__m128 left[4] = { _mm_loadu_ps(pLeft), _mm_loadu_ps(pLeft + 4), _mm_loadu_ps(pLeft + 8), _mm_loadu_ps(pLeft + 12) };
+
+			multiplySse4(left, &_pRight[index][0][0], &_pResult[index][0][0]);
+		}
+	}
+
+	SIMD_TARGET_SSE4 void multiplySharedSse4(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		const GLfloat* pLeft = &_left[0][0];
+		__m128 left[4] = { _mm_loadu_ps(pLeft), _mm_loadu_ps(pLeft + 4), _mm_loadu_ps(pLeft + 8), _mm_loadu_ps(pLeft + 12) };
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			multiplySse4(left, &_pRight[index][0][0], &_pResult[index][0][0]);
+		}
+	}
+
+	SIMD_TARGET_SSE4 void composeSse4(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t index = 0;
+
+		for (; index + 4 <= _count; index += 4)
+		{
+			// GLM stores quaternions as x, y, z, w. Four of them transpose into one component per register.
+			__m128 x = _mm_loadu_ps(&_pRotations[index].x);
+			__m128 y = _mm_loadu_ps(&_pRotations[index + 1].x);
+			__m128 z = _mm_loadu_ps(&_pRotations[index + 2].x);
+			__m128 w = _mm_loadu_ps(&_pRotations[index + 3].x);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			const glm::vec3* pScale = _pScales + index;
+			__m128 scaleX = _mm_set_ps(pScale[3].x, pScale[2].x, pScale[1].x, pScale[0].x);
+			__m128 scaleY = _mm_set_ps(pScale[3].y, pScale[2].y, pScale[1].y, pScale[0].y);
+			__m128 scaleZ = _mm_set_ps(pScale[3].z, pScale[2].z, pScale[1].z, pScale[0].z);
+
+			__m128 xx = _mm_mul_ps(x, x);
+			__m128 yy = _mm_mul_ps(y, y);
+			__m128 zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y);
+			__m128 xz = _mm_mul_ps(x, z);
+			__m128 yz = _mm_mul_ps(y, z);
+			__m128 wx = _mm_mul_ps(w, x);
+			__m128 wy = _mm_mul_ps(w, y);
+			__m128 wz = _mm_mul_ps(w, z);
+
+			// Rotation columns scaled per axis, the same terms as glm::mat4_cast().
+			__m128 column[4][4];
+			column[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX);
+			column[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX);
+			column[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX);
+			column[0][3] = zero;
+			column[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY);
+			column[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY);
+			column[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY);
+			column[1][3] = zero;
+			column[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ);
+			column[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ);
+			column[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ);
+			column[2][3] = zero;
+
+			const glm::vec3* pPosition = _pPositions + index;
+			column[3][0] = _mm_set_ps(pPosition[3].x, pPosition[2].x, pPosition[1].x, pPosition[0].x);
+			column[3][1] = _mm_set_ps(pPosition[3].y, pPosition[2].y, pPosition[1].y, pPosition[0].y);
+			column[3][2] = _mm_set_ps(pPosition[3].z, pPosition[2].z, pPosition[1].z, pPosition[0].z);
+			column[3][3] = one;
+
+			// Transpose back to one column of one matrix per register.
+			for (int counter = 0; counter < 4; counter++)
+			{
+				_MM_TRANSPOSE4_PS(column[counter][0], column[counter][1], column[counter][2], column[counter][3]);
+
+				for (int object = 0; object < 4; object++)
+				{
+					_mm_storeu_ps(&_pResult[index + object][counter][0], column[counter][object]);
+				}
+			}
+		}
+
+		composeScalar(_pPositions + index, _pRotations + index, _pScales + index, _pResult + index, _count - index);
+	}
+
+	SIMD_TARGET_SSE4 void transformBoundsSse4(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world)
+	{
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+
+		size_t count = _local.size();
+		size_t index = 0;
+
+		for (; index + 4 <= count; index += 4)
+		{
+			// One matrix element of the four boxes per register, model[column][row].
+			__m128 model[4][4];
+
+			for (int column = 0; column < 4; column++)
+			{
+				for (int box = 0; box < 4; box++)
+				{
+					model[column][box] = _mm_loadu_ps(&_pModels[index + box][column][0]);
+				}
+
+				_MM_TRANSPOSE4_PS(model[column][0], model[column][1], model[column][2], model[column][3]);
+			}
+
+			__m128 minX = _mm_loadu_ps(&_local.minX[index]);
+			__m128 minY = _mm_loadu_ps(&_local.minY[index]);
+			__m128 minZ = _mm_loadu_ps(&_local.minZ[index]);
+			__m128 maxX = _mm_loadu_ps(&_local.maxX[index]);
+			__m128 maxY = _mm_loadu_ps(&_local.maxY[index]);
+			__m128 maxZ = _mm_loadu_ps(&_local.maxZ[index]);
+
+			__m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+			__m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+			__m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+			__m128 extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+			__m128 extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+			__m128 extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+			GLfloat* pMin[3] = { &_world.minX[index], &_world.minY[index], &_world.minZ[index] };
+			GLfloat* pMax[3] = { &_world.maxX[index], &_world.maxY[index], &_world.maxZ[index] };
+
+			for (int row = 0; row < 3; row++)
+			{
+				__m128 center = _mm_add_ps(model[3][row], _mm_add_ps(_mm_mul_ps(model[0][row], centerX), _mm_add_ps(_mm_mul_ps(model[1][row], centerY), _mm_mul_ps(model[2][row], centerZ))));
+				__m128 extent = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signBit, model[0][row]), extentX), _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signBit, model[1][row]), extentY), _mm_mul_ps(_mm_andnot_ps(signBit, model[2][row]), extentZ)));
+
+				_mm_storeu_ps(pMin[row], _mm_sub_ps(center, extent));
+				_mm_storeu_ps(pMax[row], _mm_add_ps(center, extent));
+			}
+		}
+
+		transformBoundsRange(_pModels, _local, _world, index, count);
+	}
+
+	// AVX2: two columns per register for products, eight objects for composing and bounds. Eight objects are held as
+	// two groups of four, one per 128 bit lane, so the SSE style transposes work lane by lane.
+
+	SIMD_TARGET_AVX2 inline __m256 loadLanes(const GLfloat* _pLow, const GLfloat* _pHigh)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(_pLow)), _mm_loadu_ps(_pHigh), 1);
+	}
+
+	SIMD_TARGET_AVX2 inline void storeLanes(GLfloat* _pLow, GLfloat* _pHigh, __m256 _value)
+	{
+		_mm_storeu_ps(_pLow, _mm256_castps256_ps128(_value));
+		_mm_storeu_ps(_pHigh, _mm256_extractf128_ps(_value, 1));
+	}
+
+	SIMD_TARGET_AVX2 inline void transposeLanes(__m256& _row0, __m256& _row1, __m256& _row2, __m256& _row3)
+	{
+		__m256 low01 = _mm256_unpacklo_ps(_row0, _row1);
+		__m256 low23 = _mm256_unpacklo_ps(_row2, _row3);
+		__m256 high01 = _mm256_unpackhi_ps(_row0, _row1);
+		__m256 high23 = _mm256_unpackhi_ps(_row2, _row3);
+
+		_row0 = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(1, 0, 1, 0));
+		_row1 = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(3, 2, 3, 2));
+		_row2 = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(1, 0, 1, 0));
+		_row3 = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	SIMD_TARGET_AVX2 inline __m256 multiplyColumnsAvx2(const __m256 _left[4], __m256 _right)
+	{
+		// Two columns of the right matrix, each component broadcast within its lane.
+		__m256 result = _mm256_mul_ps(_left[0], _mm256_shuffle_ps(_right, _right, _MM_SHUFFLE(0, 0, 0, 0)));
+		result = _mm256_fmadd_ps(_left[1], _mm256_shuffle_ps(_right, _right, _MM_SHUFFLE(1, 1, 1, 1)), result);
+		result = _mm256_fmadd_ps(_left[2], _mm256_shuffle_ps(_right, _right, _MM_SHUFFLE(2, 2, 2, 2)), result);
+		result = _mm256_fmadd_ps(_left[3], _mm256_shuffle_ps(_right, _right, _MM_SHUFFLE(3, 3, 3, 3)), result);
+
+		return result;
+	}
+
+	SIMD_TARGET_AVX2 void multiplyAvx2(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			const GLfloat* pLeft = &_pLeft[index][0][0];
+			const GLfloat* pRight = &_pRight[index][0][0];
+			GLfloat* pResult = &_pResult[index][0][0];
+
+			__m256 left[4];
+
+			for (int column = 0; column < 4; column++)
+			{
+				left[column] = _mm256_broadcast_ps((const __m128*)(pLeft + column * 4));
+			}
+
+			// Both halves are read before either is written, so the result may alias the inputs.
+			__m256 right01 = _mm256_loadu_ps(pRight);
+			__m256 right23 = _mm256_loadu_ps(pRight + 8);
+
+			_mm256_storeu_ps(pResult, multiplyColumnsAvx2(left, right01));
+			_mm256_storeu_ps(pResult + 8, multiplyColumnsAvx2(left, right23));
+		}
+	}
+
+	SIMD_TARGET_AVX2 void multiplySharedAvx2(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		const GLfloat* pLeft = &_left[0][0];
+		__m256 left[4];
+
+		for (int column = 0; column < 4; column++)
+		{
+			left[column] = _mm256_broadcast_ps((const __m128*)(pLeft + column * 4));
+		}
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			const GLfloat* pRight = &_pRight[index][0][0];
+			GLfloat* pResult = &_pResult[index][0][0];
+
+			__m256 right01 = _mm256_loadu_ps(pRight);
+			__m256 right23 = _mm256_loadu_ps(pRight + 8);
+
+			_mm256_storeu_ps(pResult, multiplyColumnsAvx2(left, right01));
+			_mm256_storeu_ps(pResult + 8, multiplyColumnsAvx2(left, right23));
+		}
+	}
+
+	SIMD_TARGET_AVX2 void composeAvx2(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+		const __m256 zero = _mm256_setzero_ps();
+
+		size_t index = 0;
+
+		for (; index + 8 <= _count; index += 8)
+		{
+			const glm::quat* pRotation = _pRotations + index;
+			__m256 x = loadLanes(&pRotation[0].x, &pRotation[4].x);
+			__m256 y = loadLanes(&pRotation[1].x, &pRotation[5].x);
+			__m256 z = loadLanes(&pRotation[2].x, &pRotation[6].x);
+			__m256 w = loadLanes(&pRotation[3].x, &pRotation[7].x);
+			transposeLanes(x, y, z, w);
+
+			const glm::vec3* pScale = _pScales + index;
+			__m256 scaleX = _mm256_set_ps(pScale[7].x, pScale[6].x, pScale[5].x, pScale[4].x, pScale[3].x, pScale[2].x, pScale[1].x, pScale[0].x);
+			__m256 scaleY = _mm256_set_ps(pScale[7].y, pScale[6].y, pScale[5].y, pScale[4].y, pScale[3].y, pScale[2].y, pScale[1].y, pScale[0].y);
+			__m256 scaleZ = _mm256_set_ps(pScale[7].z, pScale[6].z, pScale[5].z, pScale[4].z, pScale[3].z, pScale[2].z, pScale[1].z, pScale[0].z);
+
+			__m256 xx = _mm256_mul_ps(x, x);
+			__m256 yy = _mm256_mul_ps(y, y);
+			__m256 zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y);
+			__m256 xz = _mm256_mul_ps(x, z);
+			__m256 yz = _mm256_mul_ps(y, z);
+			__m256 wx = _mm256_mul_ps(w, x);
+			__m256 wy = _mm256_mul_ps(w, y);
+			__m256 wz = _mm256_mul_ps(w, z);
+
+			__m256 column[4][4];
+			column[0][0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), scaleX);
+			column[0][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), scaleX);
+			column[0][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), scaleX);
+			column[0][3] = zero;
+			column[1][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), scaleY);
+			column[1][1] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), scaleY);
+			column[1][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), scaleY);
+			column[1][3] = zero;
+			column[2][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), scaleZ);
+			column[2][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), scaleZ);
+			column[2][2] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), scaleZ);
+			column[2][3] = zero;
+
+			const glm::vec3* pPosition = _pPositions + index;
+			column[3][0] = _mm256_set_ps(pPosition[7].x, pPosition[6].x, pPosition[5].x, pPosition[4].x, pPosition[3].x, pPosition[2].x, pPosition[1].x, pPosition[0].x);
+			column[3][1] = _mm256_set_ps(pPosition[7].y, pPosition[6].y, pPosition[5].y, pPosition[4].y, pPosition[3].y, pPosition[2].y, pPosition[1].y, pPosition[0].y);
+			column[3][2] = _mm256_set_ps(pPosition[7].z, pPosition[6].z, pPosition[5].z, pPosition[4].z, pPosition[3].z, pPosition[2].z, pPosition[1].z, pPosition[0].z);
+			column[3][3] = one;
+
+			// Each lane transposes into one column of objects n and n + 4.
+			for (int counter = 0; counter < 4; counter++)
+			{
+				transposeLanes(column[counter][0], column[counter][1], column[counter][2], column[counter][3]);
+
+				for (int object = 0; object < 4; object++)
+				{
+					storeLanes(&_pResult[index + object][counter][0], &_pResult[index + object + 4][counter][0], column[counter][object]);
+				}
+			}
+		}
+
+		composeScalar(_pPositions + index, _pRotations + index, _pScales + index, _pResult + index, _count - index);
+	}
+
+	SIMD_TARGET_AVX2 void transformBoundsAvx2(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world)
+	{
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+		size_t count = _local.size();
+		size_t index = 0;
+
+		for (; index + 8 <= count; index += 8)
+		{
+			__m256 model[4][4];
+
+			for (int column = 0; column < 4; column++)
+			{
+				for (int box = 0; box < 4; box++)
+				{
+					model[column][box] = loadLanes(&_pModels[index + box][column][0], &_pModels[index + box + 4][column][0]);
+				}
+
+				transposeLanes(model[column][0], model[column][1], model[column][2], model[column][3]);
+			}
+
+			__m256 minX = _mm256_loadu_ps(&_local.minX[index]);
+			__m256 minY = _mm256_loadu_ps(&_local.minY[index]);
+			__m256 minZ = _mm256_loadu_ps(&_local.minZ[index]);
+			__m256 maxX = _mm256_loadu_ps(&_local.maxX[index]);
+			__m256 maxY = _mm256_loadu_ps(&_local.maxY[index]);
+			__m256 maxZ = _mm256_loadu_ps(&_local.maxZ[index]);
+
+			__m256 centerX = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+			__m256 centerY = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+			__m256 centerZ = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+			__m256 extentX = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+			__m256 extentY = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+			__m256 extentZ = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+			GLfloat* pMin[3] = { &_world.minX[index], &_world.minY[index], &_world.minZ[index] };
+			GLfloat* pMax[3] = { &_world.maxX[index], &_world.maxY[index], &_world.maxZ[index] };
+
+			for (int row = 0; row < 3; row++)
+			{
+				__m256 center = _mm256_fmadd_ps(model[0][row], centerX, _mm256_fmadd_ps(model[1][row], centerY, _mm256_fmadd_ps(model[2][row], centerZ, model[3][row])));
+				__m256 extent = _mm256_fmadd_ps(_mm256_andnot_ps(signBit, model[0][row]), extentX, _mm256_fmadd_ps(_mm256_andnot_ps(signBit, model[1][row]), extentY, _mm256_mul_ps(_mm256_andnot_ps(signBit, model[2][row]), extentZ)));
+
+				_mm256_storeu_ps(pMin[row], _mm256_sub_ps(center, extent));
+				_mm256_storeu_ps(pMax[row], _mm256_add_ps(center, extent));
+			}
+		}
+
+		transformBoundsRange(_pModels, _local, _world, index, count);
+	}
+
+SIMD_AVX512_BEGIN
+
+	// AVX-512: a whole matrix per register for products, sixteen objects for composing and bounds. Objects are loaded
+	// with gathers in order, so every 128 bit lane holds four consecutive objects and transposes lane by lane.
+
+	SIMD_TARGET_AVX512 inline void transposeLanesAvx512(__m512& _row0, __m512& _row1, __m512& _row2, __m512& _row3)
+	{
+		__m512 low01 = _mm512_unpacklo_ps(_row0, _row1);
+		__m512 low23 = _mm512_unpacklo_ps(_row2, _row3);
+		__m512 high01 = _mm512_unpackhi_ps(_row0, _row1);
+		__m512 high23 = _mm512_unpackhi_ps(_row2, _row3);
+
+		_row0 = _mm512_shuffle_ps(low01, low23, _MM_SHUFFLE(1, 0, 1, 0));
+		_row1 = _mm512_shuffle_ps(low01, low23, _MM_SHUFFLE(3, 2, 3, 2));
+		_row2 = _mm512_shuffle_ps(high01, high23, _MM_SHUFFLE(1, 0, 1, 0));
+		_row3 = _mm512_shuffle_ps(high01, high23, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	SIMD_TARGET_AVX512 inline void storeLanesAvx512(GLfloat* _p0, GLfloat* _p1, GLfloat* _p2, GLfloat* _p3, __m512 _value)
+	{
+		_mm_storeu_ps(_p0, _mm512_extractf32x4_ps(_value, 0));
+		_mm_storeu_ps(_p1, _mm512_extractf32x4_ps(_value, 1));
+		_mm_storeu_ps(_p2, _mm512_extractf32x4_ps(_value, 2));
+		_mm_storeu_ps(_p3, _mm512_extractf32x4_ps(_value, 3));
+	}
+
+	SIMD_TARGET_AVX512 inline __m512 multiplyColumnsAvx512(const __m512 _left[4], __m512 _right)
+	{
+		// All four columns of the right matrix, each component broadcast within its lane.
+		__m512 result = _mm512_mul_ps(_left[0], _mm512_permute_ps(_right, _MM_SHUFFLE(0, 0, 0, 0)));
+		result = _mm512_fmadd_ps(_left[1], _mm512_permute_ps(_right, _MM_SHUFFLE(1, 1, 1, 1)), result);
+		result = _mm512_fmadd_ps(_left[2], _mm512_permute_ps(_right, _MM_SHUFFLE(2, 2, 2, 2)), result);
+		result = _mm512_fmadd_ps(_left[3], _mm512_permute_ps(_right, _MM_SHUFFLE(3, 3, 3, 3)), result);
+
+		return result;
+	}
+
+	SIMD_TARGET_AVX512 void multiplyAvx512(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			const GLfloat* pLeft = &_pLeft[index][0][0];
+			__m512 left[4];
+
+			for (int column = 0; column < 4; column++)
+			{
+				left[column] = _mm512_broadcast_f32x4(_mm_loadu_ps(pLeft + column * 4));
+			}
+
+			_mm512_storeu_ps(&_pResult[index][0][0], multiplyColumnsAvx512(left, _mm512_loadu_ps(&_pRight[index][0][0])));
+		}
+	}
+
+	SIMD_TARGET_AVX512 void multiplySharedAvx512(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+	{
+		const GLfloat* pLeft = &_left[0][0];
+		__m512 left[4];
+
+		for (int column = 0; column < 4; column++)
+		{
+			left[column] = _mm512_broadcast_f32x4(_mm_loadu_ps(pLeft + column * 4));
+		}
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			_mm512_storeu_ps(&_pResult[index][0][0], multiplyColumnsAvx512(left, _mm512_loadu_ps(&_pRight[index][0][0])));
+		}
+	}
+
+	SIMD_TARGET_AVX512 void composeAvx512(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count)
+	{
+		const __m512 one = _mm512_set1_ps(1.0f);
+		const __m512 two = _mm512_set1_ps(2.0f);
+		const __m512 zero = _mm512_setzero_ps();
+
+		// Float offsets of sixteen quaternions and sixteen vectors.
+		const __m512i quatOffsets = _mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(4));
+		const __m512i vectorOffsets = _mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(3));
+
+		size_t index = 0;
+
+		for (; index + 16 <= _count; index += 16)
+		{
+			const GLfloat* pRotation = &_pRotations[index].x;
+			__m512 x = _mm512_i32gather_ps(quatOffsets, pRotation, 4);
+			__m512 y = _mm512_i32gather_ps(quatOffsets, pRotation + 1, 4);
+			__m512 z = _mm512_i32gather_ps(quatOffsets, pRotation + 2, 4);
+			__m512 w = _mm512_i32gather_ps(quatOffsets, pRotation + 3, 4);
+
+			const GLfloat* pScale = &_pScales[index].x;
+			__m512 scaleX = _mm512_i32gather_ps(vectorOffsets, pScale, 4);
+			__m512 scaleY = _mm512_i32gather_ps(vectorOffsets, pScale + 1, 4);
+			__m512 scaleZ = _mm512_i32gather_ps(vectorOffsets, pScale + 2, 4);
+
+			__m512 xx = _mm512_mul_ps(x, x);
+			__m512 yy = _mm512_mul_ps(y, y);
+			__m512 zz = _mm512_mul_ps(z, z);
+			__m512 xy = _mm512_mul_ps(x, y);
+			__m512 xz = _mm512_mul_ps(x, z);
+			__m512 yz = _mm512_mul_ps(y, z);
+			__m512 wx = _mm512_mul_ps(w, x);
+			__m512 wy = _mm512_mul_ps(w, y);
+			__m512 wz = _mm512_mul_ps(w, z);
+
+			__m512 column[4][4];
+			column[0][0] = _mm512_mul_ps(_mm512_fnmadd_ps(two, _mm512_add_ps(yy, zz), one), scaleX);
+			column[0][1] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_add_ps(xy, wz)), scaleX);
+			column[0][2] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_sub_ps(xz, wy)), scaleX);
+			column[0][3] = zero;
+			column[1][0] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_sub_ps(xy, wz)), scaleY);
+			column[1][1] = _mm512_mul_ps(_mm512_fnmadd_ps(two, _mm512_add_ps(xx, zz), one), scaleY);
+			column[1][2] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_add_ps(yz, wx)), scaleY);
+			column[1][3] = zero;
+			column[2][0] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_add_ps(xz, wy)), scaleZ);
+			column[2][1] = _mm512_mul_ps(_mm512_mul_ps(two, _mm512_sub_ps(yz, wx)), scaleZ);
+			column[2][2] = _mm512_mul_ps(_mm512_fnmadd_ps(two, _mm512_add_ps(xx, yy), one), scaleZ);
+			column[2][3] = zero;
+
+			const GLfloat* pPosition = &_pPositions[index].x;
+			column[3][0] = _mm512_i32gather_ps(vectorOffsets, pPosition, 4);
+			column[3][1] = _mm512_i32gather_ps(vectorOffsets, pPosition + 1, 4);
+			column[3][2] = _mm512_i32gather_ps(vectorOffsets, pPosition + 2, 4);
+			column[3][3] = one;
+
+			// Each lane transposes into one column of objects n, n + 4, n + 8 and n + 12.
+			for (int counter = 0; counter < 4; counter++)
+			{
+				transposeLanesAvx512(column[counter][0], column[counter][1], column[counter][2], column[counter][3]);
+
+				for (int object = 0; object < 4; object++)
+				{
+					glm::mat4* pResult = _pResult + index + object;
+					storeLanesAvx512(&pResult[0][counter][0], &pResult[4][counter][0], &pResult[8][counter][0], &pResult[12][counter][0], column[counter][object]);
+				}
+			}
+		}
+
+		composeScalar(_pPositions + index, _pRotations + index, _pScales + index, _pResult + index, _count - index);
+	}
+
+	SIMD_TARGET_AVX512 void transformBoundsAvx512(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world)
+	{
+		const __m512 half = _mm512_set1_ps(0.5f);
+		const __m512i matrixOffsets = _mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(16));
+
+		size_t count = _local.size();
+		size_t index = 0;
+
+		for (; index + 16 <= count; index += 16)
+		{
+			// The bottom row of the models is never needed, so only twelve elements are gathered.
+			const GLfloat* pModels = &_pModels[index][0][0];
+			__m512 model[4][3];
+
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					model[column][row] = _mm512_i32gather_ps(matrixOffsets, pModels + column * 4 + row, 4);
+				}
+			}
+
+			__m512 minX = _mm512_loadu_ps(&_local.minX[index]);
+			__m512 minY = _mm512_loadu_ps(&_local.minY[index]);
+			__m512 minZ = _mm512_loadu_ps(&_local.minZ[index]);
+			__m512 maxX = _mm512_loadu_ps(&_local.maxX[index]);
+			__m512 maxY = _mm512_loadu_ps(&_local.maxY[index]);
+			__m512 maxZ = _mm512_loadu_ps(&_local.maxZ[index]);
+
+			__m512 centerX = _mm512_mul_ps(_mm512_add_ps(minX, maxX), half);
+			__m512 centerY = _mm512_mul_ps(_mm512_add_ps(minY, maxY), half);
+			__m512 centerZ = _mm512_mul_ps(_mm512_add_ps(minZ, maxZ), half);
+			__m512 extentX = _mm512_mul_ps(_mm512_sub_ps(maxX, minX), half);
+			__m512 extentY = _mm512_mul_ps(_mm512_sub_ps(maxY, minY), half);
+			__m512 extentZ = _mm512_mul_ps(_mm512_sub_ps(maxZ, minZ), half);
+
+			GLfloat* pMin[3] = { &_world.minX[index], &_world.minY[index], &_world.minZ[index] };
+			GLfloat* pMax[3] = { &_world.maxX[index], &_world.maxY[index], &_world.maxZ[index] };
+
+			for (int row = 0; row < 3; row++)
+			{
+				__m512 center = _mm512_fmadd_ps(model[0][row], centerX, _mm512_fmadd_ps(model[1][row], centerY, _mm512_fmadd_ps(model[2][row], centerZ, model[3][row])));
+				__m512 extent = _mm512_fmadd_ps(_mm512_abs_ps(model[0][row]), extentX, _mm512_fmadd_ps(_mm512_abs_ps(model[1][row]), extentY, _mm512_mul_ps(_mm512_abs_ps(model[2][row]), extentZ)));
+
+				_mm512_storeu_ps(pMin[row], _mm512_sub_ps(center, extent));
+				_mm512_storeu_ps(pMax[row], _mm512_add_ps(center, extent));
+			}
+		}
+
+		transformBoundsRange(_pModels, _local, _world, index, count);
+	}
+
+SIMD_AVX512_END
+#endif
+
+	/// <summary> Kernels of every level. Levels the build cannot target use the scalar ones. </summary>
+	const BatchKernels BATCH_KERNELS[(int)SimdLevel::Count] =
+	{
+		{ multiplyScalar, multiplySharedScalar, composeScalar, transformBoundsScalar },
+#ifdef SIMD_X86
+		{ multiplySse4, multiplySharedSse4, composeSse4, transformBoundsSse4 },
+		{ multiplyAvx2, multiplySharedAvx2, composeAvx2, transformBoundsAvx2 },
+		{ multiplyAvx512, multiplySharedAvx512, composeAvx512, transformBoundsAvx512 },
+#else
+		{ multiplyScalar, multiplySharedScalar, composeScalar, transformBoundsScalar },
+		{ multiplyScalar, multiplySharedScalar, composeScalar, transformBoundsScalar },
+		{ multiplyScalar, multiplySharedScalar, composeScalar, transformBoundsScalar },
+#endif
+	};
+
+	const BatchKernels& activeKernels()
+	{
+		return BATCH_KERNELS[(int)CpuFeatures::getLevel()];
+	}
+}
+
+void BoundsSoA::resize(size_t _count)
+{
+	minX.resize(_count);
+	minY.resize(_count);
+	minZ.resize(_count);
+	maxX.resize(_count);
+	maxY.resize(_count);
+	maxZ.resize(_count);
+}
+
+void BatchMath::multiply(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+{
+	activeKernels().multiply(_pLeft, _pRight, _pResult, _count);
+}
+
+void BatchMath::multiply(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count)
+{
+	activeKernels().multiplyShared(_left, _pRight, _pResult, _count);
+}
+
+void BatchMath::compose(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count)
+{
+	activeKernels().compose(_pPositions, _pRotations, _pScales, _pResult, _count);
+}
+
+void BatchMath::transformBounds(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world)
+{
+	_world.resize(_local.size());
+
+	activeKernels().transformBounds(_pModels, _local, _world);
+}
@@ -1,102 +1,394 @@
 #include <GL/glew.h>
 #include <GLM/glm.hpp>
 #include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
 #include <GLFW/glfw3.h>
 
+#include <math.h>
 #include <iostream>
+#include <atomic>
 
+#include <Input.h>
+#include <Culling.h>
 #include <Camera.h>
 
+namespace
+{
+	// Distance in world units and angle in degrees at which smoothed motion snaps to its target and stops.
+	const GLfloat SETTLE_DISTANCE = 1e-4f;
+	const GLfloat SETTLE_ANGLE = 1e-3f;
+
+	// Move a value toward a target like a critically damped spring: as fast as possible without overshooting.
+	template<typename T>
+	T smoothDamp(const T& _current, const T& _target, T& _velocity, GLfloat _smoothTime, GLfloat _deltaTime)
+	{
+		// Without smoothing, jump to the target.
+		if (_smoothTime <= 0.0f)
+		{
+			_velocity = T(0.0f);
+			return _target;
+		}
+
+		GLfloat omega = 2.0f / _smoothTime;
+		GLfloat x = omega * _deltaTime;
+
+		// Polynomial approximation of exp(-x).
+		GLfloat decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+
+		T change = _current - _target;
+		T temp = (_velocity + omega * change) * _deltaTime;
+
+		_velocity = (_velocity - omega * temp) * decay;
+
+		return _target + (change + temp) * decay;
+	}
+}
+
 Camera::Camera(glm::vec3 _initialPosition, glm::vec3 _worldUp, GLfloat _initialYaw, GLfloat _initialPitch, GLfloat _initialSpeed, GLfloat _initialAngularSpeed)
 {
 	mPosition = _initialPosition;
+	mTargetPosition = _initialPosition;
+	mVelocity = glm::vec3(0.0f);
+	mPreviousPosition = _initialPosition;
+	mViewPosition = _initialPosition;
+	mOrigin = glm::dvec3(0.0);
+	mRebaseDistance = DEFAULT_REBASE_DISTANCE;
 	mWorldUp = _worldUp;
 	mYaw = _initialYaw;
-	mPitch = _initialPitch;
+	mTargetYaw = _initialYaw;
+	mYawVelocity = 0.0f;
+	mPitch = glm::clamp(_initialPitch, -MAX_CAMERA_PITCH, MAX_CAMERA_PITCH);
+	mTargetPitch = mPitch;
+	mPitchVelocity = 0.0f;
 	mFront = glm::vec3(0.0f, 0.0f, -1.0f);
 
 	mSpeed = _initialSpeed;
 	mAngularSpeed = _initialAngularSpeed;
 
+	mPositionSmoothing = DEFAULT_POSITION_SMOOTHING;
+	mRotationSmoothing = DEFAULT_ROTATION_SMOOTHING;
+
+	mFieldOfView = glm::radians(45.0f);
+	mAspectRatio = 1.0f;
+	mNearPlane = 0.1f;
+	mFarPlane = 100.0f;
+	mReverseZ = false;
+
+	mView = glm::mat4(1.0f);
+	mProjection = glm::mat4(1.0f);
+	mViewProjection = glm::mat4(1.0f);
+	mProjectionDirty = true;
+
 	update();
 }
 
-void Camera::keyControl(bool* _keys, GLfloat _deltaTime)
+void Camera::keyControl(const InputState& _input, GLfloat _deltaTime)
 {
 	// Calculate velocity this frame.
 	GLfloat velocity = mSpeed * _deltaTime;
 
 	// Move forward by speed.
-	if (_keys[GLFW_KEY_W])
+	if (_input.isActive(InputAction::MoveForward))
 	{
-		mPosition += mFront * velocity;
+		mTargetPosition += mFront * velocity;
 	}
 
 	// Move backward by speed.
-	if (_keys[GLFW_KEY_S])
+	if (_input.isActive(InputAction::MoveBackward))
 	{
-		mPosition -= mFront * velocity;
+		mTargetPosition -= mFront * velocity;
 	}
 
 	// Move left by speed.
-	if (_keys[GLFW_KEY_A])
+	if (_input.isActive(InputAction::MoveLeft))
 	{
-		mPosition -= mRight * velocity;
+		mTargetPosition -= mRight * velocity;
 	}
 
 	// Move right by speed.
-	if (_keys[GLFW_KEY_D])
+	if (_input.isActive(InputAction::MoveRight))
 	{
-		mPosition += mRight * velocity;
+		mTargetPosition += mRight * velocity;
 	}
 
 	// Move down by speed.
-	if (_keys[GLFW_KEY_Q])
+	if (_input.isActive(InputAction::MoveDown))
 	{
-		mPosition -= mUp * velocity;
+		mTargetPosition -= mUp * velocity;
 	}
 
 	// Move up by speed.
-	if (_keys[GLFW_KEY_E])
+	if (_input.isActive(InputAction::MoveUp))
 	{
-		mPosition += mUp * velocity;
+		mTargetPosition += mUp * velocity;
 	}
 }
 
 void Camera::mouseControl(GLfloat _deltaX, GLfloat _deltaY)
 {
-	_deltaX *= mAngularSpeed;
-	_deltaY *= mAngularSpeed;
+	if (_deltaX == 0.0f && _deltaY == 0.0f)
+	{
+		return;
+	}
+
+	mTargetYaw += _deltaX * mAngularSpeed;
+	mTargetPitch = glm::clamp(mTargetPitch + _deltaY * mAngularSpeed, -MAX_CAMERA_PITCH, MAX_CAMERA_PITCH);
+
+	// Unsmoothed turning applies now rather than at the next step, keeping mouse look responsive.
+	if (mRotationSmoothing <= 0.0f)
+	{
+		mYaw = mTargetYaw;
+		mPitch = mTargetPitch;
+
+		update();
+	}
+}
 
-	mYaw += _deltaX;
-	mPitch += _deltaY;
+void Camera::advance(GLfloat _deltaTime)
+{
+	if (mPosition != mTargetPosition)
+	{
+		mPosition = smoothDamp(mPosition, mTargetPosition, mVelocity, mPositionSmoothing, _deltaTime);
 
-	//if (mPitch > 89.0f)
-	//{
-	//	mPitch = 89.0f;
-	//}
+		// Stop once settled, so a camera at rest keeps its cached view.
+		if (glm::length(mTargetPosition - mPosition) < SETTLE_DISTANCE)
+		{
+			mPosition = mTargetPosition;
+			mVelocity = glm::vec3(0.0f);
+		}
+	}
 
-	//if (mPitch < -89.0f)
-	//{
-	//	mPitch = -89.0f;
-	//}
+	if (mYaw != mTargetYaw || mPitch != mTargetPitch)
+	{
+		mYaw = smoothDamp(mYaw, mTargetYaw, mYawVelocity, mRotationSmoothing, _deltaTime);
+		mPitch = smoothDamp(mPitch, mTargetPitch, mPitchVelocity, mRotationSmoothing, _deltaTime);
+
+		if (fabsf(mTargetYaw - mYaw) < SETTLE_ANGLE && fabsf(mTargetPitch - mPitch) < SETTLE_ANGLE)
+		{
+			mYaw = mTargetYaw;
+			mPitch = mTargetPitch;
+			mYawVelocity = 0.0f;
+			mPitchVelocity = 0.0f;
+		}
+
+		update();
+	}
+}
+
+void Camera::setSmoothing(GLfloat _positionTime, GLfloat _rotationTime)
+{
+	mPositionSmoothing = _positionTime;
+	mRotationSmoothing = _rotationTime;
+}
+
+void Camera::setPose(glm::vec3 _position, GLfloat _yaw, GLfloat _pitch)
+{
+	mPosition = _position;
+	mTargetPosition = _position;
+	mVelocity = glm::vec3(0.0f);
+	mPreviousPosition = _position;
+	mViewPosition = _position;
+	mYaw = _yaw;
+	mTargetYaw = _yaw;
+	mYawVelocity = 0.0f;
+	mPitch = glm::clamp(_pitch, -MAX_CAMERA_PITCH, MAX_CAMERA_PITCH);
+	mTargetPitch = mPitch;
+	mPitchVelocity = 0.0f;
 
 	update();
 }
 
+void Camera::setWorldPosition(const glm::dvec3& _position)
+{
+	mOrigin = _position;
+	mPosition = glm::vec3(0.0f);
+	mTargetPosition = glm::vec3(0.0f);
+	mVelocity = glm::vec3(0.0f);
+	mPreviousPosition = glm::vec3(0.0f);
+	mViewPosition = glm::vec3(0.0f);
+
+	mViewDirty = true;
+	mViewProjectionDirty = true;
+}
+
+bool Camera::rebase()
+{
+	if (glm::length(mPosition) <= mRebaseDistance || mPosition == glm::vec3(0.0f))
+	{
+		return false;
+	}
+
+	// Every position shifts by the same amount, so interpolation and smoothing carry on undisturbed.
+	glm::vec3 offset = mPosition;
+
+	mOrigin += glm::dvec3(offset);
+	mPosition = glm::vec3(0.0f);
+	mTargetPosition -= offset;
+	mPreviousPosition -= offset;
+	mViewPosition -= offset;
+
+	mViewDirty = true;
+	mViewProjectionDirty = true;
+
+	return true;
+}
+
+void Camera::setProjection(GLfloat _fieldOfView, GLfloat _aspectRatio, GLfloat _nearPlane, GLfloat _farPlane)
+{
+	if (_fieldOfView == mFieldOfView && _aspectRatio == mAspectRatio && _nearPlane == mNearPlane && _farPlane == mFarPlane && !mProjectionDirty)
+	{
+		return;
+	}
+
+	mFieldOfView = _fieldOfView;
+	mAspectRatio = _aspectRatio;
+	mNearPlane = _nearPlane;
+	mFarPlane = _farPlane;
+
+	mProjectionDirty = true;
+	mViewProjectionDirty = true;
+}
+
+void Camera::setReverseZ(bool _enabled)
+{
+	if (_enabled == mReverseZ)
+	{
+		return;
+	}
+
+	mReverseZ = _enabled;
+
+	mProjectionDirty = true;
+	mViewProjectionDirty = true;
+}
+
+const glm::mat4& Camera::getView()
+{
+	if (mViewDirty)
+	{
+		// The inverse of the camera's rotation and translation, without the trig of a look at.
+		mView = glm::mat4_cast(glm::conjugate(mOrientation)) * glm::translate(glm::mat4(1.0f), -mViewPosition);
+
+		mViewDirty = false;
+		mViewProjectionDirty = true;
+	}
+
+	return mView;
+}
+
+const glm::mat4& Camera::getProjection()
+{
+	if (mProjectionDirty)
+	{
+		if (mReverseZ)
+		{
+			// Clip depth is the near distance, so depth is near / distance: one at the near plane, zero at infinity.
+			GLfloat focalLength = 1.0f / tanf(mFieldOfView * 0.5f);
+
+			mProjection = glm::mat4(0.0f);
+			mProjection[0][0] = focalLength / mAspectRatio;
+			mProjection[1][1] = focalLength;
+			mProjection[2][3] = -1.0f;
+			mProjection[3][2] = mNearPlane;
+		}
+		else
+		{
+			mProjection = glm::perspective(mFieldOfView, mAspectRatio, mNearPlane, mFarPlane);
+		}
+
+		mProjectionDirty = false;
+		mViewProjectionDirty = true;
+	}
+
+	return mProjection;
+}
+
+const glm::mat4& Camera::getViewProjection()
+{
+	updateViewProjection();
+
+	return mViewProjection;
+}
+
+const glm::vec4* Camera::getFrustumPlanes()
+{
+	updateViewProjection();
+
+	return mPlanes;
+}
+
+bool Camera::isSphereVisible(const glm::vec3& _center, GLfloat _radius)
+{
+	const glm::vec4* pPlanes = getFrustumPlanes();
+
+	for (int counter = 0; counter < (int)FrustumPlane::Count; counter++)
+	{
+		if (glm::dot(glm::vec3(pPlanes[counter]), _center) + pPlanes[counter].w < -_radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 glm::mat4 Camera::calculateViewMatrix()
 {
-	return glm::lookAt(mPosition, mPosition + mFront, mUp);
+	if (mViewPosition != mPosition)
+	{
+		mViewPosition = mPosition;
+		mViewDirty = true;
+	}
+
+	return getView();
+}
+
+glm::mat4 Camera::calculateViewMatrix(GLfloat _alpha)
+{
+	// Orientation follows the mouse every frame, so only the position is interpolated.
+	glm::vec3 position = glm::mix(mPreviousPosition, mPosition, _alpha);
+
+	// A camera at rest keeps its cached view.
+	if (mViewPosition != position)
+	{
+		mViewPosition = position;
+		mViewDirty = true;
+	}
+
+	return getView();
+}
+
+void Camera::storePrevious()
+{
+	mPreviousPosition = mPosition;
 }
 
 void Camera::update()
 {
-	mFront.x = cos(glm::radians(mYaw)) * cos(glm::radians(mPitch));
-	mFront.y = sin(glm::radians(mPitch));
-	mFront.z = sin(glm::radians(mYaw)) * cos(glm::radians(mPitch));
+	// Yaw about world up, then pitch about the camera's right. A yaw of -90 degrees looks down -z.
+	mOrientation = glm::angleAxis(glm::radians(-90.0f - mYaw), mWorldUp) * glm::angleAxis(glm::radians(mPitch), glm::vec3(1.0f, 0.0f, 0.0f));
+
+	mFront = mOrientation * glm::vec3(0.0f, 0.0f, -1.0f);
+	mRight = mOrientation * glm::vec3(1.0f, 0.0f, 0.0f);
+	mUp = mOrientation * glm::vec3(0.0f, 1.0f, 0.0f);
+
+	mViewDirty = true;
+	mViewProjectionDirty = true;
+}
+
+void Camera::updateViewProjection()
+{
+	// Either matrix being rebuilt marks the product dirty.
+	getView();
+	getProjection();
+
+	if (!mViewProjectionDirty)
+	{
+		return;
+	}
 
-	mFront = glm::normalize(mFront);
+	mViewProjection = mProjection * mView;
+	Culling::extractPlanes(mViewProjection, mReverseZ, mPlanes);
 
-	mRight = glm::normalize(glm::cross(mFront, mWorldUp));
-	mUp = glm::normalize(glm::cross(mRight, mFront));
+	mViewProjectionDirty = false;
 }
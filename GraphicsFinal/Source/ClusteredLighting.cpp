@@ -0,0 +1,318 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
+
+#include <Profiler.h>
+#include <Shader.h>
+#include <ClusteredLighting.h>
+
+ClusteredLighting::ClusteredLighting()
+{
+	mLightBuffer = 0;
+	mLightTexture = 0;
+	mGridBuffer = 0;
+	mGridTexture = 0;
+	mIndexBuffer = 0;
+	mIndexTexture = 0;
+	mLightCount = 0;
+	mUpdateTime = 0.0;
+
+	// Force the clusters to be built on the first update.
+	mFrustum.farPlane = 0.0f;
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+	// Buffers are deleted in clear() while the context still exists.
+}
+
+void ClusteredLighting::initialize()
+{
+	GLuint buffers[3];
+	GLuint textures[3];
+
+	glGenBuffers(3, buffers);
+	glGenTextures(3, textures);
+
+	mLightBuffer = buffers[0];
+	mGridBuffer = buffers[1];
+	mIndexBuffer = buffers[2];
+
+	mLightTexture = textures[0];
+	mGridTexture = textures[1];
+	mIndexTexture = textures[2];
+
+	// Every buffer needs storage before a texture can view it.
+	glm::vec4 emptyLight[2] = { glm::vec4(0.0f), glm::vec4(0.0f) };
+	upload(mLightBuffer, emptyLight, sizeof(emptyLight));
+
+	mGrid.assign(CLUSTER_COUNT * 2, 0);
+	upload(mGridBuffer, mGrid.data(), mGrid.size() * sizeof(GLuint));
+
+	GLushort emptyIndex = 0;
+	upload(mIndexBuffer, &emptyIndex, sizeof(emptyIndex));
+
+	// View the buffers as textures.
+	glBindTexture(GL_TEXTURE_BUFFER, mLightTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mLightBuffer);
+
+	glBindTexture(GL_TEXTURE_BUFFER, mGridTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, mGridBuffer);
+
+	glBindTexture(GL_TEXTURE_BUFFER, mIndexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, mIndexBuffer);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::update(const std::vector<PointLight>& _lights, const ViewFrustum& _frustum)
+{
+	double start = glfwGetTime();
+
+	// Cluster bounds only depend on the projection.
+	if (_frustum.fieldOfView != mFrustum.fieldOfView || _frustum.aspectRatio != mFrustum.aspectRatio ||
+		_frustum.nearPlane != mFrustum.nearPlane || _frustum.farPlane != mFrustum.farPlane)
+	{
+		buildClusters(_frustum);
+	}
+
+	mFrustum = _frustum;
+	mLightCount = (GLuint)glm::min(_lights.size(), (size_t)MAX_POINT_LIGHTS);
+
+	float tanHalfY = tanf(_frustum.fieldOfView * 0.5f);
+	float tanHalfX = tanHalfY * _frustum.aspectRatio;
+
+	mLightData.resize((size_t)mLightCount * 2);
+	mClusterCounts.assign(CLUSTER_COUNT, 0);
+	mLightClusters.clear();
+	mLightClusterOffsets.resize((size_t)mLightCount + 1);
+
+	// Pass 1: find the clusters each light touches.
+	for (GLuint light = 0; light < mLightCount; light++)
+	{
+		const PointLight& pointLight = _lights[light];
+
+		glm::vec3 center = glm::vec3(_frustum.view * glm::vec4(pointLight.position, 1.0f));
+		float radius = pointLight.radius;
+
+		// Shaders light in view space.
+		mLightData[light * 2] = glm::vec4(center, radius);
+		mLightData[light * 2 + 1] = glm::vec4(pointLight.color * pointLight.intensity, 0.0f);
+		mLightClusterOffsets[light] = (GLuint)mLightClusters.size();
+
+		// View space looks down -z.
+		float depth = -center.z;
+		float nearDepth = glm::max(depth - radius, _frustum.nearPlane);
+		float farDepth = glm::min(depth + radius, _frustum.farPlane);
+
+		// Entirely in front of the near plane or behind the far plane.
+		if (nearDepth > farDepth)
+		{
+			continue;
+		}
+
+		// Conservative screen bounds of the light's view space box. For a fixed x, x / depth
+		// is monotonic in depth, so the extremes are at the box corners.
+		float minX = 1.0f;
+		float maxX = -1.0f;
+		float minY = 1.0f;
+		float maxY = -1.0f;
+
+		for (int corner = 0; corner < 8; corner++)
+		{
+			float cornerDepth = (corner & 1) ? farDepth : nearDepth;
+			float x = center.x + ((corner & 2) ? radius : -radius);
+			float y = center.y + ((corner & 4) ? radius : -radius);
+
+			minX = glm::min(minX, x / (cornerDepth * tanHalfX));
+			maxX = glm::max(maxX, x / (cornerDepth * tanHalfX));
+			minY = glm::min(minY, y / (cornerDepth * tanHalfY));
+			maxY = glm::max(maxY, y / (cornerDepth * tanHalfY));
+		}
+
+		// Off screen.
+		if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+		{
+			continue;
+		}
+
+		GLint tileX0 = glm::clamp((GLint)((minX * 0.5f + 0.5f) * CLUSTER_COUNT_X), 0, (GLint)CLUSTER_COUNT_X - 1);
+		GLint tileX1 = glm::clamp((GLint)((maxX * 0.5f + 0.5f) * CLUSTER_COUNT_X), 0, (GLint)CLUSTER_COUNT_X - 1);
+		GLint tileY0 = glm::clamp((GLint)((minY * 0.5f + 0.5f) * CLUSTER_COUNT_Y), 0, (GLint)CLUSTER_COUNT_Y - 1);
+		GLint tileY1 = glm::clamp((GLint)((maxY * 0.5f + 0.5f) * CLUSTER_COUNT_Y), 0, (GLint)CLUSTER_COUNT_Y - 1);
+		GLint slice0 = depthSlice(nearDepth);
+		GLint slice1 = depthSlice(farDepth);
+
+		float radiusSquared = radius * radius;
+
+		// Refine the range with a sphere against box test.
+		for (GLint slice = slice0; slice <= slice1; slice++)
+		{
+			for (GLint tileY = tileY0; tileY <= tileY1; tileY++)
+			{
+				for (GLint tileX = tileX0; tileX <= tileX1; tileX++)
+				{
+					GLuint cluster = (slice * CLUSTER_COUNT_Y + tileY) * CLUSTER_COUNT_X + tileX;
+
+					glm::vec3 closest = glm::clamp(center, mClusterMin[cluster], mClusterMax[cluster]);
+					glm::vec3 offset = closest - center;
+
+					if (glm::dot(offset, offset) <= radiusSquared)
+					{
+						mLightClusters.push_back(cluster);
+						mClusterCounts[cluster]++;
+					}
+				}
+			}
+		}
+	}
+
+	mLightClusterOffsets[mLightCount] = (GLuint)mLightClusters.size();
+
+	// Pass 2: prefix sum the counts into offsets.
+	mGrid.resize(CLUSTER_COUNT * 2);
+
+	GLuint offset = 0;
+
+	for (GLuint cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		mGrid[cluster * 2] = offset;
+		mGrid[cluster * 2 + 1] = mClusterCounts[cluster];
+
+		offset += mClusterCounts[cluster];
+
+		// Reuse the counts as write cursors.
+		mClusterCounts[cluster] = 0;
+	}
+
+	// Pass 3: scatter the light indices into each cluster's range.
+	mIndices.resize(glm::max(offset, 1u));
+
+	for (GLuint light = 0; light < mLightCount; light++)
+	{
+		for (GLuint entry = mLightClusterOffsets[light]; entry < mLightClusterOffsets[light + 1]; entry++)
+		{
+			GLuint cluster = mLightClusters[entry];
+
+			mIndices[mGrid[cluster * 2] + mClusterCounts[cluster]++] = (GLushort)light;
+		}
+	}
+
+	// Upload the results.
+	if (mLightCount > 0)
+	{
+		upload(mLightBuffer, mLightData.data(), mLightData.size() * sizeof(glm::vec4));
+	}
+
+	upload(mGridBuffer, mGrid.data(), mGrid.size() * sizeof(GLuint));
+	upload(mIndexBuffer, mIndices.data(), mIndices.size() * sizeof(GLushort));
+
+	mUpdateTime = (glfwGetTime() - start) * 1000.0;
+}
+
+void ClusteredLighting::bind(const Shader& _shader, GLint _screenWidth, GLint _screenHeight)
+{
+	// Bind the buffers to consecutive texture units.
+	glActiveTexture(GL_TEXTURE0 + LIGHTING_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, mLightTexture);
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTING_TEXTURE_UNIT + 1);
+	glBindTexture(GL_TEXTURE_BUFFER, mGridTexture);
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTING_TEXTURE_UNIT + 2);
+	glBindTexture(GL_TEXTURE_BUFFER, mIndexTexture);
+
+	glActiveTexture(GL_TEXTURE0);
+
+	// Map view depth to a slice: slice = log(depth) * scale + bias.
+	float logRatio = logf(mFrustum.farPlane / mFrustum.nearPlane);
+	float sliceScale = CLUSTER_COUNT_Z / logRatio;
+	float sliceBias = -CLUSTER_COUNT_Z * logf(mFrustum.nearPlane) / logRatio;
+
+	glUniform1i(_shader.getUniform(ShaderUniform::LightData), LIGHTING_TEXTURE_UNIT);
+	glUniform1i(_shader.getUniform(ShaderUniform::ClusterGrid), LIGHTING_TEXTURE_UNIT + 1);
+	glUniform1i(_shader.getUniform(ShaderUniform::LightIndices), LIGHTING_TEXTURE_UNIT + 2);
+	glUniform3i(_shader.getUniform(ShaderUniform::ClusterCount), CLUSTER_COUNT_X, CLUSTER_COUNT_Y, CLUSTER_COUNT_Z);
+	glUniform2f(_shader.getUniform(ShaderUniform::ClusterTileScale), (GLfloat)CLUSTER_COUNT_X / _screenWidth, (GLfloat)CLUSTER_COUNT_Y / _screenHeight);
+	glUniform2f(_shader.getUniform(ShaderUniform::ClusterSlice), sliceScale, sliceBias);
+}
+
+void ClusteredLighting::clear()
+{
+	// Check for existing buffers.
+	if (mLightBuffer != 0)
+	{
+		GLuint buffers[3] = { mLightBuffer, mGridBuffer, mIndexBuffer };
+		GLuint textures[3] = { mLightTexture, mGridTexture, mIndexTexture };
+
+		// Delete the buffers from graphics memory.
+		glDeleteTextures(3, textures);
+		glDeleteBuffers(3, buffers);
+
+		// Clear the buffers.
+		mLightBuffer = 0;
+		mGridBuffer = 0;
+		mIndexBuffer = 0;
+		mLightTexture = 0;
+		mGridTexture = 0;
+		mIndexTexture = 0;
+	}
+}
+
+void ClusteredLighting::buildClusters(const ViewFrustum& _frustum)
+{
+	mClusterMin.resize(CLUSTER_COUNT);
+	mClusterMax.resize(CLUSTER_COUNT);
+
+	float tanHalfY = tanf(_frustum.fieldOfView * 0.5f);
+	float tanHalfX = tanHalfY * _frustum.aspectRatio;
+	float ratio = _frustum.farPlane / _frustum.nearPlane;
+
+	for (GLuint slice = 0; slice < CLUSTER_COUNT_Z; slice++)
+	{
+		// Exponential slices keep clusters roughly cube shaped.
+		float nearDepth = _frustum.nearPlane * powf(ratio, (float)slice / CLUSTER_COUNT_Z);
+		float farDepth = _frustum.nearPlane * powf(ratio, (float)(slice + 1) / CLUSTER_COUNT_Z);
+
+		for (GLuint tileY = 0; tileY < CLUSTER_COUNT_Y; tileY++)
+		{
+			float y0 = (2.0f * tileY / CLUSTER_COUNT_Y - 1.0f) * tanHalfY;
+			float y1 = (2.0f * (tileY + 1) / CLUSTER_COUNT_Y - 1.0f) * tanHalfY;
+
+			for (GLuint tileX = 0; tileX < CLUSTER_COUNT_X; tileX++)
+			{
+				float x0 = (2.0f * tileX / CLUSTER_COUNT_X - 1.0f) * tanHalfX;
+				float x1 = (2.0f * (tileX + 1) / CLUSTER_COUNT_X - 1.0f) * tanHalfX;
+
+				GLuint cluster = (slice * CLUSTER_COUNT_Y + tileY) * CLUSTER_COUNT_X + tileX;
+
+				// The tile's side planes widen with depth, so take both ends of the slice.
+				mClusterMin[cluster] = glm::vec3(glm::min(x0 * nearDepth, x0 * farDepth), glm::min(y0 * nearDepth, y0 * farDepth), -farDepth);
+				mClusterMax[cluster] = glm::vec3(glm::max(x1 * nearDepth, x1 * farDepth), glm::max(y1 * nearDepth, y1 * farDepth), -nearDepth);
+			}
+		}
+	}
+}
+
+GLint ClusteredLighting::depthSlice(GLfloat _depth) const
+{
+	float logRatio = logf(mFrustum.farPlane / mFrustum.nearPlane);
+	GLint slice = (GLint)(logf(_depth / mFrustum.nearPlane) / logRatio * CLUSTER_COUNT_Z);
+
+	return glm::clamp(slice, 0, (GLint)CLUSTER_COUNT_Z - 1);
+}
+
+void ClusteredLighting::upload(GLuint _buffer, const void* _pData, size_t _bytes)
+{
+	glBindBuffer(GL_TEXTURE_BUFFER, _buffer);
+
+	// Respecifying the whole store lets the driver orphan the copy still in use.
+	glBufferData(GL_TEXTURE_BUFFER, _bytes, _pData, GL_STREAM_DRAW);
+	Profiler::countUpload(_bytes);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
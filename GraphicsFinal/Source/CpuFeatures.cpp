@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <CpuFeatures.h>
+
+#if defined(SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	CpuFeatureFlags detectFeatures()
+	{
+		CpuFeatureFlags flags;
+
+#ifdef SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		int highestLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool sse41 = (info[2] & (1 << 19)) != 0;
+		bool sse42 = (info[2] & (1 << 20)) != 0;
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool xsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		// Which register states the OS saves on context switches: SSE and AVX, then the AVX-512 mask and upper halves.
+		unsigned long long state = xsave ? _xgetbv(0) : 0;
+		bool osAvx = (state & 0x6) == 0x6;
+		bool osAvx512 = (state & 0xE6) == 0xE6;
+
+		bool avx2 = false;
+		bool avx512 = false;
+
+		if (highestLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+
+			// Foundation, doubleword and quadword, and vector length.
+			avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 17)) != 0 && (info[1] & (1 << 31)) != 0;
+		}
+
+		flags.sse42 = sse41 && sse42;
+		flags.avx2 = flags.sse42 && avx && avx2 && fma && osAvx;
+		flags.avx512 = flags.avx2 && avx512 && osAvx512;
+#else
+		// Also checks that the OS saves the wider registers.
+		__builtin_cpu_init();
+
+		flags.sse42 = __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("sse4.2");
+		flags.avx2 = flags.sse42 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		flags.avx512 = flags.avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+#endif
+#endif
+
+		return flags;
+	}
+
+	/// <summary> Level the kernels currently run with. </summary>
+	SimdLevel& activeLevel()
+	{
+		static SimdLevel level = CpuFeatures::getSupportedLevel();
+
+		return level;
+	}
+
+	/// <summary> Names of the levels, indexed by level. </summary>
+	const char* const SIMD_LEVEL_NAMES[(int)SimdLevel::Count] = { "scalar", "sse4", "avx2", "avx512" };
+}
+
+const CpuFeatureFlags& CpuFeatures::getFlags()
+{
+	static CpuFeatureFlags flags = detectFeatures();
+
+	return flags;
+}
+
+SimdLevel CpuFeatures::getSupportedLevel()
+{
+	const CpuFeatureFlags& flags = getFlags();
+
+	if (flags.avx512)
+	{
+		return SimdLevel::AVX512;
+	}
+
+	if (flags.avx2)
+	{
+		return SimdLevel::AVX2;
+	}
+
+	if (flags.sse42)
+	{
+		return SimdLevel::SSE4;
+	}
+
+	return SimdLevel::Scalar;
+}
+
+SimdLevel CpuFeatures::getLevel()
+{
+	return activeLevel();
+}
+
+void CpuFeatures::setLevel(SimdLevel _level)
+{
+	SimdLevel supported = getSupportedLevel();
+
+	activeLevel() = _level < supported ? _level : supported;
+}
+
+const char* CpuFeatures::getLevelName(SimdLevel _level)
+{
+	return _level < SimdLevel::Count ? SIMD_LEVEL_NAMES[(int)_level] : "unknown";
+}
+
+bool CpuFeatures::parseLevel(const char* _pName, SimdLevel& _level)
+{
+	for (int level = 0; level < (int)SimdLevel::Count; level++)
+	{
+		if (strcmp(_pName, SIMD_LEVEL_NAMES[level]) == 0)
+		{
+			_level = (SimdLevel)level;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,293 @@
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <CpuFeatures.h>
+#include <BatchMath.h>
+#include <Mesh.h>
+#include <Culling.h>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	const int PLANE_COUNT = (int)FrustumPlane::Count;
+
+	/// <summary> Plane with the box corner furthest along its normal, one component array per axis. </summary>
+	struct CullPlane
+	{
+		glm::vec4 plane;
+		const GLfloat* pX;
+		const GLfloat* pY;
+		const GLfloat* pZ;
+	};
+
+	typedef size_t (*CullKernel)(const CullPlane* _pPlanes, size_t _count, GLuint* _pVisible);
+
+	void selectCorners(const glm::vec4* _pPlanes, const BoundsSoA& _bounds, CullPlane* _pResult)
+	{
+		for (int counter = 0; counter < PLANE_COUNT; counter++)
+		{
+			const glm::vec4& plane = _pPlanes[counter];
+
+			_pResult[counter].plane = plane;
+			_pResult[counter].pX = plane.x >= 0.0f ? _bounds.maxX.data() : _bounds.minX.data();
+			_pResult[counter].pY = plane.y >= 0.0f ? _bounds.maxY.data() : _bounds.minY.data();
+			_pResult[counter].pZ = plane.z >= 0.0f ? _bounds.maxZ.data() : _bounds.minZ.data();
+		}
+	}
+
+	size_t cullRange(const CullPlane* _pPlanes, size_t _begin, size_t _end, GLuint* _pVisible)
+	{
+		size_t visibleCount = 0;
+
+		for (size_t index = _begin; index < _end; index++)
+		{
+			bool visible = true;
+
+			for (int counter = 0; counter < PLANE_COUNT && visible; counter++)
+			{
+				const CullPlane& plane = _pPlanes[counter];
+				visible = plane.plane.x * plane.pX[index] + plane.plane.y * plane.pY[index] + plane.plane.z * plane.pZ[index] + plane.plane.w >= 0.0f;
+			}
+
+			if (visible)
+			{
+				_pVisible[visibleCount++] = (GLuint)index;
+			}
+		}
+
+		return visibleCount;
+	}
+
+	size_t cullScalar(const CullPlane* _pPlanes, size_t _count, GLuint* _pVisible)
+	{
+		return cullRange(_pPlanes, 0, _count, _pVisible);
+	}
+
+#ifdef SIMD_X86
+	// Every plane is tested on all boxes of the iteration without branching, then the indices of the survivors are
+	// written from the bit mask.
+
+	size_t writeMaskIndices(unsigned int _mask, size_t _base, GLuint* _pVisible)
+	{
+		size_t visibleCount = 0;
+
+		while (_mask != 0)
+		{
+			unsigned int bit = 0;
+
+			while ((_mask & (1u << bit)) == 0)
+			{
+				bit++;
+			}
+
+			_pVisible[visibleCount++] = (GLuint)(_base + bit);
+			_mask &= _mask - 1;
+		}
+
+		return visibleCount;
+	}
+
+	SIMD_TARGET_SSE4 size_t cullSse4(const CullPlane* _pPlanes, size_t _count, GLuint* _pVisible)
+	{
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t visibleCount = 0;
+		size_t index = 0;
+
+		for (; index + 4 <= _count; index += 4)
+		{
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+			for (int counter = 0; counter < PLANE_COUNT; counter++)
+			{
+				const CullPlane& plane = _pPlanes[counter];
+
+				__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.plane.x), _mm_loadu_ps(plane.pX + index)), _mm_set1_ps(plane.plane.w));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.plane.y), _mm_loadu_ps(plane.pY + index)));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.plane.z), _mm_loadu_ps(plane.pZ + index)));
+
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+			}
+
+			visibleCount += writeMaskIndices((unsigned int)_mm_movemask_ps(inside), index, _pVisible + visibleCount);
+		}
+
+		return visibleCount + cullRange(_pPlanes, index, _count, _pVisible + visibleCount);
+	}
+
+	SIMD_TARGET_AVX2 size_t cullAvx2(const CullPlane* _pPlanes, size_t _count, GLuint* _pVisible)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+
+		size_t visibleCount = 0;
+		size_t index = 0;
+
+		for (; index + 8 <= _count; index += 8)
+		{
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+			for (int counter = 0; counter < PLANE_COUNT; counter++)
+			{
+				const CullPlane& plane = _pPlanes[counter];
+
+				__m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.plane.x), _mm256_loadu_ps(plane.pX + index), _mm256_set1_ps(plane.plane.w));
+				distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.plane.y), _mm256_loadu_ps(plane.pY + index), distance);
+				distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.plane.z), _mm256_loadu_ps(plane.pZ + index), distance);
+
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+			}
+
+			visibleCount += writeMaskIndices((unsigned int)_mm256_movemask_ps(inside), index, _pVisible + visibleCount);
+		}
+
+		return visibleCount + cullRange(_pPlanes, index, _count, _pVisible + visibleCount);
+	}
+
+SIMD_AVX512_BEGIN
+
+	SIMD_TARGET_AVX512 size_t cullAvx512(const CullPlane* _pPlanes, size_t _count, GLuint* _pVisible)
+	{
+		const __m512 zero = _mm512_setzero_ps();
+		const __m512i lanes = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+		size_t visibleCount = 0;
+		size_t index = 0;
+
+		for (; index < _count; index += 16)
+		{
+			// The last iteration masks off the boxes past the end instead of falling back to scalar code.
+			size_t remaining = _count - index;
+			__mmask16 inside = remaining >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << remaining) - 1);
+
+			for (int counter = 0; counter < PLANE_COUNT; counter++)
+			{
+				const CullPlane& plane = _pPlanes[counter];
+
+				__m512 distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.plane.x), _mm512_maskz_loadu_ps(inside, plane.pX + index), _mm512_set1_ps(plane.plane.w));
+				distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.plane.y), _mm512_maskz_loadu_ps(inside, plane.pY + index), distance);
+				distance = _mm512_fmadd_ps(_mm512_set1_ps(plane.plane.z), _mm512_maskz_loadu_ps(inside, plane.pZ + index), distance);
+
+				inside = _mm512_mask_cmp_ps_mask(inside, distance, zero, _CMP_GE_OQ);
+			}
+
+			// Compress the indices of the survivors into the front of the output.
+			__m512i indices = _mm512_add_epi32(lanes, _mm512_set1_epi32((int)index));
+			_mm512_mask_compressstoreu_epi32(_pVisible + visibleCount, inside, indices);
+
+			visibleCount += (size_t)_mm_popcnt_u32((unsigned int)inside);
+		}
+
+		return visibleCount;
+	}
+
+SIMD_AVX512_END
+#endif
+
+	/// <summary> Kernels of every level. Levels the build cannot target use the scalar one. </summary>
+	const CullKernel CULL_KERNELS[(int)SimdLevel::Count] =
+	{
+		cullScalar,
+#ifdef SIMD_X86
+		cullSse4,
+		cullAvx2,
+		cullAvx512,
+#else
+		cullScalar,
+		cullScalar,
+		cullScalar,
+#endif
+	};
+}
+
+void Culling::extractPlanes(const glm::mat4& _viewProjection, bool _reverseZ, glm::vec4* _pPlanes)
+{
+	glm::mat4 rows = glm::transpose(_viewProjection);
+
+	_pPlanes[(int)FrustumPlane::Left] = rows[3] + rows[0];
+	_pPlanes[(int)FrustumPlane::Right] = rows[3] - rows[0];
+	_pPlanes[(int)FrustumPlane::Bottom] = rows[3] + rows[1];
+	_pPlanes[(int)FrustumPlane::Top] = rows[3] - rows[1];
+	if (_reverseZ)
+	{
+		// Depth from one at the near plane down to zero, which is only reached at infinity.
+		_pPlanes[(int)FrustumPlane::Near] = rows[3] - rows[2];
+		_pPlanes[(int)FrustumPlane::Far] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else
+	{
+		_pPlanes[(int)FrustumPlane::Near] = rows[3] + rows[2];
+		_pPlanes[(int)FrustumPlane::Far] = rows[3] - rows[2];
+	}
+
+	// The infinite far plane has no normal to normalize.
+	for (int counter = 0; counter < PLANE_COUNT; counter++)
+	{
+		GLfloat length = glm::length(glm::vec3(_pPlanes[counter]));
+
+		if (length > 0.0f)
+		{
+			_pPlanes[counter] /= length;
+		}
+	}
+}
+
+size_t Culling::cullBounds(const glm::vec4* _pPlanes, const BoundsSoA& _bounds, GLuint* _pVisible)
+{
+	CullPlane planes[PLANE_COUNT];
+	selectCorners(_pPlanes, _bounds, planes);
+
+	return CULL_KERNELS[(int)CpuFeatures::getLevel()](planes, _bounds.size(), _pVisible);
+}
+
+void Culling::transformPlanes(const glm::vec4* _pPlanes, const glm::mat4& _model, glm::vec4* _pLocalPlanes)
+{
+	for (int counter = 0; counter < PLANE_COUNT; counter++)
+	{
+		// A local point p is on the world side of plane n when dot(n, model * p) = dot(n * model, p) is positive.
+		_pLocalPlanes[counter] = _pPlanes[counter] * _model;
+
+		GLfloat length = glm::length(glm::vec3(_pLocalPlanes[counter]));
+
+		if (length > 0.0f)
+		{
+			_pLocalPlanes[counter] /= length;
+		}
+	}
+}
+
+size_t Culling::cullMeshlets(const glm::vec4* _pPlanes, const glm::vec3& _cameraPosition, bool _backfaceCones, const Meshlet* _pMeshlets, size_t _count, GLuint* _pVisible)
+{
+	size_t visibleCount = 0;
+
+	for (size_t counter = 0; counter < _count; counter++)
+	{
+		const Meshlet& meshlet = _pMeshlets[counter];
+		bool visible = true;
+
+		for (int plane = 0; plane < PLANE_COUNT && visible; plane++)
+		{
+			visible = glm::dot(glm::vec3(_pPlanes[plane]), meshlet.center) + _pPlanes[plane].w >= -meshlet.radius;
+		}
+
+		// Every point of the sphere must be seen within 90 degrees minus the cone's angle of the axis, so no
+		// triangle can face the camera. The bound is taken at the sphere's far side to stay conservative.
+		if (visible && _backfaceCones && meshlet.coneCutoff < 1.0f)
+		{
+			glm::vec3 toCenter = meshlet.center - _cameraPosition;
+
+			visible = glm::dot(toCenter, meshlet.coneAxis) - meshlet.radius < meshlet.coneCutoff * (glm::length(toCenter) + meshlet.radius);
+		}
+
+		if (visible)
+		{
+			_pVisible[visibleCount++] = (GLuint)counter;
+		}
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <cmath>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <DynamicResolution.h>
+
+namespace
+{
+	/// <summary> Weight of the newest frame in the GPU time average. </summary>
+	const double RESOLUTION_AVERAGE_WEIGHT = 0.2;
+
+	/// <summary> Scales are multiples of this, so small time changes do not reallocate the targets. </summary>
+	const GLfloat RESOLUTION_SCALE_STEP = 0.05f;
+
+	/// <summary> The scale only grows once the time is below this fraction of the target. </summary>
+	const double RESOLUTION_RAISE_THRESHOLD = 0.85;
+
+	/// <summary> Frames to skip after a change: the queries in flight plus time for the average to settle. </summary>
+	const GLuint RESOLUTION_SETTLE_FRAMES = RESOLUTION_QUERY_FRAMES + 4;
+}
+
+DynamicResolution::DynamicResolution()
+{
+	for (GLuint counter = 0; counter < RESOLUTION_QUERY_FRAMES * 2; counter++)
+	{
+		mQueries[counter] = 0;
+	}
+
+	mFrameCount = 0;
+	mEnabled = false;
+	mScale = 1.0f;
+	mMinScale = DEFAULT_MIN_RESOLUTION_SCALE;
+	mMaxScale = 1.0f;
+	mTargetTime = DEFAULT_TARGET_GPU_TIME;
+	mAverageTime = 0.0;
+	mSettleFrames = 0;
+	mChangeCount = 0;
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	// Queries are deleted in clear() while the context still exists.
+}
+
+void DynamicResolution::initialize()
+{
+	glGenQueries(RESOLUTION_QUERY_FRAMES * 2, mQueries);
+}
+
+void DynamicResolution::setEnabled(bool _enabled)
+{
+	mEnabled = _enabled;
+
+	// Start from full quality and measure again.
+	mScale = mMaxScale;
+	mAverageTime = 0.0;
+	mSettleFrames = RESOLUTION_SETTLE_FRAMES;
+}
+
+void DynamicResolution::setScaleRange(GLfloat _minimum, GLfloat _maximum)
+{
+	mMinScale = glm::clamp(_minimum, RESOLUTION_SCALE_STEP, 1.0f);
+	mMaxScale = glm::clamp(_maximum, mMinScale, 1.0f);
+	mScale = glm::clamp(mScale, mMinScale, mMaxScale);
+}
+
+void DynamicResolution::beginFrame()
+{
+	if (!mEnabled)
+	{
+		return;
+	}
+
+	// The slot this frame will use holds the oldest frame in flight. Read it if it finished, otherwise skip it.
+	GLuint slot = (GLuint)(mFrameCount % RESOLUTION_QUERY_FRAMES);
+
+	if (mFrameCount >= RESOLUTION_QUERY_FRAMES)
+	{
+		GLuint available = 0;
+		glGetQueryObjectuiv(mQueries[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available)
+		{
+			GLuint64 start = 0;
+			GLuint64 end = 0;
+			glGetQueryObjectui64v(mQueries[slot * 2], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(mQueries[slot * 2 + 1], GL_QUERY_RESULT, &end);
+
+			adjust((double)(end - start) / 1000000.0);
+		}
+	}
+
+	glQueryCounter(mQueries[slot * 2], GL_TIMESTAMP);
+}
+
+void DynamicResolution::endFrame()
+{
+	if (!mEnabled)
+	{
+		return;
+	}
+
+	glQueryCounter(mQueries[(mFrameCount % RESOLUTION_QUERY_FRAMES) * 2 + 1], GL_TIMESTAMP);
+
+	mFrameCount++;
+}
+
+void DynamicResolution::scaleSize(GLint _width, GLint _height, GLint& _scaledWidth, GLint& _scaledHeight) const
+{
+	GLfloat scale = getScale();
+
+	_scaledWidth = glm::max((GLint)(_width * scale + 0.5f), 1);
+	_scaledHeight = glm::max((GLint)(_height * scale + 0.5f), 1);
+}
+
+void DynamicResolution::clear()
+{
+	// Check for existing queries.
+	if (mQueries[0] != 0)
+	{
+		glDeleteQueries(RESOLUTION_QUERY_FRAMES * 2, mQueries);
+
+		for (GLuint counter = 0; counter < RESOLUTION_QUERY_FRAMES * 2; counter++)
+		{
+			mQueries[counter] = 0;
+		}
+	}
+
+	mFrameCount = 0;
+}
+
+void DynamicResolution::adjust(double _gpuTime)
+{
+	if (mAverageTime == 0.0)
+	{
+		mAverageTime = _gpuTime;
+	}
+	else
+	{
+		mAverageTime += (_gpuTime - mAverageTime) * RESOLUTION_AVERAGE_WEIGHT;
+	}
+
+	if (mSettleFrames > 0)
+	{
+		mSettleFrames--;
+		return;
+	}
+
+	// Only shrink when over the target and only grow with clear headroom, so the scale does not oscillate.
+	bool shrink = mAverageTime > mTargetTime;
+	bool grow = mAverageTime < mTargetTime * RESOLUTION_RAISE_THRESHOLD && mScale < mMaxScale;
+
+	if (!shrink && !grow)
+	{
+		return;
+	}
+
+	// Shading cost follows the pixel count, which is the square of the scale.
+	GLfloat ideal = mScale * (GLfloat)sqrt(mTargetTime / mAverageTime);
+
+	// Round down to a step so the target is met rather than just missed.
+	GLfloat scale = glm::clamp(floorf(ideal / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP, mMinScale, mMaxScale);
+
+	if (fabsf(scale - mScale) < RESOLUTION_SCALE_STEP * 0.5f)
+	{
+		return;
+	}
+
+	// Predict the new time so the average does not lag behind the change.
+	mAverageTime *= (double)(scale * scale) / (double)(mScale * mScale);
+	mScale = scale;
+	mSettleFrames = RESOLUTION_SETTLE_FRAMES;
+	mChangeCount++;
+}
@@ -0,0 +1,59 @@
+#include <GL/glew.h>
+
+#include <FixedTimestep.h>
+
+FixedTimestep::FixedTimestep()
+{
+	mStep = DEFAULT_FIXED_STEP;
+	mMaxSteps = DEFAULT_MAX_STEPS;
+	mAccumulator = 0.0;
+	mStepsThisFrame = 0;
+	mSimulationTime = 0.0;
+	mDroppedTime = 0.0;
+}
+
+FixedTimestep::FixedTimestep(double _step, GLuint _maxSteps)
+{
+	mStep = _step > 0.0 ? _step : DEFAULT_FIXED_STEP;
+	mMaxSteps = _maxSteps > 0 ? _maxSteps : 1;
+	mAccumulator = 0.0;
+	mStepsThisFrame = 0;
+	mSimulationTime = 0.0;
+	mDroppedTime = 0.0;
+}
+
+void FixedTimestep::advance(double _frameTime)
+{
+	// Ignore clocks going backwards.
+	if (_frameTime < 0.0)
+	{
+		_frameTime = 0.0;
+	}
+
+	mAccumulator += _frameTime;
+	mStepsThisFrame = 0;
+
+	// Spiral of death guard: never queue more work than the step limit can consume.
+	double maxAccumulated = mStep * mMaxSteps;
+
+	if (mAccumulator > maxAccumulated)
+	{
+		mDroppedTime += mAccumulator - maxAccumulated;
+		mAccumulator = maxAccumulated;
+	}
+}
+
+bool FixedTimestep::step()
+{
+	// No full step left or the limit for this frame is reached.
+	if (mAccumulator < mStep || mStepsThisFrame >= mMaxSteps)
+	{
+		return false;
+	}
+
+	mAccumulator -= mStep;
+	mSimulationTime += mStep;
+	mStepsThisFrame++;
+
+	return true;
+}
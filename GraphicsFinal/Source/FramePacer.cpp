@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <atomic>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <Input.h>
+#include <GL_Window.h>
+#include <FramePacer.h>
+
+namespace
+{
+	/// <summary> Weight of the newest sample in the latency averages. </summary>
+	const double AVERAGE_WEIGHT = 0.1;
+
+	/// <summary> Time to wait on a fence before checking again, in nanoseconds. </summary>
+	const GLuint64 FENCE_TIMEOUT = 1000000;
+
+	/// <summary> Blend a sample into an exponential moving average. </summary>
+	void accumulate(double& _average, double _sample)
+	{
+		_average += (_sample - _average) * AVERAGE_WEIGHT;
+	}
+}
+
+FramePacer::FramePacer()
+{
+	mFramesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+	mSwapMode = SwapMode::VSync;
+	mFrameIndex = 0;
+	mInputTime = 0;
+	mPresentLatency = 0.0;
+	mGpuLatency = 0.0;
+	mFenceWait = 0.0;
+}
+
+FramePacer::~FramePacer()
+{
+	// Fences are deleted in clear() while the context still exists.
+}
+
+void FramePacer::initialize(GLuint _framesInFlight, SwapMode _mode)
+{
+	for (GLuint counter = 0; counter < MAX_FRAMES_IN_FLIGHT; counter++)
+	{
+		glGenQueries(2, mSlots[counter].queries);
+	}
+
+	setFramesInFlight(_framesInFlight);
+	setSwapMode(_mode);
+}
+
+void FramePacer::setSwapMode(SwapMode _mode)
+{
+	mSwapMode = _mode;
+
+	switch (_mode)
+	{
+	case SwapMode::Adaptive:
+		// Negative intervals enable late swap tearing where it is supported.
+		if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+		{
+			glfwSwapInterval(-1);
+		}
+		else
+		{
+			printf("Adaptive vsync is not supported, using vsync.\n");
+
+			mSwapMode = SwapMode::VSync;
+			glfwSwapInterval(1);
+		}
+		break;
+	case SwapMode::Uncapped:
+		glfwSwapInterval(0);
+		break;
+	default:
+		glfwSwapInterval(1);
+		break;
+	}
+}
+
+void FramePacer::setFramesInFlight(GLuint _framesInFlight)
+{
+	// Finish everything queued before changing the ring size.
+	for (GLuint counter = 0; counter < MAX_FRAMES_IN_FLIGHT; counter++)
+	{
+		waitSlot(mSlots[counter]);
+	}
+
+	if (_framesInFlight < 1)
+	{
+		_framesInFlight = 1;
+	}
+	else if (_framesInFlight > MAX_FRAMES_IN_FLIGHT)
+	{
+		_framesInFlight = MAX_FRAMES_IN_FLIGHT;
+	}
+
+	mFramesInFlight = _framesInFlight;
+}
+
+void FramePacer::beginFrame()
+{
+	// The slot this frame will use still holds the frame from N frames ago.
+	waitSlot(mSlots[mFrameIndex % mFramesInFlight]);
+
+	// Pick up the timestamps of every frame that has finished so far.
+	readLatencies();
+}
+
+void FramePacer::markInputPoll()
+{
+	// The GPU clock now, so the latency is measured on one clock with the frame's timestamps.
+	glGetInteger64v(GL_TIMESTAMP, &mInputTime);
+}
+
+void FramePacer::present(GL_Window& _window)
+{
+	FrameSlot& slot = mSlots[mFrameIndex % mFramesInFlight];
+
+	// Read the slot's last timestamps if they landed. Reusing the queries drops a sample rather than stall.
+	readLatencies();
+
+	// Timestamp and fence everything submitted for this frame.
+	glQueryCounter(slot.queries[0], GL_TIMESTAMP);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	// Swap to back buffer.
+	_window.swapBuffers();
+
+	// Timestamp the GPU reaching the swap.
+	glQueryCounter(slot.queries[1], GL_TIMESTAMP);
+	slot.inputTime = mInputTime;
+	slot.pending = mInputTime != 0;
+
+	mInputTime = 0;
+	mFrameIndex++;
+}
+
+void FramePacer::clear()
+{
+	for (GLuint counter = 0; counter < MAX_FRAMES_IN_FLIGHT; counter++)
+	{
+		// Check for an existing fence.
+		if (mSlots[counter].fence != 0)
+		{
+			// Delete the fence.
+			glDeleteSync(mSlots[counter].fence);
+
+			// Clear the fence.
+			mSlots[counter].fence = 0;
+		}
+
+		// Delete the queries.
+		if (mSlots[counter].queries[0] != 0)
+		{
+			glDeleteQueries(2, mSlots[counter].queries);
+
+			mSlots[counter].queries[0] = 0;
+			mSlots[counter].queries[1] = 0;
+		}
+
+		mSlots[counter].pending = false;
+	}
+}
+
+void FramePacer::waitSlot(FrameSlot& _slot)
+{
+	// Nothing queued in this slot.
+	if (_slot.fence == 0)
+	{
+		return;
+	}
+
+	double start = glfwGetTime();
+
+	// Flush on the first wait so the fence is guaranteed to signal.
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	GLenum result = GL_TIMEOUT_EXPIRED;
+
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(_slot.fence, flags, FENCE_TIMEOUT);
+		flags = 0;
+	}
+
+	if (result == GL_WAIT_FAILED)
+	{
+		printf("Error waiting on frame fence!\n");
+	}
+
+	// Time blocked.
+	accumulate(mFenceWait, (glfwGetTime() - start) * 1000.0);
+
+	// Delete the fence.
+	glDeleteSync(_slot.fence);
+
+	// Clear the fence.
+	_slot.fence = 0;
+}
+
+void FramePacer::readLatencies()
+{
+	for (GLuint counter = 0; counter < MAX_FRAMES_IN_FLIGHT; counter++)
+	{
+		FrameSlot& slot = mSlots[counter];
+
+		if (!slot.pending)
+		{
+			continue;
+		}
+
+		// The swap timestamp is written last, so both are ready once it is.
+		GLuint available = 0;
+		glGetQueryObjectuiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			continue;
+		}
+
+		GLuint64 complete = 0;
+		GLuint64 swapped = 0;
+		glGetQueryObjectui64v(slot.queries[0], GL_QUERY_RESULT, &complete);
+		glGetQueryObjectui64v(slot.queries[1], GL_QUERY_RESULT, &swapped);
+
+		// Input poll to the GPU finishing the frame and to the GPU executing the swap, both on the GPU clock.
+		accumulate(mGpuLatency, (double)((GLint64)complete - slot.inputTime) / 1000000.0);
+		accumulate(mPresentLatency, (double)((GLint64)swapped - slot.inputTime) / 1000000.0);
+
+		slot.pending = false;
+	}
+}
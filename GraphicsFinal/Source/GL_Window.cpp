@@ -1,24 +1,32 @@
 #include <stdio.h>
+#include <atomic>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <Input.h>
 #include <GL_Window.h>
 
 GL_Window::GL_Window()
 {
+	mpWindow = NULL;
 	mWidth = 800;
 	mHeight = 600;
-
-	initializeKeys();
 }
 
 GL_Window::GL_Window(GLint _width, GLint _height)
 {
+	mpWindow = NULL;
 	mWidth = _width;
 	mHeight = _height;
+}
 
-	initializeKeys();
+GL_Window::GL_Window(GLint _width, GLint _height, bool _visible)
+{
+	mpWindow = NULL;
+	mWidth = _width;
+	mHeight = _height;
+	mVisible = _visible;
 }
 
 GL_Window::~GL_Window()
@@ -59,6 +67,17 @@ int GL_Window::initialize()
 	// Allow forward compatibility.
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
+	// Hidden windows still get a default framebuffer for headless runs.
+	glfwWindowHint(GLFW_VISIBLE, mVisible ? GL_TRUE : GL_FALSE);
+
+#ifdef GRAPHICS_FINAL_EGL
+	// Create headless contexts through EGL rather than GLX/WGL.
+	if (!mVisible)
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	}
+#endif
+
 	// Create new window.
 	mpWindow = glfwCreateWindow(mWidth, mHeight, "Test Window", NULL, NULL);
 
@@ -106,9 +125,6 @@ int GL_Window::initialize()
 		return 1;
 	}
 
-	// Enable depth test.
-	glEnable(GL_DEPTH_TEST);
-
 	// Setup viewport.
 	glViewport(0, 0, mBufferWidth, mBufferHeight);
 
@@ -119,28 +135,52 @@ int GL_Window::initialize()
 	return 0;
 }
 
-GLfloat GL_Window::getMouseDeltaX()
+bool GL_Window::setRawMouseMotion(bool _enabled)
 {
-	GLfloat change = mDeltaMouseX;
+	if (!_enabled)
+	{
+		glfwSetInputMode(mpWindow, GLFW_RAW_MOUSE_MOTION, GLFW_FALSE);
+		glfwSetInputMode(mpWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+		return true;
+	}
 
-	mDeltaMouseX = 0.0f;
+	if (!glfwRawMouseMotionSupported())
+	{
+		printf("Raw mouse motion is not supported!\n");
+		return false;
+	}
 
-	return change;
+	// Raw motion only applies while the cursor is disabled.
+	glfwSetInputMode(mpWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	glfwSetInputMode(mpWindow, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+
+	return true;
 }
 
-GLfloat GL_Window::getMouseDeltaY()
+void GL_Window::runEventLoop(double _rate)
 {
-	GLfloat change = mDeltaMouseY;
+	// Events are handled as they arrive; the timeout only bounds how long a wake up can take.
+	while (!glfwWindowShouldClose(mpWindow))
+	{
+		glfwWaitEventsTimeout(1.0 / _rate);
+	}
+}
 
-	mDeltaMouseY = 0.0f;
+void GL_Window::close()
+{
+	glfwSetWindowShouldClose(mpWindow, GL_TRUE);
 
-	return change;
+	// Wake the event loop so it sees the flag.
+	glfwPostEmptyEvent();
 }
 
 void GL_Window::createCallbacks()
 {
 	glfwSetKeyCallback(mpWindow, handleKeys);
 	glfwSetCursorPosCallback(mpWindow, handleMouse);
+	glfwSetMouseButtonCallback(mpWindow, handleMouseButton);
+	glfwSetScrollCallback(mpWindow, handleScroll);
 }
 
 void GL_Window::handleKeys(GLFWwindow* _pWindow, int _key, int _code, int _action, int _mode)
@@ -153,47 +193,51 @@ void GL_Window::handleKeys(GLFWwindow* _pWindow, int _key, int _code, int _actio
 		glfwSetWindowShouldClose(_pWindow, GL_TRUE);
 	}
 
-	// Make sure key is within the ASCII range.
-	if (_key >= 0 && _key < 1024)
-	{
-		if (_action == GLFW_PRESS)
-		{
-			pWindow->mKeys[_key] = true;
-		}
-		else if (_action == GLFW_RELEASE)
-		{
-			pWindow->mKeys[_key] = false;
-		}
-	}
+	InputEvent event;
+	event.type = InputEventType::Key;
+	event.code = _key;
+	event.action = _action;
+	event.time = glfwGetTime();
+
+	pWindow->mInputQueue.push(event);
 }
 
 void GL_Window::handleMouse(GLFWwindow* _pWindow, double _xPosition, double _yPosition)
 {
 	GL_Window* pWindow = static_cast<GL_Window*>(glfwGetWindowUserPointer(_pWindow));
 
-	if (pWindow->mMouseFirstMoved)
-	{
-		// Set the mouse coordinates for the initial frame.
-		pWindow->mLastMouseX = (GLfloat)_xPosition;
-		pWindow->mLastMouseY = (GLfloat)_yPosition;
+	// Every position is queued so the consumer sees all of the motion, not just the last step.
+	InputEvent event;
+	event.type = InputEventType::MouseMove;
+	event.x = _xPosition;
+	event.y = _yPosition;
+	event.time = glfwGetTime();
 
-		// Mouse moved on the screen already.
-		pWindow->mMouseFirstMoved = false;
-	}
+	pWindow->mInputQueue.push(event);
+}
 
-	// Calculate the change in the mouse position.
-	pWindow->mDeltaMouseX = (GLfloat)_xPosition - pWindow->mLastMouseX;
-	pWindow->mDeltaMouseY = pWindow->mLastMouseY - (GLfloat)_yPosition;
+void GL_Window::handleMouseButton(GLFWwindow* _pWindow, int _button, int _action, int _mode)
+{
+	GL_Window* pWindow = static_cast<GL_Window*>(glfwGetWindowUserPointer(_pWindow));
 
-	// Set the mouse coordinates for the next from.
-	pWindow->mLastMouseX = (GLfloat)_xPosition;
-	pWindow->mLastMouseY = (GLfloat)_yPosition;
+	InputEvent event;
+	event.type = InputEventType::MouseButton;
+	event.code = _button;
+	event.action = _action;
+	event.time = glfwGetTime();
+
+	pWindow->mInputQueue.push(event);
 }
 
-void GL_Window::initializeKeys()
+void GL_Window::handleScroll(GLFWwindow* _pWindow, double _xOffset, double _yOffset)
 {
-	for (size_t counter = 0; counter < 1024; counter++)
-	{
-		mKeys[counter] = false;
-	}
+	GL_Window* pWindow = static_cast<GL_Window*>(glfwGetWindowUserPointer(_pWindow));
+
+	InputEvent event;
+	event.type = InputEventType::Scroll;
+	event.x = _xOffset;
+	event.y = _yOffset;
+	event.time = glfwGetTime();
+
+	pWindow->mInputQueue.push(event);
 }
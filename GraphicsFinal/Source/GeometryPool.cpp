@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <PipelineState.h>
+#include <Profiler.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
+
+namespace
+{
+	/// <summary> Does any range of a defragmentation change its offset? </summary>
+	bool anyRangeMoved(const std::vector<GpuMove>& _moves)
+	{
+		for (const GpuMove& move : _moves)
+		{
+			if (move.source != move.destination)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+GeometryPool::GeometryPool()
+{
+	mVertexBuffer = 0;
+	mIndexBuffer = 0;
+	mVAO = 0;
+	mCopyCount = 0;
+}
+
+GeometryPool::~GeometryPool()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+void GeometryPool::initialize(const VertexLayout& _layout, GLuint _vertexCapacity, GLuint _indexCapacity)
+{
+	clear();
+
+	mLayout = _layout;
+	mVertexAllocator.initialize(glm::max(_vertexCapacity, 1u));
+	mIndexAllocator.initialize(glm::max(_indexCapacity, 1u));
+
+	// Empty arenas of the starting size.
+	std::vector<GpuMove> noMoves;
+	copyBuffer(mVertexBuffer, (GLsizeiptr)mVertexAllocator.getCapacity() * mLayout.stride, noMoves, mLayout.stride);
+	copyBuffer(mIndexBuffer, (GLsizeiptr)mIndexAllocator.getCapacity() * sizeof(GLuint), noMoves, sizeof(GLuint));
+
+	glGenVertexArrays(1, &mVAO);
+	bindBuffers();
+
+	// Creating the arenas is not a copy.
+	mCopyCount = 0;
+}
+
+bool GeometryPool::allocate(const GLfloat* _pVertices, const unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, GeometryAllocation& _allocation)
+{
+	// The floats must make up whole vertices of the layout.
+	size_t vertexBytes = sizeof(_pVertices[0]) * _vertexCount;
+
+	if (mVAO == 0 || mLayout.stride == 0 || vertexBytes % mLayout.stride != 0)
+	{
+		printf("Mesh data does not match the geometry pool layout!\n");
+		return false;
+	}
+
+	GLuint vertices = (GLuint)(vertexBytes / mLayout.stride);
+	GLuint copyCount = mCopyCount;
+
+	_allocation.vertices = allocateRange(mVertexAllocator, mVertexBuffer, vertices, mLayout.stride);
+	_allocation.indices = allocateRange(mIndexAllocator, mIndexBuffer, _indexCount, sizeof(GLuint));
+
+	// Growing replaces the buffers the vertex array reads.
+	if (mCopyCount != copyCount)
+	{
+		bindBuffers();
+	}
+
+	if (_allocation.vertices == INVALID_ALLOCATION || _allocation.indices == INVALID_ALLOCATION)
+	{
+		printf("Geometry pool is out of memory!\n");
+		free(_allocation);
+		return false;
+	}
+
+	// Copy the data into the ranges.
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)mVertexAllocator.getOffset(_allocation.vertices) * mLayout.stride, vertexBytes, _pVertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	Profiler::countUpload(vertexBytes);
+
+	// The element buffer binding belongs to the vertex array, so upload through the copy target.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, mIndexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mIndexAllocator.getOffset(_allocation.indices) * sizeof(GLuint), sizeof(_pIndices[0]) * _indexCount, _pIndices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	Profiler::countUpload(sizeof(_pIndices[0]) * _indexCount);
+
+	return true;
+}
+
+void GeometryPool::free(GeometryAllocation& _allocation)
+{
+	mVertexAllocator.free(_allocation.vertices);
+	mIndexAllocator.free(_allocation.indices);
+
+	_allocation.vertices = INVALID_ALLOCATION;
+	_allocation.indices = INVALID_ALLOCATION;
+}
+
+void GeometryPool::defragment()
+{
+	if (mVAO == 0)
+	{
+		return;
+	}
+
+	// Copy every live range into fresh buffers, since ranges of one buffer may not overlap in a copy. Ranges that
+	// stay in place are copied too: nothing else carries their data into the new buffer.
+	mVertexAllocator.defragment(mMoves);
+
+	if (anyRangeMoved(mMoves))
+	{
+		copyBuffer(mVertexBuffer, (GLsizeiptr)mVertexAllocator.getCapacity() * mLayout.stride, mMoves, mLayout.stride);
+	}
+
+	mIndexAllocator.defragment(mMoves);
+
+	if (anyRangeMoved(mMoves))
+	{
+		copyBuffer(mIndexBuffer, (GLsizeiptr)mIndexAllocator.getCapacity() * sizeof(GLuint), mMoves, sizeof(GLuint));
+	}
+
+	bindBuffers();
+}
+
+void GeometryPool::bind() const
+{
+	glBindVertexArray(mVAO);
+}
+
+size_t GeometryPool::getBufferBytes() const
+{
+	return (size_t)mVertexAllocator.getCapacity() * mLayout.stride + (size_t)mIndexAllocator.getCapacity() * sizeof(GLuint);
+}
+
+void GeometryPool::clear()
+{
+	if (mVertexBuffer != 0)
+	{
+		glDeleteBuffers(1, &mVertexBuffer);
+		mVertexBuffer = 0;
+	}
+
+	if (mIndexBuffer != 0)
+	{
+		glDeleteBuffers(1, &mIndexBuffer);
+		mIndexBuffer = 0;
+	}
+
+	if (mVAO != 0)
+	{
+		glDeleteVertexArrays(1, &mVAO);
+		mVAO = 0;
+	}
+
+	mVertexAllocator.initialize(0);
+	mIndexAllocator.initialize(0);
+	mCopyCount = 0;
+}
+
+GLuint GeometryPool::allocateRange(GpuAllocator& _allocator, GLuint& _buffer, GLuint _size, GLsizeiptr _unitBytes)
+{
+	GLuint allocation = _allocator.allocate(_size);
+
+	// Double the arena until the range fits, keeping every live range where it is.
+	while (allocation == INVALID_ALLOCATION)
+	{
+		GLuint capacity = _allocator.getCapacity();
+
+		// Give up before the capacity wraps around.
+		if (capacity >= 0x80000000u)
+		{
+			return INVALID_ALLOCATION;
+		}
+
+		GpuMove whole;
+		whole.source = 0;
+		whole.destination = 0;
+		whole.size = capacity;
+
+		std::vector<GpuMove> moves(1, whole);
+
+		_allocator.grow(glm::max(capacity * 2, capacity + _size));
+		copyBuffer(_buffer, (GLsizeiptr)_allocator.getCapacity() * _unitBytes, moves, _unitBytes);
+
+		allocation = _allocator.allocate(_size);
+	}
+
+	return allocation;
+}
+
+void GeometryPool::copyBuffer(GLuint& _buffer, GLsizeiptr _bytes, const std::vector<GpuMove>& _moves, GLsizeiptr _unitBytes)
+{
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+
+	// Allocate the new arena without data.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, _bytes, nullptr, GL_STATIC_DRAW);
+
+	// Copy the ranges across on the GPU.
+	if (_buffer != 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+
+		for (const GpuMove& move : _moves)
+		{
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.source * _unitBytes, move.destination * _unitBytes, move.size * _unitBytes);
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glDeleteBuffers(1, &_buffer);
+
+		mCopyCount++;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	_buffer = buffer;
+}
+
+void GeometryPool::bindBuffers()
+{
+	glBindVertexArray(mVAO);
+
+	// The element buffer binding is stored in the vertex array.
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+
+	// Attribute pointers capture the array buffer bound when they are set.
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	mLayout.apply();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(0);
+}
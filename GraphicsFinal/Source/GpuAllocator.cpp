@@ -0,0 +1,429 @@
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <GpuAllocator.h>
+
+namespace
+{
+	/// <summary> Marks a missing block link. </summary>
+	const GLuint NO_BLOCK = ~0u;
+
+	/// <summary> Index of the highest set bit. The value must not be zero. </summary>
+	GLuint highestBit(GLuint _value)
+	{
+		GLuint bit = 0;
+
+		while (_value >>= 1)
+		{
+			bit++;
+		}
+
+		return bit;
+	}
+
+	/// <summary> Index of the lowest set bit. The value must not be zero. </summary>
+	GLuint lowestBit(GLuint _value)
+	{
+		return highestBit(_value & (~_value + 1));
+	}
+
+	/// <summary> Size class of a size. Sizes below the second level count share the first list linearly. </summary>
+	void sizeClass(GLuint _size, GLuint& _firstLevel, GLuint& _secondLevel)
+	{
+		if (_size < TLSF_SL_COUNT)
+		{
+			_firstLevel = 0;
+			_secondLevel = _size;
+		}
+		else
+		{
+			GLuint bit = highestBit(_size);
+
+			_firstLevel = bit - TLSF_SL_LOG2 + 1;
+			_secondLevel = (_size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		}
+	}
+}
+
+GpuAllocator::GpuAllocator()
+{
+	initialize(0);
+}
+
+void GpuAllocator::initialize(GLuint _capacity)
+{
+	mBlocks.clear();
+	mUnusedBlocks.clear();
+	mFirstLevelBitmap = 0;
+
+	for (GLuint firstLevel = 0; firstLevel < TLSF_FL_COUNT; firstLevel++)
+	{
+		mSecondLevelBitmaps[firstLevel] = 0;
+
+		for (GLuint secondLevel = 0; secondLevel < TLSF_SL_COUNT; secondLevel++)
+		{
+			mFreeHeads[firstLevel][secondLevel] = NO_BLOCK;
+		}
+	}
+
+	mFirstBlock = NO_BLOCK;
+	mLastBlock = NO_BLOCK;
+	mCapacity = 0;
+	mUsed = 0;
+	mAllocationCount = 0;
+
+	grow(_capacity);
+}
+
+GLuint GpuAllocator::allocate(GLuint _size)
+{
+	if (_size == 0)
+	{
+		_size = 1;
+	}
+
+	// Round up to the next size class so any block in the found list is large enough.
+	GLuint rounded = _size;
+
+	if (rounded >= TLSF_SL_COUNT)
+	{
+		GLuint step = (1u << (highestBit(rounded) - TLSF_SL_LOG2)) - 1;
+
+		// Too large for any class.
+		if (rounded > ~0u - step)
+		{
+			return INVALID_ALLOCATION;
+		}
+
+		rounded += step;
+	}
+
+	GLuint firstLevel = 0;
+	GLuint secondLevel = 0;
+	sizeClass(rounded, firstLevel, secondLevel);
+
+	// A list of this class or larger in the same first level, otherwise the smallest larger first level.
+	GLuint secondMap = mSecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+	if (secondMap == 0)
+	{
+		GLuint firstMap = firstLevel + 1 < 32 ? mFirstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+
+		if (firstMap == 0)
+		{
+			return INVALID_ALLOCATION;
+		}
+
+		firstLevel = lowestBit(firstMap);
+		secondMap = mSecondLevelBitmaps[firstLevel];
+	}
+
+	secondLevel = lowestBit(secondMap);
+
+	GLuint block = mFreeHeads[firstLevel][secondLevel];
+	removeFree(block);
+
+	// Split off the rest as a new free block.
+	if (mBlocks[block].size > _size)
+	{
+		GLuint rest = createBlock(mBlocks[block].offset + _size, mBlocks[block].size - _size, true);
+
+		mBlocks[rest].previousPhysical = block;
+		mBlocks[rest].nextPhysical = mBlocks[block].nextPhysical;
+
+		if (mBlocks[block].nextPhysical != NO_BLOCK)
+		{
+			mBlocks[mBlocks[block].nextPhysical].previousPhysical = rest;
+		}
+		else
+		{
+			mLastBlock = rest;
+		}
+
+		mBlocks[block].nextPhysical = rest;
+		mBlocks[block].size = _size;
+
+		insertFree(rest);
+	}
+
+	mBlocks[block].free = false;
+	mUsed += _size;
+	mAllocationCount++;
+
+	return block;
+}
+
+void GpuAllocator::free(GLuint _allocation)
+{
+	if (_allocation == INVALID_ALLOCATION || mBlocks[_allocation].free)
+	{
+		return;
+	}
+
+	mUsed -= mBlocks[_allocation].size;
+	mAllocationCount--;
+
+	GLuint block = _allocation;
+	mBlocks[block].free = true;
+
+	// Merge with the free neighbours on both sides.
+	GLuint previous = mBlocks[block].previousPhysical;
+
+	if (previous != NO_BLOCK && mBlocks[previous].free)
+	{
+		removeFree(previous);
+		block = mergeWithPrevious(block);
+	}
+
+	GLuint next = mBlocks[block].nextPhysical;
+
+	if (next != NO_BLOCK && mBlocks[next].free)
+	{
+		removeFree(next);
+		block = mergeWithPrevious(next);
+	}
+
+	insertFree(block);
+}
+
+void GpuAllocator::grow(GLuint _capacity)
+{
+	if (_capacity <= mCapacity)
+	{
+		return;
+	}
+
+	GLuint extra = _capacity - mCapacity;
+
+	// Extend a free tail block, otherwise append one.
+	if (mLastBlock != NO_BLOCK && mBlocks[mLastBlock].free)
+	{
+		removeFree(mLastBlock);
+		mBlocks[mLastBlock].size += extra;
+		insertFree(mLastBlock);
+	}
+	else
+	{
+		GLuint block = createBlock(mCapacity, extra, true);
+		mBlocks[block].previousPhysical = mLastBlock;
+
+		if (mLastBlock != NO_BLOCK)
+		{
+			mBlocks[mLastBlock].nextPhysical = block;
+		}
+		else
+		{
+			mFirstBlock = block;
+		}
+
+		mLastBlock = block;
+		insertFree(block);
+	}
+
+	mCapacity = _capacity;
+}
+
+void GpuAllocator::defragment(std::vector<GpuMove>& _moves)
+{
+	_moves.clear();
+
+	// Slide every used block down over the free space before it, in address order.
+	GLuint cursor = 0;
+	GLuint previousUsed = NO_BLOCK;
+	GLuint block = mFirstBlock;
+
+	mFirstBlock = NO_BLOCK;
+
+	while (block != NO_BLOCK)
+	{
+		GLuint next = mBlocks[block].nextPhysical;
+
+		if (mBlocks[block].free)
+		{
+			// Free blocks are rebuilt as a single tail block below.
+			removeFree(block);
+			mUnusedBlocks.push_back(block);
+		}
+		else
+		{
+			// Report every live range, so the owner can copy all of them into a new buffer.
+			GpuMove* pLast = _moves.empty() ? nullptr : &_moves.back();
+
+			if (pLast && pLast->source + pLast->size == mBlocks[block].offset && pLast->destination + pLast->size == cursor)
+			{
+				pLast->size += mBlocks[block].size;
+			}
+			else
+			{
+				GpuMove move;
+				move.source = mBlocks[block].offset;
+				move.destination = cursor;
+				move.size = mBlocks[block].size;
+
+				_moves.push_back(move);
+			}
+
+			mBlocks[block].offset = cursor;
+
+			mBlocks[block].previousPhysical = previousUsed;
+			mBlocks[block].nextPhysical = NO_BLOCK;
+
+			if (previousUsed != NO_BLOCK)
+			{
+				mBlocks[previousUsed].nextPhysical = block;
+			}
+			else
+			{
+				mFirstBlock = block;
+			}
+
+			previousUsed = block;
+			cursor += mBlocks[block].size;
+		}
+
+		block = next;
+	}
+
+	mLastBlock = previousUsed;
+
+	// The remaining space becomes one free block at the end.
+	GLuint capacity = mCapacity;
+	mCapacity = cursor;
+	grow(capacity);
+}
+
+GpuAllocatorStats GpuAllocator::getStats() const
+{
+	GpuAllocatorStats stats;
+	stats.capacity = mCapacity;
+	stats.used = mUsed;
+	stats.allocationCount = mAllocationCount;
+
+	GLuint totalFree = 0;
+
+	for (GLuint block = mFirstBlock; block != NO_BLOCK; block = mBlocks[block].nextPhysical)
+	{
+		if (mBlocks[block].free)
+		{
+			stats.freeBlockCount++;
+			totalFree += mBlocks[block].size;
+
+			if (mBlocks[block].size > stats.largestFreeBlock)
+			{
+				stats.largestFreeBlock = mBlocks[block].size;
+			}
+		}
+	}
+
+	stats.fragmentation = totalFree > 0 ? 1.0 - (double)stats.largestFreeBlock / (double)totalFree : 0.0;
+
+	return stats;
+}
+
+GLuint GpuAllocator::createBlock(GLuint _offset, GLuint _size, bool _free)
+{
+	Block block;
+	block.offset = _offset;
+	block.size = _size;
+	block.previousPhysical = NO_BLOCK;
+	block.nextPhysical = NO_BLOCK;
+	block.previousFree = NO_BLOCK;
+	block.nextFree = NO_BLOCK;
+	block.free = _free;
+
+	// Reuse a slot so handles stay small.
+	if (!mUnusedBlocks.empty())
+	{
+		GLuint index = mUnusedBlocks.back();
+		mUnusedBlocks.pop_back();
+		mBlocks[index] = block;
+
+		return index;
+	}
+
+	mBlocks.push_back(block);
+
+	return (GLuint)mBlocks.size() - 1;
+}
+
+void GpuAllocator::insertFree(GLuint _block)
+{
+	GLuint firstLevel = 0;
+	GLuint secondLevel = 0;
+	sizeClass(mBlocks[_block].size, firstLevel, secondLevel);
+
+	GLuint head = mFreeHeads[firstLevel][secondLevel];
+
+	mBlocks[_block].previousFree = NO_BLOCK;
+	mBlocks[_block].nextFree = head;
+
+	if (head != NO_BLOCK)
+	{
+		mBlocks[head].previousFree = _block;
+	}
+
+	mFreeHeads[firstLevel][secondLevel] = _block;
+	mFirstLevelBitmap |= 1u << firstLevel;
+	mSecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void GpuAllocator::removeFree(GLuint _block)
+{
+	GLuint firstLevel = 0;
+	GLuint secondLevel = 0;
+	sizeClass(mBlocks[_block].size, firstLevel, secondLevel);
+
+	GLuint previous = mBlocks[_block].previousFree;
+	GLuint next = mBlocks[_block].nextFree;
+
+	if (previous != NO_BLOCK)
+	{
+		mBlocks[previous].nextFree = next;
+	}
+	else
+	{
+		mFreeHeads[firstLevel][secondLevel] = next;
+	}
+
+	if (next != NO_BLOCK)
+	{
+		mBlocks[next].previousFree = previous;
+	}
+
+	// Clear the bitmap bits of lists that became empty.
+	if (mFreeHeads[firstLevel][secondLevel] == NO_BLOCK)
+	{
+		mSecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+		if (mSecondLevelBitmaps[firstLevel] == 0)
+		{
+			mFirstLevelBitmap &= ~(1u << firstLevel);
+		}
+	}
+
+	mBlocks[_block].previousFree = NO_BLOCK;
+	mBlocks[_block].nextFree = NO_BLOCK;
+}
+
+GLuint GpuAllocator::mergeWithPrevious(GLuint _block)
+{
+	GLuint previous = mBlocks[_block].previousPhysical;
+	GLuint next = mBlocks[_block].nextPhysical;
+
+	mBlocks[previous].size += mBlocks[_block].size;
+	mBlocks[previous].nextPhysical = next;
+
+	if (next != NO_BLOCK)
+	{
+		mBlocks[next].previousPhysical = previous;
+	}
+	else
+	{
+		mLastBlock = previous;
+	}
+
+	mUnusedBlocks.push_back(_block);
+
+	return previous;
+}
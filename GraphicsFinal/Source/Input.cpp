@@ -0,0 +1,174 @@
+#include <string.h>
+#include <atomic>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <Input.h>
+
+InputQueue::InputQueue() : mHead(0), mTail(0), mDropped(0)
+{
+}
+
+bool InputQueue::push(const InputEvent& _event)
+{
+	GLuint tail = mTail.load(std::memory_order_relaxed);
+
+	// Full when the producer is a whole ring ahead of the consumer.
+	if (tail - mHead.load(std::memory_order_acquire) == INPUT_QUEUE_CAPACITY)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	mEvents[tail & (INPUT_QUEUE_CAPACITY - 1)] = _event;
+
+	// Publish the event after writing it.
+	mTail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool InputQueue::pop(InputEvent& _event)
+{
+	GLuint head = mHead.load(std::memory_order_relaxed);
+
+	if (head == mTail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	_event = mEvents[head & (INPUT_QUEUE_CAPACITY - 1)];
+
+	// Free the slot after reading it.
+	mHead.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+InputState::InputState()
+{
+	memset(mKeys, 0, sizeof(mKeys));
+	memset(mButtons, 0, sizeof(mButtons));
+	memset(mKeyPresses, 0, sizeof(mKeyPresses));
+
+	for (GLuint counter = 0; counter < INPUT_ACTION_COUNT; counter++)
+	{
+		mBindings[counter] = GLFW_KEY_UNKNOWN;
+	}
+
+	// Fly camera defaults.
+	bind(InputAction::MoveForward, GLFW_KEY_W);
+	bind(InputAction::MoveBackward, GLFW_KEY_S);
+	bind(InputAction::MoveLeft, GLFW_KEY_A);
+	bind(InputAction::MoveRight, GLFW_KEY_D);
+	bind(InputAction::MoveDown, GLFW_KEY_Q);
+	bind(InputAction::MoveUp, GLFW_KEY_E);
+
+	mLastMouseX = 0.0;
+	mLastMouseY = 0.0;
+	mMouseFirstMoved = true;
+	mMouseDeltaX = 0.0f;
+	mMouseDeltaY = 0.0f;
+	mScrollX = 0.0f;
+	mScrollY = 0.0f;
+	mEventCount = 0;
+	mLastEventTime = 0.0;
+}
+
+void InputState::bind(InputAction _action, int _key)
+{
+	mBindings[(GLuint)_action] = _key;
+}
+
+void InputState::update(InputQueue& _queue)
+{
+	mMouseDeltaX = 0.0f;
+	mMouseDeltaY = 0.0f;
+	mScrollX = 0.0f;
+	mScrollY = 0.0f;
+	mEventCount = 0;
+
+	poll(_queue);
+}
+
+void InputState::poll(InputQueue& _queue)
+{
+	InputEvent event;
+
+	while (_queue.pop(event))
+	{
+		apply(event);
+		mEventCount++;
+	}
+}
+
+void InputState::consumePresses()
+{
+	memset(mKeyPresses, 0, sizeof(mKeyPresses));
+}
+
+bool InputState::isDown(InputAction _action) const
+{
+	return isKeyDown(mBindings[(GLuint)_action]);
+}
+
+GLuint InputState::getPressCount(InputAction _action) const
+{
+	int key = mBindings[(GLuint)_action];
+
+	return key >= 0 && key < (int)MAX_INPUT_KEYS ? mKeyPresses[key] : 0;
+}
+
+void InputState::apply(const InputEvent& _event)
+{
+	mLastEventTime = _event.time;
+
+	switch (_event.type)
+	{
+	case InputEventType::Key:
+		if (_event.code >= 0 && _event.code < (int)MAX_INPUT_KEYS)
+		{
+			// Repeats keep the key held without counting as presses.
+			if (_event.action == GLFW_PRESS)
+			{
+				mKeys[_event.code] = true;
+				mKeyPresses[_event.code]++;
+			}
+			else if (_event.action == GLFW_RELEASE)
+			{
+				mKeys[_event.code] = false;
+			}
+		}
+		break;
+
+	case InputEventType::MouseButton:
+		if (_event.code >= 0 && _event.code < (int)MAX_INPUT_BUTTONS)
+		{
+			mButtons[_event.code] = _event.action == GLFW_PRESS;
+		}
+		break;
+
+	case InputEventType::MouseMove:
+		if (mMouseFirstMoved)
+		{
+			// The first position only sets where motion is measured from.
+			mLastMouseX = _event.x;
+			mLastMouseY = _event.y;
+			mMouseFirstMoved = false;
+		}
+
+		// Screen y grows downward.
+		mMouseDeltaX += (GLfloat)(_event.x - mLastMouseX);
+		mMouseDeltaY += (GLfloat)(mLastMouseY - _event.y);
+
+		mLastMouseX = _event.x;
+		mLastMouseY = _event.y;
+		break;
+
+	case InputEventType::Scroll:
+		mScrollX += (GLfloat)_event.x;
+		mScrollY += (GLfloat)_event.y;
+		break;
+	}
+}
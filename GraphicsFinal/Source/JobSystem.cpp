@@ -0,0 +1,147 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <GL/glew.h>
+
+#include <JobSystem.h>
+
+JobSystem::JobSystem()
+{
+	mWorkerCount = 1;
+	mpFunction = nullptr;
+	mpContext = nullptr;
+	mCount = 0;
+	mGrain = 1;
+	mNext = 0;
+	mPending = 0;
+	mGeneration = 0;
+	mStopping = false;
+}
+
+JobSystem::~JobSystem()
+{
+	clear();
+}
+
+void JobSystem::initialize(GLuint _workerCount)
+{
+	clear();
+
+	if (_workerCount == 0)
+	{
+		// The hardware thread count is zero when unknown.
+		_workerCount = std::thread::hardware_concurrency();
+		_workerCount = _workerCount > 0 ? _workerCount : 1;
+	}
+
+	mWorkerCount = _workerCount;
+	mStopping = false;
+
+	for (GLuint worker = 1; worker < mWorkerCount; worker++)
+	{
+		mThreads.emplace_back(&JobSystem::workerLoop, this, worker);
+	}
+}
+
+void JobSystem::run(size_t _count, size_t _grain, JobFunction _function, void* _pContext)
+{
+	if (_count == 0)
+	{
+		return;
+	}
+
+	_grain = _grain > 0 ? _grain : 1;
+
+	// Without workers or with a single chunk there is nothing to share.
+	if (mThreads.empty() || _count <= _grain)
+	{
+		_function(_pContext, 0, _count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mpFunction = _function;
+		mpContext = _pContext;
+		mCount = _count;
+		mGrain = _grain;
+		mNext = 0;
+		mPending = (GLuint)mThreads.size();
+		mGeneration++;
+	}
+
+	mWake.notify_all();
+
+	runChunks(0);
+
+	// Workers may still be finishing their last chunk.
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this]() { return mPending == 0; });
+}
+
+void JobSystem::clear()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads)
+	{
+		thread.join();
+	}
+
+	mThreads.clear();
+	mWorkerCount = 1;
+}
+
+void JobSystem::runChunks(GLuint _worker)
+{
+	for (;;)
+	{
+		size_t begin = mNext.fetch_add(mGrain);
+
+		if (begin >= mCount)
+		{
+			return;
+		}
+
+		size_t end = begin + mGrain < mCount ? begin + mGrain : mCount;
+		mpFunction(mpContext, begin, end, _worker);
+	}
+}
+
+void JobSystem::workerLoop(GLuint _worker)
+{
+	unsigned long long generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [this, generation]() { return mStopping || mGeneration != generation; });
+
+			if (mStopping)
+			{
+				return;
+			}
+
+			generation = mGeneration;
+		}
+
+		runChunks(_worker);
+
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (--mPending == 0)
+		{
+			mDone.notify_one();
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <Memory.h>
+
+namespace
+{
+	/// <summary> Counters updated from any thread. </summary>
+	std::atomic<unsigned long long> heapAllocationCount(0);
+	std::atomic<unsigned long long> heapAllocationBytes(0);
+	std::atomic<unsigned long long> arenaAllocationCount(0);
+	std::atomic<unsigned long long> arenaAllocationBytes(0);
+	std::atomic<unsigned long long> poolAllocationCount(0);
+
+	/// <summary> Round an address or size up to a power of two alignment. </summary>
+	size_t alignUp(size_t _value, size_t _alignment)
+	{
+		return (_value + _alignment - 1) & ~(_alignment - 1);
+	}
+}
+
+// Count every heap allocation made through new.
+void* operator new(size_t _bytes)
+{
+	heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	heapAllocationBytes.fetch_add(_bytes, std::memory_order_relaxed);
+
+	void* pMemory = malloc(_bytes > 0 ? _bytes : 1);
+
+	if (!pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pMemory;
+}
+
+void operator delete(void* _pMemory) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete(void* _pMemory, size_t) noexcept
+{
+	free(_pMemory);
+}
+
+AllocationStats AllocationCounter::snapshot()
+{
+	AllocationStats stats;
+	stats.heapAllocations = heapAllocationCount.load(std::memory_order_relaxed);
+	stats.heapBytes = heapAllocationBytes.load(std::memory_order_relaxed);
+	stats.arenaAllocations = arenaAllocationCount.load(std::memory_order_relaxed);
+	stats.arenaBytes = arenaAllocationBytes.load(std::memory_order_relaxed);
+	stats.poolAllocations = poolAllocationCount.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+void AllocationCounter::countArena(size_t _bytes)
+{
+	arenaAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	arenaAllocationBytes.fetch_add(_bytes, std::memory_order_relaxed);
+}
+
+void AllocationCounter::countPool()
+{
+	poolAllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameArena::FrameArena()
+{
+	mpBuffer = nullptr;
+	mCapacity = 0;
+	mUsed = 0;
+	mPeak = 0;
+	mOverflowBytes = 0;
+	mOverflowCount = 0;
+}
+
+FrameArena::~FrameArena()
+{
+	clear();
+}
+
+void FrameArena::initialize(size_t _capacity)
+{
+	clear();
+
+	mpBuffer = (unsigned char*)malloc(_capacity);
+	mCapacity = mpBuffer ? _capacity : 0;
+
+	// Overflow blocks are tracked without allocating during a frame.
+	mOverflowBlocks.reserve(64);
+}
+
+void* FrameArena::allocate(size_t _bytes, size_t _alignment)
+{
+	AllocationCounter::countArena(_bytes);
+
+	size_t offset = alignUp(mUsed, _alignment);
+
+	if (offset + _bytes <= mCapacity)
+	{
+		mUsed = offset + _bytes;
+		return mpBuffer + offset;
+	}
+
+	// Too large for what is left. Use the heap for this frame and grow at the next reset.
+	void* pMemory = ::operator new(alignUp(_bytes, _alignment) + _alignment);
+	mOverflowBlocks.push_back(pMemory);
+	mOverflowBytes += alignUp(_bytes, _alignment) + _alignment;
+	mOverflowCount++;
+
+	return (void*)alignUp((size_t)pMemory, _alignment);
+}
+
+void FrameArena::reset()
+{
+	size_t used = mUsed + mOverflowBytes;
+	mPeak = used > mPeak ? used : mPeak;
+
+	for (void* pMemory : mOverflowBlocks)
+	{
+		::operator delete(pMemory);
+	}
+
+	// Make room for the whole of the frame that overflowed.
+	if (!mOverflowBlocks.empty())
+	{
+		mOverflowBlocks.clear();
+		initialize(alignUp(used + used / 2, DEFAULT_ARENA_ALIGNMENT));
+	}
+
+	mUsed = 0;
+	mOverflowBytes = 0;
+}
+
+void FrameArena::clear()
+{
+	for (void* pMemory : mOverflowBlocks)
+	{
+		::operator delete(pMemory);
+	}
+
+	mOverflowBlocks.clear();
+	mOverflowBytes = 0;
+
+	free(mpBuffer);
+	mpBuffer = nullptr;
+	mCapacity = 0;
+	mUsed = 0;
+}
@@ -1,7 +1,16 @@
 
+#include <unordered_map>
+#include <vector>
+
 #include <GL/glew.h>
+#include <GLM/glm.hpp>
 
+#include <PipelineState.h>
+#include <Profiler.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
 #include <Mesh.h>
+#include <MeshProcessing.h>
 
 Mesh::Mesh()
 {
@@ -9,7 +18,17 @@ Mesh::Mesh()
 	mVAO = 0;
 	mVBO = 0;
 	mIBO = 0;
+	mPositionVBO = 0;
+	mPositionVAO = 0;
+	mpPool = nullptr;
+	mVertexAllocation = INVALID_ALLOCATION;
+	mIndexAllocation = INVALID_ALLOCATION;
 	mIndexCount = 0;
+	mBoundsMin = glm::vec3(0.0f);
+	mBoundsMax = glm::vec3(0.0f);
+	mPositionScale = glm::vec3(1.0f);
+	mPositionOffset = glm::vec3(0.0f);
+	mNormalEncoding = NormalEncoding::None;
 }
 
 Mesh::~Mesh()
@@ -19,9 +38,16 @@ Mesh::~Mesh()
 }
 
 void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount)
+{
+	// Positions only.
+	create(_pVertices, _pIndices, _vertexCount, _indexCount, VertexLayout::position());
+}
+
+void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, const VertexLayout& _layout)
 {
 	// Set the number of indices.
 	mIndexCount = _indexCount;
+	computeBounds(_pVertices, _vertexCount, _layout.stride);
 	
 	// Create a vertex array object.
 	glGenVertexArrays(1, &mVAO);
@@ -38,6 +64,7 @@ void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _ve
 
 	// Pass indices into the buffer.
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_pIndices[0]) * mIndexCount, _pIndices, GL_STATIC_DRAW);
+	Profiler::countUpload(sizeof(_pIndices[0]) * mIndexCount);
 
 
 	// Create a vertex buffer object.
@@ -48,10 +75,11 @@ void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _ve
 
 	// Pass verticies into buffer. Not going to be edited (GL_STATIC_DRAW)
 	glBufferData(GL_ARRAY_BUFFER, sizeof(_pVertices[0]) * _vertexCount, _pVertices, GL_STATIC_DRAW);
+	Profiler::countUpload(sizeof(_pVertices[0]) * _vertexCount);
 
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(0);
+	// Describe the vertex attributes to the VAO.
+	_layout.apply();
 
 	// Unbind the VBO.
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -63,16 +91,117 @@ void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _ve
 	glBindVertexArray(0);
 }
 
-void Mesh::render()
+void Mesh::create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, GeometryPool* _pPool)
 {
-	// Use this VAO for the shader.
+	// Without a pool the mesh owns its buffers.
+	if (!_pPool)
+	{
+		create(_pVertices, _pIndices, _vertexCount, _indexCount);
+		return;
+	}
+
+	GeometryAllocation allocation;
+
+	// Fall back to separate buffers when the pool cannot take the data.
+	if (!_pPool->allocate(_pVertices, _pIndices, _vertexCount, _indexCount, allocation))
+	{
+		create(_pVertices, _pIndices, _vertexCount, _indexCount);
+		return;
+	}
+
+	mpPool = _pPool;
+	mVertexAllocation = allocation.vertices;
+	mIndexAllocation = allocation.indices;
+	mIndexCount = _indexCount;
+	computeBounds(_pVertices, _vertexCount, _pPool->getLayout().stride);
+}
+
+void Mesh::create(const PackedVertices& _vertices, unsigned int* _pIndices, unsigned int _indexCount)
+{
+	mIndexCount = _indexCount;
+	mBoundsMin = _vertices.boundsMin;
+	mBoundsMax = _vertices.boundsMax;
+	mPositionScale = _vertices.positionScale;
+	mPositionOffset = _vertices.positionOffset;
+	mNormalEncoding = _vertices.normalEncoding;
+
+	bool split = !_vertices.positions.empty();
+
+	glGenBuffers(1, &mIBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_pIndices[0]) * mIndexCount, _pIndices, GL_STATIC_DRAW);
+	Profiler::countUpload(sizeof(_pIndices[0]) * mIndexCount);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &mVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+	glBufferData(GL_ARRAY_BUFFER, _vertices.vertices.size(), _vertices.vertices.data(), GL_STATIC_DRAW);
+	Profiler::countUpload(_vertices.vertices.size());
+
+	if (split)
+	{
+		glGenBuffers(1, &mPositionVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, mPositionVBO);
+		glBufferData(GL_ARRAY_BUFFER, _vertices.positions.size(), _vertices.positions.data(), GL_STATIC_DRAW);
+		Profiler::countUpload(_vertices.positions.size());
+	}
+
+	// Every attribute, reading the position from its own buffer when split.
+	glGenVertexArrays(1, &mVAO);
 	glBindVertexArray(mVAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+
+	if (split)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, mPositionVBO);
+		_vertices.positionLayout.apply();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+	_vertices.layout.apply();
+
+	// Positions alone for depth only passes.
+	if (split)
+	{
+		glGenVertexArrays(1, &mPositionVAO);
+		glBindVertexArray(mPositionVAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+		glBindBuffer(GL_ARRAY_BUFFER, mPositionVBO);
+		_vertices.positionLayout.apply();
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::render(bool _positionsOnly)
+{
+	// Pooled meshes draw their ranges from the shared buffers.
+	if (mpPool)
+	{
+		GeometryAllocation allocation;
+		allocation.vertices = mVertexAllocation;
+		allocation.indices = mIndexAllocation;
+
+		mpPool->bind();
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, mIndexCount, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * mpPool->getFirstIndex(allocation)), mpPool->getBaseVertex(allocation));
+		Profiler::countDraw(mIndexCount);
+
+		glBindVertexArray(0);
+
+		return;
+	}
+
+	// Use this VAO for the shader.
+	glBindVertexArray(_positionsOnly && mPositionVAO != 0 ? mPositionVAO : mVAO);
 
 	// Bind the IBO.
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
 
 	// Draw the vertices.
 	glDrawElements(GL_TRIANGLES, mIndexCount, GL_UNSIGNED_INT, 0);
+	Profiler::countDraw(mIndexCount);
 
 	// Unbind the IBO.
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -81,8 +210,103 @@ void Mesh::render()
 	glBindVertexArray(0);
 }
 
+void Mesh::setMeshlets(const std::vector<Meshlet>& _meshlets)
+{
+	mMeshlets = _meshlets;
+
+	// A draw has at most one range per meshlet, so drawing never allocates.
+	mRangeCounts.reserve(mMeshlets.size());
+	mRangeOffsets.reserve(mMeshlets.size());
+	mRangeBaseVertices.reserve(mMeshlets.size());
+}
+
+void Mesh::renderMeshlets(const GLuint* _pMeshlets, GLuint _count, bool _positionsOnly)
+{
+	if (_count == 0)
+	{
+		return;
+	}
+
+	GLuint firstIndex = 0;
+	GLint baseVertex = 0;
+
+	if (mpPool)
+	{
+		GeometryAllocation allocation;
+		allocation.vertices = mVertexAllocation;
+		allocation.indices = mIndexAllocation;
+
+		firstIndex = mpPool->getFirstIndex(allocation);
+		baseVertex = mpPool->getBaseVertex(allocation);
+	}
+
+	mRangeCounts.clear();
+	mRangeOffsets.clear();
+
+	GLsizei indexCount = 0;
+	GLuint rangeEnd = 0;
+
+	for (GLuint counter = 0; counter < _count; counter++)
+	{
+		const Meshlet& meshlet = mMeshlets[_pMeshlets[counter]];
+		GLsizei meshletIndices = (GLsizei)meshlet.triangleCount * 3;
+
+		// Extend the last range when this meshlet follows it.
+		if (!mRangeCounts.empty() && meshlet.firstIndex == rangeEnd)
+		{
+			mRangeCounts.back() += meshletIndices;
+		}
+		else
+		{
+			mRangeCounts.push_back(meshletIndices);
+			mRangeOffsets.push_back((void*)(sizeof(GLuint) * ((size_t)firstIndex + meshlet.firstIndex)));
+		}
+
+		rangeEnd = meshlet.firstIndex + meshlet.triangleCount * 3;
+		indexCount += meshletIndices;
+	}
+
+	GLsizei rangeCount = (GLsizei)mRangeCounts.size();
+	mRangeBaseVertices.assign(mRangeCounts.size(), baseVertex);
+
+	// The pool's vertex array holds its element buffer; separate meshes bind theirs like render().
+	if (mpPool)
+	{
+		mpPool->bind();
+	}
+	else
+	{
+		glBindVertexArray(_positionsOnly && mPositionVAO != 0 ? mPositionVAO : mVAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+	}
+
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, mRangeCounts.data(), GL_UNSIGNED_INT, mRangeOffsets.data(), rangeCount, mRangeBaseVertices.data());
+	Profiler::countDraw(indexCount);
+
+	if (!mpPool)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	glBindVertexArray(0);
+}
+
 void Mesh::clear()
 {
+	// Return the ranges to the pool.
+	if (mpPool)
+	{
+		GeometryAllocation allocation;
+		allocation.vertices = mVertexAllocation;
+		allocation.indices = mIndexAllocation;
+
+		mpPool->free(allocation);
+
+		mpPool = nullptr;
+		mVertexAllocation = INVALID_ALLOCATION;
+		mIndexAllocation = INVALID_ALLOCATION;
+	}
+
 	// Check for existing IBO.
 	if (mIBO != 0)
 	{
@@ -103,6 +327,19 @@ void Mesh::clear()
 		mVBO = 0;
 	}
 
+	// Delete the split position buffer and its VAO.
+	if (mPositionVBO != 0)
+	{
+		glDeleteBuffers(1, &mPositionVBO);
+		mPositionVBO = 0;
+	}
+
+	if (mPositionVAO != 0)
+	{
+		glDeleteVertexArrays(1, &mPositionVAO);
+		mPositionVAO = 0;
+	}
+
 	// Check for existing VAO.
 	if (mVAO != 0)
 	{
@@ -115,4 +352,31 @@ void Mesh::clear()
 
 	// Reset the index count.
 	mIndexCount = 0;
+	mMeshlets.clear();
+	mPositionScale = glm::vec3(1.0f);
+	mPositionOffset = glm::vec3(0.0f);
+	mNormalEncoding = NormalEncoding::None;
+}
+
+void Mesh::computeBounds(const GLfloat* _pVertices, unsigned int _vertexCount, GLsizei _stride)
+{
+	unsigned int floatsPerVertex = (unsigned int)_stride / sizeof(GLfloat);
+
+	if (floatsPerVertex < 3 || _vertexCount < floatsPerVertex)
+	{
+		mBoundsMin = glm::vec3(0.0f);
+		mBoundsMax = glm::vec3(0.0f);
+		return;
+	}
+
+	mBoundsMin = glm::vec3(_pVertices[0], _pVertices[1], _pVertices[2]);
+	mBoundsMax = mBoundsMin;
+
+	for (unsigned int offset = floatsPerVertex; offset + 3 <= _vertexCount; offset += floatsPerVertex)
+	{
+		glm::vec3 position(_pVertices[offset], _pVertices[offset + 1], _pVertices[offset + 2]);
+
+		mBoundsMin = glm::min(mBoundsMin, position);
+		mBoundsMax = glm::max(mBoundsMax, position);
+	}
 }
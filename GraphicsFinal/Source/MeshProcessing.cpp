@@ -0,0 +1,987 @@
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/packing.hpp>
+
+#include <JobSystem.h>
+#include <PipelineState.h>
+#include <Mesh.h>
+#include <MeshProcessing.h>
+
+namespace
+{
+	/// <summary> Index of no vertex. </summary>
+	const GLuint NO_VERTEX = ~0u;
+
+	/// <summary> Cosine below which a corner normal differs from a vertex's and the vertex is split. </summary>
+	const GLfloat SPLIT_NORMAL_COSINE = 0.9999f;
+
+	/// <summary> Summed tangent frame of a vertex. </summary>
+	struct TangentSum
+	{
+		glm::vec3 tangent = glm::vec3(0.0f);
+		glm::vec3 bitangent = glm::vec3(0.0f);
+	};
+
+	/// <summary> Meshlets per chunk of the parallel meshlet loops. </summary>
+	const size_t MESHLET_JOB_GRAIN = 256;
+
+	/// <summary> Streams stored after the positions of a binary mesh. </summary>
+	const GLuint MESH_STREAM_NORMALS = 1 << 0;
+	const GLuint MESH_STREAM_UVS = 1 << 1;
+	const GLuint MESH_STREAM_TANGENTS = 1 << 2;
+
+	/// <summary> Start of the binary mesh format. Counts are in elements; streams follow in the order of the flags. </summary>
+	struct MeshFormatHeader
+	{
+		GLuint magic;
+		GLuint version;
+		GLuint vertexCount;
+		GLuint indexCount;
+		GLuint meshletCount;
+		GLuint streams;
+	};
+
+	/// <summary> Run a loop on the jobs, or all of it on the caller without them. </summary>
+	template<typename Function>
+	void parallelRange(JobSystem* _pJobs, size_t _count, const Function& _function, size_t _grain = GEOMETRY_JOB_GRAIN)
+	{
+		if (_pJobs)
+		{
+			_pJobs->parallelFor(_count, _grain, _function);
+		}
+		else
+		{
+			_function(0, _count, 0);
+		}
+	}
+
+	GLuint getJobWorkers(JobSystem* _pJobs)
+	{
+		return _pJobs ? _pJobs->getWorkerCount() : 1;
+	}
+
+	glm::vec3 normalizeOr(const glm::vec3& _vector, const glm::vec3& _fallback)
+	{
+		GLfloat length = glm::length(_vector);
+
+		return length > 0.0f ? _vector / length : _fallback;
+	}
+
+	/// <summary> Append the elements of a stream to a byte array. </summary>
+	template<typename T>
+	void appendStream(std::vector<unsigned char>& _bytes, const std::vector<T>& _stream)
+	{
+		size_t offset = _bytes.size();
+		_bytes.resize(offset + sizeof(T) * _stream.size());
+
+		if (!_stream.empty())
+		{
+			memcpy(&_bytes[offset], _stream.data(), sizeof(T) * _stream.size());
+		}
+	}
+
+	/// <summary> Read a number of elements into a stream and advance past them. Returns false when the bytes end first. </summary>
+	template<typename T>
+	bool readStream(const unsigned char*& _pBytes, const unsigned char* _pEnd, size_t _count, std::vector<T>& _stream)
+	{
+		if ((size_t)(_pEnd - _pBytes) / sizeof(T) < _count)
+		{
+			return false;
+		}
+
+		_stream.resize(_count);
+
+		if (_count > 0)
+		{
+			memcpy(_stream.data(), _pBytes, sizeof(T) * _count);
+		}
+
+		_pBytes += sizeof(T) * _count;
+		return true;
+	}
+
+	/// <summary> Do the indices name vertices of the mesh and the meshlets ranges of its whole triangles? </summary>
+	bool meshRangesAreValid(const MeshData& _mesh)
+	{
+		if (_mesh.indices.size() % 3 != 0)
+		{
+			return false;
+		}
+
+		for (GLuint index : _mesh.indices)
+		{
+			if (index >= _mesh.positions.size())
+			{
+				return false;
+			}
+		}
+
+		for (const Meshlet& meshlet : _mesh.meshlets)
+		{
+			// In 64 bits, so huge counts cannot wrap around into range.
+			unsigned long long end = (unsigned long long)meshlet.firstIndex + (unsigned long long)meshlet.triangleCount * 3;
+
+			if (meshlet.firstIndex % 3 != 0 || end > _mesh.indices.size())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary> Largest magnitude of a 16 bit quantized position. </summary>
+	const GLfloat POSITION_QUANTIZE_RANGE = 32767.0f;
+
+	/// <summary> Copy a value into a vertex at an attribute's offset. </summary>
+	template<typename T>
+	void writeAttribute(unsigned char* _pVertex, const VertexAttribute& _attribute, const T& _value)
+	{
+		memcpy(_pVertex + _attribute.offset, &_value, sizeof(T));
+	}
+
+	/// <summary> Fit a meshlet's sphere and normal cone to its triangles. </summary>
+	void fitMeshlet(const MeshData& _mesh, Meshlet& _meshlet)
+	{
+		const GLuint* pIndices = &_mesh.indices[_meshlet.firstIndex];
+		GLuint cornerCount = _meshlet.triangleCount * 3;
+
+		// Centre of the box around the corners, then the furthest corner from it.
+		glm::vec3 boundsMin = _mesh.positions[pIndices[0]];
+		glm::vec3 boundsMax = boundsMin;
+
+		for (GLuint corner = 1; corner < cornerCount; corner++)
+		{
+			boundsMin = glm::min(boundsMin, _mesh.positions[pIndices[corner]]);
+			boundsMax = glm::max(boundsMax, _mesh.positions[pIndices[corner]]);
+		}
+
+		_meshlet.center = (boundsMin + boundsMax) * 0.5f;
+		_meshlet.radius = 0.0f;
+
+		for (GLuint corner = 0; corner < cornerCount; corner++)
+		{
+			_meshlet.radius = glm::max(_meshlet.radius, glm::length(_mesh.positions[pIndices[corner]] - _meshlet.center));
+		}
+
+		// The axis is the average face direction, and the cone opens to the face furthest from it.
+		glm::vec3 axis(0.0f);
+
+		for (GLuint corner = 0; corner < cornerCount; corner += 3)
+		{
+			const glm::vec3& position0 = _mesh.positions[pIndices[corner]];
+			axis += normalizeOr(glm::cross(_mesh.positions[pIndices[corner + 1]] - position0, _mesh.positions[pIndices[corner + 2]] - position0), glm::vec3(0.0f));
+		}
+
+		_meshlet.coneAxis = normalizeOr(axis, glm::vec3(0.0f, 0.0f, 1.0f));
+		_meshlet.coneCutoff = 1.0f;
+
+		if (axis == glm::vec3(0.0f))
+		{
+			return;
+		}
+
+		GLfloat minimumCosine = 1.0f;
+
+		for (GLuint corner = 0; corner < cornerCount; corner += 3)
+		{
+			const glm::vec3& position0 = _mesh.positions[pIndices[corner]];
+			glm::vec3 direction = normalizeOr(glm::cross(_mesh.positions[pIndices[corner + 1]] - position0, _mesh.positions[pIndices[corner + 2]] - position0), glm::vec3(0.0f));
+
+			// Degenerate triangles cover nothing, whichever way they face.
+			if (direction != glm::vec3(0.0f))
+			{
+				minimumCosine = glm::min(minimumCosine, glm::dot(direction, _meshlet.coneAxis));
+			}
+		}
+
+		// Wider than a hemisphere and some triangle always faces the camera.
+		if (minimumCosine > 0.0f)
+		{
+			_meshlet.coneCutoff = glm::sqrt(1.0f - minimumCosine * minimumCosine);
+		}
+	}
+
+	/// <summary> Hash of a position's bits. Negative zero is made positive so it matches zero. </summary>
+	GLuint hashPosition(const glm::vec3& _position)
+	{
+		glm::vec3 position = _position + glm::vec3(0.0f);
+		GLuint bits[3];
+		memcpy(bits, &position, sizeof(bits));
+
+		GLuint hash = bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+		return hash ^ (hash >> 16);
+	}
+
+	/// <summary> Map every vertex to the lowest vertex at the same position, with an open addressing table of vertices. </summary>
+	void weldPositions(const std::vector<glm::vec3>& _positions, std::vector<GLuint>& _canonical)
+	{
+		size_t count = _positions.size();
+		size_t tableSize = 1;
+
+		// At most half full, so probes stay short.
+		while (tableSize < count * 2)
+		{
+			tableSize *= 2;
+		}
+
+		std::vector<GLuint> table(tableSize, NO_VERTEX);
+		_canonical.resize(count);
+
+		for (size_t vertex = 0; vertex < count; vertex++)
+		{
+			const glm::vec3& position = _positions[vertex];
+			size_t slot = hashPosition(position) & (tableSize - 1);
+
+			while (table[slot] != NO_VERTEX && _positions[table[slot]] != position)
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			// Vertices are visited in order, so the first one at a position is the lowest.
+			if (table[slot] == NO_VERTEX)
+			{
+				table[slot] = (GLuint)vertex;
+			}
+
+			_canonical[vertex] = table[slot];
+		}
+	}
+
+	void generateSmoothNormals(MeshData& _mesh, const std::vector<GLuint>& _canonical, JobSystem* _pJobs)
+	{
+		size_t vertexCount = _mesh.getVertexCount();
+
+		// Partial sums of every worker, allocated by the worker on its first chunk.
+		std::vector<std::vector<glm::vec3>> sums(getJobWorkers(_pJobs));
+
+		parallelRange(_pJobs, _mesh.getTriangleCount(), [&](size_t _begin, size_t _end, GLuint _worker)
+		{
+			std::vector<glm::vec3>& sum = sums[_worker];
+
+			if (sum.empty())
+			{
+				sum.assign(vertexCount, glm::vec3(0.0f));
+			}
+
+			for (size_t triangle = _begin; triangle < _end; triangle++)
+			{
+				const GLuint* pIndices = &_mesh.indices[triangle * 3];
+				const glm::vec3& position0 = _mesh.positions[pIndices[0]];
+
+				// The length of the cross product is twice the area, which weights the face.
+				glm::vec3 normal = glm::cross(_mesh.positions[pIndices[1]] - position0, _mesh.positions[pIndices[2]] - position0);
+
+				sum[_canonical[pIndices[0]]] += normal;
+				sum[_canonical[pIndices[1]]] += normal;
+				sum[_canonical[pIndices[2]]] += normal;
+			}
+		});
+
+		// Reduce the partial sums of every vertex's position.
+		_mesh.normals.resize(vertexCount);
+
+		parallelRange(_pJobs, vertexCount, [&](size_t _begin, size_t _end, GLuint _worker)
+		{
+			for (size_t vertex = _begin; vertex < _end; vertex++)
+			{
+				GLuint position = _canonical[vertex];
+				glm::vec3 total(0.0f);
+
+				for (const std::vector<glm::vec3>& sum : sums)
+				{
+					if (!sum.empty())
+					{
+						total += sum[position];
+					}
+				}
+
+				_mesh.normals[vertex] = normalizeOr(total, glm::vec3(0.0f, 1.0f, 0.0f));
+			}
+		});
+	}
+
+	void generateCreasedNormals(MeshData& _mesh, const std::vector<GLuint>& _canonical, GLfloat _creaseCosine, JobSystem* _pJobs)
+	{
+		size_t vertexCount = _mesh.getVertexCount();
+		size_t triangleCount = _mesh.getTriangleCount();
+		size_t cornerCount = triangleCount * 3;
+
+		// Area weighted face normals and their directions.
+		std::vector<glm::vec3> faceNormals(triangleCount);
+		std::vector<glm::vec3> faceDirections(triangleCount);
+
+		parallelRange(_pJobs, triangleCount, [&](size_t _begin, size_t _end, GLuint _worker)
+		{
+			for (size_t triangle = _begin; triangle < _end; triangle++)
+			{
+				const GLuint* pIndices = &_mesh.indices[triangle * 3];
+				const glm::vec3& position0 = _mesh.positions[pIndices[0]];
+
+				faceNormals[triangle] = glm::cross(_mesh.positions[pIndices[1]] - position0, _mesh.positions[pIndices[2]] - position0);
+				faceDirections[triangle] = normalizeOr(faceNormals[triangle], glm::vec3(0.0f));
+			}
+		});
+
+		// Faces around every position, as ranges of one array.
+		std::vector<GLuint> faceOffsets(vertexCount + 1, 0);
+
+		for (size_t corner = 0; corner < cornerCount; corner++)
+		{
+			faceOffsets[_canonical[_mesh.indices[corner]] + 1]++;
+		}
+
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			faceOffsets[vertex + 1] += faceOffsets[vertex];
+		}
+
+		std::vector<GLuint> faces(cornerCount);
+		std::vector<GLuint> cursors(faceOffsets.begin(), faceOffsets.end() - 1);
+
+		for (size_t corner = 0; corner < cornerCount; corner++)
+		{
+			faces[cursors[_canonical[_mesh.indices[corner]]]++] = (GLuint)(corner / 3);
+		}
+
+		// Every corner sums the faces around its position within the crease angle of its own face.
+		std::vector<glm::vec3> cornerNormals(cornerCount);
+
+		parallelRange(_pJobs, triangleCount, [&](size_t _begin, size_t _end, GLuint _worker)
+		{
+			for (size_t triangle = _begin; triangle < _end; triangle++)
+			{
+				const glm::vec3& direction = faceDirections[triangle];
+
+				// Degenerate faces, such as those at the poles of a sphere, have no direction to crease against.
+				GLfloat creaseCosine = direction == glm::vec3(0.0f) ? -1.0f : _creaseCosine;
+
+				for (size_t corner = triangle * 3; corner < triangle * 3 + 3; corner++)
+				{
+					GLuint position = _canonical[_mesh.indices[corner]];
+					glm::vec3 sum(0.0f);
+
+					for (GLuint face = faceOffsets[position]; face < faceOffsets[position + 1]; face++)
+					{
+						if (glm::dot(faceDirections[faces[face]], direction) >= creaseCosine)
+						{
+							sum += faceNormals[faces[face]];
+						}
+					}
+
+					cornerNormals[corner] = normalizeOr(sum, direction);
+				}
+			}
+		});
+
+		// Corners share a vertex while their normals agree; the others get copies of it, chained from the vertex.
+		bool hasUvs = _mesh.uvs.size() == vertexCount;
+		std::vector<GLuint> nextCopy(vertexCount, NO_VERTEX);
+		std::vector<bool> assigned(vertexCount, false);
+
+		_mesh.normals.assign(vertexCount, glm::vec3(0.0f, 1.0f, 0.0f));
+
+		for (size_t corner = 0; corner < cornerCount; corner++)
+		{
+			GLuint vertex = _mesh.indices[corner];
+			const glm::vec3& normal = cornerNormals[corner];
+
+			if (!assigned[vertex])
+			{
+				assigned[vertex] = true;
+				_mesh.normals[vertex] = normal;
+				continue;
+			}
+
+			GLuint copy = vertex;
+			GLuint last = vertex;
+
+			while (copy != NO_VERTEX && glm::dot(_mesh.normals[copy], normal) < SPLIT_NORMAL_COSINE)
+			{
+				last = copy;
+				copy = nextCopy[copy];
+			}
+
+			if (copy == NO_VERTEX)
+			{
+				copy = (GLuint)_mesh.positions.size();
+
+				glm::vec3 position = _mesh.positions[vertex];
+				_mesh.positions.push_back(position);
+				_mesh.normals.push_back(normal);
+
+				if (hasUvs)
+				{
+					glm::vec2 uv = _mesh.uvs[vertex];
+					_mesh.uvs.push_back(uv);
+				}
+
+				nextCopy.push_back(NO_VERTEX);
+				nextCopy[last] = copy;
+			}
+
+			_mesh.indices[corner] = copy;
+		}
+	}
+}
+
+void MeshProcessing::loadPositions(const GLfloat* _pVertices, size_t _floatCount, GLuint _floatsPerVertex, const GLuint* _pIndices, size_t _indexCount, MeshData& _mesh)
+{
+	_mesh = MeshData();
+
+	if (_floatsPerVertex < 3)
+	{
+		printf("Vertices need at least three floats for a position!\n");
+		return;
+	}
+
+	size_t vertexCount = _floatCount / _floatsPerVertex;
+	_mesh.positions.resize(vertexCount);
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const GLfloat* pVertex = _pVertices + vertex * _floatsPerVertex;
+		_mesh.positions[vertex] = glm::vec3(pVertex[0], pVertex[1], pVertex[2]);
+	}
+
+	// Whole triangles only.
+	_mesh.indices.assign(_pIndices, _pIndices + _indexCount / 3 * 3);
+}
+
+void MeshProcessing::generateNormals(MeshData& _mesh, GLfloat _creaseAngle, JobSystem* _pJobs)
+{
+	_mesh.tangents.clear();
+
+	std::vector<GLuint> canonical;
+	weldPositions(_mesh.positions, canonical);
+
+	// Nothing is creased at 180 degrees, so no vertex splits and the normals are plain sums.
+	if (_creaseAngle >= 180.0f)
+	{
+		generateSmoothNormals(_mesh, canonical, _pJobs);
+	}
+	else
+	{
+		generateCreasedNormals(_mesh, canonical, glm::cos(glm::radians(_creaseAngle)), _pJobs);
+	}
+}
+
+bool MeshProcessing::generateTangents(MeshData& _mesh, JobSystem* _pJobs)
+{
+	size_t vertexCount = _mesh.getVertexCount();
+
+	if (_mesh.normals.size() != vertexCount || _mesh.uvs.size() != vertexCount)
+	{
+		printf("Tangents need normals and texture coordinates!\n");
+		return false;
+	}
+
+	std::vector<std::vector<TangentSum>> sums(getJobWorkers(_pJobs));
+
+	parallelRange(_pJobs, _mesh.getTriangleCount(), [&](size_t _begin, size_t _end, GLuint _worker)
+	{
+		std::vector<TangentSum>& sum = sums[_worker];
+
+		if (sum.empty())
+		{
+			sum.resize(vertexCount);
+		}
+
+		for (size_t triangle = _begin; triangle < _end; triangle++)
+		{
+			const GLuint* pIndices = &_mesh.indices[triangle * 3];
+			glm::vec3 positions[3] = { _mesh.positions[pIndices[0]], _mesh.positions[pIndices[1]], _mesh.positions[pIndices[2]] };
+
+			glm::vec3 edge1 = positions[1] - positions[0];
+			glm::vec3 edge2 = positions[2] - positions[0];
+			glm::vec2 delta1 = _mesh.uvs[pIndices[1]] - _mesh.uvs[pIndices[0]];
+			glm::vec2 delta2 = _mesh.uvs[pIndices[2]] - _mesh.uvs[pIndices[0]];
+
+			// Triangles without an area in texture space have no direction of increasing u.
+			GLfloat determinant = delta1.x * delta2.y - delta2.x * delta1.y;
+
+			if (determinant == 0.0f)
+			{
+				continue;
+			}
+
+			glm::vec3 tangent = normalizeOr((edge1 * delta2.y - edge2 * delta1.y) / determinant, glm::vec3(0.0f));
+			glm::vec3 bitangent = normalizeOr((edge2 * delta1.x - edge1 * delta2.x) / determinant, glm::vec3(0.0f));
+
+			// Weighted by the angle of each corner, as MikkTSpace does, so the result does not depend on tessellation.
+			for (int corner = 0; corner < 3; corner++)
+			{
+				glm::vec3 toNext = normalizeOr(positions[(corner + 1) % 3] - positions[corner], glm::vec3(0.0f));
+				glm::vec3 toPrevious = normalizeOr(positions[(corner + 2) % 3] - positions[corner], glm::vec3(0.0f));
+				GLfloat angle = glm::acos(glm::clamp(glm::dot(toNext, toPrevious), -1.0f, 1.0f));
+
+				TangentSum& vertexSum = sum[pIndices[corner]];
+				vertexSum.tangent += tangent * angle;
+				vertexSum.bitangent += bitangent * angle;
+			}
+		}
+	});
+
+	_mesh.tangents.resize(vertexCount);
+
+	parallelRange(_pJobs, vertexCount, [&](size_t _begin, size_t _end, GLuint _worker)
+	{
+		for (size_t vertex = _begin; vertex < _end; vertex++)
+		{
+			TangentSum total;
+
+			for (const std::vector<TangentSum>& sum : sums)
+			{
+				if (!sum.empty())
+				{
+					total.tangent += sum[vertex].tangent;
+					total.bitangent += sum[vertex].bitangent;
+				}
+			}
+
+			// Gram-Schmidt against the normal. Vertices without a tangent get any direction in the surface.
+			const glm::vec3& normal = _mesh.normals[vertex];
+			glm::vec3 anyAxis = glm::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			glm::vec3 tangent = normalizeOr(total.tangent - normal * glm::dot(normal, total.tangent), glm::normalize(glm::cross(normal, anyAxis)));
+
+			// The bitangent is rebuilt in the shader as cross(normal, tangent) * w.
+			GLfloat handedness = glm::dot(glm::cross(normal, tangent), total.bitangent) < 0.0f ? -1.0f : 1.0f;
+
+			_mesh.tangents[vertex] = glm::vec4(tangent, handedness);
+		}
+	});
+
+	return true;
+}
+
+void MeshProcessing::buildMeshlets(MeshData& _mesh, JobSystem* _pJobs)
+{
+	size_t vertexCount = _mesh.getVertexCount();
+	size_t triangleCount = _mesh.getTriangleCount();
+	size_t cornerCount = triangleCount * 3;
+
+	// Triangles around every vertex, as ranges of one array.
+	std::vector<GLuint> triangleOffsets(vertexCount + 1, 0);
+
+	for (size_t corner = 0; corner < cornerCount; corner++)
+	{
+		triangleOffsets[_mesh.indices[corner] + 1]++;
+	}
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+	}
+
+	std::vector<GLuint> triangles(cornerCount);
+	std::vector<GLuint> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+	for (size_t corner = 0; corner < cornerCount; corner++)
+	{
+		triangles[cursors[_mesh.indices[corner]]++] = (GLuint)(corner / 3);
+	}
+
+	// Meshlet that last took each vertex, so a vertex is counted once per meshlet.
+	std::vector<GLuint> vertexMeshlet(vertexCount, NO_VERTEX);
+	std::vector<bool> used(triangleCount, false);
+	std::vector<GLuint> candidates;
+	std::vector<GLuint> indices;
+	indices.reserve(cornerCount);
+
+	_mesh.meshlets.clear();
+	size_t seed = 0;
+
+	while (true)
+	{
+		while (seed < triangleCount && used[seed])
+		{
+			seed++;
+		}
+
+		if (seed == triangleCount)
+		{
+			break;
+		}
+
+		GLuint meshletIndex = (GLuint)_mesh.meshlets.size();
+		Meshlet meshlet;
+		meshlet.firstIndex = (GLuint)indices.size();
+		GLuint meshletVertices = 0;
+
+		// Take candidates in the order they were reached, so the meshlet grows outwards from the seed.
+		candidates.clear();
+		candidates.push_back((GLuint)seed);
+
+		for (size_t next = 0; next < candidates.size() && meshlet.triangleCount < MAX_MESHLET_TRIANGLES; next++)
+		{
+			GLuint triangle = candidates[next];
+
+			if (used[triangle])
+			{
+				continue;
+			}
+
+			const GLuint* pIndices = &_mesh.indices[(size_t)triangle * 3];
+			GLuint newVertices = 0;
+
+			for (GLuint corner = 0; corner < 3; corner++)
+			{
+				bool repeated = (corner > 0 && pIndices[corner] == pIndices[0]) || (corner > 1 && pIndices[corner] == pIndices[1]);
+				newVertices += vertexMeshlet[pIndices[corner]] != meshletIndex && !repeated ? 1 : 0;
+			}
+
+			// Triangles that do not fit are left for a later meshlet.
+			if (meshletVertices + newVertices > MAX_MESHLET_VERTICES)
+			{
+				continue;
+			}
+
+			used[triangle] = true;
+			meshlet.triangleCount++;
+			meshletVertices += newVertices;
+
+			for (GLuint corner = 0; corner < 3; corner++)
+			{
+				GLuint vertex = pIndices[corner];
+				indices.push_back(vertex);
+
+				if (vertexMeshlet[vertex] == meshletIndex)
+				{
+					continue;
+				}
+
+				vertexMeshlet[vertex] = meshletIndex;
+
+				for (GLuint around = triangleOffsets[vertex]; around < triangleOffsets[vertex + 1]; around++)
+				{
+					if (!used[triangles[around]])
+					{
+						candidates.push_back(triangles[around]);
+					}
+				}
+			}
+		}
+
+		_mesh.meshlets.push_back(meshlet);
+	}
+
+	_mesh.indices.swap(indices);
+
+	parallelRange(_pJobs, _mesh.meshlets.size(), [&](size_t _begin, size_t _end, GLuint _worker)
+	{
+		for (size_t meshlet = _begin; meshlet < _end; meshlet++)
+		{
+			fitMeshlet(_mesh, _mesh.meshlets[meshlet]);
+		}
+	}, MESHLET_JOB_GRAIN);
+}
+
+void MeshProcessing::packVertices(const MeshData& _mesh, const VertexFormat& _format, PackedVertices& _packed)
+{
+	size_t vertexCount = _mesh.getVertexCount();
+	bool hasNormals = _mesh.normals.size() == vertexCount && vertexCount > 0;
+	bool hasUvs = _mesh.uvs.size() == vertexCount && vertexCount > 0;
+	bool hasTangents = hasNormals && _mesh.tangents.size() == vertexCount;
+	bool packNormals = _format.normalBits == 8 || _format.normalBits == 16;
+
+	_packed = PackedVertices();
+	_packed.vertexCount = (GLuint)vertexCount;
+
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	// The box the positions are quantized across.
+	_packed.boundsMin = _mesh.positions[0];
+	_packed.boundsMax = _mesh.positions[0];
+
+	for (const glm::vec3& position : _mesh.positions)
+	{
+		_packed.boundsMin = glm::min(_packed.boundsMin, position);
+		_packed.boundsMax = glm::max(_packed.boundsMax, position);
+	}
+
+	if (_format.quantizePositions)
+	{
+		glm::vec3 halfExtent = (_packed.boundsMax - _packed.boundsMin) * 0.5f;
+
+		// Flat axes store zeros, which any scale decodes.
+		_packed.positionOffset = (_packed.boundsMin + _packed.boundsMax) * 0.5f;
+		_packed.positionScale = glm::vec3(
+			halfExtent.x > 0.0f ? halfExtent.x / POSITION_QUANTIZE_RANGE : 1.0f,
+			halfExtent.y > 0.0f ? halfExtent.y / POSITION_QUANTIZE_RANGE : 1.0f,
+			halfExtent.z > 0.0f ? halfExtent.z / POSITION_QUANTIZE_RANGE : 1.0f);
+	}
+
+	// Integer positions are not normalized, so the shader's scale alone decodes them on every GL version.
+	VertexLayout& positionLayout = _format.splitPositions ? _packed.positionLayout : _packed.layout;
+	positionLayout.add(0, 3, _format.quantizePositions ? GL_SHORT : GL_FLOAT);
+
+	if (hasNormals)
+	{
+		_packed.normalEncoding = packNormals ? NormalEncoding::Octahedral : NormalEncoding::Float;
+		_packed.layout.add(VERTEX_NORMAL_LOCATION, packNormals ? 2 : 3, !packNormals ? GL_FLOAT : _format.normalBits == 8 ? GL_BYTE : GL_SHORT, packNormals ? GL_TRUE : GL_FALSE);
+	}
+
+	if (hasUvs)
+	{
+		_packed.layout.add(VERTEX_UV_LOCATION, 2, _format.halfUvs ? GL_HALF_FLOAT : GL_FLOAT);
+	}
+
+	if (hasTangents)
+	{
+		_packed.layout.add(VERTEX_TANGENT_LOCATION, 4, packNormals ? GL_INT_2_10_10_10_REV : GL_FLOAT, packNormals ? GL_TRUE : GL_FALSE);
+	}
+
+	_packed.vertices.resize(vertexCount * _packed.layout.stride);
+	_packed.positions.resize(_format.splitPositions ? vertexCount * _packed.positionLayout.stride : 0);
+
+	unsigned char* pPositions = _format.splitPositions ? _packed.positions.data() : _packed.vertices.data();
+	const VertexAttribute* pAttribute = &_packed.layout.attributes[_format.splitPositions ? 0 : 1];
+
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		unsigned char* pVertex = &_packed.vertices[vertex * _packed.layout.stride];
+		unsigned char* pPosition = pPositions + vertex * positionLayout.stride;
+		const VertexAttribute* pNext = pAttribute;
+
+		if (_format.quantizePositions)
+		{
+			glm::vec3 quantized = glm::round(glm::clamp((_mesh.positions[vertex] - _packed.positionOffset) / _packed.positionScale, -POSITION_QUANTIZE_RANGE, POSITION_QUANTIZE_RANGE));
+			GLshort components[3] = { (GLshort)quantized.x, (GLshort)quantized.y, (GLshort)quantized.z };
+
+			writeAttribute(pPosition, positionLayout.attributes[0], components);
+		}
+		else
+		{
+			writeAttribute(pPosition, positionLayout.attributes[0], _mesh.positions[vertex]);
+		}
+
+		if (hasNormals)
+		{
+			const glm::vec3& normal = _mesh.normals[vertex];
+
+			if (!packNormals)
+			{
+				writeAttribute(pVertex, *pNext++, normal);
+			}
+			else if (_format.normalBits == 8)
+			{
+				writeAttribute(pVertex, *pNext++, glm::packSnorm2x8(encodeOctahedral(normal)));
+			}
+			else
+			{
+				writeAttribute(pVertex, *pNext++, glm::packSnorm2x16(encodeOctahedral(normal)));
+			}
+		}
+
+		if (hasUvs)
+		{
+			const glm::vec2& uv = _mesh.uvs[vertex];
+
+			if (_format.halfUvs)
+			{
+				writeAttribute(pVertex, *pNext++, glm::packHalf2x16(uv));
+			}
+			else
+			{
+				writeAttribute(pVertex, *pNext++, uv);
+			}
+		}
+
+		if (hasTangents)
+		{
+			const glm::vec4& tangent = _mesh.tangents[vertex];
+
+			if (packNormals)
+			{
+				writeAttribute(pVertex, *pNext++, glm::packSnorm3x10_1x2(tangent));
+			}
+			else
+			{
+				writeAttribute(pVertex, *pNext++, tangent);
+			}
+		}
+	}
+}
+
+glm::vec2 MeshProcessing::encodeOctahedral(const glm::vec3& _direction)
+{
+	GLfloat length = glm::abs(_direction.x) + glm::abs(_direction.y) + glm::abs(_direction.z);
+
+	// A zero vector has no direction; store up the z axis.
+	if (length == 0.0f)
+	{
+		return glm::vec2(0.0f);
+	}
+
+	glm::vec3 direction = _direction / length;
+	glm::vec2 encoded(direction.x, direction.y);
+
+	// The lower half folds over the diagonals onto the corners.
+	if (direction.z < 0.0f)
+	{
+		glm::vec2 sign(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+		encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * sign;
+	}
+
+	return encoded;
+}
+
+glm::vec3 MeshProcessing::decodeOctahedral(const glm::vec2& _encoded)
+{
+	glm::vec3 direction(_encoded.x, _encoded.y, 1.0f - glm::abs(_encoded.x) - glm::abs(_encoded.y));
+
+	if (direction.z < 0.0f)
+	{
+		glm::vec2 sign(direction.x >= 0.0f ? 1.0f : -1.0f, direction.y >= 0.0f ? 1.0f : -1.0f);
+		glm::vec2 unfolded = (1.0f - glm::abs(glm::vec2(direction.y, direction.x))) * sign;
+
+		direction.x = unfolded.x;
+		direction.y = unfolded.y;
+	}
+
+	return glm::normalize(direction);
+}
+
+void MeshProcessing::writeMesh(const MeshData& _mesh, std::vector<unsigned char>& _bytes)
+{
+	size_t vertexCount = _mesh.getVertexCount();
+
+	MeshFormatHeader header;
+	header.magic = MESH_FORMAT_MAGIC;
+	header.version = MESH_FORMAT_VERSION;
+	header.vertexCount = (GLuint)vertexCount;
+	header.indexCount = (GLuint)_mesh.indices.size();
+	header.meshletCount = (GLuint)_mesh.meshlets.size();
+	header.streams = 0;
+
+	// Streams that do not cover every vertex are left out.
+	header.streams |= _mesh.normals.size() == vertexCount ? MESH_STREAM_NORMALS : 0;
+	header.streams |= _mesh.uvs.size() == vertexCount ? MESH_STREAM_UVS : 0;
+	header.streams |= _mesh.tangents.size() == vertexCount ? MESH_STREAM_TANGENTS : 0;
+
+	_bytes.resize(sizeof(header));
+	memcpy(_bytes.data(), &header, sizeof(header));
+
+	appendStream(_bytes, _mesh.positions);
+
+	if (header.streams & MESH_STREAM_NORMALS)
+	{
+		appendStream(_bytes, _mesh.normals);
+	}
+
+	if (header.streams & MESH_STREAM_UVS)
+	{
+		appendStream(_bytes, _mesh.uvs);
+	}
+
+	if (header.streams & MESH_STREAM_TANGENTS)
+	{
+		appendStream(_bytes, _mesh.tangents);
+	}
+
+	appendStream(_bytes, _mesh.indices);
+	appendStream(_bytes, _mesh.meshlets);
+}
+
+bool MeshProcessing::readMesh(const unsigned char* _pBytes, size_t _size, MeshData& _mesh)
+{
+	_mesh = MeshData();
+
+	MeshFormatHeader header;
+
+	if (_size < sizeof(header))
+	{
+		printf("Mesh data is too short!\n");
+		return false;
+	}
+
+	memcpy(&header, _pBytes, sizeof(header));
+
+	if (header.magic != MESH_FORMAT_MAGIC || header.version != MESH_FORMAT_VERSION)
+	{
+		printf("Mesh data is not in version %u of the mesh format!\n", MESH_FORMAT_VERSION);
+		return false;
+	}
+
+	const unsigned char* pBytes = _pBytes + sizeof(header);
+	const unsigned char* pEnd = _pBytes + _size;
+
+	bool complete = readStream(pBytes, pEnd, header.vertexCount, _mesh.positions);
+	complete = complete && (!(header.streams & MESH_STREAM_NORMALS) || readStream(pBytes, pEnd, header.vertexCount, _mesh.normals));
+	complete = complete && (!(header.streams & MESH_STREAM_UVS) || readStream(pBytes, pEnd, header.vertexCount, _mesh.uvs));
+	complete = complete && (!(header.streams & MESH_STREAM_TANGENTS) || readStream(pBytes, pEnd, header.vertexCount, _mesh.tangents));
+	complete = complete && readStream(pBytes, pEnd, header.indexCount, _mesh.indices);
+	complete = complete && readStream(pBytes, pEnd, header.meshletCount, _mesh.meshlets);
+
+	if (!complete)
+	{
+		printf("Mesh data is truncated!\n");
+		_mesh = MeshData();
+		return false;
+	}
+
+	if (pBytes != pEnd)
+	{
+		printf("Mesh data has %u bytes past its end!\n", (GLuint)(pEnd - pBytes));
+		_mesh = MeshData();
+		return false;
+	}
+
+	// Draws and meshlet fitting index with these without checking them again.
+	if (!meshRangesAreValid(_mesh))
+	{
+		printf("Mesh data has indices or meshlets outside the mesh!\n");
+		_mesh = MeshData();
+		return false;
+	}
+
+	return true;
+}
+
+bool MeshProcessing::saveMesh(const char* _pPath, const MeshData& _mesh)
+{
+	std::vector<unsigned char> bytes;
+	writeMesh(_mesh, bytes);
+
+	std::ofstream fileStream(_pPath, std::ios::out | std::ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		printf("Error opening '%s' for writing!\n", _pPath);
+		return false;
+	}
+
+	fileStream.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+
+	return fileStream.good();
+}
+
+bool MeshProcessing::loadMesh(const char* _pPath, MeshData& _mesh)
+{
+	std::ifstream fileStream(_pPath, std::ios::in | std::ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		printf("Error opening '%s' for reading!\n", _pPath);
+		_mesh = MeshData();
+		return false;
+	}
+
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+
+	return readMesh(bytes.data(), bytes.size(), _mesh);
+}
@@ -0,0 +1,446 @@
+#include <stdio.h>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+#include <PipelineState.h>
+
+namespace
+{
+	/// <summary> FNV-1a offset basis. </summary>
+	const size_t HASH_OFFSET = (size_t)14695981039346656037ULL;
+
+	/// <summary> FNV-1a prime. </summary>
+	const size_t HASH_PRIME = (size_t)1099511628211ULL;
+
+	/// <summary> Mix a value into an FNV-1a hash. </summary>
+	template <typename T>
+	void hashValue(size_t& _hash, const T& _value)
+	{
+		const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(&_value);
+
+		for (size_t counter = 0; counter < sizeof(T); counter++)
+		{
+			_hash ^= pBytes[counter];
+			_hash *= HASH_PRIME;
+		}
+	}
+
+	/// <summary> Get the byte size of a vertex component type. </summary>
+	GLsizei typeSize(GLenum _type)
+	{
+		switch (_type)
+		{
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			return 1;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+}
+
+VertexLayout VertexLayout::position()
+{
+	VertexLayout layout;
+
+	// Single vec3 position at location 0.
+	layout.add(0, 3, GL_FLOAT);
+
+	return layout;
+}
+
+VertexLayout& VertexLayout::add(GLuint _location, GLint _components, GLenum _type, GLboolean _normalized)
+{
+	// Ignore attributes past the maximum.
+	if (attributeCount >= MAX_VERTEX_ATTRIBUTES)
+	{
+		printf("Vertex layout exceeds %u attributes!\n", MAX_VERTEX_ATTRIBUTES);
+		return *this;
+	}
+
+	VertexAttribute& attribute = attributes[attributeCount++];
+
+	attribute.location = _location;
+	attribute.components = _components;
+	attribute.type = _type;
+	attribute.normalized = _normalized;
+	attribute.offset = (GLuint)stride;
+
+	// Packed formats store all components in 4 bytes.
+	if (_type == GL_INT_2_10_10_10_REV || _type == GL_UNSIGNED_INT_2_10_10_10_REV)
+	{
+		stride += 4;
+	}
+	else
+	{
+		stride += typeSize(_type) * _components;
+	}
+
+	// Keep every vertex 4 byte aligned.
+	stride = (stride + 3) & ~3;
+
+	return *this;
+}
+
+void VertexLayout::apply() const
+{
+	for (GLuint counter = 0; counter < attributeCount; counter++)
+	{
+		const VertexAttribute& attribute = attributes[counter];
+
+		glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized, stride, (const void*)(size_t)attribute.offset);
+		glEnableVertexAttribArray(attribute.location);
+	}
+}
+
+bool operator==(const PipelineStateDesc& _left, const PipelineStateDesc& _right)
+{
+	if (_left.program != _right.program)
+	{
+		return false;
+	}
+
+	// Blend state.
+	if (_left.blend.enabled != _right.blend.enabled ||
+		_left.blend.sourceFactor != _right.blend.sourceFactor ||
+		_left.blend.destinationFactor != _right.blend.destinationFactor ||
+		_left.blend.equation != _right.blend.equation)
+	{
+		return false;
+	}
+
+	// Depth state.
+	if (_left.depth.testEnabled != _right.depth.testEnabled ||
+		_left.depth.writeEnabled != _right.depth.writeEnabled ||
+		_left.depth.function != _right.depth.function ||
+		_left.depth.clipRange != _right.depth.clipRange)
+	{
+		return false;
+	}
+
+	// Cull state.
+	if (_left.cull.enabled != _right.cull.enabled ||
+		_left.cull.face != _right.cull.face ||
+		_left.cull.frontFace != _right.cull.frontFace)
+	{
+		return false;
+	}
+
+	// Raster state.
+	if (_left.raster.polygonMode != _right.raster.polygonMode ||
+		_left.raster.colorWriteEnabled != _right.raster.colorWriteEnabled ||
+		_left.raster.depthBiasEnabled != _right.raster.depthBiasEnabled ||
+		_left.raster.depthBiasFactor != _right.raster.depthBiasFactor ||
+		_left.raster.depthBiasUnits != _right.raster.depthBiasUnits)
+	{
+		return false;
+	}
+
+	// Vertex layout.
+	if (_left.vertexLayout.attributeCount != _right.vertexLayout.attributeCount ||
+		_left.vertexLayout.stride != _right.vertexLayout.stride)
+	{
+		return false;
+	}
+
+	for (GLuint counter = 0; counter < _left.vertexLayout.attributeCount; counter++)
+	{
+		const VertexAttribute& left = _left.vertexLayout.attributes[counter];
+		const VertexAttribute& right = _right.vertexLayout.attributes[counter];
+
+		if (left.location != right.location ||
+			left.components != right.components ||
+			left.type != right.type ||
+			left.normalized != right.normalized ||
+			left.offset != right.offset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PipelineCache::~PipelineCache()
+{
+	// Delete every pipeline state.
+	for (auto& entry : mStates)
+	{
+		delete entry.second;
+	}
+
+	mStates.clear();
+}
+
+const PipelineState* PipelineCache::create(const PipelineStateDesc& _desc)
+{
+	size_t descHash = hash(_desc);
+
+	// Look for an identical state with the same hash.
+	auto range = mStates.equal_range(descHash);
+
+	for (auto iterator = range.first; iterator != range.second; ++iterator)
+	{
+		if (iterator->second->getDesc() == _desc)
+		{
+			return iterator->second;
+		}
+	}
+
+	// Create a new state.
+	PipelineState* pState = new PipelineState(_desc, descHash);
+
+	mStates.emplace(descHash, pState);
+
+	return pState;
+}
+
+size_t PipelineCache::hash(const PipelineStateDesc& _desc)
+{
+	size_t result = HASH_OFFSET;
+
+	// Hash each field individually so padding never affects the result.
+	hashValue(result, _desc.program);
+
+	hashValue(result, _desc.blend.enabled);
+	hashValue(result, _desc.blend.sourceFactor);
+	hashValue(result, _desc.blend.destinationFactor);
+	hashValue(result, _desc.blend.equation);
+
+	hashValue(result, _desc.depth.testEnabled);
+	hashValue(result, _desc.depth.writeEnabled);
+	hashValue(result, _desc.depth.function);
+	hashValue(result, _desc.depth.clipRange);
+
+	hashValue(result, _desc.cull.enabled);
+	hashValue(result, _desc.cull.face);
+	hashValue(result, _desc.cull.frontFace);
+
+	hashValue(result, _desc.raster.polygonMode);
+	hashValue(result, _desc.raster.colorWriteEnabled);
+	hashValue(result, _desc.raster.depthBiasEnabled);
+	hashValue(result, _desc.raster.depthBiasFactor);
+	hashValue(result, _desc.raster.depthBiasUnits);
+
+	hashValue(result, _desc.vertexLayout.attributeCount);
+	hashValue(result, _desc.vertexLayout.stride);
+
+	for (GLuint counter = 0; counter < _desc.vertexLayout.attributeCount; counter++)
+	{
+		const VertexAttribute& attribute = _desc.vertexLayout.attributes[counter];
+
+		hashValue(result, attribute.location);
+		hashValue(result, attribute.components);
+		hashValue(result, attribute.type);
+		hashValue(result, attribute.normalized);
+		hashValue(result, attribute.offset);
+	}
+
+	return result;
+}
+
+StateTracker::StateTracker()
+{
+	mpBound = nullptr;
+	mStateChangeCount = 0;
+	mClearDepth = 1.0f;
+}
+
+void StateTracker::reset()
+{
+	// Default description.
+	PipelineStateDesc defaults;
+
+	// Apply every state regardless of what is tracked.
+	apply(defaults, true);
+
+	glClearDepth(1.0);
+	mClearDepth = 1.0f;
+
+	mpBound = nullptr;
+}
+
+void StateTracker::bind(const PipelineState* _pState)
+{
+	// Nothing to do for the state that is already bound.
+	if (_pState == mpBound || !_pState)
+	{
+		return;
+	}
+
+	apply(_pState->getDesc(), false);
+
+	mpBound = _pState;
+}
+
+void StateTracker::clear(GLbitfield _mask, GLfloat _red, GLfloat _green, GLfloat _blue, GLfloat _alpha, GLfloat _depth)
+{
+	// glClear respects the write masks, so make sure they are enabled.
+	if ((_mask & GL_COLOR_BUFFER_BIT) && !mCurrent.raster.colorWriteEnabled)
+	{
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		mCurrent.raster.colorWriteEnabled = true;
+		mStateChangeCount++;
+
+		// The bound state no longer matches GL.
+		mpBound = nullptr;
+	}
+
+	if ((_mask & GL_DEPTH_BUFFER_BIT) && !mCurrent.depth.writeEnabled)
+	{
+		glDepthMask(GL_TRUE);
+		mCurrent.depth.writeEnabled = true;
+		mStateChangeCount++;
+
+		// The bound state no longer matches GL.
+		mpBound = nullptr;
+	}
+
+	if ((_mask & GL_DEPTH_BUFFER_BIT) && _depth != mClearDepth)
+	{
+		glClearDepth(_depth);
+		mClearDepth = _depth;
+		mStateChangeCount++;
+	}
+
+	glClearColor(_red, _green, _blue, _alpha);
+	glClear(_mask);
+}
+
+bool StateTracker::supportsClipControl()
+{
+	return GLEW_VERSION_4_5 || GLEW_ARB_clip_control;
+}
+
+void StateTracker::setCapability(GLenum _capability, bool _enabled)
+{
+	if (_enabled)
+	{
+		glEnable(_capability);
+	}
+	else
+	{
+		glDisable(_capability);
+	}
+
+	mStateChangeCount++;
+}
+
+void StateTracker::apply(const PipelineStateDesc& _desc, bool _force)
+{
+	// Program.
+	if (_force || _desc.program != mCurrent.program)
+	{
+		glUseProgram(_desc.program);
+		mStateChangeCount++;
+	}
+
+	// Blend state.
+	if (_force || _desc.blend.enabled != mCurrent.blend.enabled)
+	{
+		setCapability(GL_BLEND, _desc.blend.enabled);
+	}
+
+	// Factors only matter while blending.
+	if (_desc.blend.enabled || _force)
+	{
+		if (_force || _desc.blend.sourceFactor != mCurrent.blend.sourceFactor || _desc.blend.destinationFactor != mCurrent.blend.destinationFactor)
+		{
+			glBlendFunc(_desc.blend.sourceFactor, _desc.blend.destinationFactor);
+			mStateChangeCount++;
+		}
+
+		if (_force || _desc.blend.equation != mCurrent.blend.equation)
+		{
+			glBlendEquation(_desc.blend.equation);
+			mStateChangeCount++;
+		}
+
+		mCurrent.blend = _desc.blend;
+	}
+	else
+	{
+		mCurrent.blend.enabled = false;
+	}
+
+	// Depth state.
+	if (_force || _desc.depth.testEnabled != mCurrent.depth.testEnabled)
+	{
+		setCapability(GL_DEPTH_TEST, _desc.depth.testEnabled);
+	}
+
+	if (_force || _desc.depth.writeEnabled != mCurrent.depth.writeEnabled)
+	{
+		glDepthMask(_desc.depth.writeEnabled ? GL_TRUE : GL_FALSE);
+		mStateChangeCount++;
+	}
+
+	if (_force || _desc.depth.function != mCurrent.depth.function)
+	{
+		glDepthFunc(_desc.depth.function);
+		mStateChangeCount++;
+	}
+
+	// Contexts without clip control only have the default range.
+	if ((_force || _desc.depth.clipRange != mCurrent.depth.clipRange) && supportsClipControl())
+	{
+		glClipControl(GL_LOWER_LEFT, _desc.depth.clipRange);
+		mStateChangeCount++;
+	}
+
+	// Cull state.
+	if (_force || _desc.cull.enabled != mCurrent.cull.enabled)
+	{
+		setCapability(GL_CULL_FACE, _desc.cull.enabled);
+	}
+
+	if (_force || _desc.cull.face != mCurrent.cull.face)
+	{
+		glCullFace(_desc.cull.face);
+		mStateChangeCount++;
+	}
+
+	if (_force || _desc.cull.frontFace != mCurrent.cull.frontFace)
+	{
+		glFrontFace(_desc.cull.frontFace);
+		mStateChangeCount++;
+	}
+
+	// Raster state.
+	if (_force || _desc.raster.polygonMode != mCurrent.raster.polygonMode)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, _desc.raster.polygonMode);
+		mStateChangeCount++;
+	}
+
+	if (_force || _desc.raster.colorWriteEnabled != mCurrent.raster.colorWriteEnabled)
+	{
+		GLboolean mask = _desc.raster.colorWriteEnabled ? GL_TRUE : GL_FALSE;
+
+		glColorMask(mask, mask, mask, mask);
+		mStateChangeCount++;
+	}
+
+	if (_force || _desc.raster.depthBiasEnabled != mCurrent.raster.depthBiasEnabled)
+	{
+		setCapability(GL_POLYGON_OFFSET_FILL, _desc.raster.depthBiasEnabled);
+	}
+
+	if (_force || _desc.raster.depthBiasFactor != mCurrent.raster.depthBiasFactor || _desc.raster.depthBiasUnits != mCurrent.raster.depthBiasUnits)
+	{
+		glPolygonOffset(_desc.raster.depthBiasFactor, _desc.raster.depthBiasUnits);
+		mStateChangeCount++;
+	}
+
+	// Track the applied state. Blend factors are left as they were while blending is off.
+	// The vertex layout lives in each mesh's VAO, so it is only tracked.
+	BlendState blend = mCurrent.blend;
+
+	mCurrent = _desc;
+	mCurrent.blend = blend;
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <Memory.h>
+#include <PipelineState.h>
+#include <Shader.h>
+#include <RenderGraph.h>
+#include <PostProcess.h>
+
+// Shader file locations.
+static const char* postVertexShaderFile = "resources/vs/fullscreen.vert";
+static const char* bloomBrightFragmentShaderFile = "resources/fs/bloom_bright.frag";
+static const char* blurFragmentShaderFile = "resources/fs/blur.frag";
+static const char* tonemapFragmentShaderFile = "resources/fs/tonemap.frag";
+static const char* upscaleFragmentShaderFile = "resources/fs/upscale.frag";
+
+PostProcess::PostProcess()
+{
+	mpStateTracker = nullptr;
+	mpBrightShader = nullptr;
+	mpBrightPipeline = nullptr;
+	mpBlurShader = nullptr;
+	mpBlurPipeline = nullptr;
+	mpTonemapShader = nullptr;
+	mpTonemapPipeline = nullptr;
+	mpUpscaleShader = nullptr;
+	mpUpscalePipeline = nullptr;
+	mUpscaleFilter = UpscaleFilter::EdgeAdaptive;
+	mBloom = true;
+	mExposure = 1.0f;
+	mBloomThreshold = 1.0f;
+	mBloomStrength = 0.5f;
+}
+
+PostProcess::~PostProcess()
+{
+	// Shaders are deleted in clear() while the context still exists.
+}
+
+int PostProcess::initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache)
+{
+	mpStateTracker = _pStateTracker;
+
+	mpBrightShader = createShader(bloomBrightFragmentShaderFile, &mpBrightPipeline, _pPipelineCache);
+	mpBlurShader = createShader(blurFragmentShaderFile, &mpBlurPipeline, _pPipelineCache);
+	mpTonemapShader = createShader(tonemapFragmentShaderFile, &mpTonemapPipeline, _pPipelineCache);
+	mpUpscaleShader = createShader(upscaleFragmentShaderFile, &mpUpscalePipeline, _pPipelineCache);
+
+	return 0;
+}
+
+void PostProcess::addPasses(RenderGraph& _graph, GLuint _hdr, GLuint _output)
+{
+	// Bloom runs at half resolution. The passes are always declared and culled when the tone mapping ignores them.
+	TextureDesc bloomDesc;
+	bloomDesc.width = glm::max(_graph.getDesc(_hdr).width / 2, 1);
+	bloomDesc.height = glm::max(_graph.getDesc(_hdr).height / 2, 1);
+	bloomDesc.internalFormat = GL_RGBA16F;
+
+	GLuint bright = _graph.createTexture("bloom_bright", bloomDesc);
+	GLuint blurX = _graph.createTexture("bloom_blur_x", bloomDesc);
+	GLuint bloom = _graph.createTexture("bloom", bloomDesc);
+
+	GLuint brightPass = _graph.addPass("bloom_bright", [this, _hdr](RenderGraph& _frameGraph)
+	{
+		mpStateTracker->bind(mpBrightPipeline);
+
+		const TextureDesc& desc = _frameGraph.getDesc(_hdr);
+
+		_frameGraph.bindTexture(_hdr, POST_TEXTURE_UNIT);
+		glUniform1i(mpBrightShader->getUniform(ShaderUniform::Source), POST_TEXTURE_UNIT);
+		glUniform2f(mpBrightShader->getUniform(ShaderUniform::SourceTexel), 1.0f / desc.width, 1.0f / desc.height);
+		glUniform1f(mpBrightShader->getUniform(ShaderUniform::Threshold), mBloomThreshold);
+
+		_frameGraph.drawFullscreenTriangle();
+	});
+	_graph.read(brightPass, _hdr);
+	_graph.write(brightPass, bright);
+
+	// Horizontal then vertical, each from the previous target.
+	const GLuint sources[2] = { bright, blurX };
+	const GLuint targets[2] = { blurX, bloom };
+	const char* names[2] = { "bloom_blur_x", "bloom_blur_y" };
+
+	for (GLuint counter = 0; counter < 2; counter++)
+	{
+		GLuint source = sources[counter];
+		glm::vec2 direction = counter == 0 ? glm::vec2(1.0f / bloomDesc.width, 0.0f) : glm::vec2(0.0f, 1.0f / bloomDesc.height);
+
+		GLuint blurPass = _graph.addPass(names[counter], [this, source, direction](RenderGraph& _frameGraph)
+		{
+			mpStateTracker->bind(mpBlurPipeline);
+
+			_frameGraph.bindTexture(source, POST_TEXTURE_UNIT);
+			glUniform1i(mpBlurShader->getUniform(ShaderUniform::Source), POST_TEXTURE_UNIT);
+			glUniform2f(mpBlurShader->getUniform(ShaderUniform::Direction), direction.x, direction.y);
+
+			_frameGraph.drawFullscreenTriangle();
+		});
+		_graph.read(blurPass, source);
+		_graph.write(blurPass, targets[counter]);
+	}
+
+	bool bloomEnabled = mBloom;
+
+	GLuint tonemapPass = _graph.addPass("tonemap", [this, _hdr, bloom, bloomEnabled](RenderGraph& _frameGraph)
+	{
+		mpStateTracker->bind(mpTonemapPipeline);
+
+		_frameGraph.bindTexture(_hdr, POST_TEXTURE_UNIT);
+		glUniform1i(mpTonemapShader->getUniform(ShaderUniform::Hdr), POST_TEXTURE_UNIT);
+		glUniform1f(mpTonemapShader->getUniform(ShaderUniform::Exposure), mExposure);
+
+		if (bloomEnabled)
+		{
+			_frameGraph.bindTexture(bloom, POST_TEXTURE_UNIT + 1);
+			glUniform1i(mpTonemapShader->getUniform(ShaderUniform::Bloom), POST_TEXTURE_UNIT + 1);
+		}
+
+		glUniform1f(mpTonemapShader->getUniform(ShaderUniform::BloomStrength), bloomEnabled ? mBloomStrength : 0.0f);
+
+		_frameGraph.drawFullscreenTriangle();
+	});
+	_graph.read(tonemapPass, _hdr);
+	_graph.write(tonemapPass, _output);
+
+	// Without the read the bloom passes have no consumer.
+	if (bloomEnabled)
+	{
+		_graph.read(tonemapPass, bloom);
+	}
+}
+
+void PostProcess::addUpscalePass(RenderGraph& _graph, GLuint _source)
+{
+	bool edgeAdaptive = mUpscaleFilter == UpscaleFilter::EdgeAdaptive;
+
+	GLuint upscalePass = _graph.addPass("upscale", [this, _source, edgeAdaptive](RenderGraph& _frameGraph)
+	{
+		mpStateTracker->bind(mpUpscalePipeline);
+
+		const TextureDesc& desc = _frameGraph.getDesc(_source);
+
+		_frameGraph.bindTexture(_source, POST_TEXTURE_UNIT);
+		glUniform1i(mpUpscaleShader->getUniform(ShaderUniform::Source), POST_TEXTURE_UNIT);
+		glUniform2f(mpUpscaleShader->getUniform(ShaderUniform::SourceSize), (GLfloat)desc.width, (GLfloat)desc.height);
+		glUniform1i(mpUpscaleShader->getUniform(ShaderUniform::EdgeAdaptive), edgeAdaptive ? 1 : 0);
+
+		_frameGraph.drawFullscreenTriangle();
+	});
+	_graph.read(upscalePass, _source);
+	_graph.write(upscalePass, BACKBUFFER_RESOURCE);
+}
+
+void PostProcess::clear()
+{
+	Shader** shaders[4] = { &mpBrightShader, &mpBlurShader, &mpTonemapShader, &mpUpscaleShader };
+
+	// Check for existing shaders.
+	for (Shader** ppShader : shaders)
+	{
+		if (*ppShader)
+		{
+			delete *ppShader;
+			*ppShader = nullptr;
+		}
+	}
+
+	mpBrightPipeline = nullptr;
+	mpBlurPipeline = nullptr;
+	mpTonemapPipeline = nullptr;
+	mpUpscalePipeline = nullptr;
+}
+
+Shader* PostProcess::createShader(const char* _pFragmentFile, const PipelineState** _ppPipeline, PipelineCache* _pPipelineCache)
+{
+	Shader* pShader = new Shader();
+	pShader->initialize();
+	pShader->load(GL_VERTEX_SHADER, postVertexShaderFile);
+	pShader->load(GL_FRAGMENT_SHADER, _pFragmentFile);
+	pShader->link();
+	pShader->loadUniforms();
+
+	// Full screen passes cover every pixel once and ignore depth.
+	PipelineStateDesc desc;
+	desc.program = pShader->getId();
+	desc.depth.testEnabled = false;
+	desc.depth.writeEnabled = false;
+
+	*_ppPipeline = _pPipelineCache->create(desc);
+
+	return pShader;
+}
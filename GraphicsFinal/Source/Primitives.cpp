@@ -0,0 +1,143 @@
+#include <cmath>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/constants.hpp>
+
+#include <Mesh.h>
+#include <Primitives.h>
+
+Mesh* Primitives::createTetrahedron(GeometryPool* _pPool)
+{
+	Mesh* pMesh = new Mesh();
+
+	createTetrahedron(*pMesh, _pPool);
+
+	return pMesh;
+}
+
+void Primitives::createTetrahedron(Mesh& _mesh, GeometryPool* _pPool)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+
+	generateTetrahedron(vertices, indices);
+
+	_mesh.create(vertices.data(), indices.data(), (unsigned int)vertices.size(), (unsigned int)indices.size(), _pPool);
+}
+
+void Primitives::generateTetrahedron(std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices)
+{
+	_indices = {
+		0, 3, 1,
+		1, 3, 2,
+		2, 3, 0,
+		0, 1, 2
+	};
+
+	_vertices = {
+		-1.0f, -1.0f, 0.0f,
+		 0.0f, -1.0f, 1.0f,
+		 1.0f, -1.0f, 0.0f,
+		 0.0f,  1.0f, 0.0f
+	};
+}
+
+Mesh* Primitives::createSphere(GLuint _rings, GLuint _segments, GeometryPool* _pPool)
+{
+	Mesh* pMesh = new Mesh();
+
+	createSphere(*pMesh, _rings, _segments, _pPool);
+
+	return pMesh;
+}
+
+void Primitives::createSphere(Mesh& _mesh, GLuint _rings, GLuint _segments, GeometryPool* _pPool)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+
+	generateSphere(_rings, _segments, vertices, indices);
+
+	_mesh.create(vertices.data(), indices.data(), (unsigned int)vertices.size(), (unsigned int)indices.size(), _pPool);
+}
+
+void Primitives::generateSphere(GLuint _rings, GLuint _segments, std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices)
+{
+	// Need at least a triangle fan at each pole.
+	_rings = glm::max(_rings, 2u);
+	_segments = glm::max(_segments, 3u);
+
+	_vertices.clear();
+	_indices.clear();
+	_vertices.reserve((size_t)(_rings + 1) * (_segments + 1) * 3);
+	_indices.reserve((size_t)_rings * _segments * 6);
+
+	// One ring of vertices per latitude, with a seam vertex repeated at the end.
+	for (GLuint ring = 0; ring <= _rings; ring++)
+	{
+		float theta = glm::pi<float>() * ring / _rings;
+
+		for (GLuint segment = 0; segment <= _segments; segment++)
+		{
+			float phi = glm::two_pi<float>() * segment / _segments;
+
+			_vertices.push_back(sinf(theta) * cosf(phi));
+			_vertices.push_back(cosf(theta));
+			_vertices.push_back(sinf(theta) * sinf(phi));
+		}
+	}
+
+	// Two triangles per quad between neighbouring rings, counter-clockwise seen from outside.
+	for (GLuint ring = 0; ring < _rings; ring++)
+	{
+		for (GLuint segment = 0; segment < _segments; segment++)
+		{
+			unsigned int first = ring * (_segments + 1) + segment;
+			unsigned int second = first + _segments + 1;
+
+			_indices.push_back(first);
+			_indices.push_back(first + 1);
+			_indices.push_back(second);
+
+			_indices.push_back(first + 1);
+			_indices.push_back(second + 1);
+			_indices.push_back(second);
+		}
+	}
+}
+
+Mesh* Primitives::createPlane(GeometryPool* _pPool)
+{
+	Mesh* pMesh = new Mesh();
+
+	createPlane(*pMesh, _pPool);
+
+	return pMesh;
+}
+
+void Primitives::createPlane(Mesh& _mesh, GeometryPool* _pPool)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+
+	generatePlane(vertices, indices);
+
+	_mesh.create(vertices.data(), indices.data(), (unsigned int)vertices.size(), (unsigned int)indices.size(), _pPool);
+}
+
+void Primitives::generatePlane(std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices)
+{
+	_indices = {
+		0, 2, 1,
+		0, 3, 2
+	};
+
+	_vertices = {
+		-1.0f, 0.0f, -1.0f,
+		 1.0f, 0.0f, -1.0f,
+		 1.0f, 0.0f,  1.0f,
+		-1.0f, 0.0f,  1.0f
+	};
+}
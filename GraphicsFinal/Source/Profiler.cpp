@@ -0,0 +1,146 @@
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <Profiler.h>
+
+Profiler::Profiler()
+{
+	for (GLuint counter = 0; counter < PROFILER_QUERY_COUNT; counter++)
+	{
+		mQueries[counter] = 0;
+	}
+
+	mQueryWrite = 0;
+	mQueryRead = 0;
+	mFrameStart = 0.0;
+	mFrameCount = 0;
+	mCpuTime = 0.0;
+	mGpuFrameCount = 0;
+	mGpuTime = 0.0;
+	mLastGpuTime = 0.0;
+}
+
+void Profiler::initialize()
+{
+	glGenQueries(PROFILER_QUERY_COUNT, mQueries);
+}
+
+void Profiler::beginFrame()
+{
+	mFrameStart = glfwGetTime();
+
+	// Read any timings the GPU has finished without stalling.
+	resolve(false);
+
+	// Every query is still in flight, so wait for the oldest.
+	if (mQueryWrite - mQueryRead >= PROFILER_QUERY_COUNT)
+	{
+		readOldest();
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, mQueries[mQueryWrite % PROFILER_QUERY_COUNT]);
+}
+
+void Profiler::endFrame()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	mQueryWrite++;
+
+	mCpuTime += (glfwGetTime() - mFrameStart) * 1000.0;
+	mFrameCount++;
+}
+
+void Profiler::flush()
+{
+	resolve(true);
+}
+
+void Profiler::clear()
+{
+	// Check for existing queries.
+	if (mQueries[0] != 0)
+	{
+		// Delete the queries from graphics memory.
+		glDeleteQueries(PROFILER_QUERY_COUNT, mQueries);
+
+		// Clear the queries.
+		for (GLuint counter = 0; counter < PROFILER_QUERY_COUNT; counter++)
+		{
+			mQueries[counter] = 0;
+		}
+	}
+
+	mQueryWrite = 0;
+	mQueryRead = 0;
+}
+
+void Profiler::resetTimes()
+{
+	// Drop timings of earlier frames that are still in flight.
+	resolve(true);
+
+	mFrameCount = 0;
+	mCpuTime = 0.0;
+	mGpuFrameCount = 0;
+	mGpuTime = 0.0;
+}
+
+FrameStats& Profiler::stats()
+{
+	static FrameStats frameStats;
+
+	return frameStats;
+}
+
+void Profiler::countDraw(GLsizei _indexCount)
+{
+	FrameStats& frameStats = stats();
+
+	frameStats.drawCalls++;
+	frameStats.triangles += _indexCount / 3;
+}
+
+void Profiler::countUpload(size_t _bytes)
+{
+	stats().bytesUploaded += _bytes;
+}
+
+void Profiler::countFragments(unsigned long long _fragments)
+{
+	stats().fragmentsShaded += _fragments;
+}
+
+void Profiler::resolve(bool _wait)
+{
+	while (mQueryRead != mQueryWrite)
+	{
+		GLuint query = mQueries[mQueryRead % PROFILER_QUERY_COUNT];
+
+		// Stop at the first query that is not finished unless waiting.
+		if (!_wait)
+		{
+			GLint available = 0;
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+			if (!available)
+			{
+				return;
+			}
+		}
+
+		readOldest();
+	}
+}
+
+void Profiler::readOldest()
+{
+	GLuint64 elapsed = 0;
+
+	// Blocks until the query result is available.
+	glGetQueryObjectui64v(mQueries[mQueryRead % PROFILER_QUERY_COUNT], GL_QUERY_RESULT, &elapsed);
+
+	mLastGpuTime = elapsed / 1000000.0;
+	mGpuTime += mLastGpuTime;
+	mGpuFrameCount++;
+	mQueryRead++;
+}
@@ -0,0 +1,569 @@
+#include <stdio.h>
+#include <vector>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include <Profiler.h>
+#include <Memory.h>
+#include <RenderGraph.h>
+
+namespace
+{
+	/// <summary> Marks a resource or position that has none. </summary>
+	const GLuint NO_INDEX = ~0u;
+
+	/// <summary> Is the internal format a depth format? </summary>
+	bool isDepthFormat(GLenum _internalFormat)
+	{
+		return _internalFormat == GL_DEPTH_COMPONENT16 || _internalFormat == GL_DEPTH_COMPONENT24 || _internalFormat == GL_DEPTH_COMPONENT32F ||
+			_internalFormat == GL_DEPTH24_STENCIL8 || _internalFormat == GL_DEPTH32F_STENCIL8;
+	}
+
+	/// <summary> Bytes per texel of the formats the renderer uses. </summary>
+	size_t texelBytes(GLenum _internalFormat)
+	{
+		switch (_internalFormat)
+		{
+		case GL_R8:
+			return 1;
+		case GL_DEPTH_COMPONENT16:
+		case GL_R16F:
+		case GL_RG8:
+			return 2;
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_RGBA32F:
+			return 16;
+		case GL_DEPTH32F_STENCIL8:
+			return 8;
+		default:
+			// RGBA8, RG16, RG16F, R32F, R11F_G11F_B10F, RGB10_A2 and the 24/32 bit depth formats.
+			return 4;
+		}
+	}
+}
+
+bool operator==(const TextureDesc& _left, const TextureDesc& _right)
+{
+	return _left.width == _right.width && _left.height == _right.height && _left.internalFormat == _right.internalFormat;
+}
+
+RenderGraph::RenderGraph()
+{
+	mPassCount = 0;
+	mpArena = nullptr;
+	mEmptyVertexArray = 0;
+	mCulledPassCount = 0;
+	mTransientBytes = 0;
+	mUnaliasedBytes = 0;
+}
+
+RenderGraph::~RenderGraph()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+void RenderGraph::initialize(FrameArena* _pArena)
+{
+	mpArena = _pArena;
+
+	// Core profiles need a vertex array bound even without attributes.
+	glGenVertexArrays(1, &mEmptyVertexArray);
+}
+
+void RenderGraph::reset(GLsizei _backbufferWidth, GLsizei _backbufferHeight)
+{
+	// Passes stay constructed so their read and write lists keep their memory.
+	mPassCount = 0;
+	mResources.clear();
+	mOrder.clear();
+
+	// Resource 0 is always the default framebuffer.
+	GraphResource backbuffer;
+	backbuffer.pName = "backbuffer";
+	backbuffer.desc.width = _backbufferWidth;
+	backbuffer.desc.height = _backbufferHeight;
+	backbuffer.desc.internalFormat = GL_RGBA8;
+	backbuffer.physical = NO_INDEX;
+	backbuffer.external = 0;
+	backbuffer.firstUse = NO_INDEX;
+	backbuffer.lastUse = 0;
+
+	mResources.push_back(backbuffer);
+}
+
+GLuint RenderGraph::createTexture(const char* _pName, const TextureDesc& _desc)
+{
+	GraphResource resource;
+	resource.pName = _pName;
+	resource.desc = _desc;
+	resource.physical = NO_INDEX;
+	resource.external = 0;
+	resource.firstUse = NO_INDEX;
+	resource.lastUse = 0;
+
+	mResources.push_back(resource);
+
+	return (GLuint)mResources.size() - 1;
+}
+
+GLuint RenderGraph::importTexture(const char* _pName, GLuint _texture, const TextureDesc& _desc)
+{
+	GLuint resource = createTexture(_pName, _desc);
+	mResources[resource].external = _texture;
+
+	return resource;
+}
+
+GLuint RenderGraph::addPass(const char* _pName, const void* _pFunction, RenderPassInvoker _invoker)
+{
+	if (mPassCount == (GLuint)mPasses.size())
+	{
+		mPasses.push_back(GraphPass());
+	}
+
+	GraphPass& pass = mPasses[mPassCount];
+	pass.pName = _pName;
+	pass.pFunction = _pFunction;
+	pass.invoker = _invoker;
+	pass.reads.clear();
+	pass.writes.clear();
+	pass.used = false;
+
+	return mPassCount++;
+}
+
+void RenderGraph::read(GLuint _pass, GLuint _resource)
+{
+	mPasses[_pass].reads.push_back(_resource);
+}
+
+void RenderGraph::write(GLuint _pass, GLuint _resource)
+{
+	mPasses[_pass].writes.push_back(_resource);
+}
+
+void RenderGraph::compile()
+{
+	GLuint passCount = mPassCount;
+
+	// Cull: start from the passes writing the backbuffer and keep everything they depend on. Each pass is pushed once.
+	GLuint* pStack = mpArena->allocateArray<GLuint>(passCount);
+	GLuint stackSize = 0;
+
+	for (GLuint pass = 0; pass < passCount; pass++)
+	{
+		for (GLuint resource : mPasses[pass].writes)
+		{
+			if (resource == BACKBUFFER_RESOURCE && !mPasses[pass].used)
+			{
+				mPasses[pass].used = true;
+				pStack[stackSize++] = pass;
+			}
+		}
+	}
+
+	while (stackSize > 0)
+	{
+		GLuint pass = pStack[--stackSize];
+
+		for (GLuint other = 0; other < passCount; other++)
+		{
+			if (!mPasses[other].used && dependsOn(pass, other))
+			{
+				mPasses[other].used = true;
+				pStack[stackSize++] = other;
+			}
+		}
+	}
+
+	// Topological order of the used passes, earliest declared first among the ready ones.
+	GLuint* pRemaining = mpArena->allocateArray<GLuint>(passCount);
+	bool* pScheduled = mpArena->allocateArray<bool>(passCount);
+	mCulledPassCount = 0;
+
+	for (GLuint pass = 0; pass < passCount; pass++)
+	{
+		pRemaining[pass] = 0;
+		pScheduled[pass] = false;
+
+		if (!mPasses[pass].used)
+		{
+			mCulledPassCount++;
+			continue;
+		}
+
+		for (GLuint other = 0; other < passCount; other++)
+		{
+			if (mPasses[other].used && dependsOn(pass, other))
+			{
+				pRemaining[pass]++;
+			}
+		}
+	}
+
+	while (mOrder.size() + mCulledPassCount < passCount)
+	{
+		GLuint next = NO_INDEX;
+
+		for (GLuint pass = 0; pass < passCount && next == NO_INDEX; pass++)
+		{
+			if (mPasses[pass].used && !pScheduled[pass] && pRemaining[pass] == 0)
+			{
+				next = pass;
+			}
+		}
+
+		// A cycle. Run what is left in declaration order.
+		if (next == NO_INDEX)
+		{
+			printf("Error: render graph has a dependency cycle!\n");
+
+			for (GLuint pass = 0; pass < passCount; pass++)
+			{
+				if (mPasses[pass].used && !pScheduled[pass])
+				{
+					pScheduled[pass] = true;
+					mOrder.push_back(pass);
+				}
+			}
+
+			break;
+		}
+
+		pScheduled[next] = true;
+		mOrder.push_back(next);
+
+		for (GLuint pass = 0; pass < passCount; pass++)
+		{
+			if (mPasses[pass].used && !pScheduled[pass] && dependsOn(pass, next))
+			{
+				pRemaining[pass]--;
+			}
+		}
+	}
+
+	// Lifetimes of the resources in execution order.
+	for (GLuint position = 0; position < (GLuint)mOrder.size(); position++)
+	{
+		const GraphPass& pass = mPasses[mOrder[position]];
+
+		for (const std::vector<GLuint>* pList : { &pass.reads, &pass.writes })
+		{
+			for (GLuint resource : *pList)
+			{
+				GraphResource& graphResource = mResources[resource];
+
+				if (graphResource.firstUse == NO_INDEX)
+				{
+					graphResource.firstUse = position;
+				}
+
+				graphResource.lastUse = position;
+			}
+		}
+	}
+
+	// Alias: give each transient resource a physical texture no other live resource holds.
+	for (PhysicalTexture& texture : mTextures)
+	{
+		texture.busyUntil = NO_INDEX;
+		texture.used = false;
+	}
+
+	mUnaliasedBytes = 0;
+
+	for (GLuint position = 0; position < (GLuint)mOrder.size(); position++)
+	{
+		for (GLuint resource = 1; resource < (GLuint)mResources.size(); resource++)
+		{
+			GraphResource& graphResource = mResources[resource];
+
+			if (graphResource.firstUse == position && graphResource.external == 0)
+			{
+				graphResource.physical = allocate(graphResource.desc, position, graphResource.lastUse);
+				mUnaliasedBytes += (size_t)graphResource.desc.width * graphResource.desc.height * texelBytes(graphResource.desc.internalFormat);
+			}
+		}
+	}
+
+	// Textures nothing used this frame are released, along with the framebuffers naming them.
+	bool released = false;
+
+	for (size_t counter = mTextures.size(); counter-- > 0;)
+	{
+		if (!mTextures[counter].used)
+		{
+			glDeleteTextures(1, &mTextures[counter].texture);
+			mTextures.erase(mTextures.begin() + counter);
+			released = true;
+		}
+	}
+
+	if (released)
+	{
+		clearFramebuffers();
+
+		// Indices after an erased texture moved, so assign again. Nothing is created this time.
+		for (PhysicalTexture& texture : mTextures)
+		{
+			texture.busyUntil = NO_INDEX;
+		}
+
+		for (GLuint position = 0; position < (GLuint)mOrder.size(); position++)
+		{
+			for (GLuint resource = 1; resource < (GLuint)mResources.size(); resource++)
+			{
+				GraphResource& graphResource = mResources[resource];
+
+				if (graphResource.firstUse == position && graphResource.external == 0)
+				{
+					graphResource.physical = allocate(graphResource.desc, position, graphResource.lastUse);
+				}
+			}
+		}
+	}
+
+	mTransientBytes = 0;
+
+	for (const PhysicalTexture& texture : mTextures)
+	{
+		mTransientBytes += (size_t)texture.desc.width * texture.desc.height * texelBytes(texture.desc.internalFormat);
+	}
+}
+
+void RenderGraph::execute()
+{
+	for (GLuint passIndex : mOrder)
+	{
+		const GraphPass& pass = mPasses[passIndex];
+
+		// Bind the targets and cover them with the viewport.
+		glBindFramebuffer(GL_FRAMEBUFFER, getFramebuffer(pass));
+
+		if (!pass.writes.empty())
+		{
+			const TextureDesc& desc = mResources[pass.writes[0]].desc;
+			glViewport(0, 0, desc.width, desc.height);
+		}
+
+		pass.invoker(pass.pFunction, *this);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint RenderGraph::getTexture(GLuint _resource) const
+{
+	const GraphResource& resource = mResources[_resource];
+
+	if (resource.external != 0)
+	{
+		return resource.external;
+	}
+
+	return resource.physical == NO_INDEX ? 0 : mTextures[resource.physical].texture;
+}
+
+void RenderGraph::bindTexture(GLuint _resource, GLuint _unit) const
+{
+	glActiveTexture(GL_TEXTURE0 + _unit);
+	glBindTexture(GL_TEXTURE_2D, getTexture(_resource));
+}
+
+void RenderGraph::drawFullscreenTriangle() const
+{
+	glBindVertexArray(mEmptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	Profiler::countDraw(3);
+}
+
+void RenderGraph::clear()
+{
+	clearFramebuffers();
+
+	for (PhysicalTexture& texture : mTextures)
+	{
+		glDeleteTextures(1, &texture.texture);
+	}
+
+	mTextures.clear();
+
+	// Check for an existing vertex array.
+	if (mEmptyVertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &mEmptyVertexArray);
+		mEmptyVertexArray = 0;
+	}
+}
+
+bool RenderGraph::dependsOn(GLuint _pass, GLuint _other) const
+{
+	if (_pass == _other)
+	{
+		return false;
+	}
+
+	const GraphPass& pass = mPasses[_pass];
+	const GraphPass& other = mPasses[_other];
+
+	for (GLuint resource : other.writes)
+	{
+		// Writes to the same resource keep their declaration order.
+		for (GLuint written : pass.writes)
+		{
+			if (written == resource)
+			{
+				return _other < _pass;
+			}
+		}
+
+		for (GLuint read : pass.reads)
+		{
+			if (read != resource)
+			{
+				continue;
+			}
+
+			// Read the latest earlier write. Without one, the producer was declared after the reader.
+			bool earlierWriter = false;
+
+			for (GLuint counter = 0; counter < _pass && !earlierWriter; counter++)
+			{
+				for (GLuint earlierWrite : mPasses[counter].writes)
+				{
+					earlierWriter = earlierWriter || earlierWrite == resource;
+				}
+			}
+
+			return !earlierWriter || _other < _pass;
+		}
+	}
+
+	return false;
+}
+
+GLuint RenderGraph::allocate(const TextureDesc& _desc, GLuint _position, GLuint _until)
+{
+	// Reuse a texture of the same description whose last holder is done.
+	for (GLuint counter = 0; counter < (GLuint)mTextures.size(); counter++)
+	{
+		PhysicalTexture& texture = mTextures[counter];
+
+		if (texture.desc == _desc && (texture.busyUntil == NO_INDEX || texture.busyUntil < _position))
+		{
+			texture.busyUntil = _until;
+			texture.used = true;
+
+			return counter;
+		}
+	}
+
+	PhysicalTexture texture;
+	texture.desc = _desc;
+	texture.busyUntil = _until;
+	texture.used = true;
+
+	bool depth = isDepthFormat(_desc.internalFormat);
+
+	// Data is never uploaded, but the format and type must still suit the internal format.
+	glGenTextures(1, &texture.texture);
+	glBindTexture(GL_TEXTURE_2D, texture.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, _desc.internalFormat, _desc.width, _desc.height, 0, depth ? GL_DEPTH_COMPONENT : GL_RGBA, depth ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	mTextures.push_back(texture);
+
+	return (GLuint)mTextures.size() - 1;
+}
+
+GLuint RenderGraph::getFramebuffer(const GraphPass& _pass)
+{
+	// Key: the color textures in order, then the depth texture.
+	mFramebufferKey.clear();
+	GLuint depth = 0;
+
+	for (GLuint resource : _pass.writes)
+	{
+		// The default framebuffer cannot be mixed with textures.
+		if (resource == BACKBUFFER_RESOURCE)
+		{
+			return 0;
+		}
+
+		if (isDepthFormat(mResources[resource].desc.internalFormat))
+		{
+			depth = getTexture(resource);
+		}
+		else
+		{
+			mFramebufferKey.push_back(getTexture(resource));
+		}
+	}
+
+	GLuint colorCount = (GLuint)mFramebufferKey.size();
+	mFramebufferKey.push_back(depth);
+
+	auto found = mFramebuffers.find(mFramebufferKey);
+
+	if (found != mFramebuffers.end())
+	{
+		return found->second;
+	}
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	std::vector<GLenum> drawBuffers;
+
+	for (GLuint counter = 0; counter < colorCount; counter++)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + counter, GL_TEXTURE_2D, mFramebufferKey[counter], 0);
+		drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + counter);
+	}
+
+	if (depth != 0)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+	}
+
+	if (drawBuffers.empty())
+	{
+		glDrawBuffer(GL_NONE);
+	}
+	else
+	{
+		glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+	}
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Error creating the framebuffer of pass '%s'!\n", _pass.pName);
+	}
+
+	mFramebuffers[mFramebufferKey] = framebuffer;
+
+	return framebuffer;
+}
+
+void RenderGraph::clearFramebuffers()
+{
+	for (auto& entry : mFramebuffers)
+	{
+		glDeleteFramebuffers(1, &entry.second);
+	}
+
+	mFramebuffers.clear();
+}
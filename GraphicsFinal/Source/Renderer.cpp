@@ -0,0 +1,859 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+
+#include <Memory.h>
+#include <BatchMath.h>
+#include <Culling.h>
+#include <JobSystem.h>
+#include <PipelineState.h>
+#include <Mesh.h>
+#include <Shader.h>
+#include <Profiler.h>
+#include <ClusteredLighting.h>
+#include <ShadowCascades.h>
+#include <RenderGraph.h>
+#include <PostProcess.h>
+#include <DynamicResolution.h>
+#include <TemporalAA.h>
+#include <Renderer.h>
+
+// Shader file locations.
+static const char* litVertexShaderFile = "resources/vs/lit.vert";
+static const char* depthVertexShaderFile = "resources/vs/depth.vert";
+static const char* fullscreenVertexShaderFile = "resources/vs/fullscreen.vert";
+static const char* clusteredFragmentShaderFile = "resources/fs/clustered.frag";
+static const char* clusteredLightingFragmentShaderFile = "resources/fs/clustered_lighting.frag";
+static const char* gBufferFragmentShaderFile = "resources/fs/gbuffer.frag";
+static const char* deferredLightingFragmentShaderFile = "resources/fs/deferred_lighting.frag";
+static const char* shadowsFragmentShaderFile = "resources/fs/shadows.frag";
+static const char* shadowVertexShaderFile = "resources/vs/shadow.vert";
+static const char* shadowGeometryShaderFile = "resources/gs/shadow.geom";
+static const char* depthFragmentShaderFile = "resources/fs/depth.frag";
+
+Renderer::Renderer()
+{
+	mpStateTracker = nullptr;
+	mpPipelineCache = nullptr;
+	mpForwardShader = nullptr;
+	mpForwardPipeline = nullptr;
+	mpForwardEqualPipeline = nullptr;
+	mpDepthShader = nullptr;
+	mpDepthPipeline = nullptr;
+	mpGBufferShader = nullptr;
+	mpGBufferPipeline = nullptr;
+	mpGBufferEqualPipeline = nullptr;
+	mpLightingShader = nullptr;
+	mpLightingPipeline = nullptr;
+	mpShadowShader = nullptr;
+	mpShadowPipeline = nullptr;
+	mPath = RenderPath::Forward;
+	mDepthPrepass = false;
+	mReverseZ = false;
+	mFrustumCulling = true;
+	mCulledItems = 0;
+	mMeshletCulling = true;
+	mCulledMeshlets = 0;
+	mpJobs = nullptr;
+	mSampleQueries[0] = 0;
+	mSampleQueries[1] = 0;
+	mFrameCount = 0;
+	mShadedFragments = 0;
+	mGBufferBytes = 0;
+	mViewProjection = glm::mat4(1.0f);
+	mPreviousViewProjection = glm::mat4(1.0f);
+	mOrigin = glm::dvec3(0.0);
+}
+
+Renderer::~Renderer()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+int Renderer::initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache)
+{
+	mpStateTracker = _pStateTracker;
+	mpPipelineCache = _pPipelineCache;
+
+	// Create the forward shader.
+	mpForwardShader = createShader(litVertexShaderFile, clusteredFragmentShaderFile, true);
+
+	// The pre-pass reads positions only and writes no color.
+	mpDepthShader = new Shader();
+	mpDepthShader->initialize();
+	mpDepthShader->load(GL_VERTEX_SHADER, depthVertexShaderFile);
+	mpDepthShader->load(GL_FRAGMENT_SHADER, depthFragmentShaderFile);
+	mpDepthShader->link();
+	mpDepthShader->loadUniforms();
+
+	// The G-buffer pass draws the same geometry without lighting.
+	mpGBufferShader = createShader(litVertexShaderFile, gBufferFragmentShaderFile, false);
+
+	createScenePipelines();
+
+	// The lighting pass touches every pixel once and ignores depth.
+	mpLightingShader = createShader(fullscreenVertexShaderFile, deferredLightingFragmentShaderFile, true);
+
+	PipelineStateDesc lightingDesc;
+	lightingDesc.program = mpLightingShader->getId();
+	lightingDesc.depth.testEnabled = false;
+	lightingDesc.depth.writeEnabled = false;
+
+	mpLightingPipeline = mpPipelineCache->create(lightingDesc);
+
+	// The shadow program copies every triangle into the cascades selected by a mask.
+	mpShadowShader = new Shader();
+	mpShadowShader->initialize();
+	mpShadowShader->load(GL_VERTEX_SHADER, shadowVertexShaderFile);
+	mpShadowShader->load(GL_GEOMETRY_SHADER, shadowGeometryShaderFile);
+	mpShadowShader->load(GL_FRAGMENT_SHADER, depthFragmentShaderFile);
+	mpShadowShader->link();
+	mpShadowShader->loadUniforms();
+
+	PipelineStateDesc shadowDesc;
+	shadowDesc.program = mpShadowShader->getId();
+	shadowDesc.vertexLayout = VertexLayout::position();
+	shadowDesc.raster.colorWriteEnabled = false;
+	shadowDesc.raster.depthBiasEnabled = true;
+	shadowDesc.raster.depthBiasFactor = 2.0f;
+	shadowDesc.raster.depthBiasUnits = 2.0f;
+
+	mpShadowPipeline = mpPipelineCache->create(shadowDesc);
+	mShadows.initialize(DEFAULT_SHADOW_RESOLUTION);
+
+	glGenQueries(2, mSampleQueries);
+
+	mResolution.initialize();
+
+	if (mTemporalAA.initialize(mpStateTracker, mpPipelineCache) != 0)
+	{
+		return -1;
+	}
+
+	// The graph owns the frame's targets; post processing turns the HDR color into the backbuffer.
+	mFrameArena.initialize();
+	mGraph.initialize(&mFrameArena);
+
+	if (mPostProcess.initialize(mpStateTracker, mpPipelineCache) != 0)
+	{
+		return -1;
+	}
+
+	// Create the light buffers.
+	mLighting.initialize();
+
+	return 0;
+}
+
+void Renderer::setReverseZ(bool _enabled)
+{
+	if (_enabled && !StateTracker::supportsClipControl())
+	{
+		printf("Reverse-Z needs GL 4.5 or ARB_clip_control!\n");
+		_enabled = false;
+	}
+
+	if (_enabled == mReverseZ)
+	{
+		return;
+	}
+
+	mReverseZ = _enabled;
+
+	// The pipelines exist once the renderer is initialized.
+	if (mpForwardShader)
+	{
+		createScenePipelines();
+	}
+}
+
+void Renderer::setOrigin(const glm::dvec3& _origin)
+{
+	if (_origin == mOrigin)
+	{
+		return;
+	}
+
+	// Positions relative to the new origin, taken in double precision.
+	glm::vec3 offset = glm::vec3(mOrigin - _origin);
+	mOrigin = _origin;
+
+	for (PointLight& light : mLights)
+	{
+		light.position += offset;
+	}
+
+	// Motion vectors compare against last frame's transforms, which move with the world.
+	mPreviousViewProjection = mPreviousViewProjection * glm::translate(glm::mat4(1.0f), -offset);
+
+	for (glm::mat4& model : mPreviousModels)
+	{
+		model[3] += glm::vec4(offset, 0.0f);
+	}
+
+	// The static geometry in the cached cascades moved.
+	mShadows.invalidate();
+}
+
+void Renderer::render(const RenderView& _view, const std::vector<DrawItem>& _items)
+{
+	mResolution.beginFrame();
+
+	// The scene is drawn at the dynamic resolution and scaled up to the view's size at the end.
+	RenderView renderView = _view;
+	mResolution.scaleSize(_view.width, _view.height, renderView.width, renderView.height);
+
+	// Motion vectors use the unjittered transforms. Without a last frame nothing moved.
+	mViewProjection = _view.projection * _view.view;
+
+	if (mFrameCount == 0)
+	{
+		mPreviousViewProjection = mViewProjection;
+	}
+
+	// Every frame samples a different sub-pixel position for the resolve to accumulate.
+	mTemporalAA.beginFrame(renderView.width, renderView.height);
+	renderView.projection = mTemporalAA.jitterProjection(renderView.projection);
+
+	resolveFragmentQuery(renderView);
+
+	// Assign the lights to the clusters of this view.
+	ViewFrustum frustum;
+	frustum.view = renderView.view;
+	frustum.fieldOfView = renderView.fieldOfView;
+	frustum.aspectRatio = (GLfloat)renderView.width / (GLfloat)renderView.height;
+	frustum.nearPlane = renderView.nearPlane;
+	frustum.farPlane = renderView.farPlane;
+
+	mLighting.update(mLights, frustum);
+
+	// Shadow maps persist between frames for caching, so they are drawn outside the graph.
+	if (mSun.castShadows && mSun.intensity > 0.0f)
+	{
+		renderShadows(frustum, _items);
+	}
+
+	sortItems(renderView, _items);
+
+	// Build this frame's graph. The scene is shaded into an HDR target that post processing reads.
+	mGraph.reset(_view.width, _view.height);
+
+	TextureDesc hdrDesc;
+	hdrDesc.width = renderView.width;
+	hdrDesc.height = renderView.height;
+	hdrDesc.internalFormat = GL_RGBA16F;
+
+	GLuint hdr = mGraph.createTexture("hdr", hdrDesc);
+
+	TextureDesc depthDesc = hdrDesc;
+	depthDesc.internalFormat = mReverseZ ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+
+	GLuint depth = mGraph.createTexture("depth", depthDesc);
+
+	// Motion vectors are only written for the resolve.
+	GLuint velocity = 0;
+
+	if (mTemporalAA.getEnabled())
+	{
+		TextureDesc velocityDesc = hdrDesc;
+		velocityDesc.internalFormat = GL_RG16F;
+
+		velocity = mGraph.createTexture("velocity", velocityDesc);
+	}
+
+	if (mPath == RenderPath::Deferred)
+	{
+		addDeferredPasses(renderView, hdr, velocity, depth);
+	}
+	else
+	{
+		addForwardPasses(renderView, hdr, velocity, depth);
+	}
+
+	// Post processing reads the anti-aliased color when the resolve runs.
+	GLuint sceneColor = hdr;
+
+	if (mTemporalAA.getEnabled())
+	{
+		sceneColor = mTemporalAA.addPass(mGraph, hdr, velocity, depth, mPreviousViewProjection * glm::inverse(mViewProjection), mReverseZ);
+	}
+
+	if (renderView.width == _view.width && renderView.height == _view.height)
+	{
+		mPostProcess.addPasses(mGraph, sceneColor, BACKBUFFER_RESOURCE);
+	}
+	else
+	{
+		// Upscale after tone mapping, where the edge detection sees display values.
+		TextureDesc displayDesc = hdrDesc;
+		displayDesc.internalFormat = GL_RGBA8;
+
+		GLuint display = mGraph.createTexture("display", displayDesc);
+
+		mPostProcess.addPasses(mGraph, sceneColor, display);
+		mPostProcess.addUpscalePass(mGraph, display);
+	}
+
+	mGraph.compile();
+	mGraph.execute();
+
+	// Keep this frame's transforms for the next frame's motion vectors.
+	mPreviousViewProjection = mViewProjection;
+	mPreviousModels.resize(_items.size());
+
+	for (size_t counter = 0; counter < _items.size(); counter++)
+	{
+		mPreviousModels[counter] = _items[counter].model;
+	}
+
+	mResolution.endFrame();
+	mFrameCount++;
+
+	// Nothing allocated this frame is used after it.
+	mFrameArena.reset();
+}
+
+void Renderer::clear()
+{
+	mLighting.clear();
+	mShadows.clear();
+	mResolution.clear();
+	mTemporalAA.clear();
+	mGraph.clear();
+	mFrameArena.clear();
+	mPostProcess.clear();
+
+	// Check for existing shaders.
+	if (mpForwardShader)
+	{
+		delete mpForwardShader;
+		mpForwardShader = nullptr;
+	}
+
+	if (mpDepthShader)
+	{
+		delete mpDepthShader;
+		mpDepthShader = nullptr;
+	}
+
+	if (mpGBufferShader)
+	{
+		delete mpGBufferShader;
+		mpGBufferShader = nullptr;
+	}
+
+	if (mpLightingShader)
+	{
+		delete mpLightingShader;
+		mpLightingShader = nullptr;
+	}
+
+	if (mpShadowShader)
+	{
+		delete mpShadowShader;
+		mpShadowShader = nullptr;
+	}
+
+	// Check for existing queries.
+	if (mSampleQueries[0] != 0)
+	{
+		glDeleteQueries(2, mSampleQueries);
+		mSampleQueries[0] = 0;
+		mSampleQueries[1] = 0;
+	}
+
+	mpForwardPipeline = nullptr;
+	mpForwardEqualPipeline = nullptr;
+	mpDepthPipeline = nullptr;
+	mpGBufferPipeline = nullptr;
+	mpGBufferEqualPipeline = nullptr;
+	mpLightingPipeline = nullptr;
+	mpShadowPipeline = nullptr;
+}
+
+Shader* Renderer::createShader(const char* _pVertexFile, const char* _pFragmentFile, bool _lit)
+{
+	Shader* pShader = new Shader();
+	pShader->initialize();
+	pShader->load(GL_VERTEX_SHADER, _pVertexFile);
+	pShader->load(GL_FRAGMENT_SHADER, _pFragmentFile);
+
+	// The light loop and shadow lookup are separate shader objects linked into every lit program.
+	if (_lit)
+	{
+		pShader->load(GL_FRAGMENT_SHADER, clusteredLightingFragmentShaderFile);
+		pShader->load(GL_FRAGMENT_SHADER, shadowsFragmentShaderFile);
+	}
+
+	pShader->link();
+	pShader->loadUniforms();
+
+	return pShader;
+}
+
+void Renderer::createScenePipelines()
+{
+	// Opaque pipeline for the forward shader. Reverse-Z puts the near plane at one, so nearer fragments are greater.
+	PipelineStateDesc forwardDesc;
+	forwardDesc.program = mpForwardShader->getId();
+	forwardDesc.vertexLayout = VertexLayout::position();
+
+	if (mReverseZ)
+	{
+		forwardDesc.depth.function = GL_GREATER;
+		forwardDesc.depth.clipRange = GL_ZERO_TO_ONE;
+	}
+
+	mpForwardPipeline = mpPipelineCache->create(forwardDesc);
+
+	// After a pre-pass only the nearest fragment of every pixel passes.
+	PipelineStateDesc forwardEqualDesc = forwardDesc;
+	forwardEqualDesc.depth.function = GL_EQUAL;
+	forwardEqualDesc.depth.writeEnabled = false;
+
+	mpForwardEqualPipeline = mpPipelineCache->create(forwardEqualDesc);
+
+	PipelineStateDesc depthDesc = forwardDesc;
+	depthDesc.program = mpDepthShader->getId();
+	depthDesc.raster.colorWriteEnabled = false;
+
+	mpDepthPipeline = mpPipelineCache->create(depthDesc);
+
+	PipelineStateDesc gBufferDesc = forwardDesc;
+	gBufferDesc.program = mpGBufferShader->getId();
+
+	mpGBufferPipeline = mpPipelineCache->create(gBufferDesc);
+
+	PipelineStateDesc gBufferEqualDesc = forwardEqualDesc;
+	gBufferEqualDesc.program = mpGBufferShader->getId();
+
+	mpGBufferEqualPipeline = mpPipelineCache->create(gBufferEqualDesc);
+}
+
+void Renderer::drawItems(Shader* _pShader, bool _positionsOnly)
+{
+	GLuint uniformModel = _pShader->getModelLocation();
+	GLint uniformPositionScale = _pShader->getUniform(ShaderUniform::PositionScale);
+	GLint uniformPositionOffset = _pShader->getUniform(ShaderUniform::PositionOffset);
+	GLint uniformNormalEncoding = _pShader->getUniform(ShaderUniform::NormalEncoding);
+	GLint uniformRoughness = _pShader->getUniform(ShaderUniform::Roughness);
+	GLint uniformMetalness = _pShader->getUniform(ShaderUniform::Metalness);
+	GLint uniformPreviousModel = _pShader->getUniform(ShaderUniform::PreviousModel);
+
+	// Depth only programs have no material or normals.
+	bool material = uniformRoughness != -1;
+
+	// Draw every item.
+	for (const SortedDraw& draw : mDrawOrder)
+	{
+		const DrawItem& item = *draw.pItem;
+
+		glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(item.model));
+		glUniform3fv(uniformPositionScale, 1, glm::value_ptr(item.pMesh->getPositionScale()));
+		glUniform3fv(uniformPositionOffset, 1, glm::value_ptr(item.pMesh->getPositionOffset()));
+
+		if (material)
+		{
+			glUniform1i(uniformNormalEncoding, (GLint)item.pMesh->getNormalEncoding());
+			glUniform1f(uniformRoughness, item.roughness);
+			glUniform1f(uniformMetalness, item.metalness);
+		}
+
+		if (uniformPreviousModel != -1)
+		{
+			glUniformMatrix4fv(uniformPreviousModel, 1, GL_FALSE, glm::value_ptr(*draw.pPreviousModel));
+		}
+
+		if (draw.meshletsCulled)
+		{
+			item.pMesh->renderMeshlets(&mVisibleMeshlets[draw.firstMeshlet], draw.meshletCount, _positionsOnly);
+		}
+		else
+		{
+			item.pMesh->render(_positionsOnly);
+		}
+	}
+}
+
+void Renderer::sortItems(const RenderView& _view, const std::vector<DrawItem>& _items)
+{
+	size_t itemCount = _items.size();
+	size_t visibleCount = itemCount;
+
+	mVisibleItems.resize(itemCount);
+
+	if (mFrustumCulling)
+	{
+		// Gather the items into arrays so the boxes are moved to the world and tested several at a time.
+		mCullModels.resize(itemCount);
+		mLocalBounds.resize(itemCount);
+
+		for (size_t counter = 0; counter < itemCount; counter++)
+		{
+			const glm::vec3& boundsMin = _items[counter].pMesh->getBoundsMin();
+			const glm::vec3& boundsMax = _items[counter].pMesh->getBoundsMax();
+
+			mCullModels[counter] = _items[counter].model;
+			mLocalBounds.minX[counter] = boundsMin.x;
+			mLocalBounds.minY[counter] = boundsMin.y;
+			mLocalBounds.minZ[counter] = boundsMin.z;
+			mLocalBounds.maxX[counter] = boundsMax.x;
+			mLocalBounds.maxY[counter] = boundsMax.y;
+			mLocalBounds.maxZ[counter] = boundsMax.z;
+		}
+
+		BatchMath::transformBounds(mCullModels.data(), mLocalBounds, mWorldBounds);
+
+		glm::vec4 planes[(int)FrustumPlane::Count];
+		Culling::extractPlanes(_view.projection * _view.view, mReverseZ, planes);
+
+		visibleCount = Culling::cullBounds(planes, mWorldBounds, mVisibleItems.data());
+	}
+	else
+	{
+		for (size_t counter = 0; counter < itemCount; counter++)
+		{
+			mVisibleItems[counter] = (GLuint)counter;
+		}
+	}
+
+	mCulledItems = itemCount - visibleCount;
+	mDrawOrder.resize(visibleCount);
+
+	// Items are matched with the last frame's by index. A different count means a new scene that has not moved.
+	bool previousValid = mPreviousModels.size() == itemCount;
+
+	// Row 2 of the view matrix gives the view space z of a point.
+	glm::vec4 depthRow(_view.view[0][2], _view.view[1][2], _view.view[2][2], _view.view[3][2]);
+
+	for (size_t counter = 0; counter < visibleCount; counter++)
+	{
+		GLuint item = mVisibleItems[counter];
+
+		mDrawOrder[counter].depth = -glm::dot(depthRow, _items[item].model[3]);
+		mDrawOrder[counter].pItem = &_items[item];
+		mDrawOrder[counter].pPreviousModel = previousValid ? &mPreviousModels[item] : &_items[item].model;
+	}
+
+	// Nearest first.
+	std::sort(mDrawOrder.begin(), mDrawOrder.end(), [](const SortedDraw& _left, const SortedDraw& _right) { return _left.depth < _right.depth; });
+
+	cullMeshlets(_view);
+}
+
+void Renderer::cullMeshlets(const RenderView& _view)
+{
+	// Give every draw with meshlets a range of the list that holds all of them.
+	size_t meshletTotal = 0;
+
+	for (SortedDraw& draw : mDrawOrder)
+	{
+		size_t meshletCount = mMeshletCulling ? draw.pItem->pMesh->getMeshlets().size() : 0;
+
+		draw.meshletsCulled = meshletCount > 0;
+		draw.firstMeshlet = (GLuint)meshletTotal;
+		draw.meshletCount = (GLuint)meshletCount;
+
+		meshletTotal += meshletCount;
+	}
+
+	mCulledMeshlets = 0;
+
+	if (meshletTotal == 0)
+	{
+		return;
+	}
+
+	mVisibleMeshlets.resize(meshletTotal);
+
+	glm::vec4 planes[(int)FrustumPlane::Count];
+	Culling::extractPlanes(_view.projection * _view.view, mReverseZ, planes);
+
+	// Draws write only their own ranges, so workers take whole draws.
+	auto cullDraws = [&](size_t _begin, size_t _end, GLuint _worker)
+	{
+		for (size_t counter = _begin; counter < _end; counter++)
+		{
+			SortedDraw& draw = mDrawOrder[counter];
+
+			if (!draw.meshletsCulled)
+			{
+				continue;
+			}
+
+			const glm::mat4& model = draw.pItem->model;
+			const std::vector<Meshlet>& meshlets = draw.pItem->pMesh->getMeshlets();
+
+			// Test in the mesh's space, so the spheres and cones need no transforming.
+			glm::vec4 localPlanes[(int)FrustumPlane::Count];
+			Culling::transformPlanes(planes, model, localPlanes);
+
+			glm::vec3 camera = glm::vec3(glm::inverse(_view.view * model)[3]);
+
+			// A mirroring model turns the winding around, so the cones would point inwards.
+			bool backfaceCones = glm::determinant(glm::mat3(model)) > 0.0f;
+
+			draw.meshletCount = (GLuint)Culling::cullMeshlets(localPlanes, camera, backfaceCones, meshlets.data(), meshlets.size(), &mVisibleMeshlets[draw.firstMeshlet]);
+		}
+	};
+
+	if (mpJobs)
+	{
+		mpJobs->parallelFor(mDrawOrder.size(), MESHLET_CULL_GRAIN, cullDraws);
+	}
+	else
+	{
+		cullDraws(0, mDrawOrder.size(), 0);
+	}
+
+	for (const SortedDraw& draw : mDrawOrder)
+	{
+		mCulledMeshlets += draw.meshletsCulled ? draw.pItem->pMesh->getMeshlets().size() - draw.meshletCount : 0;
+	}
+}
+
+void Renderer::renderDepth(const RenderView& _view)
+{
+	mpStateTracker->bind(mpDepthPipeline);
+
+	glUniformMatrix4fv(mpDepthShader->getProjectionLocation(), 1, GL_FALSE, glm::value_ptr(_view.projection));
+	glUniformMatrix4fv(mpDepthShader->getViewLocation(), 1, GL_FALSE, glm::value_ptr(_view.view));
+
+	drawItems(mpDepthShader, true);
+}
+
+void Renderer::resolveFragmentQuery(const RenderView& _view)
+{
+	// The query of this frame's slot was issued two frames ago, so the CPU never waits on the GPU.
+	if (mFrameCount < 2)
+	{
+		return;
+	}
+
+	GLuint query = mSampleQueries[mFrameCount % 2];
+	GLuint available = 0;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+	{
+		return;
+	}
+
+	GLuint samplesPassed = 0;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samplesPassed);
+
+	mShadedFragments = samplesPassed;
+	Profiler::countFragments(samplesPassed);
+
+	if (mPath == RenderPath::Deferred)
+	{
+		// Every passing fragment writes all targets; lighting reads every pixel once.
+		unsigned long long pixels = (unsigned long long)_view.width * (unsigned long long)_view.height;
+		mGBufferBytes = ((unsigned long long)samplesPassed + pixels) * GBUFFER_BYTES_PER_PIXEL;
+	}
+}
+
+void Renderer::bindLighting(Shader* _pShader, const RenderView& _view)
+{
+	mLighting.bind(*_pShader, _view.width, _view.height);
+
+	// The sun is lit in view space like the point lights.
+	glm::vec3 sunDirection = glm::normalize(glm::mat3(_view.view) * -mSun.direction);
+	glm::vec3 sunColor = mSun.color * mSun.intensity;
+
+	glUniform3fv(_pShader->getUniform(ShaderUniform::SunDirection), 1, glm::value_ptr(sunDirection));
+	glUniform3fv(_pShader->getUniform(ShaderUniform::SunColor), 1, glm::value_ptr(sunColor));
+
+	if (mSun.castShadows)
+	{
+		mShadows.bindReceiver(*_pShader);
+	}
+	else
+	{
+		// Zero splits put every fragment past the last cascade, which is unshadowed.
+		glUniform4f(_pShader->getUniform(ShaderUniform::CascadeSplits), 0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
+
+void Renderer::renderShadows(const ViewFrustum& _frustum, const std::vector<DrawItem>& _items)
+{
+	mShadows.update(_frustum, mSun.direction);
+
+	// Cached cascades that are still valid need no drawing.
+	GLuint staticMask = mShadows.getStaticMask();
+	GLuint dynamicMask = mShadows.getDynamicMask();
+
+	mpStateTracker->bind(mpShadowPipeline);
+	mShadows.beginRender(*mpStateTracker);
+	mShadows.bindCaster(*mpShadowShader);
+
+	GLuint uniformModel = mpShadowShader->getModelLocation();
+	GLint uniformMask = mpShadowShader->getUniform(ShaderUniform::CascadeMask);
+	GLint uniformPositionScale = mpShadowShader->getUniform(ShaderUniform::PositionScale);
+	GLint uniformPositionOffset = mpShadowShader->getUniform(ShaderUniform::PositionOffset);
+	GLuint currentMask = ~0u;
+
+	for (const DrawItem& item : _items)
+	{
+		GLuint mask = item.staticGeometry ? staticMask : dynamicMask;
+
+		if (mask == 0)
+		{
+			continue;
+		}
+
+		// The mask only changes between static and dynamic items.
+		if (mask != currentMask)
+		{
+			glUniform1i(uniformMask, (GLint)mask);
+			currentMask = mask;
+		}
+
+		glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(item.model));
+		glUniform3fv(uniformPositionScale, 1, glm::value_ptr(item.pMesh->getPositionScale()));
+		glUniform3fv(uniformPositionOffset, 1, glm::value_ptr(item.pMesh->getPositionOffset()));
+
+		item.pMesh->render(true);
+	}
+}
+
+void Renderer::bindMotion(Shader* _pShader)
+{
+	glUniformMatrix4fv(_pShader->getUniform(ShaderUniform::ViewProjection), 1, GL_FALSE, glm::value_ptr(mViewProjection));
+	glUniformMatrix4fv(_pShader->getUniform(ShaderUniform::PreviousViewProjection), 1, GL_FALSE, glm::value_ptr(mPreviousViewProjection));
+}
+
+void Renderer::addForwardPasses(const RenderView& _view, GLuint _hdr, GLuint _velocity, GLuint _depth)
+{
+	GLuint forwardPass = mGraph.addPass("forward", [this, &_view](RenderGraph&) { renderForward(_view); });
+	mGraph.write(forwardPass, _hdr);
+
+	// The color outputs bind in write order: color, then velocity.
+	if (_velocity != 0)
+	{
+		mGraph.write(forwardPass, _velocity);
+	}
+
+	mGraph.write(forwardPass, _depth);
+}
+
+void Renderer::addDeferredPasses(const RenderView& _view, GLuint _hdr, GLuint _velocity, GLuint _depth)
+{
+	// Albedo with packed material and octahedral normal. Depth is shared with the rest of the frame.
+	const GLenum internalFormats[2] = { GL_RGBA8, GL_RG16 };
+	const char* names[2] = { "gbuffer_albedo", "gbuffer_normal" };
+
+	std::array<GLuint, 3> gBuffer;
+
+	for (GLuint counter = 0; counter < 2; counter++)
+	{
+		TextureDesc desc;
+		desc.width = _view.width;
+		desc.height = _view.height;
+		desc.internalFormat = internalFormats[counter];
+
+		gBuffer[counter] = mGraph.createTexture(names[counter], desc);
+	}
+
+	gBuffer[2] = _depth;
+
+	GLuint gBufferPass = mGraph.addPass("gbuffer", [this, &_view](RenderGraph&) { renderGBuffer(_view); });
+	mGraph.write(gBufferPass, gBuffer[0]);
+	mGraph.write(gBufferPass, gBuffer[1]);
+
+	// Velocity is the third color output of the G-buffer program.
+	if (_velocity != 0)
+	{
+		mGraph.write(gBufferPass, _velocity);
+	}
+
+	mGraph.write(gBufferPass, _depth);
+
+	GLuint lightingPass = mGraph.addPass("lighting", [this, &_view, gBuffer](RenderGraph&) { renderLighting(_view, gBuffer.data()); });
+	mGraph.write(lightingPass, _hdr);
+
+	for (GLuint resource : gBuffer)
+	{
+		mGraph.read(lightingPass, resource);
+	}
+}
+
+void Renderer::renderForward(const RenderView& _view)
+{
+	// Clear the target to black.
+	mpStateTracker->clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, 0.0f, 0.0f, 0.0f, 1.0f, mReverseZ ? 0.0f : 1.0f);
+
+	if (mDepthPrepass)
+	{
+		renderDepth(_view);
+	}
+
+	// Bind the forward pipeline and its lighting inputs.
+	mpStateTracker->bind(mDepthPrepass ? mpForwardEqualPipeline : mpForwardPipeline);
+	bindLighting(mpForwardShader, _view);
+
+	glUniformMatrix4fv(mpForwardShader->getProjectionLocation(), 1, GL_FALSE, glm::value_ptr(_view.projection));
+	glUniformMatrix4fv(mpForwardShader->getViewLocation(), 1, GL_FALSE, glm::value_ptr(_view.view));
+	bindMotion(mpForwardShader);
+
+	glBeginQuery(GL_SAMPLES_PASSED, mSampleQueries[mFrameCount % 2]);
+	drawItems(mpForwardShader);
+	glEndQuery(GL_SAMPLES_PASSED);
+}
+
+void Renderer::renderGBuffer(const RenderView& _view)
+{
+	// Background pixels are found by depth, so only depth is cleared.
+	mpStateTracker->clear(GL_DEPTH_BUFFER_BIT, 0.0f, 0.0f, 0.0f, 1.0f, mReverseZ ? 0.0f : 1.0f);
+
+	if (mDepthPrepass)
+	{
+		renderDepth(_view);
+	}
+
+	mpStateTracker->bind(mDepthPrepass ? mpGBufferEqualPipeline : mpGBufferPipeline);
+
+	glUniformMatrix4fv(mpGBufferShader->getProjectionLocation(), 1, GL_FALSE, glm::value_ptr(_view.projection));
+	glUniformMatrix4fv(mpGBufferShader->getViewLocation(), 1, GL_FALSE, glm::value_ptr(_view.view));
+	bindMotion(mpGBufferShader);
+
+	glBeginQuery(GL_SAMPLES_PASSED, mSampleQueries[mFrameCount % 2]);
+	drawItems(mpGBufferShader);
+	glEndQuery(GL_SAMPLES_PASSED);
+}
+
+void Renderer::renderLighting(const RenderView& _view, const GLuint _gBuffer[3])
+{
+	mpStateTracker->bind(mpLightingPipeline);
+	bindLighting(mpLightingShader, _view);
+
+	for (GLuint counter = 0; counter < 3; counter++)
+	{
+		mGraph.bindTexture(_gBuffer[counter], GBUFFER_TEXTURE_UNIT + counter);
+	}
+
+	glUniform1i(mpLightingShader->getUniform(ShaderUniform::GAlbedoMaterial), GBUFFER_TEXTURE_UNIT);
+	glUniform1i(mpLightingShader->getUniform(ShaderUniform::GNormal), GBUFFER_TEXTURE_UNIT + 1);
+	glUniform1i(mpLightingShader->getUniform(ShaderUniform::GDepth), GBUFFER_TEXTURE_UNIT + 2);
+	glUniformMatrix4fv(mpLightingShader->getUniform(ShaderUniform::InverseProjection), 1, GL_FALSE, glm::value_ptr(glm::inverse(_view.projection)));
+	glUniform2f(mpLightingShader->getUniform(ShaderUniform::ScreenSize), (GLfloat)_view.width, (GLfloat)_view.height);
+	glUniform1i(mpLightingShader->getUniform(ShaderUniform::ReverseZ), mReverseZ ? 1 : 0);
+
+	mGraph.drawFullscreenTriangle();
+}
@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <utility>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <Memory.h>
+#include <PipelineState.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
+#include <Mesh.h>
+#include <Shader.h>
+#include <ResourceManager.h>
+
+namespace
+{
+	/// <summary> 64 bit FNV-1a constants. </summary>
+	const unsigned long long RESOURCE_HASH_OFFSET = 14695981039346656037ull;
+	const unsigned long long RESOURCE_HASH_PRIME = 1099511628211ull;
+
+	/// <summary> Fold bytes into a running FNV-1a hash. </summary>
+	unsigned long long hashBytes(unsigned long long _hash, const void* _pData, size_t _bytes)
+	{
+		const unsigned char* pBytes = (const unsigned char*)_pData;
+
+		for (size_t counter = 0; counter < _bytes; counter++)
+		{
+			_hash = (_hash ^ pBytes[counter]) * RESOURCE_HASH_PRIME;
+		}
+
+		return _hash;
+	}
+
+	/// <summary> Fold a string and its terminator into a running hash, so "ab" + "c" differs from "a" + "bc". </summary>
+	unsigned long long hashString(unsigned long long _hash, const std::string& _string)
+	{
+		return hashBytes(_hash, _string.c_str(), _string.size() + 1);
+	}
+
+	/// <summary> Read a whole file. Returns false when it cannot be opened. </summary>
+	bool readFile(const char* _pPath, std::string& _content)
+	{
+		std::ifstream fileStream(_pPath, std::ios::in | std::ios::binary);
+
+		if (!fileStream)
+		{
+			return false;
+		}
+
+		std::stringstream buffer;
+		buffer << fileStream.rdbuf();
+		_content = buffer.str();
+
+		return true;
+	}
+}
+
+ResourceManager::ResourceManager()
+{
+	mpGeometryPool = nullptr;
+	mBudget = DEFAULT_RESOURCE_BUDGET;
+	mFrame = 0;
+}
+
+ResourceManager::~ResourceManager()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+void ResourceManager::initialize(GLuint _maxMeshes, GLuint _maxShaders, size_t _budget, GeometryPool* _pGeometryPool)
+{
+	clear();
+
+	mMeshes.pool.initialize(_maxMeshes);
+	mMeshes.entries.assign(_maxMeshes, ResourceEntry());
+	mShaders.pool.initialize(_maxShaders);
+	mShaders.entries.assign(_maxShaders, ResourceEntry());
+
+	mpGeometryPool = _pGeometryPool;
+	mBudget = _budget;
+	mStats = ResourceStats();
+}
+
+Handle<Mesh> ResourceManager::findMesh(const char* _pName)
+{
+	return share(mMeshes, hashString(RESOURCE_HASH_OFFSET, _pName), 0, 0, false);
+}
+
+Handle<Mesh> ResourceManager::loadMesh(const char* _pName, const std::vector<GLfloat>& _vertices, const std::vector<unsigned int>& _indices)
+{
+	unsigned long long nameKey = hashString(RESOURCE_HASH_OFFSET, _pName);
+
+	// The content is the positions and the indices.
+	unsigned long long contentKey = hashBytes(RESOURCE_HASH_OFFSET, _vertices.data(), _vertices.size() * sizeof(GLfloat));
+	contentKey = hashBytes(contentKey, _indices.data(), _indices.size() * sizeof(unsigned int));
+
+	size_t gpuBytes = _vertices.size() * sizeof(GLfloat) + _indices.size() * sizeof(unsigned int);
+
+	Handle<Mesh> mesh = share(mMeshes, nameKey, contentKey, gpuBytes, true);
+
+	if (mesh.isValid())
+	{
+		return mesh;
+	}
+
+	// Make room before uploading.
+	trim(gpuBytes);
+
+	mesh = mMeshes.pool.create();
+
+	if (!mesh.isValid())
+	{
+		return mesh;
+	}
+
+	// The mesh does not modify the data.
+	mMeshes.pool.get(mesh)->create((GLfloat*)_vertices.data(), (unsigned int*)_indices.data(), (unsigned int)_vertices.size(), (unsigned int)_indices.size(), mpGeometryPool);
+
+	insert(mMeshes, mesh, nameKey, contentKey, gpuBytes, gpuBytes);
+	mStats.meshCount++;
+
+	return mesh;
+}
+
+Handle<Shader> ResourceManager::loadShader(const char* _pVertexFile, const char* _pFragmentFile, const std::string& _defines)
+{
+	unsigned long long nameKey = hashString(hashString(hashString(RESOURCE_HASH_OFFSET, _pVertexFile), _pFragmentFile), _defines);
+
+	// A resident program of the same files skips reading them.
+	Handle<Shader> shader = share(mShaders, nameKey, 0, 0, false);
+
+	if (shader.isValid())
+	{
+		return shader;
+	}
+
+	std::string vertexSource;
+	std::string fragmentSource;
+
+	if (!readFile(_pVertexFile, vertexSource) || !readFile(_pFragmentFile, fragmentSource))
+	{
+		printf("Error reading shader files '%s' and '%s'!\n", _pVertexFile, _pFragmentFile);
+		return shader;
+	}
+
+	// Copies of the same sources under other paths build the same program.
+	unsigned long long contentKey = hashString(hashString(hashString(RESOURCE_HASH_OFFSET, vertexSource), fragmentSource), _defines);
+	size_t contentBytes = vertexSource.size() + fragmentSource.size() + _defines.size();
+
+	shader = share(mShaders, nameKey, contentKey, contentBytes, true);
+
+	if (shader.isValid())
+	{
+		return shader;
+	}
+
+	shader = mShaders.pool.create();
+
+	if (!shader.isValid())
+	{
+		return shader;
+	}
+
+	Shader* pShader = mShaders.pool.get(shader);
+	pShader->initialize();
+	pShader->setDefines(_defines);
+	pShader->load(GL_VERTEX_SHADER, _pVertexFile);
+	pShader->load(GL_FRAGMENT_SHADER, _pFragmentFile);
+	pShader->link();
+	pShader->loadUniforms();
+
+	// The driver's binary is the closest measure of a program's memory; without it use the source size.
+	GLint binaryLength = 0;
+
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+	{
+		glGetProgramiv(pShader->getId(), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	}
+
+	size_t gpuBytes = binaryLength > 0 ? (size_t)binaryLength : vertexSource.size() + fragmentSource.size();
+
+	trim(gpuBytes);
+
+	insert(mShaders, shader, nameKey, contentKey, contentBytes, gpuBytes);
+	mStats.shaderCount++;
+
+	return shader;
+}
+
+Mesh* ResourceManager::get(Handle<Mesh> _mesh)
+{
+	Mesh* pMesh = mMeshes.pool.get(_mesh);
+
+	if (pMesh)
+	{
+		mMeshes.entries[_mesh.index].lastUsed = mFrame;
+	}
+
+	return pMesh;
+}
+
+Shader* ResourceManager::get(Handle<Shader> _shader)
+{
+	Shader* pShader = mShaders.pool.get(_shader);
+
+	if (pShader)
+	{
+		mShaders.entries[_shader.index].lastUsed = mFrame;
+	}
+
+	return pShader;
+}
+
+void ResourceManager::release(Handle<Mesh> _mesh)
+{
+	if (mMeshes.pool.get(_mesh) && mMeshes.entries[_mesh.index].references > 0)
+	{
+		mMeshes.entries[_mesh.index].references--;
+		trim(0);
+	}
+}
+
+void ResourceManager::release(Handle<Shader> _shader)
+{
+	if (mShaders.pool.get(_shader) && mShaders.entries[_shader.index].references > 0)
+	{
+		mShaders.entries[_shader.index].references--;
+		trim(0);
+	}
+}
+
+void ResourceManager::setBudget(size_t _budget)
+{
+	mBudget = _budget;
+	trim(0);
+}
+
+size_t ResourceManager::getGpuBytes(Handle<Mesh> _mesh) const
+{
+	return mMeshes.pool.get(_mesh) ? mMeshes.entries[_mesh.index].gpuBytes : 0;
+}
+
+size_t ResourceManager::getGpuBytes(Handle<Shader> _shader) const
+{
+	return mShaders.pool.get(_shader) ? mShaders.entries[_shader.index].gpuBytes : 0;
+}
+
+void ResourceManager::clear()
+{
+	// Destroying the objects deletes their GL objects.
+	mMeshes.pool.clear();
+	mMeshes.byName.clear();
+	mMeshes.byContent.clear();
+	mShaders.pool.clear();
+	mShaders.byName.clear();
+	mShaders.byContent.clear();
+
+	mMeshes.entries.assign(mMeshes.entries.size(), ResourceEntry());
+	mShaders.entries.assign(mShaders.entries.size(), ResourceEntry());
+
+	mStats.meshCount = 0;
+	mStats.shaderCount = 0;
+	mStats.gpuBytes = 0;
+}
+
+template<typename T>
+Handle<T> ResourceManager::share(ResourceCache<T>& _cache, unsigned long long _nameKey, unsigned long long _contentKey, size_t _contentBytes, bool _useContent)
+{
+	Handle<T> handle;
+
+	auto found = _cache.byName.find(_nameKey);
+
+	if (found != _cache.byName.end())
+	{
+		handle = found->second;
+	}
+	else if (_useContent)
+	{
+		found = _cache.byContent.find(_contentKey);
+
+		// A hash match of a different size is a collision, not the same content.
+		if (found == _cache.byContent.end() || _cache.entries[found->second.index].contentBytes != _contentBytes)
+		{
+			return handle;
+		}
+
+		// Later requests by this name find it directly.
+		handle = found->second;
+		_cache.byName[_nameKey] = handle;
+	}
+	else
+	{
+		return handle;
+	}
+
+	ResourceEntry& entry = _cache.entries[handle.index];
+	entry.references++;
+	entry.lastUsed = mFrame;
+
+	mStats.sharedLoads++;
+
+	return handle;
+}
+
+template<typename T>
+void ResourceManager::insert(ResourceCache<T>& _cache, Handle<T> _handle, unsigned long long _nameKey, unsigned long long _contentKey, size_t _contentBytes, size_t _gpuBytes)
+{
+	ResourceEntry& entry = _cache.entries[_handle.index];
+	entry.nameKey = _nameKey;
+	entry.contentKey = _contentKey;
+	entry.contentBytes = _contentBytes;
+	entry.gpuBytes = _gpuBytes;
+	entry.references = 1;
+	entry.lastUsed = mFrame;
+
+	_cache.byName[_nameKey] = _handle;
+
+	// After a collision the resident resource keeps the content slot and this one is found by name only.
+	_cache.byContent.emplace(_contentKey, _handle);
+
+	mStats.gpuBytes += _gpuBytes;
+	mStats.loads++;
+}
+
+template<typename T>
+bool ResourceManager::findOldest(const ResourceCache<T>& _cache, GLuint& _index, unsigned long long& _lastUsed) const
+{
+	bool found = false;
+
+	for (GLuint counter = 0; counter < (GLuint)_cache.entries.size(); counter++)
+	{
+		const ResourceEntry& entry = _cache.entries[counter];
+
+		// Only resident resources nothing references. Free slots have no memory.
+		if (entry.references > 0 || entry.gpuBytes == 0 || entry.lastUsed >= _lastUsed)
+		{
+			continue;
+		}
+
+		_index = counter;
+		_lastUsed = entry.lastUsed;
+		found = true;
+	}
+
+	return found;
+}
+
+template<typename T>
+void ResourceManager::evict(ResourceCache<T>& _cache, GLuint _index)
+{
+	ResourceEntry& entry = _cache.entries[_index];
+	Handle<T> handle;
+
+	// Names shared through a content match also point at this slot. Its own name always does.
+	for (auto iterator = _cache.byName.begin(); iterator != _cache.byName.end();)
+	{
+		if (iterator->second.index == _index)
+		{
+			handle = iterator->second;
+			iterator = _cache.byName.erase(iterator);
+		}
+		else
+		{
+			iterator++;
+		}
+	}
+
+	// The content slot may belong to another resource of a colliding hash.
+	auto found = _cache.byContent.find(entry.contentKey);
+
+	if (found != _cache.byContent.end() && found->second.index == _index)
+	{
+		_cache.byContent.erase(found);
+	}
+
+	_cache.pool.destroy(handle);
+
+	mStats.gpuBytes -= entry.gpuBytes;
+	mStats.evictions++;
+
+	entry = ResourceEntry();
+}
+
+void ResourceManager::trim(size_t _incoming)
+{
+	while (mStats.gpuBytes + _incoming > mBudget)
+	{
+		GLuint meshIndex = 0;
+		GLuint shaderIndex = 0;
+		unsigned long long meshUsed = ~0ull;
+		unsigned long long shaderUsed = ~0ull;
+
+		bool mesh = findOldest(mMeshes, meshIndex, meshUsed);
+		bool shader = findOldest(mShaders, shaderIndex, shaderUsed);
+
+		// Everything left is referenced.
+		if (!mesh && !shader)
+		{
+			return;
+		}
+
+		if (mesh && (!shader || meshUsed <= shaderUsed))
+		{
+			evict(mMeshes, meshIndex);
+			mStats.meshCount--;
+		}
+		else
+		{
+			evict(mShaders, shaderIndex);
+			mStats.shaderCount--;
+		}
+	}
+}
@@ -1,3 +1,5 @@
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <fstream>
 
@@ -5,6 +7,58 @@
 
 #include <Shader.h>
 
+namespace
+{
+	/// <summary> Names of the per frame uniforms in the shaders, indexed by uniform. </summary>
+	const char* const SHADER_UNIFORM_NAMES[(int)ShaderUniform::Count] =
+	{
+		"uPositionScale",
+		"uPositionOffset",
+		"uNormalEncoding",
+		"uRoughness",
+		"uMetalness",
+		"uPreviousModel",
+		"uCascadeMask",
+		"uViewProjection",
+		"uPreviousViewProjection",
+		"uSunDirection",
+		"uSunColor",
+		"uLightData",
+		"uClusterGrid",
+		"uLightIndices",
+		"uClusterCount",
+		"uClusterTileScale",
+		"uClusterSlice",
+		"uCascadeViewProjections",
+		"uShadowMap",
+		"uShadowMatrices",
+		"uCascadeSplits",
+		"uShadowTexelSizes",
+		"uGAlbedoMaterial",
+		"uGNormal",
+		"uGDepth",
+		"uInverseProjection",
+		"uScreenSize",
+		"uReverseZ",
+		"uSource",
+		"uSourceTexel",
+		"uSourceSize",
+		"uThreshold",
+		"uDirection",
+		"uHdr",
+		"uExposure",
+		"uBloom",
+		"uBloomStrength",
+		"uEdgeAdaptive",
+		"uColor",
+		"uVelocity",
+		"uDepth",
+		"uHistory",
+		"uHistoryWeight",
+		"uReprojection"
+	};
+}
+
 Shader::Shader()
 {
 	// Set all the member variables to null.
@@ -12,10 +66,24 @@ Shader::Shader()
 	mUniformModel = 0;
 	mUniformProjection = 0;
 	mUniformView = 0;
+
+	for (GLint& location : mUniforms)
+	{
+		location = -1;
+	}
 }
 
 Shader::~Shader()
 {
+	// Check for an existing program.
+	if (mId != 0)
+	{
+		// Delete the program and the shaders attached to it from graphics memory.
+		glDeleteProgram(mId);
+
+		// Clear the id.
+		mId = 0;
+	}
 }
 
 void Shader::initialize()
@@ -54,6 +122,14 @@ void Shader::load(GLenum _type, const std::string& _filename)
 	// Close the stream.
 	fileStream.close();
 
+	// Insert the defines after the #version line, which must come first.
+	if (!mDefines.empty())
+	{
+		size_t versionEnd = content.find('\n');
+
+		content.insert(versionEnd == std::string::npos ? 0 : versionEnd + 1, mDefines + "\n");
+	}
+
 	// Compile the shader.
 	compile(_type, (content.c_str()));
 }
@@ -124,6 +200,12 @@ void Shader::loadUniforms()
 	mUniformModel = glGetUniformLocation(mId, "uModel");
 	mUniformProjection = glGetUniformLocation(mId, "uProjection");
 	mUniformView = glGetUniformLocation(mId, "uView");
+
+	// Programs only have some of them; the rest stay -1, which glUniform ignores.
+	for (GLuint counter = 0; counter < (GLuint)ShaderUniform::Count; counter++)
+	{
+		mUniforms[counter] = glGetUniformLocation(mId, SHADER_UNIFORM_NAMES[counter]);
+	}
 }
 
 GLuint Shader::loadUniform(const GLchar* _pVariable)
@@ -160,9 +242,13 @@ void Shader::compile(GLenum _type, const char* _pContent)
 	{
 		glGetShaderInfoLog(shader, sizeof(errorLog), NULL, errorLog);
 		printf("Error compiling the %d shader: '%s'\n", _type, errorLog);
+		glDeleteShader(shader);
 		return;
 	}
 
 	// Attach shader to the program.
 	glAttachShader(mId, shader);
+
+	// Flag the shader for deletion. It is freed with the program it is attached to.
+	glDeleteShader(shader);
 }
@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+
+#include <PipelineState.h>
+#include <Shader.h>
+#include <ClusteredLighting.h>
+#include <ShadowCascades.h>
+
+namespace
+{
+	/// <summary> Blend between logarithmic (1) and uniform (0) cascade splits. </summary>
+	const GLfloat SPLIT_LAMBDA = 0.75f;
+
+	/// <summary> Extra depth towards the light so casters outside the view still cast. </summary>
+	const GLfloat CASTER_DISTANCE = 50.0f;
+
+	/// <summary> Fraction of a cached cascade's width its center snaps to. The cascade grows by the same amount. </summary>
+	const GLfloat CACHE_SNAP = 0.125f;
+
+	/// <summary> Largest change of the light direction cosine treated as unmoved. </summary>
+	const GLfloat DIRECTION_EPSILON = 1.0e-5f;
+}
+
+ShadowCascades::ShadowCascades()
+{
+	mDepthTexture = 0;
+	mLayeredFramebuffer = 0;
+	mResolution = DEFAULT_SHADOW_RESOLUTION;
+	mDistance = 60.0f;
+	mCachedDirection = glm::vec3(0.0f);
+	mCacheValid = false;
+	mDynamicMask = 0;
+	mStaticMask = 0;
+
+	for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+	{
+		mLayerFramebuffers[cascade] = 0;
+		mSplits[cascade] = 0.0f;
+		mTexelSizes[cascade] = 0.0f;
+		mCachedBounds[cascade] = glm::vec4(0.0f);
+	}
+}
+
+ShadowCascades::~ShadowCascades()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+void ShadowCascades::initialize(GLsizei _resolution)
+{
+	mResolution = _resolution;
+
+	// One depth layer per cascade, sampled with hardware comparison.
+	glGenTextures(1, &mDepthTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, mDepthTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, _resolution, _resolution, SHADOW_CASCADE_COUNT, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// The geometry shader picks the layer, so every cascade is drawn in one pass.
+	glGenFramebuffers(1, &mLayeredFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, mLayeredFramebuffer);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mDepthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Error creating the shadow framebuffer!\n");
+	}
+
+	// Clearing a layered framebuffer clears every layer, so cached layers are cleared through their own.
+	glGenFramebuffers(SHADOW_CASCADE_COUNT, mLayerFramebuffers);
+
+	for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, mLayerFramebuffers[cascade]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mDepthTexture, 0, cascade);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	mCacheValid = false;
+}
+
+void ShadowCascades::update(const ViewFrustum& _frustum, const glm::vec3& _lightDirection)
+{
+	glm::vec3 direction = glm::normalize(_lightDirection);
+
+	// Cached cascades are stale once the light turns.
+	bool lightMoved = glm::dot(direction, mCachedDirection) < 1.0f - DIRECTION_EPSILON;
+
+	// Light space rotation. Only the bounds change between cascades.
+	glm::vec3 up = fabsf(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+
+	glm::mat4 inverseView = glm::inverse(_frustum.view);
+
+	GLfloat nearPlane = _frustum.nearPlane;
+	GLfloat farPlane = glm::min(_frustum.farPlane, mDistance);
+	GLfloat tanHalfY = tanf(_frustum.fieldOfView * 0.5f);
+	GLfloat tanHalfX = tanHalfY * _frustum.aspectRatio;
+
+	// Maps clip space [-1, 1] to texture space [0, 1].
+	glm::mat4 bias = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+
+	mDynamicMask = 0;
+	mStaticMask = 0;
+
+	GLfloat splitNear = nearPlane;
+
+	for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+	{
+		// Practical split scheme between logarithmic and uniform.
+		GLfloat fraction = (GLfloat)(cascade + 1) / (GLfloat)SHADOW_CASCADE_COUNT;
+		GLfloat logSplit = nearPlane * powf(farPlane / nearPlane, fraction);
+		GLfloat uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+		GLfloat splitFar = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniformSplit;
+
+		mSplits[cascade] = splitFar;
+
+		// Bounding sphere of the frustum slice. Its center stays on the view axis and its
+		// radius only depends on the projection, so the cascade size is stable as the camera turns.
+		glm::vec3 corners[8];
+		glm::vec3 center(0.0f);
+
+		for (GLuint corner = 0; corner < 8; corner++)
+		{
+			GLfloat depth = (corner & 4) ? splitFar : splitNear;
+			GLfloat x = (corner & 1) ? depth * tanHalfX : -depth * tanHalfX;
+			GLfloat y = (corner & 2) ? depth * tanHalfY : -depth * tanHalfY;
+
+			corners[corner] = glm::vec3(x, y, -depth);
+			center += corners[corner];
+		}
+
+		center /= 8.0f;
+
+		GLfloat radius = 0.0f;
+
+		for (GLuint corner = 0; corner < 8; corner++)
+		{
+			radius = glm::max(radius, glm::length(corners[corner] - center));
+		}
+
+		// Round up so float noise never changes the size.
+		radius = ceilf(radius * 16.0f) / 16.0f;
+
+		bool cached = cascade >= SHADOW_CACHED_CASCADE;
+
+		// Cached cascades move in coarse steps and grow to cover the slice between steps.
+		GLfloat snap = 0.0f;
+
+		if (cached)
+		{
+			snap = radius * 2.0f * CACHE_SNAP;
+			radius += snap;
+		}
+
+		GLfloat texelSize = radius * 2.0f / (GLfloat)mResolution;
+
+		if (!cached)
+		{
+			snap = texelSize;
+		}
+
+		// Snap the light space center so texels stay fixed in the world as the camera moves.
+		glm::vec3 lightCenter = glm::vec3(lightView * inverseView * glm::vec4(center, 1.0f));
+		lightCenter = glm::floor(lightCenter / snap) * snap;
+
+		glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius,
+			-(lightCenter.z + radius + CASTER_DISTANCE), -(lightCenter.z - radius));
+
+		mViewProjections[cascade] = projection * lightView;
+		mReceiverMatrices[cascade] = bias * mViewProjections[cascade] * inverseView;
+		mTexelSizes[cascade] = texelSize;
+
+		if (cached)
+		{
+			// Re-render only when the light, the bounds or the static geometry changed.
+			glm::vec4 bounds(lightCenter, radius);
+
+			if (!mCacheValid || lightMoved || bounds != mCachedBounds[cascade])
+			{
+				mStaticMask |= 1u << cascade;
+				mCachedBounds[cascade] = bounds;
+			}
+		}
+		else
+		{
+			mDynamicMask |= 1u << cascade;
+			mStaticMask |= 1u << cascade;
+		}
+
+		splitNear = splitFar;
+	}
+
+	mCachedDirection = direction;
+	mCacheValid = true;
+}
+
+void ShadowCascades::beginRender(StateTracker& _stateTracker)
+{
+	// Clear only the layers rendered this frame.
+	for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+	{
+		if (mStaticMask & (1u << cascade))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, mLayerFramebuffers[cascade]);
+			_stateTracker.clear(GL_DEPTH_BUFFER_BIT, 0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, mLayeredFramebuffer);
+	glViewport(0, 0, mResolution, mResolution);
+}
+
+void ShadowCascades::bindCaster(const Shader& _shader) const
+{
+	glUniformMatrix4fv(_shader.getUniform(ShaderUniform::CascadeViewProjections), SHADOW_CASCADE_COUNT, GL_FALSE, glm::value_ptr(mViewProjections[0]));
+}
+
+void ShadowCascades::bindReceiver(const Shader& _shader) const
+{
+	glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, mDepthTexture);
+
+	glUniform1i(_shader.getUniform(ShaderUniform::ShadowMap), SHADOW_TEXTURE_UNIT);
+	glUniformMatrix4fv(_shader.getUniform(ShaderUniform::ShadowMatrices), SHADOW_CASCADE_COUNT, GL_FALSE, glm::value_ptr(mReceiverMatrices[0]));
+	glUniform4fv(_shader.getUniform(ShaderUniform::CascadeSplits), 1, mSplits);
+	glUniform4fv(_shader.getUniform(ShaderUniform::ShadowTexelSizes), 1, mTexelSizes);
+}
+
+GLuint ShadowCascades::getRenderedCount() const
+{
+	GLuint count = 0;
+
+	for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+	{
+		count += (mStaticMask >> cascade) & 1u;
+	}
+
+	return count;
+}
+
+void ShadowCascades::clear()
+{
+	// Check for an existing depth array.
+	if (mDepthTexture != 0)
+	{
+		glDeleteTextures(1, &mDepthTexture);
+		glDeleteFramebuffers(1, &mLayeredFramebuffer);
+		glDeleteFramebuffers(SHADOW_CASCADE_COUNT, mLayerFramebuffers);
+
+		mDepthTexture = 0;
+		mLayeredFramebuffer = 0;
+
+		for (GLuint cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+		{
+			mLayerFramebuffers[cascade] = 0;
+		}
+	}
+
+	mCacheValid = false;
+}
@@ -0,0 +1,140 @@
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+
+#include <CpuFeatures.h>
+#include <Skinning.h>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	typedef void (*SkinKernel)(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count);
+
+	void skinScalar(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			const SkinWeights& skin = _pWeights[index];
+
+			glm::mat4 blend = _pBones[skin.bones.x] * skin.weights.x;
+			blend += _pBones[skin.bones.y] * skin.weights.y;
+			blend += _pBones[skin.bones.z] * skin.weights.z;
+			blend += _pBones[skin.bones.w] * skin.weights.w;
+
+			_pResult[index] = blend * _pPositions[index];
+		}
+	}
+
+#ifdef SIMD_X86
+	// Every kernel blends the four bone matrices of a vertex, then transforms the vertex by the blend.
+
+	SIMD_TARGET_SSE4 void skinSse4(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count)
+	{
+		for (size_t index = 0; index < _count; index++)
+		{
+			const SkinWeights& skin = _pWeights[index];
+			__m128 blend[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+			for (int bone = 0; bone < 4; bone++)
+			{
+				const GLfloat* pBone = &_pBones[skin.bones[bone]][0][0];
+				__m128 weight = _mm_set1_ps(skin.weights[bone]);
+
+				for (int column = 0; column < 4; column++)
+				{
+					blend[column] = _mm_add_ps(blend[column], _mm_mul_ps(_mm_loadu_ps(pBone + column * 4), weight));
+				}
+			}
+
+			__m128 position = _mm_loadu_ps(&_pPositions[index].x);
+			__m128 result = _mm_mul_ps(blend[0], _mm_shuffle_ps(position, position, _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm_add_ps(result, _mm_mul_ps(blend[1], _mm_shuffle_ps(position, position, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(blend[2], _mm_shuffle_ps(position, position, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(blend[3], _mm_shuffle_ps(position, position, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			_mm_storeu_ps(&_pResult[index].x, result);
+		}
+	}
+
+	SIMD_TARGET_AVX2 void skinAvx2(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count)
+	{
+		// Position components broadcast to the lanes of columns 0 and 1, then 2 and 3.
+		const __m256i lowComponents = _mm256_set_epi32(1, 1, 1, 1, 0, 0, 0, 0);
+		const __m256i highComponents = _mm256_set_epi32(3, 3, 3, 3, 2, 2, 2, 2);
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			const SkinWeights& skin = _pWeights[index];
+
+			// Two columns per register.
+			__m256 blend01 = _mm256_setzero_ps();
+			__m256 blend23 = _mm256_setzero_ps();
+
+			for (int bone = 0; bone < 4; bone++)
+			{
+				const GLfloat* pBone = &_pBones[skin.bones[bone]][0][0];
+				__m256 weight = _mm256_set1_ps(skin.weights[bone]);
+
+				blend01 = _mm256_fmadd_ps(_mm256_loadu_ps(pBone), weight, blend01);
+				blend23 = _mm256_fmadd_ps(_mm256_loadu_ps(pBone + 8), weight, blend23);
+			}
+
+			__m256 position = _mm256_castps128_ps256(_mm_loadu_ps(&_pPositions[index].x));
+			__m256 sum = _mm256_mul_ps(blend01, _mm256_permutevar8x32_ps(position, lowComponents));
+			sum = _mm256_fmadd_ps(blend23, _mm256_permutevar8x32_ps(position, highComponents), sum);
+
+			_mm_storeu_ps(&_pResult[index].x, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+		}
+	}
+
+SIMD_AVX512_BEGIN
+
+	SIMD_TARGET_AVX512 void skinAvx512(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count)
+	{
+		// Position components broadcast to the lane of their column.
+		const __m512i components = _mm512_set_epi32(3, 3, 3, 3, 2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0);
+
+		for (size_t index = 0; index < _count; index++)
+		{
+			const SkinWeights& skin = _pWeights[index];
+
+			// A whole matrix per register.
+			__m512 blend = _mm512_mul_ps(_mm512_loadu_ps(&_pBones[skin.bones.x][0][0]), _mm512_set1_ps(skin.weights.x));
+			blend = _mm512_fmadd_ps(_mm512_loadu_ps(&_pBones[skin.bones.y][0][0]), _mm512_set1_ps(skin.weights.y), blend);
+			blend = _mm512_fmadd_ps(_mm512_loadu_ps(&_pBones[skin.bones.z][0][0]), _mm512_set1_ps(skin.weights.z), blend);
+			blend = _mm512_fmadd_ps(_mm512_loadu_ps(&_pBones[skin.bones.w][0][0]), _mm512_set1_ps(skin.weights.w), blend);
+
+			__m512 position = _mm512_castps128_ps512(_mm_loadu_ps(&_pPositions[index].x));
+			__m512 columns = _mm512_mul_ps(blend, _mm512_permutexvar_ps(components, position));
+
+			// Sum the four weighted columns.
+			__m256 half = _mm256_add_ps(_mm512_castps512_ps256(columns), _mm512_extractf32x8_ps(columns, 1));
+			_mm_storeu_ps(&_pResult[index].x, _mm_add_ps(_mm256_castps256_ps128(half), _mm256_extractf128_ps(half, 1)));
+		}
+	}
+
+SIMD_AVX512_END
+#endif
+
+	/// <summary> Kernels of every level. Levels the build cannot target use the scalar one. </summary>
+	const SkinKernel SKIN_KERNELS[(int)SimdLevel::Count] =
+	{
+		skinScalar,
+#ifdef SIMD_X86
+		skinSse4,
+		skinAvx2,
+		skinAvx512,
+#else
+		skinScalar,
+		skinScalar,
+		skinScalar,
+#endif
+	};
+}
+
+void Skinning::skinPositions(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count)
+{
+	SKIN_KERNELS[(int)CpuFeatures::getLevel()](_pPositions, _pWeights, _pBones, _pResult, _count);
+}
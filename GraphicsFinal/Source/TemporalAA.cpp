@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+
+#include <Memory.h>
+#include <PipelineState.h>
+#include <Shader.h>
+#include <RenderGraph.h>
+#include <TemporalAA.h>
+
+// Shader file locations.
+static const char* resolveVertexShaderFile = "resources/vs/fullscreen.vert";
+static const char* resolveFragmentShaderFile = "resources/fs/taa.frag";
+
+namespace
+{
+	/// <summary> Weight of the history in the blend. Higher is smoother but slower to react. </summary>
+	const GLfloat HISTORY_WEIGHT = 0.9f;
+
+	/// <summary> Point of the Halton low discrepancy sequence in a base, in [0, 1). </summary>
+	GLfloat halton(GLuint _index, GLuint _base)
+	{
+		GLfloat result = 0.0f;
+		GLfloat fraction = 1.0f;
+
+		while (_index > 0)
+		{
+			fraction /= (GLfloat)_base;
+			result += fraction * (GLfloat)(_index % _base);
+			_index /= _base;
+		}
+
+		return result;
+	}
+}
+
+TemporalAA::TemporalAA()
+{
+	mpStateTracker = nullptr;
+	mpResolveShader = nullptr;
+	mpResolvePipeline = nullptr;
+	mEnabled = false;
+	mHistory[0] = 0;
+	mHistory[1] = 0;
+	mWidth = 0;
+	mHeight = 0;
+	mCurrent = 0;
+	mHistoryValid = false;
+	mHistoryChanged = false;
+	mFrameIndex = 0;
+	mJitter = glm::vec2(0.0f);
+}
+
+TemporalAA::~TemporalAA()
+{
+	// GL objects are deleted in clear() while the context still exists.
+}
+
+int TemporalAA::initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache)
+{
+	mpStateTracker = _pStateTracker;
+
+	mpResolveShader = new Shader();
+	mpResolveShader->initialize();
+	mpResolveShader->load(GL_VERTEX_SHADER, resolveVertexShaderFile);
+	mpResolveShader->load(GL_FRAGMENT_SHADER, resolveFragmentShaderFile);
+	mpResolveShader->link();
+	mpResolveShader->loadUniforms();
+
+	// The resolve covers every pixel once and ignores depth.
+	PipelineStateDesc resolveDesc;
+	resolveDesc.program = mpResolveShader->getId();
+	resolveDesc.depth.testEnabled = false;
+	resolveDesc.depth.writeEnabled = false;
+
+	mpResolvePipeline = _pPipelineCache->create(resolveDesc);
+
+	return 0;
+}
+
+void TemporalAA::setEnabled(bool _enabled)
+{
+	mEnabled = _enabled;
+	mHistoryValid = false;
+	mJitter = glm::vec2(0.0f);
+}
+
+void TemporalAA::beginFrame(GLint _width, GLint _height)
+{
+	if (!mEnabled)
+	{
+		return;
+	}
+
+	// A new size makes the history unusable.
+	if (_width != mWidth || _height != mHeight || mHistory[0] == 0)
+	{
+		mWidth = _width;
+		mHeight = _height;
+
+		deleteHistory();
+		createHistory();
+	}
+	else
+	{
+		// Last frame wrote the current texture, which is now the history.
+		mCurrent = 1 - mCurrent;
+	}
+
+	// Halton (2, 3) starting at index 1, since index 0 is the origin on both axes.
+	GLuint index = (GLuint)(mFrameIndex % TAA_JITTER_SAMPLES) + 1;
+	mJitter = glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f;
+	mFrameIndex++;
+}
+
+glm::mat4 TemporalAA::jitterProjection(const glm::mat4& _projection) const
+{
+	if (!mEnabled || mWidth == 0)
+	{
+		return _projection;
+	}
+
+	// Shift clip space by the jitter; one pixel is two over the size in normalized device coordinates.
+	glm::vec2 offset = mJitter * 2.0f / glm::vec2((GLfloat)mWidth, (GLfloat)mHeight);
+
+	return glm::translate(glm::mat4(1.0f), glm::vec3(offset, 0.0f)) * _projection;
+}
+
+GLuint TemporalAA::addPass(RenderGraph& _graph, GLuint _color, GLuint _velocity, GLuint _depth, const glm::mat4& _reprojection, bool _reverseZ)
+{
+	// Framebuffers may still name the deleted history textures.
+	if (mHistoryChanged)
+	{
+		_graph.clearFramebuffers();
+		mHistoryChanged = false;
+	}
+
+	TextureDesc historyDesc;
+	historyDesc.width = mWidth;
+	historyDesc.height = mHeight;
+	historyDesc.internalFormat = GL_RGBA16F;
+
+	GLuint history = _graph.importTexture("taa_history", mHistory[1 - mCurrent], historyDesc);
+	GLuint resolved = _graph.importTexture("taa_resolved", mHistory[mCurrent], historyDesc);
+
+	GLfloat historyWeight = mHistoryValid ? HISTORY_WEIGHT : 0.0f;
+
+	GLuint resolvePass = _graph.addPass("taa_resolve", [this, _color, _velocity, _depth, history, historyWeight, _reprojection, _reverseZ](RenderGraph& _frameGraph)
+	{
+		mpStateTracker->bind(mpResolvePipeline);
+
+		_frameGraph.bindTexture(_color, 0);
+		_frameGraph.bindTexture(_velocity, 1);
+		_frameGraph.bindTexture(_depth, 2);
+		_frameGraph.bindTexture(history, 3);
+
+		glUniform1i(mpResolveShader->getUniform(ShaderUniform::Color), 0);
+		glUniform1i(mpResolveShader->getUniform(ShaderUniform::Velocity), 1);
+		glUniform1i(mpResolveShader->getUniform(ShaderUniform::Depth), 2);
+		glUniform1i(mpResolveShader->getUniform(ShaderUniform::History), 3);
+		glUniform1f(mpResolveShader->getUniform(ShaderUniform::HistoryWeight), historyWeight);
+		glUniformMatrix4fv(mpResolveShader->getUniform(ShaderUniform::Reprojection), 1, GL_FALSE, glm::value_ptr(_reprojection));
+		glUniform1i(mpResolveShader->getUniform(ShaderUniform::ReverseZ), _reverseZ ? 1 : 0);
+
+		_frameGraph.drawFullscreenTriangle();
+	});
+	_graph.read(resolvePass, _color);
+	_graph.read(resolvePass, _velocity);
+	_graph.read(resolvePass, _depth);
+	_graph.read(resolvePass, history);
+	_graph.write(resolvePass, resolved);
+
+	// Next frame blends with this one.
+	mHistoryValid = true;
+
+	return resolved;
+}
+
+void TemporalAA::clear()
+{
+	deleteHistory();
+
+	// Check for an existing shader.
+	if (mpResolveShader)
+	{
+		delete mpResolveShader;
+		mpResolveShader = nullptr;
+	}
+
+	mpResolvePipeline = nullptr;
+}
+
+void TemporalAA::createHistory()
+{
+	glGenTextures(2, mHistory);
+
+	for (GLuint counter = 0; counter < 2; counter++)
+	{
+		glBindTexture(GL_TEXTURE_2D, mHistory[counter]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, mWidth, mHeight, 0, GL_RGBA, GL_FLOAT, nullptr);
+
+		// The history is sampled between texels when reprojected.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	mCurrent = 0;
+	mHistoryValid = false;
+	mHistoryChanged = true;
+}
+
+void TemporalAA::deleteHistory()
+{
+	// Check for existing textures.
+	if (mHistory[0] != 0)
+	{
+		glDeleteTextures(2, mHistory);
+
+		mHistory[0] = 0;
+		mHistory[1] = 0;
+		mHistoryChanged = true;
+	}
+}
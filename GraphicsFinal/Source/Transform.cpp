@@ -0,0 +1,32 @@
+#include <GL/glew.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include <Transform.h>
+
+glm::mat4 Transform::toMatrix(const glm::dvec3& _origin) const
+{
+	// Rotation with the scale applied to each basis column.
+	glm::mat4 matrix = glm::mat4_cast(rotation);
+
+	matrix[0] *= scale.x;
+	matrix[1] *= scale.y;
+	matrix[2] *= scale.z;
+
+	// Translation from the origin, small enough for a float once subtracted.
+	matrix[3] = glm::vec4(glm::vec3(position - _origin), 1.0f);
+
+	return matrix;
+}
+
+Transform Transform::interpolate(const Transform& _previous, const Transform& _current, GLfloat _alpha)
+{
+	Transform result;
+
+	result.position = glm::mix(_previous.position, _current.position, (double)_alpha);
+	result.rotation = glm::slerp(_previous.rotation, _current.rotation, _alpha);
+	result.scale = glm::mix(_previous.scale, _current.scale, _alpha);
+
+	return result;
+}
@@ -1,8 +1,19 @@
 // Windows libraries.
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 #include <cmath>
 #include <iostream>
+#include <string>
 #include <vector>
+#include <unordered_map>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <random>
+#include <atomic>
+#include <thread>
 
 // GL libraries.
 #include <GL/glew.h>
@@ -10,12 +21,33 @@
 #include <GLM/glm.hpp>
 #include <GLM/gtc/matrix_transform.hpp>
 #include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/quaternion.hpp>
 
 // Project libraries.
+#include <Memory.h>
+#include <CpuFeatures.h>
+#include <BatchMath.h>
+#include <PipelineState.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
 #include <Mesh.h>
+#include <Primitives.h>
 #include <Shader.h>
+#include <ResourceManager.h>
+#include <Input.h>
 #include <GL_Window.h>
+#include <Culling.h>
 #include <Camera.h>
+#include <FramePacer.h>
+#include <FixedTimestep.h>
+#include <Transform.h>
+#include <ClusteredLighting.h>
+#include <ShadowCascades.h>
+#include <RenderGraph.h>
+#include <PostProcess.h>
+#include <DynamicResolution.h>
+#include <TemporalAA.h>
+#include <Renderer.h>
 
 #define PI 3.14159265
 
@@ -29,21 +61,59 @@ const float toRadians = (float)PI / 180.0f;
 // Field of view (y-direction).
 const float fieldOfView = 45.0f;
 
-// Meshes.
-std::vector<Mesh*> meshes;
+// Most meshes and shaders the demo creates.
+const GLuint MAX_MESHES = 16;
+const GLuint MAX_SHADERS = 16;
 
-// Shaders.
-std::vector<Shader*> shaders;
+// Shared vertex and index buffers of the meshes.
+GeometryPool geometryPool;
+
+// Meshes and shaders, loaded once and referred to by handle.
+ResourceManager resources;
+Handle<Mesh> objectMesh;
+Handle<Mesh> groundMesh;
+Handle<Shader> objectShader;
 
 // Window.
-GL_Window mainWindow;
+GL_Window mainWindow(WIDTH, HEIGHT);
 
 // Camera.
 Camera camera;
 
+// Input state and action bindings, rebuilt from the window's events every frame.
+InputState input;
+
+// Pipeline states.
+PipelineCache pipelineCache;
+
+// GL state tracker.
+StateTracker stateTracker;
+
+// Frame pacing.
+FramePacer framePacer;
+
+// Clustered forward renderer.
+Renderer renderer;
+
 // Time variables.
-GLfloat deltaTime = 0.0f;
-GLfloat lastTime = 0.0f;
+double deltaTime = 0.0;
+double lastTime = 0.0;
+
+// Fixed simulation step.
+FixedTimestep fixedTimestep;
+
+// Object transform at the previous and current simulation step.
+Transform previousTransform;
+Transform currentTransform;
+
+// Transform of the ground under the object.
+Transform groundTransform;
+
+// Frames before heap allocations are counted, while targets and caches are still being created.
+const GLuint ALLOCATION_WARMUP_FRAMES = 10;
+
+// Rotation speed of the object in degrees per second.
+const float spinSpeed = 30.0f;
 
 // Shader file locations.
 static const char* vertexShaderFile = "resources/vs/shader.vert";
@@ -51,68 +121,252 @@ static const char* fragmentShaderFile = "resources/fs/shader.frag";
 
 void CreateObject()
 {
-	unsigned int indices[] = {
-		0, 3, 1,
-		1, 3, 2,
-		2, 3, 0,
-		0, 1, 2
-	};
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
 
-	GLfloat verticies[] = {
-		-1.0f, -1.0f, 0.0f,
-		 0.0f, -1.0f, 1.0f,
-		 1.0f, -1.0f, 0.0f,
-		 0.0f,  1.0f, 0.0f
-	};
+	Primitives::generateTetrahedron(vertices, indices);
+	objectMesh = resources.loadMesh("tetrahedron", vertices, indices);
+
+	// Ground for the object to cast its shadow on.
+	Primitives::generatePlane(vertices, indices);
+	groundMesh = resources.loadMesh("ground", vertices, indices);
+}
+
+void CreateLights(GLuint _count)
+{
+	std::vector<PointLight>& lights = renderer.getLights();
 
-	Mesh* pMesh1 = new Mesh();
+	// Fixed seed so every run looks the same.
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
 
-	pMesh1->create(verticies, indices, 12, 12);
+	for (GLuint counter = 0; counter < _count; counter++)
+	{
+		PointLight light;
+
+		// Scatter the lights around the object.
+		glm::vec3 direction = glm::normalize(glm::vec3(unit(generator), unit(generator), unit(generator)) * 2.0f - 1.0f + 0.001f);
+
+		light.position = glm::vec3(0.0f, 0.0f, -2.5f) + direction * (0.8f + unit(generator) * 2.0f);
+		light.radius = 1.0f + unit(generator) * 1.5f;
+		light.color = glm::vec3(unit(generator), unit(generator), unit(generator));
+		light.intensity = 2.0f;
 
-	meshes.push_back(pMesh1);
+		lights.push_back(light);
+	}
 }
 
 void CreateShaders()
 {
-	// Create a new shader.
-	Shader* pShader = new Shader();
+	// Load, compile and link the vertex and fragment shaders.
+	objectShader = resources.loadShader(vertexShaderFile, fragmentShaderFile);
 
-	// Initialize the shader.
-	pShader->initialize();
+	// Validate the shaders.
+	resources.get(objectShader)->validate();
+}
 
-	// Load the vertex and fragment shaders.
-	pShader->load(GL_VERTEX_SHADER, vertexShaderFile);
-	pShader->load(GL_FRAGMENT_SHADER, fragmentShaderFile);
+int main(int argc, char** argv)
+{
+	// Frame pacing settings.
+	GLuint framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+	SwapMode swapMode = SwapMode::VSync;
 
-	// Link the shaders.
-	pShader->link();
+	// Number of point lights. Zero draws with the unlit shader.
+	GLuint lightCount = 64;
 
-	// Validate the shaders.
-	pShader->validate();
+	// Shade the lights with a G-buffer instead of while drawing.
+	bool deferred = false;
 
-	// Load the uniforms.
-	pShader->loadUniforms();
+	// Draw depth first so hidden fragments are never shaded.
+	bool depthPrepass = false;
 
-	// Add the shader to the list.
-	shaders.push_back(pShader);
-}
+	// Blur the brightest pixels over their neighbours.
+	bool bloom = true;
 
-int main()
-{
-	// Create a window.
-	mainWindow = GL_Window(WIDTH, HEIGHT);
+	// Accumulate jittered frames to smooth edges.
+	bool temporalAA = false;
+
+	// GPU time per frame to hold by scaling the resolution. Zero renders at full resolution.
+	double targetGpuTime = 0.0;
+
+	// Filter scaling a reduced resolution up to the window.
+	UpscaleFilter upscaleFilter = UpscaleFilter::EdgeAdaptive;
+
+	// Read unaccelerated mouse motion with the cursor captured.
+	bool rawMouse = false;
+
+	// Sample input on the main thread at a high rate while another thread renders.
+	bool inputThread = false;
+
+	// Infinite reverse-Z projection with a float depth buffer.
+	bool reverseZ = false;
+
+	// Distance of the scene from the world origin, to check the camera-relative precision.
+	double worldOffset = 0.0;
+
+	// Read the settings from the command line.
+	for (int counter = 1; counter < argc; counter++)
+	{
+		if (strcmp(argv[counter], "--deferred") == 0)
+		{
+			deferred = true;
+		}
+		else if (strcmp(argv[counter], "--depth-prepass") == 0)
+		{
+			depthPrepass = true;
+		}
+		else if (strcmp(argv[counter], "--no-bloom") == 0)
+		{
+			bloom = false;
+		}
+		else if (strcmp(argv[counter], "--taa") == 0)
+		{
+			temporalAA = true;
+		}
+		else if (strcmp(argv[counter], "--raw-mouse") == 0)
+		{
+			rawMouse = true;
+		}
+		else if (strcmp(argv[counter], "--input-thread") == 0)
+		{
+			inputThread = true;
+		}
+		else if (strcmp(argv[counter], "--reverse-z") == 0)
+		{
+			reverseZ = true;
+		}
+		else if (counter + 1 == argc)
+		{
+			// The remaining options need a value.
+			break;
+		}
+		else if (strcmp(argv[counter], "--frames-in-flight") == 0)
+		{
+			framesInFlight = (GLuint)atoi(argv[++counter]);
+		}
+		else if (strcmp(argv[counter], "--lights") == 0)
+		{
+			lightCount = (GLuint)atoi(argv[++counter]);
+		}
+		else if (strcmp(argv[counter], "--world-offset") == 0)
+		{
+			worldOffset = atof(argv[++counter]);
+		}
+		else if (strcmp(argv[counter], "--target-gpu-ms") == 0)
+		{
+			targetGpuTime = atof(argv[++counter]);
+		}
+		else if (strcmp(argv[counter], "--upscale") == 0)
+		{
+			upscaleFilter = strcmp(argv[++counter], "bilinear") == 0 ? UpscaleFilter::Bilinear : UpscaleFilter::EdgeAdaptive;
+		}
+		else if (strcmp(argv[counter], "--swap-mode") == 0)
+		{
+			const char* pMode = argv[++counter];
+
+			if (strcmp(pMode, "adaptive") == 0)
+			{
+				swapMode = SwapMode::Adaptive;
+			}
+			else if (strcmp(pMode, "uncapped") == 0)
+			{
+				swapMode = SwapMode::Uncapped;
+			}
+			else
+			{
+				swapMode = SwapMode::VSync;
+			}
+		}
+		else if (strcmp(argv[counter], "--simd") == 0)
+		{
+			// Run slower kernels than the CPU supports, to compare them or rule one out.
+			SimdLevel level;
+
+			if (CpuFeatures::parseLevel(argv[++counter], level))
+			{
+				CpuFeatures::setLevel(level);
+			}
+			else
+			{
+				printf("Unknown SIMD level %s!\n", argv[counter]);
+			}
+		}
+	}
 
 	// Initialize the window.
 	mainWindow.initialize();
 
+	if (rawMouse)
+	{
+		mainWindow.setRawMouseMotion(true);
+	}
+
+	// Limit how far the CPU runs ahead of the GPU.
+	framePacer.initialize(framesInFlight, swapMode);
+
+	// Every mesh shares the pool's buffers. Resource slots are allocated once.
+	geometryPool.initialize(VertexLayout::position());
+	resources.initialize(MAX_MESHES, MAX_SHADERS, DEFAULT_RESOURCE_BUDGET, &geometryPool);
+
 	// Create an object.
 	CreateObject();
 
 	// Create the shaders.
 	CreateShaders();
 
+	// Start tracking from a known GL state.
+	stateTracker.reset();
+
+	// Create the lit renderer and its lights. Reverse-Z stays off without clip control.
+	renderer.initialize(&stateTracker, &pipelineCache);
+	renderer.setReverseZ(reverseZ);
+	reverseZ = renderer.getReverseZ();
+
+	// Opaque pipeline for the shader.
+	PipelineStateDesc opaqueDesc;
+	opaqueDesc.program = resources.get(objectShader)->getId();
+	opaqueDesc.vertexLayout = VertexLayout::position();
+
+	if (reverseZ)
+	{
+		opaqueDesc.depth.function = GL_GREATER;
+		opaqueDesc.depth.clipRange = GL_ZERO_TO_ONE;
+	}
+
+	const PipelineState* pOpaquePipeline = pipelineCache.create(opaqueDesc);
+	renderer.setPath(deferred ? RenderPath::Deferred : RenderPath::Forward);
+	renderer.setDepthPrepass(depthPrepass);
+	renderer.setBloom(bloom);
+	renderer.setTemporalAA(temporalAA);
+	renderer.getPostProcess().setUpscaleFilter(upscaleFilter);
+
+	if (targetGpuTime > 0.0)
+	{
+		renderer.getResolution().setTargetTime(targetGpuTime);
+		renderer.getResolution().setEnabled(true);
+	}
+
+	// The whole scene sits at the offset. Lights are placed relative to the renderer's origin.
+	glm::dvec3 sceneOrigin(worldOffset, 0.0, worldOffset);
+	renderer.setOrigin(sceneOrigin);
+
+	CreateLights(lightCount);
+
+	// Low sun casting shadows.
+	renderer.getSun().direction = glm::vec3(-0.5f, -1.0f, -0.4f);
+	renderer.getSun().color = glm::vec3(1.0f, 0.95f, 0.85f);
+	renderer.getSun().intensity = 1.0f;
+
+	// Items drawn by the renderer. The ground never moves.
+	std::vector<DrawItem> drawItems(2);
+	drawItems[0].pMesh = resources.get(objectMesh);
+	drawItems[1].pMesh = resources.get(groundMesh);
+	drawItems[1].roughness = 0.9f;
+	drawItems[1].staticGeometry = true;
+
 	// Create a camera.
 	camera = Camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 5.0f, 0.1f);
+	camera.setWorldPosition(sceneOrigin);
 
 	// Get the aspect ratio of the screen.
 	GLfloat aspectRatio = (GLfloat)mainWindow.getBufferWidth() / (GLfloat)mainWindow.getBufferHeight();
@@ -123,61 +377,200 @@ int main()
 	GLuint uniformView = 0;
 
 	// Create projection matrix.
-	glm::mat4 projection = glm::perspective(glm::radians(fieldOfView), aspectRatio, 0.1f, 100.0f);
+	camera.setReverseZ(reverseZ);
+	camera.setProjection(glm::radians(fieldOfView), aspectRatio, 0.1f, 100.0f);
+	glm::mat4 projection = camera.getProjection();
+
+	// Place the object in front of the camera, above the ground.
+	currentTransform.position = sceneOrigin + glm::dvec3(0.0, 0.0, -2.5);
+	currentTransform.scale = glm::vec3(0.4f, 0.4f, 1.0f);
+	previousTransform = currentTransform;
 
-	// Loop until window is closed.
-	while (!mainWindow.shouldClose())
+	groundTransform.position = sceneOrigin + glm::dvec3(0.0, -0.6, -2.5);
+	groundTransform.scale = glm::vec3(10.0f);
+
+	// Start timing from now rather than from GLFW initialization.
+	lastTime = glfwGetTime();
+
+	// Heap allocations of the frames after the warm up.
+	GLuint frameCount = 0;
+	AllocationStats allocationsStart;
+
+	// Frame loop, run on this thread or on a render thread while this one samples input.
+	auto renderLoop = [&]()
 	{
-		// Get the current time.
-		GLfloat now = (GLfloat)glfwGetTime();
+		// Loop until window is closed.
+		while (!mainWindow.shouldClose())
+		{
+			// Get the current time.
+			double now = glfwGetTime();
 
-		// Calculate delta time.
-		deltaTime = now - lastTime;
+			// Calculate delta time.
+			deltaTime = now - lastTime;
 
-		// Set the last time for the next frame.
-		lastTime = now;
+			// Set the last time for the next frame.
+			lastTime = now;
+
+			// Wait for the GPU to release the oldest frame in flight.
+			framePacer.beginFrame();
 
-		// Get and handle user input event.
-		glfwPollEvents();
+			// Resources used from here on count as used this frame.
+			resources.beginFrame();
 
-		// Check for key presses.
-		camera.keyControl(mainWindow.getKeys(), deltaTime);
-		camera.mouseControl(mainWindow.getMouseDeltaX(), mainWindow.getMouseDeltaY());
+			// Get and handle user input event, unless the input thread already does.
+			if (!inputThread)
+			{
+				glfwPollEvents();
+			}
+
+			// Apply the queued events in order.
+			input.update(mainWindow.getInputQueue());
+
+			// Run the simulation in fixed steps.
+			fixedTimestep.advance(deltaTime);
+
+			bool stepped = false;
+
+			while (fixedTimestep.step())
+			{
+				stepped = true;
+
+				GLfloat step = (GLfloat)fixedTimestep.getStep();
+
+				// Keep the state the step starts from for interpolation.
+				camera.storePrevious();
+				previousTransform = currentTransform;
+
+				// Check for key presses.
+				camera.keyControl(input, step);
+
+				// Ease toward where the input moved the camera.
+				camera.advance(step);
+
+				// Spin the object around the y axis.
+				currentTransform.rotation = glm::angleAxis(spinSpeed * toRadians * step, glm::vec3(0.0f, 1.0f, 0.0f)) * currentTransform.rotation;
+			}
+
+			// Taps are used up once a step has seen them. Those latched by the late poll below wait for the next frame's steps.
+			if (stepped)
+			{
+				input.consumePresses();
+			}
+
+			// Fraction of a step left over for interpolation.
+			GLfloat alpha = fixedTimestep.getAlpha();
+
+			// Latch the newest input right before the view is built. Events arriving during the simulation are included.
+			input.poll(mainWindow.getInputQueue());
+
+			// Input for this frame has been sampled.
+			framePacer.markInputPoll();
+
+			// Mouse look is applied every frame for responsiveness.
+			camera.mouseControl(input.getMouseDeltaX(), input.getMouseDeltaY());
+
+			// Keep the camera near the origin. Every matrix below is relative to it, so floats stay precise.
+			camera.rebase();
+			renderer.setOrigin(camera.getOrigin());
+
+			// Model matrix between the last two simulation steps.
+			glm::mat4 model = Transform::interpolate(previousTransform, currentTransform, alpha).toMatrix(camera.getOrigin());
+			glm::mat4 view = camera.calculateViewMatrix(alpha);
+
+			if (lightCount > 0)
+			{
+				// Draw lit with clustered shading.
+				RenderView renderView;
+				renderView.view = view;
+				renderView.projection = projection;
+				renderView.fieldOfView = glm::radians(fieldOfView);
+				renderView.nearPlane = 0.1f;
+				renderView.farPlane = 100.0f;
+				renderView.width = mainWindow.getBufferWidth();
+				renderView.height = mainWindow.getBufferHeight();
+
+				drawItems[0].model = model;
+				drawItems[1].model = groundTransform.toMatrix(camera.getOrigin());
+
+				renderer.render(renderView, drawItems);
+			}
+			else
+			{
+				// Clear the window to black.
+				stateTracker.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, 0.0f, 0.0f, 0.0f, 1.0f, reverseZ ? 0.0f : 1.0f);
+
+				// Bind the pipeline state, which uses the shader program.
+				stateTracker.bind(pOpaquePipeline);
+
+				// Get the uniforms.
+				Shader* pShader = resources.get(objectShader);
+				uniformModel = pShader->getModelLocation();
+				uniformProjection = pShader->getProjectionLocation();
+				uniformView = pShader->getViewLocation();
 
-		// Clear the window to black.
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+				// Apply the value to the uniform variable at their location.
+				glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
+				glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
+				glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(view));
+
+				// Render the meshes.
+				resources.get(objectMesh)->render();
+			}
+
+			// Fence the frame and swap to back buffer.
+			framePacer.present(mainWindow);
+
+			if (++frameCount == ALLOCATION_WARMUP_FRAMES)
+			{
+				allocationsStart = AllocationCounter::snapshot();
+			}
+		}
+	};
 
-		// Clear the color buffer data.
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if (inputThread)
+	{
+		// GLFW only handles events on the main thread, so rendering moves to another thread instead.
+		mainWindow.makeContextCurrent(false);
+
+		std::thread renderThread([&]()
+		{
+			mainWindow.makeContextCurrent(true);
+			renderLoop();
 
-		// Use the shader program.
-		shaders[0]->use();
+			// Hand the context back for cleanup and stop the event loop if rendering ended on its own.
+			mainWindow.makeContextCurrent(false);
+			mainWindow.close();
+		});
 
-		// Get the uniforms.
-		uniformModel = shaders[0]->getModelLocation();
-		uniformProjection = shaders[0]->getProjectionLocation();
-		uniformView = shaders[0]->getViewLocation();
+		mainWindow.runEventLoop(DEFAULT_INPUT_RATE);
+		renderThread.join();
 
-		// Identity model matrix.
-		glm::mat4 model(1.0f);
+		mainWindow.makeContextCurrent(true);
+	}
+	else
+	{
+		renderLoop();
+	}
 
-		// Apply matrix operations.
-		model = glm::translate(model, glm::vec3(0.0f, 0.0f, -2.5f));
-		model = glm::rotate(model, 0.0f * toRadians, glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(0.4f, 0.4f, 1.0f));
-			
-		// Apply the value to the uniform variable at their location.
-		glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
-		glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
-		glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(camera.calculateViewMatrix()));
+	// Report the measured latency.
+	printf("Input to present: %.2f ms, input to GPU complete: %.2f ms, fence wait: %.2f ms\n",
+		framePacer.getPresentLatency(), framePacer.getGpuLatency(), framePacer.getFenceWait());
 
-		// Render the meshes.
-		meshes[0]->render();
+	if (frameCount > ALLOCATION_WARMUP_FRAMES)
+	{
+		AllocationStats allocationsEnd = AllocationCounter::snapshot();
+		GLuint countedFrames = frameCount - ALLOCATION_WARMUP_FRAMES;
 
-		// Swap to back buffer.
-		mainWindow.swapBuffers();
+		printf("Heap allocations per frame: %.2f, frame arena peak: %zu bytes\n",
+			(double)(allocationsEnd.heapAllocations - allocationsStart.heapAllocations) / countedFrames, renderer.getFrameArena().getPeak());
 	}
 
+	// Delete outstanding fences, lighting, meshes and geometry buffers while the context exists.
+	framePacer.clear();
+	renderer.clear();
+	resources.clear();
+	geometryPool.clear();
+
 	// Return error code.
 	return 0;
-}
\ No newline at end of file
+}
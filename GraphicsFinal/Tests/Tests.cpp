@@ -0,0 +1,894 @@
+// Unit tests of the framework. Every group checks one module and the run
+// fails when any check does, so CTest can register the groups one by one.
+//
+// Usage: Tests [group]
+
+// Windows libraries.
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <new>
+#include <utility>
+#include <atomic>
+#include <thread>
+
+// GL libraries.
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/constants.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+
+// Project headers.
+#include <Memory.h>
+#include <PipelineState.h>
+#include <GpuAllocator.h>
+#include <GeometryPool.h>
+#include <Mesh.h>
+#include <MeshProcessing.h>
+#include <Shader.h>
+#include <Input.h>
+#include <GL_Window.h>
+
+// Exit code telling CTest a group was skipped.
+const int SKIP_CODE = 77;
+
+// Checks run and failed.
+GLuint checkCount = 0;
+GLuint failureCount = 0;
+
+// Hidden window holding the context of the GL groups, created by the first of them.
+GL_Window* pWindow = nullptr;
+bool contextFailed = false;
+
+/// <summary> Count a check and report it when it fails. </summary>
+void Check(bool _passed, const char* _pCondition, const char* _pFile, int _line)
+{
+	checkCount++;
+
+	if (!_passed)
+	{
+		failureCount++;
+		fprintf(stderr, "%s(%d): check failed: %s\n", _pFile, _line, _pCondition);
+	}
+}
+
+#define CHECK(condition) Check((condition), #condition, __FILE__, __LINE__)
+
+/// <summary> Are the allocator's live ranges disjoint and inside its capacity? </summary>
+bool RangesAreDisjoint(const GpuAllocator& _allocator, const std::vector<GLuint>& _allocations)
+{
+	for (size_t first = 0; first < _allocations.size(); first++)
+	{
+		GLuint firstOffset = _allocator.getOffset(_allocations[first]);
+		GLuint firstEnd = firstOffset + _allocator.getSize(_allocations[first]);
+
+		if (firstEnd > _allocator.getCapacity())
+		{
+			return false;
+		}
+
+		for (size_t second = first + 1; second < _allocations.size(); second++)
+		{
+			GLuint secondOffset = _allocator.getOffset(_allocations[second]);
+			GLuint secondEnd = secondOffset + _allocator.getSize(_allocations[second]);
+
+			if (firstOffset < secondEnd && secondOffset < firstEnd)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void TestGpuAllocator()
+{
+	GpuAllocator allocator;
+	allocator.initialize(1000);
+
+	// Allocations are carved off the front in order.
+	std::vector<GLuint> allocations;
+
+	for (GLuint counter = 0; counter < 6; counter++)
+	{
+		allocations.push_back(allocator.allocate(100));
+		CHECK(allocations.back() != INVALID_ALLOCATION);
+	}
+
+	CHECK(RangesAreDisjoint(allocator, allocations));
+	CHECK(allocator.getStats().used == 600);
+	CHECK(allocator.getStats().allocationCount == 6);
+	CHECK(allocator.getStats().freeBlockCount == 1);
+
+	// Too large for the free space.
+	CHECK(allocator.allocate(401) == INVALID_ALLOCATION);
+
+	// Freeing two neighbours merges them into one block, apart from the tail.
+	allocator.free(allocations[1]);
+	allocator.free(allocations[2]);
+
+	GpuAllocatorStats stats = allocator.getStats();
+	CHECK(stats.used == 400);
+	CHECK(stats.freeBlockCount == 2);
+	CHECK(stats.largestFreeBlock == 400);
+	CHECK(stats.fragmentation > 0.0);
+
+	// The merged hole takes an allocation of its whole size.
+	GLuint hole = allocator.allocate(200);
+	CHECK(hole != INVALID_ALLOCATION && allocator.getOffset(hole) == 100);
+	allocator.free(hole);
+
+	// Freeing twice is ignored.
+	allocator.free(allocations[1]);
+	CHECK(allocator.getStats().used == 400);
+
+	// Freeing everything merges back into a single block.
+	allocator.free(allocations[0]);
+	allocator.free(allocations[3]);
+	allocator.free(allocations[4]);
+	allocator.free(allocations[5]);
+
+	stats = allocator.getStats();
+	CHECK(stats.used == 0);
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == 1000);
+
+	// Sizes round up to their class, so the single block serves the largest class it holds.
+	CHECK(allocator.allocate(960) != INVALID_ALLOCATION);
+
+	// Sizes of every class fit up to the capacity.
+	allocator.initialize(1 << 20);
+	allocations.clear();
+
+	for (GLuint size = 1; size < 4096; size = size * 3 + 1)
+	{
+		allocations.push_back(allocator.allocate(size));
+		CHECK(allocations.back() != INVALID_ALLOCATION && allocator.getSize(allocations.back()) == size);
+	}
+
+	CHECK(RangesAreDisjoint(allocator, allocations));
+
+	// Growing extends the free tail.
+	allocator.initialize(100);
+	GLuint whole = allocator.allocate(100);
+	CHECK(allocator.allocate(1) == INVALID_ALLOCATION);
+	allocator.grow(200);
+	CHECK(allocator.allocate(100) != INVALID_ALLOCATION);
+	CHECK(allocator.getOffset(whole) == 0);
+
+	// Defragmenting packs every allocation to the front, keeps the handles and reports where the data went.
+	allocator.initialize(1000);
+	allocations.clear();
+
+	for (GLuint counter = 0; counter < 6; counter++)
+	{
+		allocations.push_back(allocator.allocate(50 + counter * 10));
+	}
+
+	std::vector<GLuint> sizes;
+	std::vector<GLuint> offsets;
+
+	for (GLuint allocation : allocations)
+	{
+		sizes.push_back(allocator.getSize(allocation));
+		offsets.push_back(allocator.getOffset(allocation));
+	}
+
+	allocator.free(allocations[1]);
+	allocator.free(allocations[3]);
+
+	std::vector<GpuMove> moves;
+	allocator.defragment(moves);
+
+	stats = allocator.getStats();
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == 1000 - stats.used);
+	CHECK(stats.fragmentation == 0.0);
+
+	GLuint cursor = 0;
+
+	for (GLuint counter : { 0u, 2u, 4u, 5u })
+	{
+		CHECK(allocator.getOffset(allocations[counter]) == cursor);
+		CHECK(allocator.getSize(allocations[counter]) == sizes[counter]);
+
+		// Every live allocation is in exactly one move from its old offset, whether it moved or not.
+		GLuint covered = 0;
+
+		for (const GpuMove& move : moves)
+		{
+			if (move.destination <= cursor && cursor + sizes[counter] <= move.destination + move.size && move.source + (cursor - move.destination) == offsets[counter])
+			{
+				covered++;
+			}
+		}
+
+		CHECK(covered == 1);
+		cursor += sizes[counter];
+	}
+
+	// Neighbours that stay neighbours are one move: the first allocation stays, the next two slide down together.
+	CHECK(moves.size() == 3);
+	CHECK(moves.size() == 3 && moves[0].source == 0 && moves[0].destination == 0 && moves[0].size == sizes[0]);
+
+	// Freed space is allocated again after the live ranges.
+	GLuint tail = allocator.allocate(100);
+	CHECK(tail != INVALID_ALLOCATION && allocator.getOffset(tail) == cursor);
+
+	// A packed allocator still reports its ranges, in place.
+	allocator.defragment(moves);
+	CHECK(moves.size() == 1 && moves[0].source == 0 && moves[0].destination == 0 && moves[0].size == cursor + 100);
+}
+
+/// <summary> Create the hidden window of the GL groups. Returns false when there is no GL context to test with. </summary>
+bool CreateContext()
+{
+	if (!pWindow && !contextFailed)
+	{
+		pWindow = new GL_Window(64, 64, false);
+
+		if (pWindow->initialize() != 0)
+		{
+			delete pWindow;
+			pWindow = nullptr;
+			contextFailed = true;
+		}
+	}
+
+	return pWindow != nullptr;
+}
+
+/// <summary> Read back part of the buffer bound to a target. </summary>
+template<typename T>
+std::vector<T> ReadBuffer(GLenum _target, GLint _buffer, GLuint _first, GLuint _count)
+{
+	std::vector<T> data(_count);
+
+	glBindBuffer(_target, (GLuint)_buffer);
+	glGetBufferSubData(_target, (GLintptr)_first * sizeof(T), (GLsizeiptr)_count * sizeof(T), data.data());
+	glBindBuffer(_target, 0);
+
+	return data;
+}
+
+/// <summary> Does every live mesh of the pool read back as it was uploaded? </summary>
+bool PoolHoldsMeshes(GeometryPool& _pool, const std::vector<GeometryAllocation>& _allocations, const std::vector<std::vector<GLfloat>>& _vertices, const std::vector<std::vector<GLuint>>& _indices)
+{
+	// The pool's buffers are the ones its vertex array reads.
+	GLint vertexBuffer = 0;
+	GLint indexBuffer = 0;
+
+	_pool.bind();
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vertexBuffer);
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &indexBuffer);
+	glBindVertexArray(0);
+
+	bool matches = true;
+
+	for (size_t counter = 0; counter < _allocations.size(); counter++)
+	{
+		if (_allocations[counter].vertices == INVALID_ALLOCATION)
+		{
+			continue;
+		}
+
+		GLuint floatsPerVertex = _pool.getLayout().stride / sizeof(GLfloat);
+		std::vector<GLfloat> vertices = ReadBuffer<GLfloat>(GL_COPY_READ_BUFFER, vertexBuffer, _pool.getBaseVertex(_allocations[counter]) * floatsPerVertex, (GLuint)_vertices[counter].size());
+		std::vector<GLuint> indices = ReadBuffer<GLuint>(GL_COPY_READ_BUFFER, indexBuffer, _pool.getFirstIndex(_allocations[counter]), (GLuint)_indices[counter].size());
+
+		matches = matches && vertices == _vertices[counter] && indices == _indices[counter];
+	}
+
+	return matches;
+}
+
+void TestGeometryPool()
+{
+	GeometryPool pool;
+	pool.initialize(VertexLayout::position(), 64, 64);
+
+	// Meshes of different sizes whose values say which mesh and element they are.
+	std::vector<GeometryAllocation> allocations(6);
+	std::vector<std::vector<GLfloat>> vertices(6);
+	std::vector<std::vector<GLuint>> indices(6);
+
+	for (GLuint mesh = 0; mesh < 6; mesh++)
+	{
+		for (GLuint counter = 0; counter < (mesh + 2) * 3; counter++)
+		{
+			vertices[mesh].push_back(mesh * 1000.0f + counter);
+		}
+
+		for (GLuint counter = 0; counter < (mesh + 1) * 3; counter++)
+		{
+			indices[mesh].push_back(mesh * 1000 + counter);
+		}
+
+		CHECK(pool.allocate(vertices[mesh].data(), indices[mesh].data(), (GLuint)vertices[mesh].size(), (GLuint)indices[mesh].size(), allocations[mesh]));
+	}
+
+	CHECK(PoolHoldsMeshes(pool, allocations, vertices, indices));
+
+	// Free two meshes and pack the rest: the first mesh stays at offset zero and the others slide down.
+	pool.free(allocations[1]);
+	pool.free(allocations[3]);
+	pool.defragment();
+
+	CHECK(pool.getBaseVertex(allocations[0]) == 0 && pool.getFirstIndex(allocations[0]) == 0);
+	CHECK(pool.getVertexStats().freeBlockCount == 1 && pool.getIndexStats().freeBlockCount == 1);
+	CHECK(PoolHoldsMeshes(pool, allocations, vertices, indices));
+
+	// Packing a packed pool copies nothing and keeps the data.
+	GLuint copies = pool.getCopyCount();
+	pool.defragment();
+	CHECK(pool.getCopyCount() == copies);
+	CHECK(PoolHoldsMeshes(pool, allocations, vertices, indices));
+
+	// Growing past the capacity keeps every range.
+	std::vector<GLfloat> large(3 * 200, 7.0f);
+	std::vector<GLuint> largeIndices(300, 7);
+
+	allocations.push_back(GeometryAllocation());
+	vertices.push_back(large);
+	indices.push_back(largeIndices);
+
+	CHECK(pool.allocate(large.data(), largeIndices.data(), (GLuint)large.size(), (GLuint)largeIndices.size(), allocations.back()));
+	CHECK(pool.getCopyCount() > copies);
+	CHECK(PoolHoldsMeshes(pool, allocations, vertices, indices));
+
+	CHECK(glGetError() == GL_NO_ERROR);
+
+	pool.clear();
+}
+
+/// <summary> Object counting its constructions and destructions. </summary>
+struct Counted
+{
+	static int live;
+
+	int value;
+
+	Counted(int _value) : value(_value) { live++; }
+	~Counted() { live--; }
+};
+
+int Counted::live = 0;
+
+void TestObjectPool()
+{
+	ObjectPool<Counted> pool;
+	pool.initialize(2);
+
+	Handle<Counted> first = pool.create(1);
+	Handle<Counted> second = pool.create(2);
+
+	CHECK(first.isValid() && second.isValid());
+	CHECK(pool.get(first) && pool.get(first)->value == 1);
+	CHECK(pool.get(second) && pool.get(second)->value == 2);
+	CHECK(pool.getCount() == 2 && Counted::live == 2);
+
+	// A full pool hands out invalid handles.
+	Handle<Counted> overflow = pool.create(3);
+	CHECK(!overflow.isValid());
+	CHECK(pool.get(overflow) == nullptr);
+
+	// Destroying runs the destructor and makes the handle stale.
+	pool.destroy(first);
+	CHECK(pool.get(first) == nullptr);
+	CHECK(pool.getCount() == 1 && Counted::live == 1);
+
+	// The slot is reused with a new generation, so the stale handle still resolves to nothing.
+	Handle<Counted> reused = pool.create(4);
+	CHECK(reused.index == first.index);
+	CHECK(reused.generation != first.generation);
+	CHECK(pool.get(first) == nullptr);
+	CHECK(pool.get(reused) && pool.get(reused)->value == 4);
+
+	// Destroying through a stale handle leaves the new object alone.
+	pool.destroy(first);
+	CHECK(pool.get(reused) != nullptr && pool.getCount() == 2);
+
+	// Handles beyond the pool resolve to nothing.
+	Handle<Counted> outside;
+	outside.index = 7;
+	CHECK(pool.get(outside) == nullptr);
+
+	// Clearing destroys everything and keeps the memory.
+	pool.clear();
+	CHECK(pool.getCount() == 0 && Counted::live == 0);
+	CHECK(pool.get(second) == nullptr && pool.get(reused) == nullptr);
+	CHECK(pool.getCapacity() == 2);
+}
+
+/// <summary> Fill a small grid mesh with every stream and its meshlets. </summary>
+void CreateGridMesh(GLuint _size, MeshData& _mesh)
+{
+	_mesh = MeshData();
+
+	for (GLuint row = 0; row <= _size; row++)
+	{
+		for (GLuint column = 0; column <= _size; column++)
+		{
+			glm::vec2 uv((GLfloat)column / _size, (GLfloat)row / _size);
+
+			_mesh.positions.push_back(glm::vec3(uv.x * 4.0f - 2.0f, sinf(uv.x * 3.0f) * cosf(uv.y * 2.0f), uv.y * 4.0f - 2.0f));
+			_mesh.uvs.push_back(uv);
+		}
+	}
+
+	for (GLuint row = 0; row < _size; row++)
+	{
+		for (GLuint column = 0; column < _size; column++)
+		{
+			GLuint corner = row * (_size + 1) + column;
+
+			_mesh.indices.insert(_mesh.indices.end(), { corner, corner + _size + 1, corner + 1 });
+			_mesh.indices.insert(_mesh.indices.end(), { corner + 1, corner + _size + 1, corner + _size + 2 });
+		}
+	}
+
+	MeshProcessing::generateNormals(_mesh);
+	MeshProcessing::generateTangents(_mesh);
+	MeshProcessing::buildMeshlets(_mesh);
+}
+
+void TestMeshFormat()
+{
+	MeshData mesh;
+	CreateGridMesh(24, mesh);
+
+	CHECK(!mesh.normals.empty() && !mesh.tangents.empty() && !mesh.meshlets.empty());
+
+	std::vector<unsigned char> bytes;
+	MeshProcessing::writeMesh(mesh, bytes);
+
+	// Every stream reads back bit for bit.
+	MeshData read;
+	CHECK(MeshProcessing::readMesh(bytes.data(), bytes.size(), read));
+	CHECK(read.positions.size() == mesh.positions.size() && memcmp(read.positions.data(), mesh.positions.data(), sizeof(glm::vec3) * mesh.positions.size()) == 0);
+	CHECK(read.normals.size() == mesh.normals.size() && memcmp(read.normals.data(), mesh.normals.data(), sizeof(glm::vec3) * mesh.normals.size()) == 0);
+	CHECK(read.uvs.size() == mesh.uvs.size() && memcmp(read.uvs.data(), mesh.uvs.data(), sizeof(glm::vec2) * mesh.uvs.size()) == 0);
+	CHECK(read.tangents.size() == mesh.tangents.size() && memcmp(read.tangents.data(), mesh.tangents.data(), sizeof(glm::vec4) * mesh.tangents.size()) == 0);
+	CHECK(read.indices == mesh.indices);
+	CHECK(read.meshlets.size() == mesh.meshlets.size() && memcmp(read.meshlets.data(), mesh.meshlets.data(), sizeof(Meshlet) * mesh.meshlets.size()) == 0);
+
+	// Streams the mesh lacks stay empty.
+	MeshData positionsOnly;
+	positionsOnly.positions = mesh.positions;
+	positionsOnly.indices = mesh.indices;
+	MeshProcessing::writeMesh(positionsOnly, bytes);
+
+	CHECK(MeshProcessing::readMesh(bytes.data(), bytes.size(), read));
+	CHECK(read.positions.size() == mesh.positions.size() && read.indices == mesh.indices);
+	CHECK(read.normals.empty() && read.uvs.empty() && read.tangents.empty() && read.meshlets.empty());
+
+	// Truncated data and other formats or versions are rejected.
+	MeshProcessing::writeMesh(mesh, bytes);
+
+	CHECK(!MeshProcessing::readMesh(bytes.data(), bytes.size() - 1, read));
+	CHECK(!MeshProcessing::readMesh(bytes.data(), 8, read));
+
+	std::vector<unsigned char> other = bytes;
+	other[0] ^= 0xFF;
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+
+	other = bytes;
+	other[4] ^= 0xFF;
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+
+	// Trailing bytes are rejected.
+	other = bytes;
+	other.push_back(0);
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+
+	// So are indices past the vertices and meshlets past the indices, which draws would read out of bounds.
+	MeshData corrupt = mesh;
+	corrupt.indices[5] = (GLuint)mesh.positions.size();
+	MeshProcessing::writeMesh(corrupt, other);
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+	CHECK(read.positions.empty());
+
+	corrupt = mesh;
+	corrupt.meshlets.back().triangleCount++;
+	MeshProcessing::writeMesh(corrupt, other);
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+
+	corrupt = mesh;
+	corrupt.meshlets[0].firstIndex = ~0u - 3;
+	MeshProcessing::writeMesh(corrupt, other);
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+
+	corrupt = mesh;
+	corrupt.indices.pop_back();
+	corrupt.meshlets.clear();
+	MeshProcessing::writeMesh(corrupt, other);
+	CHECK(!MeshProcessing::readMesh(other.data(), other.size(), read));
+}
+
+void TestOctahedral()
+{
+	// The axes map to the corners and centre of the square and back exactly.
+	const glm::vec3 axes[] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+
+	for (const glm::vec3& axis : axes)
+	{
+		glm::vec2 encoded = MeshProcessing::encodeOctahedral(axis);
+
+		CHECK(glm::all(glm::lessThanEqual(glm::abs(encoded), glm::vec2(1.0f))));
+		CHECK(glm::length(MeshProcessing::decodeOctahedral(encoded) - axis) < 1e-6f);
+	}
+
+	// Directions over the whole sphere round trip, and stay within a degree at 8 bits per component.
+	GLfloat largestError = 0.0f;
+	GLfloat largestError8 = 0.0f;
+	GLfloat largestError16 = 0.0f;
+
+	for (GLuint latitude = 0; latitude <= 64; latitude++)
+	{
+		for (GLuint longitude = 0; longitude < 128; longitude++)
+		{
+			GLfloat theta = glm::pi<GLfloat>() * latitude / 64.0f;
+			GLfloat phi = glm::two_pi<GLfloat>() * longitude / 128.0f;
+			glm::vec3 direction(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+
+			glm::vec2 encoded = MeshProcessing::encodeOctahedral(direction);
+			CHECK(glm::all(glm::lessThanEqual(glm::abs(encoded), glm::vec2(1.0f))));
+
+			glm::vec3 decoded = MeshProcessing::decodeOctahedral(encoded);
+			largestError = glm::max(largestError, glm::length(decoded - direction));
+
+			// Quantize like packSnorm2x8 and packSnorm2x16.
+			glm::vec3 decoded8 = MeshProcessing::decodeOctahedral(glm::round(encoded * 127.0f) / 127.0f);
+			glm::vec3 decoded16 = MeshProcessing::decodeOctahedral(glm::round(encoded * 32767.0f) / 32767.0f);
+
+			largestError8 = glm::max(largestError8, acosf(glm::clamp(glm::dot(decoded8, direction), -1.0f, 1.0f)));
+			largestError16 = glm::max(largestError16, glm::length(decoded16 - direction));
+
+			CHECK(fabsf(glm::length(decoded8) - 1.0f) < 1e-5f);
+		}
+	}
+
+	CHECK(largestError < 1e-5f);
+	CHECK(largestError8 < glm::radians(1.0f));
+	CHECK(largestError16 < 1e-4f);
+
+	// A zero vector still decodes to a unit vector.
+	glm::vec3 zero = MeshProcessing::decodeOctahedral(MeshProcessing::encodeOctahedral(glm::vec3(0.0f)));
+	CHECK(!glm::any(glm::isnan(zero)) && fabsf(glm::length(zero) - 1.0f) < 1e-5f);
+}
+
+/// <summary>
+/// Draw a triangle covering the target, whose vertices all have the given normal, with the G-buffer program and read
+/// back the view space normal written at the centre. Without a format the mesh has positions only.
+/// </summary>
+glm::vec3 RenderNormal(Shader& _shader, const VertexFormat* _pFormat, const glm::vec3& _normal, const glm::mat4& _model)
+{
+	MeshData triangle;
+	triangle.positions = { glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(3.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 3.0f, 0.0f) };
+	triangle.normals.assign(3, _normal);
+	triangle.indices = { 0, 1, 2 };
+
+	Mesh mesh;
+
+	if (_pFormat)
+	{
+		PackedVertices packed;
+		MeshProcessing::packVertices(triangle, *_pFormat, packed);
+		mesh.create(packed, triangle.indices.data(), 3);
+	}
+	else
+	{
+		mesh.create((GLfloat*)triangle.positions.data(), triangle.indices.data(), 9, 3);
+	}
+
+	// Clip space is view space, so the view normal is the model's.
+	glm::mat4 identity(1.0f);
+
+	_shader.use();
+	glUniformMatrix4fv(_shader.getModelLocation(), 1, GL_FALSE, glm::value_ptr(_model));
+	glUniformMatrix4fv(_shader.getViewLocation(), 1, GL_FALSE, glm::value_ptr(identity));
+	glUniformMatrix4fv(_shader.getProjectionLocation(), 1, GL_FALSE, glm::value_ptr(identity));
+	glUniformMatrix4fv(_shader.getUniform(ShaderUniform::PreviousModel), 1, GL_FALSE, glm::value_ptr(_model));
+	glUniformMatrix4fv(_shader.getUniform(ShaderUniform::ViewProjection), 1, GL_FALSE, glm::value_ptr(identity));
+	glUniformMatrix4fv(_shader.getUniform(ShaderUniform::PreviousViewProjection), 1, GL_FALSE, glm::value_ptr(identity));
+	glUniform3fv(_shader.getUniform(ShaderUniform::PositionScale), 1, glm::value_ptr(mesh.getPositionScale()));
+	glUniform3fv(_shader.getUniform(ShaderUniform::PositionOffset), 1, glm::value_ptr(mesh.getPositionOffset()));
+	glUniform1i(_shader.getUniform(ShaderUniform::NormalEncoding), (GLint)mesh.getNormalEncoding());
+
+	glClear(GL_COLOR_BUFFER_BIT);
+	mesh.render();
+
+	GLfloat encoded[2] = {};
+	glReadPixels(32, 32, 1, 1, GL_RG, GL_FLOAT, encoded);
+
+	return MeshProcessing::decodeOctahedral(glm::vec2(encoded[0], encoded[1]) * 2.0f - 1.0f);
+}
+
+void TestVertexStreams()
+{
+	Shader shader;
+	shader.initialize();
+	shader.load(GL_VERTEX_SHADER, "resources/vs/lit.vert");
+	shader.load(GL_FRAGMENT_SHADER, "resources/fs/gbuffer.frag");
+	shader.link();
+	shader.loadUniforms();
+
+	CHECK(shader.getUniform(ShaderUniform::NormalEncoding) != -1);
+
+	// Only the G-buffer's normal target is written.
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, 64, 64, 0, GL_RG, GL_FLOAT, nullptr);
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, texture, 0);
+
+	const GLenum drawBuffers[] = { GL_NONE, GL_COLOR_ATTACHMENT1, GL_NONE };
+	glDrawBuffers(3, drawBuffers);
+	glReadBuffer(GL_COLOR_ATTACHMENT1);
+	CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+	glViewport(0, 0, 64, 64);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+
+	VertexFormat floats;
+	floats.quantizePositions = false;
+	floats.normalBits = 0;
+
+	VertexFormat octahedral16;
+
+	VertexFormat octahedral8;
+	octahedral8.normalBits = 8;
+	octahedral8.splitPositions = true;
+
+	// Normals in both halves of the octahedron, none of them the triangle's face normal.
+	const glm::vec3 normals[] = { glm::normalize(glm::vec3(1, 2, 3)), glm::normalize(glm::vec3(-2, 1, -3)), glm::normalize(glm::vec3(0.3f, -1, -0.2f)) };
+	glm::mat4 model(1.0f);
+
+	for (const glm::vec3& normal : normals)
+	{
+		CHECK(glm::length(RenderNormal(shader, &floats, normal, model) - normal) < 1e-3f);
+		CHECK(glm::length(RenderNormal(shader, &octahedral16, normal, model) - normal) < 1e-3f);
+		CHECK(acosf(glm::clamp(glm::dot(RenderNormal(shader, &octahedral8, normal, model), normal), -1.0f, 1.0f)) < glm::radians(1.0f));
+	}
+
+	// A non-uniform scale tilts normals toward the stretched axis' perpendicular.
+	glm::mat4 stretched = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 1.0f, 1.0f));
+	glm::vec3 expected = glm::normalize(normals[0] / glm::vec3(2.0f, 1.0f, 1.0f));
+	CHECK(glm::length(RenderNormal(shader, &octahedral16, normals[0], stretched) - expected) < 1e-3f);
+
+	// Without normals the triangle is shaded with its face normal.
+	CHECK(glm::length(RenderNormal(shader, nullptr, normals[0], model) - glm::vec3(0.0f, 0.0f, 1.0f)) < 1e-3f);
+
+	CHECK(glGetError() == GL_NO_ERROR);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &texture);
+	shader.clear();
+}
+
+/// <summary> Make a key event. </summary>
+InputEvent KeyEvent(int _key, int _action, double _time)
+{
+	InputEvent event;
+	event.type = InputEventType::Key;
+	event.code = _key;
+	event.action = _action;
+	event.time = _time;
+
+	return event;
+}
+
+void TestInputQueue()
+{
+	InputQueue queue;
+	InputEvent event;
+
+	CHECK(!queue.pop(event));
+
+	// Events come out in order.
+	for (GLuint counter = 0; counter < 10; counter++)
+	{
+		CHECK(queue.push(KeyEvent((int)counter, GLFW_PRESS, counter)));
+	}
+
+	for (GLuint counter = 0; counter < 10; counter++)
+	{
+		CHECK(queue.pop(event) && event.code == (int)counter);
+	}
+
+	CHECK(!queue.pop(event));
+
+	// A full queue drops and counts events, and the ring keeps its order across the wrap.
+	for (GLuint counter = 0; counter < INPUT_QUEUE_CAPACITY; counter++)
+	{
+		CHECK(queue.push(KeyEvent((int)counter, GLFW_PRESS, counter)));
+	}
+
+	CHECK(!queue.push(KeyEvent(0, GLFW_PRESS, 0.0)));
+	CHECK(queue.getDroppedCount() == 1);
+
+	bool inOrder = true;
+
+	for (GLuint counter = 0; counter < INPUT_QUEUE_CAPACITY; counter++)
+	{
+		inOrder = inOrder && queue.pop(event) && event.code == (int)counter;
+	}
+
+	CHECK(inOrder);
+	CHECK(!queue.pop(event));
+
+	// One producer thread and one consumer see every event once and in order.
+	const GLuint eventCount = 200000;
+
+	std::thread producer([&queue, eventCount]()
+	{
+		for (GLuint counter = 0; counter < eventCount; counter++)
+		{
+			while (!queue.push(KeyEvent((int)counter, GLFW_PRESS, counter)))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	GLuint expected = 0;
+	inOrder = true;
+
+	while (expected < eventCount)
+	{
+		if (queue.pop(event))
+		{
+			inOrder = inOrder && event.code == (int)expected;
+			expected++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+
+	CHECK(inOrder);
+	CHECK(!queue.pop(event));
+
+	// Presses and releases between two updates are applied in order, so a tap is counted though the key is up again.
+	InputState state;
+	queue.push(KeyEvent(GLFW_KEY_W, GLFW_PRESS, 1.0));
+	queue.push(KeyEvent(GLFW_KEY_W, GLFW_RELEASE, 1.1));
+	state.update(queue);
+
+	CHECK(!state.isDown(InputAction::MoveForward));
+	CHECK(state.getPressCount(InputAction::MoveForward) == 1);
+	CHECK(state.isActive(InputAction::MoveForward));
+	CHECK(state.getLastEventTime() == 1.1);
+
+	// Counts are kept across updates until consumed.
+	state.update(queue);
+	CHECK(state.getPressCount(InputAction::MoveForward) == 1);
+
+	state.consumePresses();
+	CHECK(!state.isActive(InputAction::MoveForward));
+
+	// Repeats hold the key without counting.
+	queue.push(KeyEvent(GLFW_KEY_W, GLFW_PRESS, 2.0));
+	queue.push(KeyEvent(GLFW_KEY_W, GLFW_REPEAT, 2.1));
+	state.update(queue);
+
+	CHECK(state.isDown(InputAction::MoveForward));
+	CHECK(state.getPressCount(InputAction::MoveForward) == 1);
+
+	state.consumePresses();
+	state.update(queue);
+	CHECK(state.isDown(InputAction::MoveForward));
+	CHECK(state.getPressCount(InputAction::MoveForward) == 0);
+
+	// A tap latched by a late poll, after the simulation consumed the presses, reaches the next frame's simulation.
+	queue.push(KeyEvent(GLFW_KEY_W, GLFW_RELEASE, 3.0));
+	state.update(queue);
+	state.consumePresses();
+
+	queue.push(KeyEvent(GLFW_KEY_D, GLFW_PRESS, 3.1));
+	queue.push(KeyEvent(GLFW_KEY_D, GLFW_RELEASE, 3.2));
+	state.poll(queue);
+	state.update(queue);
+
+	CHECK(!state.isDown(InputAction::MoveRight));
+	CHECK(state.isActive(InputAction::MoveRight));
+
+	// Mouse motion of the late poll belongs to its own frame.
+	InputEvent move;
+	move.type = InputEventType::MouseMove;
+	move.x = 10.0;
+	queue.push(move);
+	move.x = 14.0;
+	queue.push(move);
+	state.poll(queue);
+	CHECK(state.getMouseDeltaX() == 4.0f);
+
+	state.update(queue);
+	CHECK(state.getMouseDeltaX() == 0.0f);
+}
+
+/// <summary> A group of checks. </summary>
+struct TestGroup
+{
+	const char* pName;
+	void (*pRun)();
+
+	/// <summary> Does the group need a GL context? </summary>
+	bool gl;
+};
+
+const TestGroup testGroups[] =
+{
+	{ "gpu_allocator", TestGpuAllocator, false },
+	{ "geometry_pool", TestGeometryPool, true },
+	{ "object_pool", TestObjectPool, false },
+	{ "mesh_format", TestMeshFormat, false },
+	{ "octahedral", TestOctahedral, false },
+	{ "vertex_streams", TestVertexStreams, true },
+	{ "input_queue", TestInputQueue, false },
+};
+
+int main(int argc, char** argv)
+{
+	// Run one group when it is named, otherwise all of them.
+	const char* pGroup = argc > 1 ? argv[1] : nullptr;
+	bool found = false;
+	bool skipped = false;
+
+	for (const TestGroup& group : testGroups)
+	{
+		if (pGroup && strcmp(pGroup, group.pName) != 0)
+		{
+			continue;
+		}
+
+		found = true;
+
+		// Machines without a GL context skip the GPU groups rather than fail them.
+		if (group.gl && !CreateContext())
+		{
+			fprintf(stderr, "%s: skipped, no GL context\n", group.pName);
+			skipped = true;
+			continue;
+		}
+
+		GLuint failures = failureCount;
+		group.pRun();
+
+		fprintf(stderr, "%s: %s\n", group.pName, failureCount == failures ? "passed" : "FAILED");
+	}
+
+	if (!found)
+	{
+		fprintf(stderr, "Unknown test group %s!\n", pGroup);
+		return 1;
+	}
+
+	printf("%u checks, %u failed\n", checkCount, failureCount);
+
+	delete pWindow;
+
+	// Return error code.
+	if (failureCount > 0)
+	{
+		return 1;
+	}
+
+	return skipped && checkCount == 0 ? SKIP_CODE : 0;
+}
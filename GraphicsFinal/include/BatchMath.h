@@ -0,0 +1,41 @@
+#pragma once
+
+/// <summary> Axis aligned boxes stored component by component, so the kernels load several boxes per register. </summary>
+struct BoundsSoA
+{
+	/// <summary> Minimum corners. </summary>
+	std::vector<GLfloat> minX;
+	std::vector<GLfloat> minY;
+	std::vector<GLfloat> minZ;
+
+	/// <summary> Maximum corners. </summary>
+	std::vector<GLfloat> maxX;
+	std::vector<GLfloat> maxY;
+	std::vector<GLfloat> maxZ;
+
+	/// <summary> Set the number of boxes. </summary>
+	void resize(size_t _count);
+
+	/// <summary> Get the number of boxes. </summary>
+	size_t size() const { return minX.size(); }
+};
+
+/// <summary>
+/// Matrix math over whole arrays at once. Every call runs the kernel of the CpuFeatures level; the SIMD kernels work
+/// on four to sixteen objects per iteration and never allocate.
+/// </summary>
+class BatchMath
+{
+public:
+	/// <summary> Multiply pairs of matrices, result = left * right. The result may alias either input. </summary>
+	static void multiply(const glm::mat4* _pLeft, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count);
+
+	/// <summary> Multiply one matrix by many, such as a view projection by every model. The result may alias the input. </summary>
+	static void multiply(const glm::mat4& _left, const glm::mat4* _pRight, glm::mat4* _pResult, size_t _count);
+
+	/// <summary> Compose model matrices (translate * rotate * scale) like Transform::toMatrix(). </summary>
+	static void compose(const glm::vec3* _pPositions, const glm::quat* _pRotations, const glm::vec3* _pScales, glm::mat4* _pResult, size_t _count);
+
+	/// <summary> Transform local boxes by their models into the world boxes enclosing them. The world boxes are resized to fit. </summary>
+	static void transformBounds(const glm::mat4* _pModels, const BoundsSoA& _local, BoundsSoA& _world);
+};
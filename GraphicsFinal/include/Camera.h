@@ -1,5 +1,18 @@
 #pragma once
 
+class InputState;
+
+// Time for smoothed motion to settle, in seconds. Zero follows the input directly.
+const GLfloat DEFAULT_POSITION_SMOOTHING = 0.08f;
+const GLfloat DEFAULT_ROTATION_SMOOTHING = 0.0f;
+
+// Pitch limit in degrees, short of straight up or down where the camera would flip.
+const GLfloat MAX_CAMERA_PITCH = 89.0f;
+
+// Distance from its origin at which the camera moves the origin to itself. Floats hold about a tenth of a millimetre
+// this far out. Zero rebases every frame the camera moved, keeping it exactly at the origin.
+const GLfloat DEFAULT_REBASE_DISTANCE = 1024.0f;
+
 class Camera
 {
 public:
@@ -7,17 +20,85 @@ public:
 	Camera(glm::vec3 _initialPosition, glm::vec3 _worldUp, GLfloat _initialYaw, GLfloat _initialPitch, GLfloat _initialSpeed, GLfloat _initialAngularSpeed);
 	~Camera() {}
 
-	void keyControl(bool* _keys, GLfloat _deltaTime);
+	// Move the target position by the held or tapped movement actions.
+	void keyControl(const InputState& _input, GLfloat _deltaTime);
 
+	// Turn the target orientation. Pitch is clamped so the camera cannot flip.
 	void mouseControl(GLfloat _deltaX, GLfloat _deltaY);
 
+	// Move the position and orientation toward their targets with critically damped springs.
+	void advance(GLfloat _deltaTime);
+
+	// Set the time smoothed motion takes to settle. Zero follows the input directly.
+	void setSmoothing(GLfloat _positionTime, GLfloat _rotationTime);
+
+	// Place the camera directly, for scripted camera paths. The position is relative to the origin.
+	void setPose(glm::vec3 _position, GLfloat _yaw, GLfloat _pitch);
+
+	// Move the camera anywhere in the world. The origin moves with it.
+	void setWorldPosition(const glm::dvec3& _position);
+
+	// Floating origin. Positions, matrices and planes of the camera are relative to it, so they stay small floats
+	// however far from the world origin the camera is. World transforms are made relative with the same origin.
+	const glm::dvec3& getOrigin() const { return mOrigin; }
+	glm::dvec3 getWorldPosition() const { return mOrigin + glm::dvec3(mPosition); }
+
+	// Move the origin to the camera once it is further away than the rebase distance. Call between simulation steps
+	// and rendering. Returns whether the origin moved.
+	bool rebase();
+	void setRebaseDistance(GLfloat _distance) { mRebaseDistance = _distance; }
+
+	// Set the perspective projection. The field of view is vertical, in radians.
+	void setProjection(GLfloat _fieldOfView, GLfloat _aspectRatio, GLfloat _nearPlane, GLfloat _farPlane);
+
+	// Use an infinite reverse-Z projection for a zero to one clip range: depth is one at the near plane and falls
+	// toward zero at infinity. The far plane is then ignored by the projection and the frustum.
+	void setReverseZ(bool _enabled);
+	bool getReverseZ() const { return mReverseZ; }
+
+	// Cached matrices, rebuilt only after the camera moved or the projection changed. The view is at the position of
+	// the last calculateViewMatrix() or setPose().
+	const glm::mat4& getView();
+	const glm::mat4& getProjection();
+	const glm::mat4& getViewProjection();
+
+	// Cached origin relative frustum planes, indexed by FrustumPlane.
+	const glm::vec4* getFrustumPlanes();
+
+	// Does an origin relative sphere touch the frustum?
+	bool isSphereVisible(const glm::vec3& _center, GLfloat _radius);
+
+	glm::vec3 getPosition() const { return mPosition; }
+	glm::vec3 getFront() const { return mFront; }
+	glm::vec3 getRight() const { return mRight; }
+	glm::vec3 getUp() const { return mUp; }
+
 	glm::mat4 calculateViewMatrix();
 
+	// Interpolate the position between the previous and current simulation step.
+	glm::mat4 calculateViewMatrix(GLfloat _alpha);
+
+	// Remember the current state before running a simulation step.
+	void storePrevious();
+
 private:
-	// Position of the camera.
+	// Smoothed position of the camera, where input has moved it to and how fast it is catching up.
 	glm::vec3 mPosition;
-	
+	glm::vec3 mTargetPosition;
+	glm::vec3 mVelocity;
+
+	// Position at the previous simulation step.
+	glm::vec3 mPreviousPosition;
+
+	// Position the cached view was built at, between the previous and current step.
+	glm::vec3 mViewPosition;
+
+	// World position the other positions are relative to, and how far the camera may get from it.
+	glm::dvec3 mOrigin;
+	GLfloat mRebaseDistance;
+
 	// Orientation of the camera.
+	glm::quat mOrientation;
 	glm::vec3 mFront;
 	glm::vec3 mUp;
 	glm::vec3 mRight;
@@ -25,16 +106,45 @@ private:
 	// World up reference.
 	glm::vec3 mWorldUp;
 
-	// Horizontal rotation.
+	// Horizontal rotation in degrees, smoothed and target.
 	GLfloat mYaw;
+	GLfloat mTargetYaw;
+	GLfloat mYawVelocity;
 
-	// Vertical rotation.
+	// Vertical rotation in degrees, smoothed and target.
 	GLfloat mPitch;
+	GLfloat mTargetPitch;
+	GLfloat mPitchVelocity;
 
 	// Movement speeds.
 	GLfloat mSpeed;
 	GLfloat mAngularSpeed;
 
-	// Update data.
+	// Smoothing times in seconds.
+	GLfloat mPositionSmoothing;
+	GLfloat mRotationSmoothing;
+
+	// Projection parameters.
+	GLfloat mFieldOfView;
+	GLfloat mAspectRatio;
+	GLfloat mNearPlane;
+	GLfloat mFarPlane;
+	bool mReverseZ;
+
+	// Cached matrices and planes.
+	glm::mat4 mView;
+	glm::mat4 mProjection;
+	glm::mat4 mViewProjection;
+	glm::vec4 mPlanes[(int)FrustumPlane::Count];
+
+	// Which cached data is out of date.
+	bool mViewDirty;
+	bool mProjectionDirty;
+	bool mViewProjectionDirty;
+
+	// Rebuild the orientation from yaw and pitch.
 	void update();
-};
\ No newline at end of file
+
+	// Rebuild the view projection and planes when the view or projection changed.
+	void updateViewProjection();
+};
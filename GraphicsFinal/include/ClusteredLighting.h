@@ -0,0 +1,128 @@
+#pragma once
+
+class Shader;
+
+/// <summary> Number of clusters across the screen. </summary>
+const GLuint CLUSTER_COUNT_X = 16;
+
+/// <summary> Number of clusters down the screen. </summary>
+const GLuint CLUSTER_COUNT_Y = 9;
+
+/// <summary> Number of depth slices. </summary>
+const GLuint CLUSTER_COUNT_Z = 24;
+
+/// <summary> Total number of clusters. </summary>
+const GLuint CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+
+/// <summary> Maximum number of lights. Light indices are stored as 16 bit values. </summary>
+const GLuint MAX_POINT_LIGHTS = 65535;
+
+/// <summary> Texture unit of the light data buffer. The grid and index buffers use the next two units. </summary>
+const GLuint LIGHTING_TEXTURE_UNIT = 4;
+
+/// <summary> A point light in world space. </summary>
+struct PointLight
+{
+	/// <summary> Position in world space. </summary>
+	glm::vec3 position = glm::vec3(0.0f);
+
+	/// <summary> Distance at which the light reaches zero. </summary>
+	GLfloat radius = 1.0f;
+
+	/// <summary> Linear color of the light. </summary>
+	glm::vec3 color = glm::vec3(1.0f);
+
+	/// <summary> Brightness multiplier. </summary>
+	GLfloat intensity = 1.0f;
+};
+
+/// <summary> The camera view and projection that clusters and shadow cascades are fit to. </summary>
+struct ViewFrustum
+{
+	/// <summary> World to view space transform. </summary>
+	glm::mat4 view = glm::mat4(1.0f);
+
+	/// <summary> Vertical field of view in radians. </summary>
+	GLfloat fieldOfView = glm::radians(45.0f);
+
+	/// <summary> Width divided by height. </summary>
+	GLfloat aspectRatio = 1.0f;
+
+	/// <summary> Near plane distance. </summary>
+	GLfloat nearPlane = 0.1f;
+
+	/// <summary> Far plane distance. </summary>
+	GLfloat farPlane = 100.0f;
+};
+
+/// <summary> Assigns point lights to a 3D grid of view frustum clusters for clustered shading. </summary>
+class ClusteredLighting
+{
+public:
+	ClusteredLighting();
+	~ClusteredLighting();
+
+	/// <summary> Create the light buffers. The context must be current. </summary>
+	void initialize();
+
+	/// <summary> Assign the lights to clusters and upload the results. </summary>
+	void update(const std::vector<PointLight>& _lights, const ViewFrustum& _frustum);
+
+	/// <summary> Bind the light buffers and set the lighting uniforms of the given program. </summary>
+	void bind(const Shader& _shader, GLint _screenWidth, GLint _screenHeight);
+
+	/// <summary> Get the number of lights in the last update. </summary>
+	GLuint getLightCount() const { return mLightCount; }
+
+	/// <summary> Get the number of light indices in the last update. </summary>
+	GLuint getIndexCount() const { return (GLuint)mIndices.size(); }
+
+	/// <summary> Get the CPU time of the last update in milliseconds. </summary>
+	double getUpdateTime() const { return mUpdateTime; }
+
+	/// <summary> Delete the light buffers. </summary>
+	void clear();
+
+private:
+	/// <summary> Light data, two RGBA32F texels per light (view position, radius) and (color * intensity). </summary>
+	GLuint mLightBuffer;
+	GLuint mLightTexture;
+
+	/// <summary> Per cluster offset and count into the index list (RG32UI). </summary>
+	GLuint mGridBuffer;
+	GLuint mGridTexture;
+
+	/// <summary> Light indices of every cluster packed together (R16UI). </summary>
+	GLuint mIndexBuffer;
+	GLuint mIndexTexture;
+
+	/// <summary> Number of lights in the last update. </summary>
+	GLuint mLightCount;
+
+	/// <summary> Frustum the cluster bounds were built for. </summary>
+	ViewFrustum mFrustum;
+
+	/// <summary> View space bounds of every cluster. </summary>
+	std::vector<glm::vec3> mClusterMin;
+	std::vector<glm::vec3> mClusterMax;
+
+	/// <summary> Scratch data reused between updates. </summary>
+	std::vector<glm::vec4> mLightData;
+	std::vector<GLuint> mGrid;
+	std::vector<GLushort> mIndices;
+	std::vector<GLuint> mClusterCounts;
+	std::vector<GLuint> mLightClusters;
+	std::vector<GLuint> mLightClusterOffsets;
+
+	/// <summary> CPU time of the last update in milliseconds. </summary>
+	double mUpdateTime;
+
+	/// <summary> Rebuild the view space cluster bounds when the projection changes. </summary>
+	void buildClusters(const ViewFrustum& _frustum);
+
+	/// <summary> Get the depth slice containing a view space depth. </summary>
+	GLint depthSlice(GLfloat _depth) const;
+
+	/// <summary> Upload data to a texture buffer, reallocating when it grows. </summary>
+	void upload(GLuint _buffer, const void* _pData, size_t _bytes);
+};
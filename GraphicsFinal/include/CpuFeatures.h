@@ -0,0 +1,75 @@
+#pragma once
+
+// SIMD kernels are compiled one function at a time for their instruction set, never whole files, so inline library
+// code such as GLM keeps the baseline encoding and the binary still starts on CPUs without the newer sets.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET_SSE4
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_AVX512
+#else
+#define SIMD_TARGET_SSE4 __attribute__((target("sse4.2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512vl,avx2,fma,popcnt")))
+#endif
+#endif
+
+// GCC 12 warns about its own AVX-512 headers when they are inlined into target functions, so the AVX-512 kernels
+// are wrapped in these.
+#if defined(__GNUC__) && !defined(__clang__)
+#define SIMD_AVX512_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define SIMD_AVX512_END _Pragma("GCC diagnostic pop")
+#else
+#define SIMD_AVX512_BEGIN
+#define SIMD_AVX512_END
+#endif
+
+/// <summary> Instruction sets the SIMD kernels are written for, from slowest to fastest. </summary>
+enum class SimdLevel
+{
+	Scalar,
+	SSE4,
+	AVX2,
+	AVX512,
+	Count
+};
+
+/// <summary> Instruction set extensions found on the CPU, with the OS saving their registers. </summary>
+struct CpuFeatureFlags
+{
+	/// <summary> SSE 4.1 and 4.2. </summary>
+	bool sse42 = false;
+
+	/// <summary> AVX2 with fused multiply add. </summary>
+	bool avx2 = false;
+
+	/// <summary> AVX-512 foundation, doubleword and quadword, and vector length extensions. </summary>
+	bool avx512 = false;
+};
+
+/// <summary>
+/// Picks the SIMD kernels every batch routine runs with. The CPU is checked once at startup and the best level it
+/// supports is used, so one binary runs the widest kernels a machine has and still runs on machines without them.
+/// </summary>
+class CpuFeatures
+{
+public:
+	/// <summary> Get the extensions of this CPU. </summary>
+	static const CpuFeatureFlags& getFlags();
+
+	/// <summary> Get the fastest level this CPU supports. </summary>
+	static SimdLevel getSupportedLevel();
+
+	/// <summary> Get the level the kernels run with. </summary>
+	static SimdLevel getLevel();
+
+	/// <summary> Run a slower level, for comparisons or to rule out a kernel. Levels the CPU lacks fall back to the best it has. </summary>
+	static void setLevel(SimdLevel _level);
+
+	/// <summary> Get the name of a level for reports and command lines. </summary>
+	static const char* getLevelName(SimdLevel _level);
+
+	/// <summary> Find a level by name. Returns false for unknown names. </summary>
+	static bool parseLevel(const char* _pName, SimdLevel& _level);
+};
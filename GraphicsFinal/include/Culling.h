@@ -0,0 +1,47 @@
+#pragma once
+
+struct BoundsSoA;
+struct Meshlet;
+
+/// <summary> Frustum plane order. Planes are (normal, distance) with normals pointing inside. </summary>
+enum class FrustumPlane
+{
+	Left,
+	Right,
+	Bottom,
+	Top,
+	Near,
+	Far,
+	Count
+};
+
+/// <summary>
+/// Frustum culling over whole arrays of boxes. Every call runs the kernel of the CpuFeatures level; the SIMD kernels
+/// test four to sixteen boxes against all planes per iteration.
+/// </summary>
+class Culling
+{
+public:
+	/// <summary>
+	/// Get the planes of a view projection (Gribb and Hartmann), normalized so distances are in world units. A reverse-Z
+	/// projection is infinite, so its far plane is one every point passes.
+	/// </summary>
+	static void extractPlanes(const glm::mat4& _viewProjection, bool _reverseZ, glm::vec4* _pPlanes);
+
+	/// <summary>
+	/// Write the indices of the boxes inside or touching the planes, in order, and return how many there are. The
+	/// index array must hold one entry per box. Boxes are tested by the corner furthest along each plane normal, so a
+	/// few boxes outside near the frustum corners are kept.
+	/// </summary>
+	static size_t cullBounds(const glm::vec4* _pPlanes, const BoundsSoA& _bounds, GLuint* _pVisible);
+
+	/// <summary> Move planes into the local space of a model matrix, normalized again so they measure local units. </summary>
+	static void transformPlanes(const glm::vec4* _pPlanes, const glm::mat4& _model, glm::vec4* _pLocalPlanes);
+
+	/// <summary>
+	/// Write the indices of one mesh's meshlets that may be visible, in order, and return how many there are. Planes
+	/// and camera are in the mesh's local space. Meshlets are culled when their sphere is outside a plane or, with
+	/// back facing cones, when every triangle faces away from the camera; this assumes counter-clockwise front faces.
+	/// </summary>
+	static size_t cullMeshlets(const glm::vec4* _pPlanes, const glm::vec3& _cameraPosition, bool _backfaceCones, const Meshlet* _pMeshlets, size_t _count, GLuint* _pVisible);
+};
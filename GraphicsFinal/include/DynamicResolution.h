@@ -0,0 +1,89 @@
+#pragma once
+
+/// <summary> Frames of GPU timestamps kept in flight. Results are read this many frames late. </summary>
+const GLuint RESOLUTION_QUERY_FRAMES = 4;
+
+/// <summary> Default lowest fraction of the output size rendered. </summary>
+const GLfloat DEFAULT_MIN_RESOLUTION_SCALE = 0.5f;
+
+/// <summary> Default GPU time per frame the scale is adjusted to meet, in milliseconds. </summary>
+const double DEFAULT_TARGET_GPU_TIME = 16.0;
+
+/// <summary> Picks the render resolution each frame from measured GPU time to hold a target frame time. </summary>
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	/// <summary> Create the timestamp queries. The context must be current. </summary>
+	void initialize();
+
+	/// <summary> Enable scaling. Disabled scaling renders at the output size. </summary>
+	void setEnabled(bool _enabled);
+
+	/// <summary> Is scaling enabled? </summary>
+	bool getEnabled() const { return mEnabled; }
+
+	/// <summary> Set the GPU time per frame to hold in milliseconds. </summary>
+	void setTargetTime(double _milliseconds) { mTargetTime = _milliseconds; }
+
+	/// <summary> Get the GPU time per frame to hold in milliseconds. </summary>
+	double getTargetTime() const { return mTargetTime; }
+
+	/// <summary> Set the lowest and highest fraction of the output size rendered. </summary>
+	void setScaleRange(GLfloat _minimum, GLfloat _maximum);
+
+	/// <summary> Get the fraction of the output size rendered this frame. </summary>
+	GLfloat getScale() const { return mEnabled ? mScale : 1.0f; }
+
+	/// <summary> Get the averaged GPU time of recent frames in milliseconds. </summary>
+	double getGpuTime() const { return mAverageTime; }
+
+	/// <summary> Get the number of scale changes. Each one reallocates the render targets. </summary>
+	GLuint getChangeCount() const { return mChangeCount; }
+
+	/// <summary> Read finished timings, adjust the scale and start timing a frame. </summary>
+	void beginFrame();
+
+	/// <summary> Stop timing the frame. </summary>
+	void endFrame();
+
+	/// <summary> Get the render size for an output size at the current scale. </summary>
+	void scaleSize(GLint _width, GLint _height, GLint& _scaledWidth, GLint& _scaledHeight) const;
+
+	/// <summary> Delete the timestamp queries. </summary>
+	void clear();
+
+private:
+	/// <summary> Start and end timestamps of the frames in flight. </summary>
+	GLuint mQueries[RESOLUTION_QUERY_FRAMES * 2];
+
+	/// <summary> Number of frames timed. </summary>
+	unsigned long long mFrameCount;
+
+	/// <summary> Is scaling enabled? </summary>
+	bool mEnabled;
+
+	/// <summary> Fraction of the output size rendered. </summary>
+	GLfloat mScale;
+
+	/// <summary> Range of the scale. </summary>
+	GLfloat mMinScale;
+	GLfloat mMaxScale;
+
+	/// <summary> GPU time to hold in milliseconds. </summary>
+	double mTargetTime;
+
+	/// <summary> Exponential average of the measured GPU time in milliseconds. </summary>
+	double mAverageTime;
+
+	/// <summary> Frames to wait after a change before adjusting again, so the timings reflect the new size. </summary>
+	GLuint mSettleFrames;
+
+	/// <summary> Number of scale changes. </summary>
+	GLuint mChangeCount;
+
+	/// <summary> Blend a measured frame into the average and pick the scale that meets the target. </summary>
+	void adjust(double _gpuTime);
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+/// <summary> Default simulation step in seconds. </summary>
+const double DEFAULT_FIXED_STEP = 1.0 / 120.0;
+
+/// <summary> Default maximum number of steps run per frame. </summary>
+const GLuint DEFAULT_MAX_STEPS = 8;
+
+/// <summary> Accumulates frame time and runs the simulation in fixed size steps. </summary>
+class FixedTimestep
+{
+public:
+	FixedTimestep();
+
+	/// <summary> Create a timestep with the given step length and step limit per frame. </summary>
+	FixedTimestep(double _step, GLuint _maxSteps);
+
+	/// <summary> Add the elapsed frame time to the accumulator. </summary>
+	void advance(double _frameTime);
+
+	/// <summary> Consume one step from the accumulator. Returns false when no step is due. </summary>
+	bool step();
+
+	/// <summary> Get the step length in seconds. </summary>
+	double getStep() const { return mStep; }
+
+	/// <summary> Get how far between the previous and current step the frame is, in [0, 1). </summary>
+	GLfloat getAlpha() const { return (GLfloat)(mAccumulator / mStep); }
+
+	/// <summary> Get the total simulated time in seconds. </summary>
+	double getSimulationTime() const { return mSimulationTime; }
+
+	/// <summary> Get the total time dropped by the spiral of death guard in seconds. </summary>
+	double getDroppedTime() const { return mDroppedTime; }
+
+private:
+	/// <summary> Step length in seconds. </summary>
+	double mStep;
+
+	/// <summary> Maximum number of steps run per frame. </summary>
+	GLuint mMaxSteps;
+
+	/// <summary> Unsimulated time in seconds. </summary>
+	double mAccumulator;
+
+	/// <summary> Steps run since the last advance. </summary>
+	GLuint mStepsThisFrame;
+
+	/// <summary> Total simulated time in seconds. </summary>
+	double mSimulationTime;
+
+	/// <summary> Total time dropped in seconds. </summary>
+	double mDroppedTime;
+};
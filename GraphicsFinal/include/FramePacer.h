@@ -0,0 +1,116 @@
+#pragma once
+
+class GL_Window;
+
+/// <summary> Maximum number of frames the CPU may run ahead of the GPU. </summary>
+const GLuint MAX_FRAMES_IN_FLIGHT = 4;
+
+/// <summary> Default number of frames in flight (triple buffering). </summary>
+const GLuint DEFAULT_FRAMES_IN_FLIGHT = 3;
+
+/// <summary> How buffer swaps are synchronized with the display. </summary>
+enum class SwapMode
+{
+	/// <summary> Wait for vertical blank. </summary>
+	VSync,
+
+	/// <summary> Wait for vertical blank unless the frame is late, then tear. </summary>
+	Adaptive,
+
+	/// <summary> Never wait for vertical blank. </summary>
+	Uncapped
+};
+
+/// <summary> Limits how far the CPU runs ahead of the GPU and measures input to present latency. </summary>
+class FramePacer
+{
+public:
+	FramePacer();
+	~FramePacer();
+
+	/// <summary> Initialize the pacer and create its timestamp queries. The window's context must be current. </summary>
+	void initialize(GLuint _framesInFlight, SwapMode _mode);
+
+	/// <summary> Set the swap mode. Adaptive falls back to vsync when unsupported. </summary>
+	void setSwapMode(SwapMode _mode);
+
+	/// <summary> Get the active swap mode. </summary>
+	SwapMode getSwapMode() const { return mSwapMode; }
+
+	/// <summary> Set the number of frames the CPU may queue ahead of the GPU. </summary>
+	void setFramesInFlight(GLuint _framesInFlight);
+
+	/// <summary> Get the number of frames the CPU may queue ahead of the GPU. </summary>
+	GLuint getFramesInFlight() const { return mFramesInFlight; }
+
+	/// <summary> Wait until the GPU has finished the frame whose slot is about to be reused. </summary>
+	void beginFrame();
+
+	/// <summary> Record the GPU clock when input was polled for this frame. </summary>
+	void markInputPoll();
+
+	/// <summary> Timestamp and fence the frame's commands, swap the window's buffers and timestamp the swap. </summary>
+	void present(GL_Window& _window);
+
+	/// <summary> Get the number of frames presented. </summary>
+	unsigned long long getFrameIndex() const { return mFrameIndex; }
+
+	/// <summary> Get the average time from input poll to the GPU executing the swap in milliseconds. </summary>
+	double getPresentLatency() const { return mPresentLatency; }
+
+	/// <summary> Get the average time from input poll to the GPU finishing the frame in milliseconds. </summary>
+	double getGpuLatency() const { return mGpuLatency; }
+
+	/// <summary> Get the average time the CPU spent waiting on fences in milliseconds. </summary>
+	double getFenceWait() const { return mFenceWait; }
+
+	/// <summary> Delete all outstanding fences and the timestamp queries. </summary>
+	void clear();
+
+private:
+	/// <summary> A frame queued on the GPU. </summary>
+	struct FrameSlot
+	{
+		/// <summary> Fence signalled when the GPU finishes the frame. </summary>
+		GLsync fence = 0;
+
+		/// <summary> GPU timestamps written after the frame's commands and after the swap. </summary>
+		GLuint queries[2] = {};
+
+		/// <summary> GPU clock when input was polled for the frame, zero if it was not polled. </summary>
+		GLint64 inputTime = 0;
+
+		/// <summary> Whether the timestamps are waiting to be read. </summary>
+		bool pending = false;
+	};
+
+	/// <summary> Frame slots used as a ring buffer. </summary>
+	FrameSlot mSlots[MAX_FRAMES_IN_FLIGHT];
+
+	/// <summary> Number of frames the CPU may queue. </summary>
+	GLuint mFramesInFlight;
+
+	/// <summary> Active swap mode. </summary>
+	SwapMode mSwapMode;
+
+	/// <summary> Number of frames presented. </summary>
+	unsigned long long mFrameIndex;
+
+	/// <summary> GPU clock when input was polled for the current frame. </summary>
+	GLint64 mInputTime;
+
+	/// <summary> Average input to present latency in milliseconds. </summary>
+	double mPresentLatency;
+
+	/// <summary> Average input to GPU completion latency in milliseconds. </summary>
+	double mGpuLatency;
+
+	/// <summary> Average fence wait in milliseconds. </summary>
+	double mFenceWait;
+
+	/// <summary> Block until a slot's fence signals. </summary>
+	void waitSlot(FrameSlot& _slot);
+
+	/// <summary> Record the latency of every slot whose timestamps have landed without blocking. </summary>
+	void readLatencies();
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+/// <summary> Rate an event loop on its own thread wakes at to sample input, in hertz. </summary>
+const double DEFAULT_INPUT_RATE = 1000.0;
+
 class GL_Window
 {
 public:
@@ -8,6 +11,9 @@ public:
 	/// <summary> Create a window with the given width and height. </summary>
 	GL_Window(GLint _width, GLint _height);
 
+	/// <summary> Create a window with the given width, height and visibility. Hidden windows are used for headless runs. </summary>
+	GL_Window(GLint _width, GLint _height, bool _visible);
+
 	~GL_Window();
 
 	/// <summary> Initialize the window. </summary>
@@ -21,18 +27,27 @@ public:
 	/// <summary> Should the window close? </summary>
 	bool shouldClose() { return glfwWindowShouldClose(mpWindow); }
 
-	/// <summary Get the current key status. </summary>
-	bool* getKeys() { return mKeys; }
-
-	/// <summary Get the change in the mouse x coordinate. </summary>
-	GLfloat getMouseDeltaX();
-
-	/// <summary Get the change in the mouse y coordinate. </summary>
-	GLfloat getMouseDeltaY();
+	/// <summary> Get the queue the event callbacks fill. Drain it with InputState::update() on the thread polling events. </summary>
+	InputQueue& getInputQueue() { return mInputQueue; }
 
 	/// <summary> Swap the back and front buffers. </summary>
 	void swapBuffers() { glfwSwapBuffers(mpWindow); }
 
+	/// <summary> Capture the cursor and read unscaled, unaccelerated mouse motion. Returns false when raw motion is unsupported. </summary>
+	bool setRawMouseMotion(bool _enabled);
+
+	/// <summary> Make the context current on the calling thread, or release it. </summary>
+	void makeContextCurrent(bool _current) { glfwMakeContextCurrent(_current ? mpWindow : NULL); }
+
+	/// <summary>
+	/// Process events until the window should close, waking at least at the given rate. GLFW only handles events on the
+	/// main thread, so call this from it while another thread renders and consumes the input queue.
+	/// </summary>
+	void runEventLoop(double _rate);
+
+	/// <summary> Ask the window to close and wake an event loop waiting on it. Safe on any thread. </summary>
+	void close();
+
 private:
 	/// <sumary> The window of the application. </summary>
 	GLFWwindow* mpWindow;
@@ -49,20 +64,11 @@ private:
 	/// <summary> Buffer height of the window. </summary
 	GLint mBufferHeight;
 
-	/// <summary> Array of keys in ASCII format. </summary>
-	bool mKeys[1024];
+	/// <summary> Is the window shown on screen? </summary>
+	bool mVisible = true;
 
-	/// <summary> Previous mouse x coordinate. </summary>
-	GLfloat mLastMouseX = 0.0f;
-	/// <summary> Previous mouse y coordinate. </summary>
-	GLfloat mLastMouseY = 0.0f;
-	/// <summary> Changed mouse x coordinate. </summary>
-	GLfloat mDeltaMouseX = 0.0f;
-	/// <summary> Changed mouse y coordinate. </summary>
-	GLfloat mDeltaMouseY = 0.0f;
-
-	/// <summary> Check for the first movement of the mouse. </summary>
-	bool mMouseFirstMoved = true;
+	/// <summary> Timestamped input events in arrival order. </summary>
+	InputQueue mInputQueue;
 
 	// <summary> Create callback for events. </summary>
 	void createCallbacks();
@@ -73,6 +79,9 @@ private:
 	/// <summary> Handle mouse event callbacks. </summary>
 	static void handleMouse(GLFWwindow* _pWindow, double _xPosition, double _yPosition);
 
-	/// <summary> Initialize all the keys to false. </summary>
-	void initializeKeys();
-};
\ No newline at end of file
+	/// <summary> Handle mouse button event callbacks. </summary>
+	static void handleMouseButton(GLFWwindow* _pWindow, int _button, int _action, int _mode);
+
+	/// <summary> Handle scroll event callbacks. </summary>
+	static void handleScroll(GLFWwindow* _pWindow, double _xOffset, double _yOffset);
+};
\ No newline at end of file
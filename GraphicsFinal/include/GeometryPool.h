@@ -0,0 +1,97 @@
+#pragma once
+
+/// <summary> Vertices the pool starts with. </summary>
+const GLuint DEFAULT_POOL_VERTICES = 1 << 14;
+
+/// <summary> Indices the pool starts with. </summary>
+const GLuint DEFAULT_POOL_INDICES = 1 << 16;
+
+/// <summary> Vertex and index ranges of one mesh in a geometry pool. </summary>
+struct GeometryAllocation
+{
+	/// <summary> Allocator handle of the vertex range. </summary>
+	GLuint vertices = INVALID_ALLOCATION;
+
+	/// <summary> Allocator handle of the index range. </summary>
+	GLuint indices = INVALID_ALLOCATION;
+};
+
+/// <summary>
+/// Shared vertex and index arenas for meshes of one vertex layout. Meshes draw from their ranges with a base vertex,
+/// so every mesh in the pool uses the same vertex array and buffers. The arenas grow on demand and can be compacted.
+/// </summary>
+class GeometryPool
+{
+public:
+	GeometryPool();
+	~GeometryPool();
+
+	/// <summary> Create the arenas for the given layout. The context must be current. </summary>
+	void initialize(const VertexLayout& _layout, GLuint _vertexCapacity = DEFAULT_POOL_VERTICES, GLuint _indexCapacity = DEFAULT_POOL_INDICES);
+
+	/// <summary> Copy a mesh into the arenas. The vertex count is the number of floats. Returns false when the data does not fit the layout. </summary>
+	bool allocate(const GLfloat* _pVertices, const unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, GeometryAllocation& _allocation);
+
+	/// <summary> Release a mesh's ranges. </summary>
+	void free(GeometryAllocation& _allocation);
+
+	/// <summary> Move every range to the start of its arena with GPU copies. Offsets change, allocations stay valid. </summary>
+	void defragment();
+
+	/// <summary> Bind the shared vertex array. </summary>
+	void bind() const;
+
+	/// <summary> Get the first vertex of an allocation. </summary>
+	GLint getBaseVertex(const GeometryAllocation& _allocation) const { return (GLint)mVertexAllocator.getOffset(_allocation.vertices); }
+
+	/// <summary> Get the first index of an allocation. </summary>
+	GLuint getFirstIndex(const GeometryAllocation& _allocation) const { return mIndexAllocator.getOffset(_allocation.indices); }
+
+	/// <summary> Get the layout every mesh in the pool uses. </summary>
+	const VertexLayout& getLayout() const { return mLayout; }
+
+	/// <summary> Get the occupancy of the vertex arena in vertices. </summary>
+	GpuAllocatorStats getVertexStats() const { return mVertexAllocator.getStats(); }
+
+	/// <summary> Get the occupancy of the index arena in indices. </summary>
+	GpuAllocatorStats getIndexStats() const { return mIndexAllocator.getStats(); }
+
+	/// <summary> Get the bytes held by both arenas. </summary>
+	size_t getBufferBytes() const;
+
+	/// <summary> Get the number of defragmentations and grows, each of which copies an arena on the GPU. </summary>
+	GLuint getCopyCount() const { return mCopyCount; }
+
+	/// <summary> Delete the buffers and vertex array. Every mesh in the pool must be cleared first. </summary>
+	void clear();
+
+private:
+	/// <summary> Vertex format of the arena. </summary>
+	VertexLayout mLayout;
+
+	/// <summary> Bookkeeping of the vertex and index ranges. </summary>
+	GpuAllocator mVertexAllocator;
+	GpuAllocator mIndexAllocator;
+
+	/// <summary> Arena buffers. </summary>
+	GLuint mVertexBuffer;
+	GLuint mIndexBuffer;
+
+	/// <summary> Vertex array reading the arenas. </summary>
+	GLuint mVAO;
+
+	/// <summary> Number of arena copies. </summary>
+	GLuint mCopyCount;
+
+	/// <summary> Scratch list of moved ranges. </summary>
+	std::vector<GpuMove> mMoves;
+
+	/// <summary> Allocate a range, growing the arena until it fits. </summary>
+	GLuint allocateRange(GpuAllocator& _allocator, GLuint& _buffer, GLuint _size, GLsizeiptr _unitBytes);
+
+	/// <summary> Replace a buffer with a new one of the given capacity, copying the given ranges across. </summary>
+	void copyBuffer(GLuint& _buffer, GLsizeiptr _bytes, const std::vector<GpuMove>& _moves, GLsizeiptr _unitBytes);
+
+	/// <summary> Point the vertex array at the current buffers. </summary>
+	void bindBuffers();
+};
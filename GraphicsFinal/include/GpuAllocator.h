@@ -0,0 +1,145 @@
+#pragma once
+
+/// <summary> Returned when an allocation does not fit. </summary>
+const GLuint INVALID_ALLOCATION = ~0u;
+
+/// <summary> Log2 of the number of second level lists per power of two. </summary>
+const GLuint TLSF_SL_LOG2 = 4;
+
+/// <summary> Number of second level lists per power of two. </summary>
+const GLuint TLSF_SL_COUNT = 1 << TLSF_SL_LOG2;
+
+/// <summary> Number of first level lists, enough for 32 bit sizes. </summary>
+const GLuint TLSF_FL_COUNT = 32 - TLSF_SL_LOG2 + 1;
+
+/// <summary> Occupancy of an allocator. </summary>
+struct GpuAllocatorStats
+{
+	/// <summary> Total units managed. </summary>
+	GLuint capacity = 0;
+
+	/// <summary> Units held by allocations. </summary>
+	GLuint used = 0;
+
+	/// <summary> Number of live allocations. </summary>
+	GLuint allocationCount = 0;
+
+	/// <summary> Number of free blocks. </summary>
+	GLuint freeBlockCount = 0;
+
+	/// <summary> Largest single free block in units. </summary>
+	GLuint largestFreeBlock = 0;
+
+	/// <summary> 1 - largest free block / total free. Zero when the free space is one block. </summary>
+	double fragmentation = 0.0;
+};
+
+/// <summary> A range kept by defragmentation. The owner copies the data from the old to the new offset, which may be the same. </summary>
+struct GpuMove
+{
+	/// <summary> Offset before the move in units. </summary>
+	GLuint source;
+
+	/// <summary> Offset after the move in units. </summary>
+	GLuint destination;
+
+	/// <summary> Size in units. </summary>
+	GLuint size;
+};
+
+/// <summary>
+/// Two level segregated fit allocator for ranges of a GPU buffer. It only does the bookkeeping; sizes and offsets are in
+/// caller defined units such as vertices or indices, so every offset is naturally aligned. Allocation and free are O(1).
+/// </summary>
+class GpuAllocator
+{
+public:
+	GpuAllocator();
+	~GpuAllocator() {}
+
+	/// <summary> Manage a range of the given number of units, dropping every allocation. </summary>
+	void initialize(GLuint _capacity);
+
+	/// <summary> Allocate a range. Returns a handle or INVALID_ALLOCATION when no free block is large enough. </summary>
+	GLuint allocate(GLuint _size);
+
+	/// <summary> Free an allocation and merge it with free neighbours. </summary>
+	void free(GLuint _allocation);
+
+	/// <summary> Get the offset of an allocation in units. Changes when defragmenting. </summary>
+	GLuint getOffset(GLuint _allocation) const { return mBlocks[_allocation].offset; }
+
+	/// <summary> Get the size of an allocation in units. </summary>
+	GLuint getSize(GLuint _allocation) const { return mBlocks[_allocation].size; }
+
+	/// <summary> Add free space to the end of the range. </summary>
+	void grow(GLuint _capacity);
+
+	/// <summary>
+	/// Pack every allocation to the start of the range. Handles stay valid. Every live range is returned in address
+	/// order, including those that stay in place, with neighbours that stay neighbours merged into one move.
+	/// </summary>
+	void defragment(std::vector<GpuMove>& _moves);
+
+	/// <summary> Get the total units managed. </summary>
+	GLuint getCapacity() const { return mCapacity; }
+
+	/// <summary> Get the occupancy. Walks the blocks, so it is not meant for every frame. </summary>
+	GpuAllocatorStats getStats() const;
+
+private:
+	/// <summary> A used or free range. Blocks are linked in address order and free blocks also in their size list. </summary>
+	struct Block
+	{
+		/// <summary> Start and length in units. </summary>
+		GLuint offset;
+		GLuint size;
+
+		/// <summary> Neighbours in address order. </summary>
+		GLuint previousPhysical;
+		GLuint nextPhysical;
+
+		/// <summary> Neighbours in the free list of the block's size class. </summary>
+		GLuint previousFree;
+		GLuint nextFree;
+
+		/// <summary> Is the block free? </summary>
+		bool free;
+	};
+
+	/// <summary> Every block. Indices double as allocation handles. </summary>
+	std::vector<Block> mBlocks;
+
+	/// <summary> Block slots that can be reused. </summary>
+	std::vector<GLuint> mUnusedBlocks;
+
+	/// <summary> Bit per first level with any free block, and per second level list with any free block. </summary>
+	GLuint mFirstLevelBitmap;
+	GLuint mSecondLevelBitmaps[TLSF_FL_COUNT];
+
+	/// <summary> First free block of every size class. </summary>
+	GLuint mFreeHeads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+	/// <summary> Block at the lowest and highest address. </summary>
+	GLuint mFirstBlock;
+	GLuint mLastBlock;
+
+	/// <summary> Total units managed. </summary>
+	GLuint mCapacity;
+
+	/// <summary> Units held by allocations and their number. </summary>
+	GLuint mUsed;
+	GLuint mAllocationCount;
+
+	/// <summary> Take an unused block slot. </summary>
+	GLuint createBlock(GLuint _offset, GLuint _size, bool _free);
+
+	/// <summary> Add a free block to its size class list. </summary>
+	void insertFree(GLuint _block);
+
+	/// <summary> Remove a free block from its size class list. </summary>
+	void removeFree(GLuint _block);
+
+	/// <summary> Merge a free block into its free physical predecessor. Returns the surviving block. </summary>
+	GLuint mergeWithPrevious(GLuint _block);
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+/// <summary> Number of events the queue holds between updates. Must be a power of two. </summary>
+const GLuint INPUT_QUEUE_CAPACITY = 1024;
+
+/// <summary> Number of key codes tracked. </summary>
+const GLuint MAX_INPUT_KEYS = GLFW_KEY_LAST + 1;
+
+/// <summary> Number of mouse buttons tracked. </summary>
+const GLuint MAX_INPUT_BUTTONS = GLFW_MOUSE_BUTTON_LAST + 1;
+
+/// <summary> Kind of an input event. </summary>
+enum class InputEventType
+{
+	/// <summary> A key was pressed, repeated or released. </summary>
+	Key,
+
+	/// <summary> A mouse button was pressed or released. </summary>
+	MouseButton,
+
+	/// <summary> The cursor moved to a new position. </summary>
+	MouseMove,
+
+	/// <summary> The scroll wheel moved. </summary>
+	Scroll
+};
+
+/// <summary> One input event, in the order it arrived. </summary>
+struct InputEvent
+{
+	/// <summary> Kind of event. </summary>
+	InputEventType type = InputEventType::Key;
+
+	/// <summary> Key or button code. </summary>
+	int code = 0;
+
+	/// <summary> GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE. </summary>
+	int action = 0;
+
+	/// <summary> Cursor position or scroll offsets. </summary>
+	double x = 0.0;
+	double y = 0.0;
+
+	/// <summary> Time the event was received, in seconds since GLFW was initialized. </summary>
+	double time = 0.0;
+};
+
+/// <summary>
+/// Lock free queue of input events with one producer and one consumer. The producer, such as the window callbacks,
+/// never waits; events arriving while the queue is full are dropped and counted.
+/// </summary>
+class InputQueue
+{
+public:
+	InputQueue();
+
+	InputQueue(const InputQueue&) = delete;
+	InputQueue& operator=(const InputQueue&) = delete;
+
+	/// <summary> Add an event. Producer only. Returns false when the queue is full. </summary>
+	bool push(const InputEvent& _event);
+
+	/// <summary> Take the oldest event. Consumer only. Returns false when the queue is empty. </summary>
+	bool pop(InputEvent& _event);
+
+	/// <summary> Get the number of events dropped because the queue was full. </summary>
+	unsigned long long getDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+	/// <summary> Next event to read, written by the consumer. Kept on its own cache line from the producer's index. </summary>
+	alignas(64) std::atomic<GLuint> mHead;
+
+	/// <summary> Next slot to write, written by the producer. </summary>
+	alignas(64) std::atomic<GLuint> mTail;
+
+	/// <summary> Events dropped while full, written by the producer. </summary>
+	std::atomic<unsigned long long> mDropped;
+
+	/// <summary> Ring of events. The indices wrap at the capacity. </summary>
+	InputEvent mEvents[INPUT_QUEUE_CAPACITY];
+};
+
+/// <summary> Things the user can do, bound to keys rather than checked by key code. </summary>
+enum class InputAction
+{
+	MoveForward,
+	MoveBackward,
+	MoveLeft,
+	MoveRight,
+	MoveDown,
+	MoveUp,
+	Count
+};
+
+/// <summary> Number of input actions. </summary>
+const GLuint INPUT_ACTION_COUNT = (GLuint)InputAction::Count;
+
+/// <summary>
+/// Input state of the consumer, rebuilt from the queued events once per frame. Events are applied in order, mouse
+/// motion is accumulated rather than overwritten and presses are counted, so nothing between two updates is lost.
+/// </summary>
+class InputState
+{
+public:
+	InputState();
+
+	/// <summary> Bind an action to a key. Binding again replaces the key. </summary>
+	void bind(InputAction _action, int _key);
+
+	/// <summary> Apply every queued event. Mouse motion and scrolling start over; press counts are kept until consumed. </summary>
+	void update(InputQueue& _queue);
+
+	/// <summary> Apply events queued since the last update without starting over, to latch the newest input late in the frame. </summary>
+	void poll(InputQueue& _queue);
+
+	/// <summary>
+	/// Start the press counts over once the simulation has seen them. Presses applied later, such as by a late poll,
+	/// count toward the next consumer instead of being dropped.
+	/// </summary>
+	void consumePresses();
+
+	/// <summary> Is the key of an action held? </summary>
+	bool isDown(InputAction _action) const;
+
+	/// <summary> Get the number of times the key of an action was pressed since the presses were consumed, including taps already released. </summary>
+	GLuint getPressCount(InputAction _action) const;
+
+	/// <summary> Is the action held, or was it tapped since the presses were consumed? </summary>
+	bool isActive(InputAction _action) const { return isDown(_action) || getPressCount(_action) > 0; }
+
+	/// <summary> Is a key held? </summary>
+	bool isKeyDown(int _key) const { return _key >= 0 && _key < (int)MAX_INPUT_KEYS && mKeys[_key]; }
+
+	/// <summary> Is a mouse button held? </summary>
+	bool isButtonDown(int _button) const { return _button >= 0 && _button < (int)MAX_INPUT_BUTTONS && mButtons[_button]; }
+
+	/// <summary> Get the mouse motion since the last update. Up is positive y. </summary>
+	GLfloat getMouseDeltaX() const { return mMouseDeltaX; }
+	GLfloat getMouseDeltaY() const { return mMouseDeltaY; }
+
+	/// <summary> Get the scrolling since the last update. </summary>
+	GLfloat getScrollX() const { return mScrollX; }
+	GLfloat getScrollY() const { return mScrollY; }
+
+	/// <summary> Get the number of events applied since the last update. </summary>
+	GLuint getEventCount() const { return mEventCount; }
+
+	/// <summary> Get the time of the newest event applied so far, or zero before any. </summary>
+	double getLastEventTime() const { return mLastEventTime; }
+
+private:
+	/// <summary> Held keys and buttons. </summary>
+	bool mKeys[MAX_INPUT_KEYS];
+	bool mButtons[MAX_INPUT_BUTTONS];
+
+	/// <summary> Presses of each key since the presses were consumed. </summary>
+	GLuint mKeyPresses[MAX_INPUT_KEYS];
+
+	/// <summary> Key bound to each action, or GLFW_KEY_UNKNOWN. </summary>
+	int mBindings[INPUT_ACTION_COUNT];
+
+	/// <summary> Previous cursor position. </summary>
+	double mLastMouseX;
+	double mLastMouseY;
+
+	/// <summary> Has the cursor position been seen yet? The first position has no delta. </summary>
+	bool mMouseFirstMoved;
+
+	/// <summary> Accumulated motion and scrolling of the last update. </summary>
+	GLfloat mMouseDeltaX;
+	GLfloat mMouseDeltaY;
+	GLfloat mScrollX;
+	GLfloat mScrollY;
+
+	/// <summary> Events applied by the last update. </summary>
+	GLuint mEventCount;
+
+	/// <summary> Time of the newest event applied. </summary>
+	double mLastEventTime;
+
+	/// <summary> Apply one event. </summary>
+	void apply(const InputEvent& _event);
+};
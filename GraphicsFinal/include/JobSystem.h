@@ -0,0 +1,72 @@
+#pragma once
+
+/// <summary> Work of a parallel loop: handle items [_begin, _end) on the given worker. </summary>
+typedef void (*JobFunction)(void* _pContext, size_t _begin, size_t _end, GLuint _worker);
+
+/// <summary>
+/// Persistent worker threads running parallel loops. A loop is cut into chunks the workers take in order until none
+/// are left; the calling thread works as worker zero and returns once every chunk is done. Worker indices let jobs
+/// keep per worker data, such as partial sums reduced after the loop. Loops run one at a time from a single thread
+/// and must not start loops of their own.
+/// </summary>
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	/// <summary> Start the workers. Zero uses one per hardware thread. Without initializing, loops run on the caller. </summary>
+	void initialize(GLuint _workerCount = 0);
+
+	/// <summary> Get the number of workers including the caller, which bounds the worker index of jobs. </summary>
+	GLuint getWorkerCount() const { return mWorkerCount; }
+
+	/// <summary> Run a function over [0, _count) in chunks of at most _grain items. </summary>
+	void run(size_t _count, size_t _grain, JobFunction _function, void* _pContext);
+
+	/// <summary> Run a callable (begin, end, worker) over [0, _count) in chunks of at most _grain items. </summary>
+	template<typename Function>
+	void parallelFor(size_t _count, size_t _grain, const Function& _function)
+	{
+		run(_count, _grain, [](void* _pContext, size_t _begin, size_t _end, GLuint _worker) { (*(const Function*)_pContext)(_begin, _end, _worker); }, (void*)&_function);
+	}
+
+	/// <summary> Stop and join the workers. </summary>
+	void clear();
+
+private:
+	/// <summary> Threads of workers one and up. </summary>
+	std::vector<std::thread> mThreads;
+
+	/// <summary> Number of workers including the caller. </summary>
+	GLuint mWorkerCount;
+
+	/// <summary> Guards the loop description and wakes the workers. </summary>
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+
+	/// <summary> Loop being run. </summary>
+	JobFunction mpFunction;
+	void* mpContext;
+	size_t mCount;
+	size_t mGrain;
+
+	/// <summary> First item of the next chunk to take. </summary>
+	std::atomic<size_t> mNext;
+
+	/// <summary> Number of threads still working on the loop. </summary>
+	GLuint mPending;
+
+	/// <summary> Number of loops started, so workers notice a new one. </summary>
+	unsigned long long mGeneration;
+
+	/// <summary> Are the workers being stopped? </summary>
+	bool mStopping;
+
+	/// <summary> Take and run chunks until the loop has none left. </summary>
+	void runChunks(GLuint _worker);
+
+	/// <summary> Wait for loops and work on them until stopped. </summary>
+	void workerLoop(GLuint _worker);
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+/// <summary> Bytes the frame arena starts with. It grows to the largest frame seen. </summary>
+const size_t DEFAULT_FRAME_ARENA_BYTES = 256 * 1024;
+
+/// <summary> Alignment of arena allocations that do not ask for one. </summary>
+const size_t DEFAULT_ARENA_ALIGNMENT = 16;
+
+/// <summary> Slot index of a handle that refers to nothing. </summary>
+const GLuint INVALID_HANDLE_INDEX = ~0u;
+
+/// <summary> Allocations counted since the program started. </summary>
+struct AllocationStats
+{
+	/// <summary> Number of operator new calls and the bytes they asked for. </summary>
+	unsigned long long heapAllocations = 0;
+	unsigned long long heapBytes = 0;
+
+	/// <summary> Number of frame arena allocations and their bytes. </summary>
+	unsigned long long arenaAllocations = 0;
+	unsigned long long arenaBytes = 0;
+
+	/// <summary> Number of objects created in pools. </summary>
+	unsigned long long poolAllocations = 0;
+};
+
+/// <summary> Counts heap, arena and pool allocations. The heap is counted by replacing the global operator new. </summary>
+class AllocationCounter
+{
+public:
+	/// <summary> Get the counts so far. Subtract two snapshots to count a frame. </summary>
+	static AllocationStats snapshot();
+
+	/// <summary> Count an arena allocation. </summary>
+	static void countArena(size_t _bytes);
+
+	/// <summary> Count an object created in a pool. </summary>
+	static void countPool();
+};
+
+/// <summary>
+/// Linear allocator for data that only lives for one frame. Allocation bumps an offset and reset() frees everything at
+/// once; destructors are never run, so only trivially destructible data belongs here. A frame that runs out falls back
+/// to the heap and the arena grows to fit at the next reset, so steady state frames never touch the heap.
+/// </summary>
+class FrameArena
+{
+public:
+	FrameArena();
+	~FrameArena();
+
+	/// <summary> Allocate the arena's memory. </summary>
+	void initialize(size_t _capacity = DEFAULT_FRAME_ARENA_BYTES);
+
+	/// <summary> Allocate uninitialized memory that is valid until the next reset. </summary>
+	void* allocate(size_t _bytes, size_t _alignment = DEFAULT_ARENA_ALIGNMENT);
+
+	/// <summary> Allocate an uninitialized array valid until the next reset. </summary>
+	template<typename T>
+	T* allocateArray(size_t _count) { return (T*)allocate(sizeof(T) * _count, alignof(T)); }
+
+	/// <summary> Free every allocation. Grows the arena when the frame overflowed it. </summary>
+	void reset();
+
+	/// <summary> Get the bytes allocated since the last reset. </summary>
+	size_t getUsed() const { return mUsed + mOverflowBytes; }
+
+	/// <summary> Get the most bytes any frame allocated. </summary>
+	size_t getPeak() const { return mPeak; }
+
+	/// <summary> Get the size of the arena in bytes. </summary>
+	size_t getCapacity() const { return mCapacity; }
+
+	/// <summary> Get the number of allocations that did not fit and went to the heap. </summary>
+	GLuint getOverflowCount() const { return mOverflowCount; }
+
+	/// <summary> Free the arena's memory. </summary>
+	void clear();
+
+private:
+	/// <summary> Memory of the arena. </summary>
+	unsigned char* mpBuffer;
+
+	/// <summary> Size of the arena and the bytes allocated this frame. </summary>
+	size_t mCapacity;
+	size_t mUsed;
+
+	/// <summary> Most bytes allocated in one frame. </summary>
+	size_t mPeak;
+
+	/// <summary> Heap blocks of allocations that did not fit this frame, and their total size. </summary>
+	std::vector<void*> mOverflowBlocks;
+	size_t mOverflowBytes;
+
+	/// <summary> Number of allocations that did not fit. </summary>
+	GLuint mOverflowCount;
+};
+
+/// <summary> Reference to an object in a pool. The generation detects use of a slot after the object was destroyed. </summary>
+template<typename T>
+struct Handle
+{
+	/// <summary> Slot of the object in the pool. </summary>
+	GLuint index = INVALID_HANDLE_INDEX;
+
+	/// <summary> Generation of the slot when the object was created. </summary>
+	GLuint generation = 0;
+
+	/// <summary> Does the handle refer to a slot? It may still be stale. </summary>
+	bool isValid() const { return index != INVALID_HANDLE_INDEX; }
+};
+
+/// <summary>
+/// Fixed number of objects of one type in memory allocated once. Objects are addressed by generational handles, so a
+/// handle to a destroyed object resolves to null instead of to whatever reuses its slot.
+/// </summary>
+template<typename T>
+class ObjectPool
+{
+public:
+	ObjectPool() : mFirstFree(INVALID_HANDLE_INDEX), mCount(0) {}
+	~ObjectPool() { clear(); }
+
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	/// <summary> Allocate room for the given number of objects, destroying any existing ones. </summary>
+	void initialize(GLuint _capacity)
+	{
+		clear();
+
+		mSlots = std::vector<Slot>(_capacity);
+
+		// Every slot starts on the free list in order.
+		for (GLuint counter = 0; counter < _capacity; counter++)
+		{
+			mSlots[counter].nextFree = counter + 1 < _capacity ? counter + 1 : INVALID_HANDLE_INDEX;
+		}
+
+		mFirstFree = _capacity > 0 ? 0 : INVALID_HANDLE_INDEX;
+	}
+
+	/// <summary> Construct an object in a free slot. Returns an invalid handle when the pool is full. </summary>
+	template<typename... Arguments>
+	Handle<T> create(Arguments&&... _arguments)
+	{
+		Handle<T> handle;
+
+		if (mFirstFree == INVALID_HANDLE_INDEX)
+		{
+			printf("Object pool of %u objects is full!\n", (GLuint)mSlots.size());
+			return handle;
+		}
+
+		Slot& slot = mSlots[mFirstFree];
+
+		handle.index = mFirstFree;
+		handle.generation = slot.generation;
+
+		mFirstFree = slot.nextFree;
+		new (slot.storage) T(std::forward<Arguments>(_arguments)...);
+		slot.alive = true;
+		mCount++;
+
+		AllocationCounter::countPool();
+
+		return handle;
+	}
+
+	/// <summary> Destroy an object. Stale handles are ignored. </summary>
+	void destroy(Handle<T> _handle)
+	{
+		T* pObject = get(_handle);
+
+		if (!pObject)
+		{
+			return;
+		}
+
+		Slot& slot = mSlots[_handle.index];
+
+		pObject->~T();
+		slot.alive = false;
+
+		// Handles to the old object no longer match.
+		slot.generation++;
+		slot.nextFree = mFirstFree;
+
+		mFirstFree = _handle.index;
+		mCount--;
+	}
+
+	/// <summary> Get the object a handle refers to, or null when it was destroyed. </summary>
+	T* get(Handle<T> _handle) const
+	{
+		if (_handle.index >= (GLuint)mSlots.size())
+		{
+			return nullptr;
+		}
+
+		const Slot& slot = mSlots[_handle.index];
+
+		return slot.alive && slot.generation == _handle.generation ? (T*)slot.storage : nullptr;
+	}
+
+	/// <summary> Get the number of live objects. </summary>
+	GLuint getCount() const { return mCount; }
+
+	/// <summary> Get the number of objects the pool can hold. </summary>
+	GLuint getCapacity() const { return (GLuint)mSlots.size(); }
+
+	/// <summary> Destroy every live object. The memory is kept. </summary>
+	void clear()
+	{
+		for (GLuint counter = 0; counter < (GLuint)mSlots.size(); counter++)
+		{
+			Slot& slot = mSlots[counter];
+
+			if (slot.alive)
+			{
+				Handle<T> handle;
+				handle.index = counter;
+				handle.generation = slot.generation;
+
+				destroy(handle);
+			}
+		}
+	}
+
+private:
+	/// <summary> Storage of one object with its bookkeeping. </summary>
+	struct Slot
+	{
+		/// <summary> Memory the object is constructed in. </summary>
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		/// <summary> Incremented whenever the object is destroyed. </summary>
+		GLuint generation = 0;
+
+		/// <summary> Next slot on the free list. </summary>
+		GLuint nextFree = INVALID_HANDLE_INDEX;
+
+		/// <summary> Does the slot hold an object? </summary>
+		bool alive = false;
+	};
+
+	/// <summary> Every slot, allocated once. </summary>
+	std::vector<Slot> mSlots;
+
+	/// <summary> First free slot. </summary>
+	GLuint mFirstFree;
+
+	/// <summary> Number of live objects. </summary>
+	GLuint mCount;
+};
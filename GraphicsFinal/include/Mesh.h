@@ -1,5 +1,47 @@
 #pragma once
 
+struct VertexLayout;
+struct PackedVertices;
+class GeometryPool;
+
+/// <summary> Most vertices one meshlet references. </summary>
+const GLuint MAX_MESHLET_VERTICES = 64;
+
+/// <summary> Most triangles in one meshlet. </summary>
+const GLuint MAX_MESHLET_TRIANGLES = 124;
+
+/// <summary> A cluster of neighbouring triangles culled as one. Its triangles are contiguous in the index buffer. </summary>
+struct Meshlet
+{
+	/// <summary> Sphere around the triangles. </summary>
+	glm::vec3 center = glm::vec3(0.0f);
+	GLfloat radius = 0.0f;
+
+	/// <summary>
+	/// Average direction the triangles face, and the sine of the widest angle between it and a triangle's normal.
+	/// A cutoff of one means the triangles face too many ways for the meshlet to ever be back facing.
+	/// </summary>
+	glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	GLfloat coneCutoff = 1.0f;
+
+	/// <summary> First index of the triangles and their number. </summary>
+	GLuint firstIndex = 0;
+	GLuint triangleCount = 0;
+};
+
+/// <summary> How a mesh stores vertex normals. The values are the ones the lit vertex shader decodes. </summary>
+enum class NormalEncoding
+{
+	/// <summary> No normals; lit programs shade with flat normals. </summary>
+	None,
+
+	/// <summary> Three floats. </summary>
+	Float,
+
+	/// <summary> Two normalized integers folding the direction onto an octahedron. </summary>
+	Octahedral
+};
+
 class Mesh
 {
 public:
@@ -9,13 +51,51 @@ public:
 	/// <summary> Create the mesh. </summary>
 	void create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount);
 
-	/// <summary> Render the mesh. </summary>
-	void render();
+	/// <summary> Create the mesh with vertices in the given layout. The vertex count is the number of floats. </summary>
+	void create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, const VertexLayout& _layout);
+
+	/// <summary> Create the mesh in ranges of a shared pool, in the pool's layout. Without a pool it gets its own buffers. </summary>
+	void create(GLfloat* _pVertices, unsigned int* _pIndices, unsigned int _vertexCount, unsigned int _indexCount, GeometryPool* _pPool);
+
+	/// <summary>
+	/// Create the mesh from packed vertex buffers in buffers of its own. Quantized positions are decoded by the vertex
+	/// shader with the mesh's position scale and offset.
+	/// </summary>
+	void create(const PackedVertices& _vertices, unsigned int* _pIndices, unsigned int _indexCount);
+
+	/// <summary> Render the mesh. Depth and shadow passes draw positions only, which reads the position buffer alone when it is split. </summary>
+	void render(bool _positionsOnly = false);
+
+	/// <summary> Render the given meshlets, in increasing order, with one draw. Neighbouring meshlets are merged into one range. </summary>
+	void renderMeshlets(const GLuint* _pMeshlets, GLuint _count, bool _positionsOnly = false);
+
+	/// <summary> Set the meshlets of the mesh, whose index ranges must match the indices it was created with. </summary>
+	void setMeshlets(const std::vector<Meshlet>& _meshlets);
+
+	/// <summary> Get the meshlets of the mesh. Empty when it is drawn whole. </summary>
+	const std::vector<Meshlet>& getMeshlets() const { return mMeshlets; }
+
+	/// <summary> Get the pool holding the mesh, or null when it owns its buffers. </summary>
+	GeometryPool* getPool() const { return mpPool; }
+
+	/// <summary> Get the scale and offset that turn stored positions into local positions, one and zero unless quantized. </summary>
+	const glm::vec3& getPositionScale() const { return mPositionScale; }
+	const glm::vec3& getPositionOffset() const { return mPositionOffset; }
+
+	/// <summary> Get how the vertex normals are stored, none unless created from packed vertices with normals. </summary>
+	NormalEncoding getNormalEncoding() const { return mNormalEncoding; }
+
+	/// <summary> Get the corners of the local box around the positions, for culling. </summary>
+	const glm::vec3& getBoundsMin() const { return mBoundsMin; }
+	const glm::vec3& getBoundsMax() const { return mBoundsMax; }
 
 	/// <summary> Clear the mesh. </summary>
 	void clear();
 
 private:
+	/// <summary> Fit the local box to the positions, the first three floats of every vertex. </summary>
+	void computeBounds(const GLfloat* _pVertices, unsigned int _vertexCount, GLsizei _stride);
+
 	/// <summary> Vertex array object. </summary>
 	GLuint mVAO;
 
@@ -25,6 +105,36 @@ private:
 	/// <summary> Index buffer object. </summary>
 	GLuint mIBO;
 
+	/// <summary> Buffer of the positions and a vertex array reading only it, when positions are split. </summary>
+	GLuint mPositionVBO;
+	GLuint mPositionVAO;
+
+	/// <summary> Pool holding the mesh, or null when it owns its buffers. </summary>
+	GeometryPool* mpPool;
+
+	/// <summary> Vertex and index ranges in the pool. </summary>
+	GLuint mVertexAllocation;
+	GLuint mIndexAllocation;
+
 	/// <summary> Number of indices. </summary>
 	GLsizei mIndexCount;
-};
\ No newline at end of file
+
+	/// <summary> Local box around the positions. </summary>
+	glm::vec3 mBoundsMin;
+	glm::vec3 mBoundsMax;
+
+	/// <summary> Decoding of stored positions. </summary>
+	glm::vec3 mPositionScale;
+	glm::vec3 mPositionOffset;
+
+	/// <summary> Storage of the vertex normals. </summary>
+	NormalEncoding mNormalEncoding;
+
+	/// <summary> Clusters of the triangles. </summary>
+	std::vector<Meshlet> mMeshlets;
+
+	/// <summary> Index counts, byte offsets and base vertices of the ranges of a meshlet draw, kept between draws. </summary>
+	std::vector<GLsizei> mRangeCounts;
+	std::vector<void*> mRangeOffsets;
+	std::vector<GLint> mRangeBaseVertices;
+};
\ No newline at end of file
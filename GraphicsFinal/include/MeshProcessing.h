@@ -0,0 +1,153 @@
+#pragma once
+
+class JobSystem;
+
+/// <summary> Angle in degrees between faces up to which their normals are smoothed together. 180 smooths everything. </summary>
+const GLfloat DEFAULT_CREASE_ANGLE = 60.0f;
+
+/// <summary> Triangles per chunk of the parallel geometry loops. </summary>
+const size_t GEOMETRY_JOB_GRAIN = 16 * 1024;
+
+/// <summary> Attribute locations of packed vertices. Positions are at location zero, like in every other layout. </summary>
+const GLuint VERTEX_NORMAL_LOCATION = 1;
+const GLuint VERTEX_UV_LOCATION = 2;
+const GLuint VERTEX_TANGENT_LOCATION = 3;
+
+/// <summary> First four bytes of the binary mesh format, "GFMS" in file order. </summary>
+const GLuint MESH_FORMAT_MAGIC = 0x534D4647;
+
+/// <summary> Version of the binary mesh format, raised whenever its layout changes. </summary>
+const GLuint MESH_FORMAT_VERSION = 1;
+
+/// <summary> An indexed triangle mesh with one array per attribute, as imported before it is packed into a vertex buffer. </summary>
+struct MeshData
+{
+	/// <summary> Vertex positions. </summary>
+	std::vector<glm::vec3> positions;
+
+	/// <summary> Unit vertex normals. Empty until loaded or generated. </summary>
+	std::vector<glm::vec3> normals;
+
+	/// <summary> Texture coordinates. Empty when the mesh has none. </summary>
+	std::vector<glm::vec2> uvs;
+
+	/// <summary> Unit tangents along increasing u, with the handedness of the bitangent in w. Empty until generated. </summary>
+	std::vector<glm::vec4> tangents;
+
+	/// <summary> Three indices per triangle, counter-clockwise. </summary>
+	std::vector<GLuint> indices;
+
+	/// <summary> Clusters of the triangles, whose index ranges follow one another. Empty until built. </summary>
+	std::vector<Meshlet> meshlets;
+
+	/// <summary> Get the number of vertices. </summary>
+	size_t getVertexCount() const { return positions.size(); }
+
+	/// <summary> Get the number of triangles. </summary>
+	size_t getTriangleCount() const { return indices.size() / 3; }
+};
+
+/// <summary> How packed vertices store each attribute. The defaults halve the vertex size of a mesh with normals and texture coordinates. </summary>
+struct VertexFormat
+{
+	/// <summary> Store positions as 16 bit integers across the mesh's box, which the vertex shader scales back. </summary>
+	bool quantizePositions = true;
+
+	/// <summary> Bits per component of octahedral normals, 8 or 16. Zero stores three floats. </summary>
+	GLuint normalBits = 16;
+
+	/// <summary> Store texture coordinates as half floats. </summary>
+	bool halfUvs = true;
+
+	/// <summary> Put the positions in a buffer of their own, so depth and shadow passes fetch nothing else. </summary>
+	bool splitPositions = false;
+};
+
+/// <summary> Vertex buffers of a mesh ready to upload, with the layouts they are read with. </summary>
+struct PackedVertices
+{
+	/// <summary> Interleaved vertices: every attribute, or all but the position when positions are split. </summary>
+	std::vector<unsigned char> vertices;
+	VertexLayout layout;
+
+	/// <summary> Positions alone when split, otherwise empty. </summary>
+	std::vector<unsigned char> positions;
+	VertexLayout positionLayout;
+
+	/// <summary> Number of vertices. </summary>
+	GLuint vertexCount = 0;
+
+	/// <summary> Stored positions times the scale plus the offset are the mesh positions. </summary>
+	glm::vec3 positionScale = glm::vec3(1.0f);
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+
+	/// <summary> How the normals are stored, none when the mesh has none. </summary>
+	NormalEncoding normalEncoding = NormalEncoding::None;
+
+	/// <summary> Box around the mesh positions. </summary>
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+/// <summary>
+/// Import time processing of meshes. Loops over triangles run on a job system when one is given: every worker sums
+/// into its own per vertex arrays, and a reduction pass over the vertices adds them up, so there are no atomics or
+/// locks. The partial arrays cost one copy of the summed attribute per worker.
+/// </summary>
+class MeshProcessing
+{
+public:
+	/// <summary> Fill a mesh with the positions of interleaved vertices, the first three floats of every vertex. </summary>
+	static void loadPositions(const GLfloat* _pVertices, size_t _floatCount, GLuint _floatsPerVertex, const GLuint* _pIndices, size_t _indexCount, MeshData& _mesh);
+
+	/// <summary>
+	/// Generate smooth normals weighted by triangle area. Vertices at the same position are smoothed together, so
+	/// seams of split vertices do not show. Faces meeting at more than the crease angle (degrees) keep their own
+	/// normals: vertices on creases are split and their texture coordinates copied. Tangents are dropped, since they
+	/// follow the normals.
+	/// </summary>
+	static void generateNormals(MeshData& _mesh, GLfloat _creaseAngle = DEFAULT_CREASE_ANGLE, JobSystem* _pJobs = nullptr);
+
+	/// <summary>
+	/// Generate tangents from the texture coordinates like MikkTSpace: per triangle tangents weighted by the corner
+	/// angle, made orthogonal to the vertex normal, with the bitangent's handedness in w. Vertices are not split where
+	/// mirrored texture coordinates meet. Needs normals and texture coordinates; returns false without them.
+	/// </summary>
+	static bool generateTangents(MeshData& _mesh, JobSystem* _pJobs = nullptr);
+
+	/// <summary>
+	/// Split the triangles into meshlets of at most MAX_MESHLET_VERTICES vertices and MAX_MESHLET_TRIANGLES
+	/// triangles, reordering the indices so every meshlet is one range. Meshlets are grown greedily from a seed
+	/// triangle across shared vertices, which keeps them compact so their spheres and normal cones are tight. Build
+	/// them last: later steps that split vertices keep the ranges but may exceed the vertex limit.
+	/// </summary>
+	static void buildMeshlets(MeshData& _mesh, JobSystem* _pJobs = nullptr);
+
+	/// <summary>
+	/// Pack the mesh's streams into vertex buffers in the given format. Normals and tangents are only stored when the
+	/// mesh has them; tangents take 10 bits per axis and 2 for the handedness whenever normals are packed. The lit
+	/// programs read positions and normals; texture coordinates and tangents are for programs that sample textures.
+	/// </summary>
+	static void packVertices(const MeshData& _mesh, const VertexFormat& _format, PackedVertices& _packed);
+
+	/// <summary> Fold a unit vector onto the octahedron flattened into [-1, 1] on both axes. </summary>
+	static glm::vec2 encodeOctahedral(const glm::vec3& _direction);
+
+	/// <summary> Unfold an octahedral vector into a unit vector. </summary>
+	static glm::vec3 decodeOctahedral(const glm::vec2& _encoded);
+
+	/// <summary> Write the mesh in the binary mesh format: a header, then the positions, every other stream present, indices and meshlets. </summary>
+	static void writeMesh(const MeshData& _mesh, std::vector<unsigned char>& _bytes);
+
+	/// <summary>
+	/// Read a mesh in the binary mesh format. Returns false for data of another format, version or size, and for
+	/// indices or meshlet ranges outside the mesh.
+	/// </summary>
+	static bool readMesh(const unsigned char* _pBytes, size_t _size, MeshData& _mesh);
+
+	/// <summary> Write the mesh to a binary mesh file. </summary>
+	static bool saveMesh(const char* _pPath, const MeshData& _mesh);
+
+	/// <summary> Read a binary mesh file. </summary>
+	static bool loadMesh(const char* _pPath, MeshData& _mesh);
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+/// <summary> Maximum number of vertex attributes in a layout. </summary>
+const GLuint MAX_VERTEX_ATTRIBUTES = 8;
+
+/// <summary> Blending of the fragment output with the framebuffer. </summary>
+struct BlendState
+{
+	/// <summary> Is blending enabled? </summary>
+	bool enabled = false;
+
+	/// <summary> Source blend factor. </summary>
+	GLenum sourceFactor = GL_ONE;
+
+	/// <summary> Destination blend factor. </summary>
+	GLenum destinationFactor = GL_ZERO;
+
+	/// <summary> Blend equation. </summary>
+	GLenum equation = GL_FUNC_ADD;
+};
+
+/// <summary> Depth testing and writing. </summary>
+struct DepthState
+{
+	/// <summary> Is the depth test enabled? </summary>
+	bool testEnabled = true;
+
+	/// <summary> Are depth values written? </summary>
+	bool writeEnabled = true;
+
+	/// <summary> Depth comparison function. </summary>
+	GLenum function = GL_LESS;
+
+	/// <summary> Clip space depth range, GL_NEGATIVE_ONE_TO_ONE or GL_ZERO_TO_ONE. Zero to one needs clip control. </summary>
+	GLenum clipRange = GL_NEGATIVE_ONE_TO_ONE;
+};
+
+/// <summary> Face culling. </summary>
+struct CullState
+{
+	/// <summary> Is face culling enabled? </summary>
+	bool enabled = false;
+
+	/// <summary> Face to cull. </summary>
+	GLenum face = GL_BACK;
+
+	/// <summary> Winding of front facing triangles. </summary>
+	GLenum frontFace = GL_CCW;
+};
+
+/// <summary> Rasterizer settings. </summary>
+struct RasterState
+{
+	/// <summary> Polygon fill mode. </summary>
+	GLenum polygonMode = GL_FILL;
+
+	/// <summary> Are color values written? </summary>
+	bool colorWriteEnabled = true;
+
+	/// <summary> Is polygon offset enabled? </summary>
+	bool depthBiasEnabled = false;
+
+	/// <summary> Slope scaled polygon offset factor. </summary>
+	GLfloat depthBiasFactor = 0.0f;
+
+	/// <summary> Constant polygon offset units. </summary>
+	GLfloat depthBiasUnits = 0.0f;
+};
+
+/// <summary> A single vertex attribute read from a vertex buffer. </summary>
+struct VertexAttribute
+{
+	/// <summary> Shader attribute location. </summary>
+	GLuint location = 0;
+
+	/// <summary> Number of components (1 - 4). </summary>
+	GLint components = 3;
+
+	/// <summary> Component type in the buffer. </summary>
+	GLenum type = GL_FLOAT;
+
+	/// <summary> Are integer components normalized to [0, 1] or [-1, 1]? </summary>
+	GLboolean normalized = GL_FALSE;
+
+	/// <summary> Byte offset from the start of the vertex. </summary>
+	GLuint offset = 0;
+};
+
+/// <summary> Description of the vertex format read by a pipeline. </summary>
+struct VertexLayout
+{
+	/// <summary> Attributes of the layout. </summary>
+	VertexAttribute attributes[MAX_VERTEX_ATTRIBUTES];
+
+	/// <summary> Number of attributes used. </summary>
+	GLuint attributeCount = 0;
+
+	/// <summary> Byte size of one vertex. </summary>
+	GLsizei stride = 0;
+
+	/// <summary> Layout holding a single vec3 position at location 0. </summary>
+	static VertexLayout position();
+
+	/// <summary> Append an attribute to the end of the vertex. </summary>
+	VertexLayout& add(GLuint _location, GLint _components, GLenum _type, GLboolean _normalized = GL_FALSE);
+
+	/// <summary> Set the attribute pointers for the currently bound VAO and VBO. </summary>
+	void apply() const;
+};
+
+/// <summary> Everything needed to create a pipeline state object. </summary>
+struct PipelineStateDesc
+{
+	/// <summary> Shader program id. </summary>
+	GLuint program = 0;
+
+	/// <summary> Blend state. </summary>
+	BlendState blend;
+
+	/// <summary> Depth state. </summary>
+	DepthState depth;
+
+	/// <summary> Cull state. </summary>
+	CullState cull;
+
+	/// <summary> Raster state. </summary>
+	RasterState raster;
+
+	/// <summary> Vertex layout read by the program. </summary>
+	VertexLayout vertexLayout;
+};
+
+/// <summary> Compare two pipeline descriptions field by field. </summary>
+bool operator==(const PipelineStateDesc& _left, const PipelineStateDesc& _right);
+
+/// <summary> Immutable pipeline state. Created and owned by a PipelineCache. </summary>
+class PipelineState
+{
+public:
+	/// <summary> Get the description of the state. </summary>
+	const PipelineStateDesc& getDesc() const { return mDesc; }
+
+	/// <summary> Get the hash of the description. </summary>
+	size_t getHash() const { return mHash; }
+
+private:
+	friend class PipelineCache;
+
+	PipelineState(const PipelineStateDesc& _desc, size_t _hash) : mDesc(_desc), mHash(_hash) {}
+
+	/// <summary> Description the state was created from. </summary>
+	const PipelineStateDesc mDesc;
+
+	/// <summary> Hash of the description. </summary>
+	const size_t mHash;
+};
+
+/// <summary> Creates and deduplicates pipeline state objects. </summary>
+class PipelineCache
+{
+public:
+	PipelineCache() {}
+	~PipelineCache();
+
+	/// <summary> Get the pipeline state for a description, creating it if it does not exist. </summary>
+	const PipelineState* create(const PipelineStateDesc& _desc);
+
+	/// <summary> Get the number of unique pipeline states. </summary>
+	size_t getSize() const { return mStates.size(); }
+
+	/// <summary> Hash a pipeline description. </summary>
+	static size_t hash(const PipelineStateDesc& _desc);
+
+private:
+	/// <summary> Pipeline states keyed by their description hash. </summary>
+	std::unordered_multimap<size_t, PipelineState*> mStates;
+};
+
+/// <summary> Tracks the GL state and only applies what changes between pipeline states. </summary>
+class StateTracker
+{
+public:
+	StateTracker();
+
+	/// <summary> Force the GL state to match the tracked defaults. Call after context creation. </summary>
+	void reset();
+
+	/// <summary> Bind a pipeline state, applying only the state that differs from the bound one. </summary>
+	void bind(const PipelineState* _pState);
+
+	/// <summary> Clear the bound framebuffer, enabling the writes glClear respects. Reverse-Z clears depth to zero. </summary>
+	void clear(GLbitfield _mask, GLfloat _red, GLfloat _green, GLfloat _blue, GLfloat _alpha, GLfloat _depth = 1.0f);
+
+	/// <summary> Is the zero to one clip range supported (GL 4.5 or ARB_clip_control)? </summary>
+	static bool supportsClipControl();
+
+	/// <summary> Get the currently bound pipeline state. </summary>
+	const PipelineState* getBound() const { return mpBound; }
+
+	/// <summary> Get the number of GL state calls made since the last reset of the counter. </summary>
+	GLuint getStateChangeCount() const { return mStateChangeCount; }
+
+	/// <summary> Reset the state change counter. </summary>
+	void resetStateChangeCount() { mStateChangeCount = 0; }
+
+private:
+	/// <summary> State currently set in GL. </summary>
+	PipelineStateDesc mCurrent;
+
+	/// <summary> Currently bound pipeline state. </summary>
+	const PipelineState* mpBound;
+
+	/// <summary> Number of GL state calls made. </summary>
+	GLuint mStateChangeCount;
+
+	/// <summary> Depth value glClear writes. </summary>
+	GLfloat mClearDepth;
+
+	/// <summary> Enable or disable a GL capability. </summary>
+	void setCapability(GLenum _capability, bool _enabled);
+
+	/// <summary> Apply the differences between the current and the given state. </summary>
+	void apply(const PipelineStateDesc& _desc, bool _force);
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+class Shader;
+class RenderGraph;
+
+/// <summary> First texture unit of the post processing inputs. The HDR color and bloom use two units. </summary>
+const GLuint POST_TEXTURE_UNIT = 0;
+
+/// <summary> How a lower resolution image is scaled up to the backbuffer. </summary>
+enum class UpscaleFilter
+{
+	/// <summary> Hardware bilinear filtering. </summary>
+	Bilinear,
+
+	/// <summary> Lanczos-like kernel stretched along local edges, in the style of FSR 1 EASU. </summary>
+	EdgeAdaptive
+};
+
+/// <summary> Bloom, tone mapping and upscaling passes from the HDR scene color to the backbuffer. </summary>
+class PostProcess
+{
+public:
+	PostProcess();
+	~PostProcess();
+
+	/// <summary> Load the shaders and create the pipelines. The context must be current. </summary>
+	int initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache);
+
+	/// <summary> Add the post passes reading the HDR color to a graph. The last pass writes the output. </summary>
+	void addPasses(RenderGraph& _graph, GLuint _hdr, GLuint _output);
+
+	/// <summary> Add a pass scaling a display color texture up to the backbuffer. </summary>
+	void addUpscalePass(RenderGraph& _graph, GLuint _source);
+
+	/// <summary> Enable bloom. Disabled bloom passes are culled by the graph. </summary>
+	void setBloom(bool _enabled) { mBloom = _enabled; }
+
+	/// <summary> Is bloom enabled? </summary>
+	bool getBloom() const { return mBloom; }
+
+	/// <summary> Set the exposure multiplier applied before tone mapping. </summary>
+	void setExposure(GLfloat _exposure) { mExposure = _exposure; }
+
+	/// <summary> Get the exposure multiplier. </summary>
+	GLfloat getExposure() const { return mExposure; }
+
+	/// <summary> Choose the upscaling filter. </summary>
+	void setUpscaleFilter(UpscaleFilter _filter) { mUpscaleFilter = _filter; }
+
+	/// <summary> Get the upscaling filter. </summary>
+	UpscaleFilter getUpscaleFilter() const { return mUpscaleFilter; }
+
+	/// <summary> Delete the shaders. </summary>
+	void clear();
+
+private:
+	/// <summary> Tracker every pipeline is bound through. </summary>
+	StateTracker* mpStateTracker;
+
+	/// <summary> Program keeping the bright parts of the scene at half resolution. </summary>
+	Shader* mpBrightShader;
+	const PipelineState* mpBrightPipeline;
+
+	/// <summary> Separable gaussian blur program. </summary>
+	Shader* mpBlurShader;
+	const PipelineState* mpBlurPipeline;
+
+	/// <summary> Program adding bloom and mapping HDR color to the display. </summary>
+	Shader* mpTonemapShader;
+	const PipelineState* mpTonemapPipeline;
+
+	/// <summary> Program scaling the display image up to the backbuffer. </summary>
+	Shader* mpUpscaleShader;
+	const PipelineState* mpUpscalePipeline;
+
+	/// <summary> Upscaling filter. </summary>
+	UpscaleFilter mUpscaleFilter;
+
+	/// <summary> Is bloom enabled? </summary>
+	bool mBloom;
+
+	/// <summary> Exposure multiplier. </summary>
+	GLfloat mExposure;
+
+	/// <summary> Brightness above which pixels bloom. </summary>
+	GLfloat mBloomThreshold;
+
+	/// <summary> Amount of bloom added to the scene. </summary>
+	GLfloat mBloomStrength;
+
+	/// <summary> Load a full screen program and create its pipeline without depth. </summary>
+	Shader* createShader(const char* _pFragmentFile, const PipelineState** _ppPipeline, PipelineCache* _pPipelineCache);
+};
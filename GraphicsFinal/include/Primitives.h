@@ -0,0 +1,36 @@
+#pragma once
+
+class Mesh;
+class GeometryPool;
+
+/// <summary> Procedurally generated meshes. </summary>
+class Primitives
+{
+public:
+	/// <summary> Create the four sided pyramid used by the demo. Meshes given a pool are placed in its shared buffers. </summary>
+	static Mesh* createTetrahedron(GeometryPool* _pPool = nullptr);
+
+	/// <summary> Create the pyramid in an existing mesh, such as one from an object pool. </summary>
+	static void createTetrahedron(Mesh& _mesh, GeometryPool* _pPool = nullptr);
+
+	/// <summary> Fill the positions and indices of the pyramid without creating a mesh. </summary>
+	static void generateTetrahedron(std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices);
+
+	/// <summary> Create a unit sphere with the given number of rings and segments. </summary>
+	static Mesh* createSphere(GLuint _rings, GLuint _segments, GeometryPool* _pPool = nullptr);
+
+	/// <summary> Create the sphere in an existing mesh. </summary>
+	static void createSphere(Mesh& _mesh, GLuint _rings, GLuint _segments, GeometryPool* _pPool = nullptr);
+
+	/// <summary> Fill the positions and indices of the sphere without creating a mesh. </summary>
+	static void generateSphere(GLuint _rings, GLuint _segments, std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices);
+
+	/// <summary> Create a square from -1 to 1 in the xz plane, facing up. </summary>
+	static Mesh* createPlane(GeometryPool* _pPool = nullptr);
+
+	/// <summary> Create the square in an existing mesh. </summary>
+	static void createPlane(Mesh& _mesh, GeometryPool* _pPool = nullptr);
+
+	/// <summary> Fill the positions and indices of the square without creating a mesh. </summary>
+	static void generatePlane(std::vector<GLfloat>& _vertices, std::vector<unsigned int>& _indices);
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+/// <summary> Number of GPU timer queries kept in flight. </summary>
+const GLuint PROFILER_QUERY_COUNT = 8;
+
+/// <summary> Work counted while rendering. </summary>
+struct FrameStats
+{
+	/// <summary> Number of draw calls issued. </summary>
+	unsigned long long drawCalls = 0;
+
+	/// <summary> Number of triangles submitted. </summary>
+	unsigned long long triangles = 0;
+
+	/// <summary> Number of bytes uploaded to the GPU. </summary>
+	unsigned long long bytesUploaded = 0;
+
+	/// <summary> Number of fragments written by the shading pass, from occlusion queries a few frames late. </summary>
+	unsigned long long fragmentsShaded = 0;
+};
+
+/// <summary> Counts rendering work and times frames on the CPU and GPU. </summary>
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler() {}
+
+	/// <summary> Create the GPU timer queries. The context must be current. </summary>
+	void initialize();
+
+	/// <summary> Start timing a frame. </summary>
+	void beginFrame();
+
+	/// <summary> Stop timing a frame. </summary>
+	void endFrame();
+
+	/// <summary> Wait for all outstanding GPU timings. </summary>
+	void flush();
+
+	/// <summary> Delete the GPU timer queries. </summary>
+	void clear();
+
+	/// <summary> Get the number of frames timed on the CPU. </summary>
+	unsigned long long getFrameCount() const { return mFrameCount; }
+
+	/// <summary> Get the total CPU time of all frames in milliseconds. </summary>
+	double getCpuTime() const { return mCpuTime; }
+
+	/// <summary> Get the number of frames timed on the GPU. </summary>
+	unsigned long long getGpuFrameCount() const { return mGpuFrameCount; }
+
+	/// <summary> Get the total GPU time of all frames in milliseconds. </summary>
+	double getGpuTime() const { return mGpuTime; }
+
+	/// <summary> Get the GPU time of the most recently resolved frame in milliseconds. </summary>
+	double getLastGpuTime() const { return mLastGpuTime; }
+
+	/// <summary> Reset the CPU and GPU totals. </summary>
+	void resetTimes();
+
+	/// <summary> Get the global render counters. </summary>
+	static FrameStats& stats();
+
+	/// <summary> Count a draw call with the given number of indices. </summary>
+	static void countDraw(GLsizei _indexCount);
+
+	/// <summary> Count bytes uploaded to the GPU. </summary>
+	static void countUpload(size_t _bytes);
+
+	/// <summary> Count fragments written by the shading pass. </summary>
+	static void countFragments(unsigned long long _fragments);
+
+private:
+	/// <summary> GPU timer queries used as a ring buffer. </summary>
+	GLuint mQueries[PROFILER_QUERY_COUNT];
+
+	/// <summary> Next query to issue. </summary>
+	GLuint mQueryWrite;
+
+	/// <summary> Oldest query that has not been read. </summary>
+	GLuint mQueryRead;
+
+	/// <summary> CPU time the current frame started in seconds. </summary>
+	double mFrameStart;
+
+	/// <summary> Number of frames timed on the CPU. </summary>
+	unsigned long long mFrameCount;
+
+	/// <summary> Total CPU time in milliseconds. </summary>
+	double mCpuTime;
+
+	/// <summary> Number of frames timed on the GPU. </summary>
+	unsigned long long mGpuFrameCount;
+
+	/// <summary> Total GPU time in milliseconds. </summary>
+	double mGpuTime;
+
+	/// <summary> GPU time of the most recently resolved frame in milliseconds. </summary>
+	double mLastGpuTime;
+
+	/// <summary> Read finished queries. Blocks on every query when wait is set. </summary>
+	void resolve(bool _wait);
+
+	/// <summary> Read the oldest outstanding query. </summary>
+	void readOldest();
+};
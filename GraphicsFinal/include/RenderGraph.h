@@ -0,0 +1,204 @@
+#pragma once
+
+class RenderGraph;
+
+/// <summary> Resource handle of the default framebuffer. It exists in every frame and keeps the passes writing it alive. </summary>
+const GLuint BACKBUFFER_RESOURCE = 0;
+
+/// <summary> Size and format of a graph texture. </summary>
+struct TextureDesc
+{
+	/// <summary> Width in pixels. </summary>
+	GLsizei width = 0;
+
+	/// <summary> Height in pixels. </summary>
+	GLsizei height = 0;
+
+	/// <summary> Sized internal format, color or depth. </summary>
+	GLenum internalFormat = GL_RGBA8;
+};
+
+/// <summary> Compare two texture descriptions field by field. </summary>
+bool operator==(const TextureDesc& _left, const TextureDesc& _right);
+
+/// <summary> Calls a pass's work, stored in the frame arena, once its targets are bound. </summary>
+typedef void (*RenderPassInvoker)(const void* _pFunction, RenderGraph& _graph);
+
+/// <summary>
+/// Frame graph of render passes. Passes declare the textures they read and write every frame; compile() orders
+/// them, culls the ones nothing depends on and places transient textures with disjoint lifetimes in the same memory.
+/// </summary>
+class RenderGraph
+{
+public:
+	RenderGraph();
+	~RenderGraph();
+
+	/// <summary> Create the vertex array for full screen passes. Per frame data goes in the arena. The context must be current. </summary>
+	void initialize(FrameArena* _pArena);
+
+	/// <summary> Drop last frame's passes and resources. Physical textures and framebuffers are kept for reuse. Call after resetting the arena. </summary>
+	void reset(GLsizei _backbufferWidth, GLsizei _backbufferHeight);
+
+	/// <summary> Declare a transient texture that only lives within this frame. </summary>
+	GLuint createTexture(const char* _pName, const TextureDesc& _desc);
+
+	/// <summary> Declare a texture owned outside the graph, such as history kept between frames. It is never aliased. </summary>
+	GLuint importTexture(const char* _pName, GLuint _texture, const TextureDesc& _desc);
+
+	/// <summary> Add a pass run by execute(). The function is copied into the frame arena without ever being destroyed. Returns the pass index for declaring reads and writes. </summary>
+	template<typename Function>
+	GLuint addPass(const char* _pName, const Function& _function)
+	{
+		static_assert(std::is_trivially_destructible<Function>::value, "Render pass functions must be trivially destructible.");
+
+		void* pFunction = mpArena->allocate(sizeof(Function), alignof(Function));
+		new (pFunction) Function(_function);
+
+		return addPass(_pName, pFunction, &invoke<Function>);
+	}
+
+	/// <summary> Declare that a pass samples a resource. </summary>
+	void read(GLuint _pass, GLuint _resource);
+
+	/// <summary> Declare that a pass renders into a resource. Color writes bind in declaration order. </summary>
+	void write(GLuint _pass, GLuint _resource);
+
+	/// <summary> Order the passes, cull unused ones and assign physical textures. </summary>
+	void compile();
+
+	/// <summary> Run the compiled passes with their targets bound. </summary>
+	void execute();
+
+	/// <summary> Get the GL texture behind a resource. Valid while executing. </summary>
+	GLuint getTexture(GLuint _resource) const;
+
+	/// <summary> Get the description of a resource. </summary>
+	const TextureDesc& getDesc(GLuint _resource) const { return mResources[_resource].desc; }
+
+	/// <summary> Bind a resource's texture to a texture unit. </summary>
+	void bindTexture(GLuint _resource, GLuint _unit) const;
+
+	/// <summary> Draw one triangle covering the bound target. </summary>
+	void drawFullscreenTriangle() const;
+
+	/// <summary> Get the number of passes declared this frame. </summary>
+	GLuint getPassCount() const { return mPassCount; }
+
+	/// <summary> Get the number of passes culled this frame. </summary>
+	GLuint getCulledPassCount() const { return mCulledPassCount; }
+
+	/// <summary> Get the number of physical textures backing this frame's transient resources. </summary>
+	GLuint getPhysicalTextureCount() const { return (GLuint)mTextures.size(); }
+
+	/// <summary> Get the memory of the physical textures in bytes. </summary>
+	size_t getTransientBytes() const { return mTransientBytes; }
+
+	/// <summary> Get the memory the used transient resources would take without aliasing, in bytes. </summary>
+	size_t getUnaliasedBytes() const { return mUnaliasedBytes; }
+
+	/// <summary> Delete the cached framebuffers. Call after deleting a texture that was imported. </summary>
+	void clearFramebuffers();
+
+	/// <summary> Delete the physical textures, framebuffers and vertex array. </summary>
+	void clear();
+
+private:
+	/// <summary> Call a pass function of a known type. </summary>
+	template<typename Function>
+	static void invoke(const void* _pFunction, RenderGraph& _graph) { (*(const Function*)_pFunction)(_graph); }
+
+	/// <summary> Add a pass whose function is already in the arena. </summary>
+	GLuint addPass(const char* _pName, const void* _pFunction, RenderPassInvoker _invoker);
+
+	/// <summary> A texture declared by the frame. </summary>
+	struct GraphResource
+	{
+		/// <summary> Name for debugging. Must outlive the frame, such as a string literal. </summary>
+		const char* pName;
+
+		/// <summary> Size and format. </summary>
+		TextureDesc desc;
+
+		/// <summary> Index of the physical texture, or none for the backbuffer and imported textures. </summary>
+		GLuint physical;
+
+		/// <summary> GL texture of an imported resource, zero for transient ones. </summary>
+		GLuint external;
+
+		/// <summary> Execution order positions of the first and last pass using the resource. </summary>
+		GLuint firstUse;
+		GLuint lastUse;
+	};
+
+	/// <summary> A pass declared by the frame. </summary>
+	struct GraphPass
+	{
+		/// <summary> Name for debugging. Must outlive the frame, such as a string literal. </summary>
+		const char* pName;
+
+		/// <summary> Work run with the targets bound, in the frame arena, and the function calling it. </summary>
+		const void* pFunction;
+		RenderPassInvoker invoker;
+
+		/// <summary> Resources sampled and rendered into. </summary>
+		std::vector<GLuint> reads;
+		std::vector<GLuint> writes;
+
+		/// <summary> Is the pass needed for the backbuffer? </summary>
+		bool used;
+	};
+
+	/// <summary> A GL texture shared by transient resources with disjoint lifetimes. </summary>
+	struct PhysicalTexture
+	{
+		/// <summary> Size and format. </summary>
+		TextureDesc desc;
+
+		/// <summary> GL texture id. </summary>
+		GLuint texture;
+
+		/// <summary> Execution order position after which the texture is free this frame. </summary>
+		GLuint busyUntil;
+
+		/// <summary> Was the texture assigned this frame? </summary>
+		bool used;
+	};
+
+	/// <summary> Resources and passes of the current frame. Passes are reused between frames to keep their lists' memory. </summary>
+	std::vector<GraphResource> mResources;
+	std::vector<GraphPass> mPasses;
+	GLuint mPassCount;
+
+	/// <summary> Allocator of per frame data, reset by the owner. </summary>
+	FrameArena* mpArena;
+
+	/// <summary> Used passes in execution order. </summary>
+	std::vector<GLuint> mOrder;
+
+	/// <summary> Physical textures kept between frames. </summary>
+	std::vector<PhysicalTexture> mTextures;
+
+	/// <summary> Framebuffers by their attached textures, kept between frames. </summary>
+	std::map<std::vector<GLuint>, GLuint> mFramebuffers;
+
+	/// <summary> Scratch key for framebuffer lookups. </summary>
+	std::vector<GLuint> mFramebufferKey;
+
+	/// <summary> Vertex array for the full screen triangle, which has no attributes. </summary>
+	GLuint mEmptyVertexArray;
+
+	/// <summary> Statistics of the last compile. </summary>
+	GLuint mCulledPassCount;
+	size_t mTransientBytes;
+	size_t mUnaliasedBytes;
+
+	/// <summary> Must the other pass run before the pass? </summary>
+	bool dependsOn(GLuint _pass, GLuint _other) const;
+
+	/// <summary> Find or create a physical texture that is free at the given order position. </summary>
+	GLuint allocate(const TextureDesc& _desc, GLuint _position, GLuint _until);
+
+	/// <summary> Find or create the framebuffer for a pass's writes. </summary>
+	GLuint getFramebuffer(const GraphPass& _pass);
+};
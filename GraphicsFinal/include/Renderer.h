@@ -0,0 +1,391 @@
+#pragma once
+
+class Mesh;
+class Shader;
+class JobSystem;
+
+/// <summary> Draws per chunk of the parallel meshlet culling. </summary>
+const size_t MESHLET_CULL_GRAIN = 8;
+
+/// <summary> Bytes per pixel of the G-buffer: RGBA8 albedo and material, RG16 normal and 24 bit depth padded to 32 bits. </summary>
+const GLuint GBUFFER_BYTES_PER_PIXEL = 12;
+
+/// <summary> First texture unit of the G-buffer. The albedo, normal and depth use three units. </summary>
+const GLuint GBUFFER_TEXTURE_UNIT = 0;
+
+/// <summary> How the renderer shades a scene. </summary>
+enum class RenderPath
+{
+	/// <summary> Light every fragment while drawing it. </summary>
+	Forward,
+
+	/// <summary> Write a G-buffer, then light every pixel once. </summary>
+	Deferred
+};
+
+/// <summary> A mesh to draw with its model matrix. </summary>
+struct DrawItem
+{
+	/// <summary> Mesh to draw. </summary>
+	Mesh* pMesh = nullptr;
+
+	/// <summary> Object to world transform. </summary>
+	glm::mat4 model = glm::mat4(1.0f);
+
+	/// <summary> Surface roughness from 0 to 1. </summary>
+	GLfloat roughness = 0.5f;
+
+	/// <summary> Surface metalness from 0 to 1. </summary>
+	GLfloat metalness = 0.0f;
+
+	/// <summary> Does the item never move? Only static items are drawn into the cached shadow cascades. </summary>
+	bool staticGeometry = false;
+};
+
+/// <summary> A draw item with its view depth, for front to back ordering. </summary>
+struct SortedDraw
+{
+	/// <summary> Distance of the item's origin along the view direction. </summary>
+	GLfloat depth;
+
+	/// <summary> Item to draw. </summary>
+	const DrawItem* pItem;
+
+	/// <summary> Model transform of the item in the last frame, for motion vectors. </summary>
+	const glm::mat4* pPreviousModel;
+
+	/// <summary> Were the item's meshlets culled? Otherwise the whole mesh is drawn. </summary>
+	bool meshletsCulled;
+
+	/// <summary> Range of the item's visible meshlets in the renderer's list. </summary>
+	GLuint firstMeshlet;
+	GLuint meshletCount;
+};
+
+/// <summary> A light infinitely far away, such as the sun. </summary>
+struct DirectionalLight
+{
+	/// <summary> Direction the light travels in world space. </summary>
+	glm::vec3 direction = glm::vec3(-0.4f, -1.0f, -0.3f);
+
+	/// <summary> Linear color of the light. </summary>
+	glm::vec3 color = glm::vec3(1.0f);
+
+	/// <summary> Brightness multiplier. Zero turns the light off. </summary>
+	GLfloat intensity = 0.0f;
+
+	/// <summary> Does the light cast cascaded shadows? </summary>
+	bool castShadows = true;
+};
+
+/// <summary> The camera and target a frame is rendered for. </summary>
+struct RenderView
+{
+	/// <summary> World to view space transform, with the world relative to the renderer's origin. </summary>
+	glm::mat4 view = glm::mat4(1.0f);
+
+	/// <summary> View to clip space transform. </summary>
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	/// <summary> Vertical field of view in radians. </summary>
+	GLfloat fieldOfView = glm::radians(45.0f);
+
+	/// <summary> Near plane distance. </summary>
+	GLfloat nearPlane = 0.1f;
+
+	/// <summary> Far plane distance. A reverse-Z projection has none; this is then how far lights are clustered and shadows cast. </summary>
+	GLfloat farPlane = 100.0f;
+
+	/// <summary> Width of the render target in pixels. </summary>
+	GLint width = 800;
+
+	/// <summary> Height of the render target in pixels. </summary>
+	GLint height = 600;
+};
+
+/// <summary> Draws lit scenes with clustered forward or deferred shading, as a render graph ending in post processing. </summary>
+class Renderer
+{
+public:
+	Renderer();
+	~Renderer();
+
+	/// <summary> Load the shaders and create the lighting buffers. The context must be current. </summary>
+	int initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache);
+
+	/// <summary> Choose forward or deferred shading. </summary>
+	void setPath(RenderPath _path) { mPath = _path; }
+
+	/// <summary> Get the shading path. </summary>
+	RenderPath getPath() const { return mPath; }
+
+	/// <summary> Draw the depth of every item before shading, so only visible fragments are shaded. </summary>
+	void setDepthPrepass(bool _enabled) { mDepthPrepass = _enabled; }
+
+	/// <summary> Is the depth pre-pass enabled? </summary>
+	bool getDepthPrepass() const { return mDepthPrepass; }
+
+	/// <summary>
+	/// Expect reverse-Z projections with an infinite far plane. Depth runs from one at the near plane to zero at
+	/// infinity in a 32 bit float buffer, keeping precision even far away. Needs clip control; stays off without it.
+	/// </summary>
+	void setReverseZ(bool _enabled);
+
+	/// <summary> Is reverse-Z enabled? </summary>
+	bool getReverseZ() const { return mReverseZ; }
+
+	/// <summary> Skip items whose world box is outside the view frustum. Shadows still draw every item. </summary>
+	void setFrustumCulling(bool _enabled) { mFrustumCulling = _enabled; }
+
+	/// <summary> Is frustum culling enabled? </summary>
+	bool getFrustumCulling() const { return mFrustumCulling; }
+
+	/// <summary> Get the number of items the last frame culled. </summary>
+	size_t getCulledItems() const { return mCulledItems; }
+
+	/// <summary>
+	/// Also cull the meshlets of visible items that have them, by their spheres against the frustum and by their
+	/// normal cones facing away from the camera. Large meshes then draw only the clusters that can be seen. Back
+	/// facing meshlets are culled for counter-clockwise front faces. The depth pre-pass draws the same meshlets;
+	/// shadows draw whole meshes, since they are seen from the light.
+	/// </summary>
+	void setMeshletCulling(bool _enabled) { mMeshletCulling = _enabled; }
+
+	/// <summary> Is meshlet culling enabled? </summary>
+	bool getMeshletCulling() const { return mMeshletCulling; }
+
+	/// <summary> Get the number of meshlets of visible items the last frame culled. </summary>
+	size_t getCulledMeshlets() const { return mCulledMeshlets; }
+
+	/// <summary> Cull the meshlets of several items at once on these jobs. Without them culling runs on the caller. </summary>
+	void setJobSystem(JobSystem* _pJobs) { mpJobs = _pJobs; }
+
+	/// <summary> Enable bloom. </summary>
+	void setBloom(bool _enabled) { mPostProcess.setBloom(_enabled); }
+
+	/// <summary> Get the post processing passes. </summary>
+	PostProcess& getPostProcess() { return mPostProcess; }
+
+	/// <summary> Enable temporal anti-aliasing. </summary>
+	void setTemporalAA(bool _enabled) { mTemporalAA.setEnabled(_enabled); }
+
+	/// <summary> Get the temporal anti-aliasing. </summary>
+	TemporalAA& getTemporalAA() { return mTemporalAA; }
+
+	/// <summary> Get the dynamic resolution controller. </summary>
+	DynamicResolution& getResolution() { return mResolution; }
+
+	/// <summary> Get the allocator of per frame data. Allocations stay valid until the end of the next render(). </summary>
+	FrameArena& getFrameArena() { return mFrameArena; }
+
+	/// <summary> Get the render graph of the last frame, for its statistics. </summary>
+	const RenderGraph& getGraph() const { return mGraph; }
+
+	/// <summary> Get the fragments written by the shading pass of the most recently resolved frame. </summary>
+	unsigned long long getShadedFragments() const { return mShadedFragments; }
+
+	/// <summary> Get the G-buffer bytes written and read by the most recently resolved deferred frame. </summary>
+	unsigned long long getGBufferBytes() const { return mGBufferBytes; }
+
+	/// <summary> Get the directional light of the scene. </summary>
+	DirectionalLight& getSun() { return mSun; }
+
+	/// <summary> Get the shadow cascades of the directional light. </summary>
+	ShadowCascades& getShadows() { return mShadows; }
+
+	/// <summary> Get the point lights of the scene. Positions are relative to the origin. </summary>
+	std::vector<PointLight>& getLights() { return mLights; }
+
+	/// <summary>
+	/// Move the world position that the view, items and lights are relative to, such as a camera's floating origin.
+	/// Lights and last frame's transforms are shifted to stay in place and the cached shadows are rendered again.
+	/// </summary>
+	void setOrigin(const glm::dvec3& _origin);
+
+	/// <summary> Get the world position the scene is relative to. </summary>
+	const glm::dvec3& getOrigin() const { return mOrigin; }
+
+	/// <summary> Get the clustered light assignment. </summary>
+	ClusteredLighting& getLighting() { return mLighting; }
+
+	/// <summary> Clear the target and draw the items lit by the scene's lights. Items are matched with the last frame's by index for motion vectors. </summary>
+	void render(const RenderView& _view, const std::vector<DrawItem>& _items);
+
+	/// <summary> Delete the shaders, graph textures, shadow maps and lighting buffers. </summary>
+	void clear();
+
+private:
+	/// <summary> Tracker every pipeline is bound through. </summary>
+	StateTracker* mpStateTracker;
+
+	/// <summary> Cache the pipelines are created from. </summary>
+	PipelineCache* mpPipelineCache;
+
+	/// <summary> Clustered forward shading program. </summary>
+	Shader* mpForwardShader;
+
+	/// <summary> Opaque pipeline of the forward program. </summary>
+	const PipelineState* mpForwardPipeline;
+
+	/// <summary> Forward pipeline testing equal against pre-pass depth, without writing it. </summary>
+	const PipelineState* mpForwardEqualPipeline;
+
+	/// <summary> Position only program for the depth pre-pass. </summary>
+	Shader* mpDepthShader;
+
+	/// <summary> Depth only pipeline of the pre-pass. </summary>
+	const PipelineState* mpDepthPipeline;
+
+	/// <summary> Program writing the G-buffer. </summary>
+	Shader* mpGBufferShader;
+
+	/// <summary> Opaque pipeline of the G-buffer program. </summary>
+	const PipelineState* mpGBufferPipeline;
+
+	/// <summary> G-buffer pipeline testing equal against pre-pass depth, without writing it. </summary>
+	const PipelineState* mpGBufferEqualPipeline;
+
+	/// <summary> Full screen program lighting the G-buffer. </summary>
+	Shader* mpLightingShader;
+
+	/// <summary> Pipeline of the lighting program without depth. </summary>
+	const PipelineState* mpLightingPipeline;
+
+	/// <summary> Layered program drawing depth into every shadow cascade at once. </summary>
+	Shader* mpShadowShader;
+
+	/// <summary> Depth only pipeline of the shadow program with slope scaled bias. </summary>
+	const PipelineState* mpShadowPipeline;
+
+	/// <summary> Shading path. </summary>
+	RenderPath mPath;
+
+	/// <summary> Is the depth pre-pass enabled? </summary>
+	bool mDepthPrepass;
+
+	/// <summary> Is depth reversed with a zero to one clip range? </summary>
+	bool mReverseZ;
+
+	/// <summary> Is frustum culling enabled? </summary>
+	bool mFrustumCulling;
+
+	/// <summary> Number of items the last frame culled. </summary>
+	size_t mCulledItems;
+
+	/// <summary> Models, local boxes and world boxes of the current frame's items, gathered for the batch kernels. </summary>
+	std::vector<glm::mat4> mCullModels;
+	BoundsSoA mLocalBounds;
+	BoundsSoA mWorldBounds;
+
+	/// <summary> Indices of the items inside the frustum. </summary>
+	std::vector<GLuint> mVisibleItems;
+
+	/// <summary> Is meshlet culling enabled? </summary>
+	bool mMeshletCulling;
+
+	/// <summary> Number of meshlets the last frame culled. </summary>
+	size_t mCulledMeshlets;
+
+	/// <summary> Visible meshlets of every sorted draw, one range per draw. </summary>
+	std::vector<GLuint> mVisibleMeshlets;
+
+	/// <summary> Workers meshlets are culled on, or null. </summary>
+	JobSystem* mpJobs;
+
+	/// <summary> Visible items of the current frame sorted front to back. </summary>
+	std::vector<SortedDraw> mDrawOrder;
+
+	/// <summary> Per frame data such as the graph's passes, freed at the end of every frame. </summary>
+	FrameArena mFrameArena;
+
+	/// <summary> Passes and transient targets of the frame. </summary>
+	RenderGraph mGraph;
+
+	/// <summary> Bloom, tone mapping and upscaling. </summary>
+	PostProcess mPostProcess;
+
+	/// <summary> Render resolution chosen from GPU time. </summary>
+	DynamicResolution mResolution;
+
+	/// <summary> Jitter and history resolve. </summary>
+	TemporalAA mTemporalAA;
+
+	/// <summary> Unjittered view projection of this frame and the last. </summary>
+	glm::mat4 mViewProjection;
+	glm::mat4 mPreviousViewProjection;
+
+	/// <summary> Model transforms of the last frame's items. </summary>
+	std::vector<glm::mat4> mPreviousModels;
+
+	/// <summary> Samples passed queries of the shading pass, alternated between frames. </summary>
+	GLuint mSampleQueries[2];
+
+	/// <summary> Number of frames rendered. </summary>
+	unsigned long long mFrameCount;
+
+	/// <summary> Fragments written by the shading pass of the most recently resolved frame. </summary>
+	unsigned long long mShadedFragments;
+
+	/// <summary> G-buffer traffic of the most recently resolved deferred frame. </summary>
+	unsigned long long mGBufferBytes;
+
+	/// <summary> Point lights of the scene. </summary>
+	std::vector<PointLight> mLights;
+
+	/// <summary> World position the scene is relative to. </summary>
+	glm::dvec3 mOrigin;
+
+	/// <summary> Light to cluster assignment. </summary>
+	ClusteredLighting mLighting;
+
+	/// <summary> Directional light of the scene. </summary>
+	DirectionalLight mSun;
+
+	/// <summary> Shadow maps of the directional light. </summary>
+	ShadowCascades mShadows;
+
+	/// <summary> Load a program from a vertex shader and a fragment shader linked with the clustered lighting functions. </summary>
+	Shader* createShader(const char* _pVertexFile, const char* _pFragmentFile, bool _lit);
+
+	/// <summary> Create the pipelines drawing the scene, whose depth test depends on reverse-Z. </summary>
+	void createScenePipelines();
+
+	/// <summary> Draw the sorted items with the bound program, setting the model, position decoding and material uniforms. </summary>
+	void drawItems(Shader* _pShader, bool _positionsOnly = false);
+
+	/// <summary> Cull the items outside the view, then sort the rest front to back so early depth testing rejects hidden fragments. </summary>
+	void sortItems(const RenderView& _view, const std::vector<DrawItem>& _items);
+
+	/// <summary> Cull the meshlets of the sorted items that have them. </summary>
+	void cullMeshlets(const RenderView& _view);
+
+	/// <summary> Draw the depth of the sorted items. </summary>
+	void renderDepth(const RenderView& _view);
+
+	/// <summary> Read the shading pass query issued two frames ago if it is ready. </summary>
+	void resolveFragmentQuery(const RenderView& _view);
+
+	/// <summary> Bind the clustered lights, sun and shadows to a lit program. </summary>
+	void bindLighting(Shader* _pShader, const RenderView& _view);
+
+	/// <summary> Draw the items into the shadow cascades that need rendering this frame. </summary>
+	void renderShadows(const ViewFrustum& _frustum, const std::vector<DrawItem>& _items);
+
+	/// <summary> Set the view projections the lit programs compute motion vectors with. </summary>
+	void bindMotion(Shader* _pShader);
+
+	/// <summary> Add a pass drawing the sorted items lit while they are rasterized. Velocity is optional. </summary>
+	void addForwardPasses(const RenderView& _view, GLuint _hdr, GLuint _velocity, GLuint _depth);
+
+	/// <summary> Add passes writing the sorted items to a G-buffer and lighting it with a full screen pass. Velocity is optional. </summary>
+	void addDeferredPasses(const RenderView& _view, GLuint _hdr, GLuint _velocity, GLuint _depth);
+
+	/// <summary> Clear the bound targets and draw the sorted items lit. </summary>
+	void renderForward(const RenderView& _view);
+
+	/// <summary> Clear the bound G-buffer and draw the sorted items into it. </summary>
+	void renderGBuffer(const RenderView& _view);
+
+	/// <summary> Light the G-buffer resources into the bound target. </summary>
+	void renderLighting(const RenderView& _view, const GLuint _gBuffer[3]);
+};
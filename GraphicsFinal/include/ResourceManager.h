@@ -0,0 +1,153 @@
+#pragma once
+
+class Mesh;
+class Shader;
+class GeometryPool;
+
+/// <summary> GPU memory cached resources may use before unreferenced ones are evicted. </summary>
+const size_t DEFAULT_RESOURCE_BUDGET = 256 * 1024 * 1024;
+
+/// <summary> Residency and sharing counters of a resource manager. </summary>
+struct ResourceStats
+{
+	/// <summary> Number of resident meshes and shaders. </summary>
+	GLuint meshCount = 0;
+	GLuint shaderCount = 0;
+
+	/// <summary> GPU memory of the resident resources in bytes. </summary>
+	size_t gpuBytes = 0;
+
+	/// <summary> Number of resources created. </summary>
+	unsigned long long loads = 0;
+
+	/// <summary> Number of requests served by a resident resource of the same name or content. </summary>
+	unsigned long long sharedLoads = 0;
+
+	/// <summary> Number of resources evicted to stay within the budget. </summary>
+	unsigned long long evictions = 0;
+};
+
+/// <summary>
+/// Loads meshes and shaders once and shares them. Requests are matched by name or file paths first and then by a hash
+/// of the content, so identical assets under different names are also shared. Resources are reference counted; the
+/// ones nothing references stay cached until the GPU memory budget is exceeded, then the least recently used go first.
+/// </summary>
+class ResourceManager
+{
+public:
+	ResourceManager();
+	~ResourceManager();
+
+	/// <summary> Allocate room for the given number of resources. Meshes go in the geometry pool when one is given. </summary>
+	void initialize(GLuint _maxMeshes, GLuint _maxShaders, size_t _budget = DEFAULT_RESOURCE_BUDGET, GeometryPool* _pGeometryPool = nullptr);
+
+	/// <summary> Get another reference to a resident mesh of the given name. Returns an invalid handle when there is none. </summary>
+	Handle<Mesh> findMesh(const char* _pName);
+
+	/// <summary> Get a reference to a mesh of positions and indices, creating it unless the name or content is resident. </summary>
+	Handle<Mesh> loadMesh(const char* _pName, const std::vector<GLfloat>& _vertices, const std::vector<unsigned int>& _indices);
+
+	/// <summary> Get a reference to a linked program of the two files and defines, creating it unless it is resident. </summary>
+	Handle<Shader> loadShader(const char* _pVertexFile, const char* _pFragmentFile, const std::string& _defines = "");
+
+	/// <summary> Get a mesh and mark it used this frame. Returns null once the mesh is evicted; released meshes resolve until then. </summary>
+	Mesh* get(Handle<Mesh> _mesh);
+
+	/// <summary> Get a shader and mark it used this frame. Returns null once the shader is evicted; released shaders resolve until then. </summary>
+	Shader* get(Handle<Shader> _shader);
+
+	/// <summary> Drop a reference. The resource stays cached until the budget needs its memory. </summary>
+	void release(Handle<Mesh> _mesh);
+
+	/// <summary> Drop a reference. The resource stays cached until the budget needs its memory. </summary>
+	void release(Handle<Shader> _shader);
+
+	/// <summary> Advance the clock resources are marked used with. </summary>
+	void beginFrame() { mFrame++; }
+
+	/// <summary> Set the GPU memory budget in bytes, evicting unreferenced resources over it. </summary>
+	void setBudget(size_t _budget);
+
+	/// <summary> Get the GPU memory of a mesh in bytes. </summary>
+	size_t getGpuBytes(Handle<Mesh> _mesh) const;
+
+	/// <summary> Get the GPU memory of a shader in bytes. </summary>
+	size_t getGpuBytes(Handle<Shader> _shader) const;
+
+	/// <summary> Get the residency and sharing counters. </summary>
+	const ResourceStats& getStats() const { return mStats; }
+
+	/// <summary> Destroy every resource, referenced or not. The context must be current. </summary>
+	void clear();
+
+private:
+	/// <summary> Bookkeeping of a resident resource. </summary>
+	struct ResourceEntry
+	{
+		/// <summary> Hash of the name or paths, and of the content. </summary>
+		unsigned long long nameKey = 0;
+		unsigned long long contentKey = 0;
+
+		/// <summary> Size of the hashed content in bytes, compared on a hash match to reject collisions. </summary>
+		size_t contentBytes = 0;
+
+		/// <summary> GPU memory in bytes. </summary>
+		size_t gpuBytes = 0;
+
+		/// <summary> Number of handles given out and not released. </summary>
+		GLuint references = 0;
+
+		/// <summary> Frame the resource was last requested or fetched. </summary>
+		unsigned long long lastUsed = 0;
+	};
+
+	/// <summary> Resources of one type with their lookup tables. </summary>
+	template<typename T>
+	struct ResourceCache
+	{
+		/// <summary> The resources, addressed by handle. </summary>
+		ObjectPool<T> pool;
+
+		/// <summary> Bookkeeping by slot index. </summary>
+		std::vector<ResourceEntry> entries;
+
+		/// <summary> Resident resources by name and by content hash. The first resource of a content hash keeps it. </summary>
+		std::unordered_map<unsigned long long, Handle<T>> byName;
+		std::unordered_map<unsigned long long, Handle<T>> byContent;
+	};
+
+	/// <summary> Meshes and shaders. </summary>
+	ResourceCache<Mesh> mMeshes;
+	ResourceCache<Shader> mShaders;
+
+	/// <summary> Shared buffers meshes are created in, or null for separate buffers. </summary>
+	GeometryPool* mpGeometryPool;
+
+	/// <summary> GPU memory budget in bytes. </summary>
+	size_t mBudget;
+
+	/// <summary> Clock for least recently used eviction. </summary>
+	unsigned long long mFrame;
+
+	/// <summary> Residency and sharing counters. </summary>
+	ResourceStats mStats;
+
+	/// <summary> Find a resident resource by name, then by content of the same size, and add a reference. Returns an invalid handle when there is none. </summary>
+	template<typename T>
+	Handle<T> share(ResourceCache<T>& _cache, unsigned long long _nameKey, unsigned long long _contentKey, size_t _contentBytes, bool _useContent);
+
+	/// <summary> Record a new resource in the lookup tables with one reference. </summary>
+	template<typename T>
+	void insert(ResourceCache<T>& _cache, Handle<T> _handle, unsigned long long _nameKey, unsigned long long _contentKey, size_t _contentBytes, size_t _gpuBytes);
+
+	/// <summary> Find the least recently used unreferenced resource. Returns false when every resource is referenced. </summary>
+	template<typename T>
+	bool findOldest(const ResourceCache<T>& _cache, GLuint& _index, unsigned long long& _lastUsed) const;
+
+	/// <summary> Destroy a resource and drop it from the lookup tables. </summary>
+	template<typename T>
+	void evict(ResourceCache<T>& _cache, GLuint _index);
+
+	/// <summary> Evict unreferenced resources until the incoming bytes fit in the budget, or nothing is left to evict. </summary>
+	void trim(size_t _incoming);
+};
@@ -1,5 +1,69 @@
 #pragma once
 
+/// <summary> Uniforms set every frame. Their locations are looked up once, when the program is linked. </summary>
+enum class ShaderUniform
+{
+	// Per draw.
+	PositionScale,
+	PositionOffset,
+	NormalEncoding,
+	Roughness,
+	Metalness,
+	PreviousModel,
+	CascadeMask,
+
+	// Motion vectors.
+	ViewProjection,
+	PreviousViewProjection,
+
+	// Lighting.
+	SunDirection,
+	SunColor,
+	LightData,
+	ClusterGrid,
+	LightIndices,
+	ClusterCount,
+	ClusterTileScale,
+	ClusterSlice,
+
+	// Shadows.
+	CascadeViewProjections,
+	ShadowMap,
+	ShadowMatrices,
+	CascadeSplits,
+	ShadowTexelSizes,
+
+	// Deferred lighting.
+	GAlbedoMaterial,
+	GNormal,
+	GDepth,
+	InverseProjection,
+	ScreenSize,
+	ReverseZ,
+
+	// Post-processing.
+	Source,
+	SourceTexel,
+	SourceSize,
+	Threshold,
+	Direction,
+	Hdr,
+	Exposure,
+	Bloom,
+	BloomStrength,
+	EdgeAdaptive,
+
+	// Temporal anti-aliasing.
+	Color,
+	Velocity,
+	Depth,
+	History,
+	HistoryWeight,
+	Reprojection,
+
+	Count
+};
+
 /// <summary> Shader code to run on the program. </summary>
 class Shader
 {
@@ -10,6 +74,9 @@ public:
 	/// <summary> Initialize the shader program. </summary>
 	void initialize();
 
+	/// <summary> Set preprocessor lines inserted after the #version line of every loaded shader. </summary>
+	void setDefines(const std::string& _defines) { mDefines = _defines; }
+
 	/// <summary> Load a shader from a file. </summary>
 	void load(GLenum _type, const std::string& _filename);
 
@@ -28,16 +95,22 @@ public:
 	/// <summary> Get the uniform variable location for the view matrix. </summary>
 	GLuint getViewLocation();
 
+	/// <summary> Get the id of the shader program. </summary>
+	GLuint getId() const { return mId; }
+
+	/// <summary> Get the location of a uniform loaded by loadUniforms(), or -1 when the program has none. </summary>
+	GLint getUniform(ShaderUniform _uniform) const { return mUniforms[(int)_uniform]; }
+
 	/// <summary> Use the shader in the program. </summary>
 	void use();
 
 	/// <summary> Clear the shader from the program. </summary>
 	void clear();
 
-	/// <summary> Load all the uniforms into the shader. </summary>
+	/// <summary> Load all the uniforms into the shader. Call once after linking. </summary>
 	void loadUniforms();
 
-	/// <summary> Load a uniform veriable location from the shader. </summary>
+	/// <summary> Load a uniform variable location from the shader. This asks the driver, so keep the result rather than calling it every frame. </summary>
 	GLuint loadUniform(const GLchar* _pVariable);
 
 private:
@@ -53,6 +126,12 @@ private:
 	/// <summary> Uniform view matrix for the shader. </summary>
 	GLuint mUniformView;
 
+	/// <summary> Locations of the per frame uniforms. </summary>
+	GLint mUniforms[(int)ShaderUniform::Count];
+
+	/// <summary> Preprocessor lines inserted into loaded shaders. </summary>
+	std::string mDefines;
+
 	/// <summary> Compile the shader for the program. </summary>
 	void compile(GLenum _type, const char* _pContent);
-};
\ No newline at end of file
+};
\ No newline at end of file
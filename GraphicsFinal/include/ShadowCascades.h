@@ -0,0 +1,105 @@
+#pragma once
+
+struct ViewFrustum;
+class StateTracker;
+class Shader;
+
+/// <summary> Number of shadow cascades. Must match the shadow shaders. </summary>
+const GLuint SHADOW_CASCADE_COUNT = 4;
+
+/// <summary> First cascade that is cached. It and the cascades after it only hold static geometry. </summary>
+const GLuint SHADOW_CACHED_CASCADE = 2;
+
+/// <summary> Default width and height of every cascade in texels. </summary>
+const GLsizei DEFAULT_SHADOW_RESOLUTION = 2048;
+
+/// <summary> Texture unit of the shadow map array. </summary>
+const GLuint SHADOW_TEXTURE_UNIT = 7;
+
+/// <summary> Cascaded shadow maps for a directional light, stored as layers of one depth array. </summary>
+class ShadowCascades
+{
+public:
+	ShadowCascades();
+	~ShadowCascades();
+
+	/// <summary> Create the depth array and framebuffers. The context must be current. </summary>
+	void initialize(GLsizei _resolution);
+
+	/// <summary> Fit the cascades to the view and find the cascades that need rendering. </summary>
+	void update(const ViewFrustum& _frustum, const glm::vec3& _lightDirection);
+
+	/// <summary> Re-render the cached cascades next update, after static geometry changes. </summary>
+	void invalidate() { mCacheValid = false; }
+
+	/// <summary> Bind the depth array and clear the layers that will be rendered this frame. </summary>
+	void beginRender(StateTracker& _stateTracker);
+
+	/// <summary> Set the cascade uniforms of the layered shadow program. </summary>
+	void bindCaster(const Shader& _shader) const;
+
+	/// <summary> Bind the depth array and set the sampling uniforms of a lit program. </summary>
+	void bindReceiver(const Shader& _shader) const;
+
+	/// <summary> Get the cascades dynamic geometry is rendered into. </summary>
+	GLuint getDynamicMask() const { return mDynamicMask; }
+
+	/// <summary> Get the cascades static geometry is rendered into. </summary>
+	GLuint getStaticMask() const { return mStaticMask; }
+
+	/// <summary> Get the number of cascades rendered in the last update. </summary>
+	GLuint getRenderedCount() const;
+
+	/// <summary> Get the world to shadow clip space transform of a cascade. </summary>
+	const glm::mat4& getViewProjection(GLuint _cascade) const { return mViewProjections[_cascade]; }
+
+	/// <summary> Get the farthest view distance shadows are drawn to. </summary>
+	GLfloat getDistance() const { return mDistance; }
+
+	/// <summary> Set the farthest view distance shadows are drawn to. </summary>
+	void setDistance(GLfloat _distance) { mDistance = _distance; }
+
+	/// <summary> Delete the depth array and framebuffers. </summary>
+	void clear();
+
+private:
+	/// <summary> Depth array with one layer per cascade. </summary>
+	GLuint mDepthTexture;
+
+	/// <summary> Framebuffer with every layer attached, for layered rendering. </summary>
+	GLuint mLayeredFramebuffer;
+
+	/// <summary> One framebuffer per layer, for clearing single cascades. </summary>
+	GLuint mLayerFramebuffers[SHADOW_CASCADE_COUNT];
+
+	/// <summary> Width and height of every cascade in texels. </summary>
+	GLsizei mResolution;
+
+	/// <summary> Farthest view distance shadows are drawn to. </summary>
+	GLfloat mDistance;
+
+	/// <summary> Far view distance of every cascade. </summary>
+	GLfloat mSplits[SHADOW_CASCADE_COUNT];
+
+	/// <summary> World size of one texel in every cascade. </summary>
+	GLfloat mTexelSizes[SHADOW_CASCADE_COUNT];
+
+	/// <summary> World to shadow clip space transform of every cascade. </summary>
+	glm::mat4 mViewProjections[SHADOW_CASCADE_COUNT];
+
+	/// <summary> View space to shadow texture space transform of every cascade. </summary>
+	glm::mat4 mReceiverMatrices[SHADOW_CASCADE_COUNT];
+
+	/// <summary> Light space bounds (snapped center, radius) the cached cascades were rendered with. </summary>
+	glm::vec4 mCachedBounds[SHADOW_CASCADE_COUNT];
+
+	/// <summary> Light direction the cached cascades were rendered with. </summary>
+	glm::vec3 mCachedDirection;
+
+	/// <summary> Do the cached cascades hold the current static geometry? </summary>
+	bool mCacheValid;
+
+	/// <summary> Cascades rendered this frame for dynamic and static geometry. </summary>
+	GLuint mDynamicMask;
+	GLuint mStaticMask;
+};
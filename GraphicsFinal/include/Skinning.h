@@ -0,0 +1,22 @@
+#pragma once
+
+/// <summary> Up to four bones moving a vertex. Weights of unused bones are zero and should sum to one. </summary>
+struct SkinWeights
+{
+	/// <summary> Indices into the bone matrices. </summary>
+	glm::uvec4 bones;
+
+	/// <summary> Share of each bone. </summary>
+	glm::vec4 weights;
+};
+
+/// <summary>
+/// Linear blend skinning on the CPU, for skinned vertices needed outside the vertex shader such as bounds, picking or
+/// collision. Every call runs the kernel of the CpuFeatures level.
+/// </summary>
+class Skinning
+{
+public:
+	/// <summary> Move positions by the weighted sum of their bone matrices. The result may alias the positions. </summary>
+	static void skinPositions(const glm::vec4* _pPositions, const SkinWeights* _pWeights, const glm::mat4* _pBones, glm::vec4* _pResult, size_t _count);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+class Shader;
+class RenderGraph;
+
+/// <summary> Number of Halton points the projection jitter cycles through. </summary>
+const GLuint TAA_JITTER_SAMPLES = 8;
+
+/// <summary> Temporal anti-aliasing: jitters the projection every frame and blends the result with reprojected history. </summary>
+class TemporalAA
+{
+public:
+	TemporalAA();
+	~TemporalAA();
+
+	/// <summary> Load the resolve shader and create its pipeline. The context must be current. </summary>
+	int initialize(StateTracker* _pStateTracker, PipelineCache* _pPipelineCache);
+
+	/// <summary> Enable anti-aliasing. The history is discarded when it is enabled again. </summary>
+	void setEnabled(bool _enabled);
+
+	/// <summary> Is anti-aliasing enabled? </summary>
+	bool getEnabled() const { return mEnabled; }
+
+	/// <summary> Advance the jitter sequence and drop the history if the render size changed. </summary>
+	void beginFrame(GLint _width, GLint _height);
+
+	/// <summary> Get this frame's sub-pixel offset in pixels, each axis in [-0.5, 0.5]. </summary>
+	glm::vec2 getJitter() const { return mJitter; }
+
+	/// <summary> Offset a projection by this frame's jitter. </summary>
+	glm::mat4 jitterProjection(const glm::mat4& _projection) const;
+
+	/// <summary> Is there a history to blend with this frame? </summary>
+	bool getHistoryValid() const { return mHistoryValid; }
+
+	/// <summary> Add the resolve pass to a graph. Returns the anti-aliased color, which becomes next frame's history. Reverse-Z depth is nearest at one. </summary>
+	GLuint addPass(RenderGraph& _graph, GLuint _color, GLuint _velocity, GLuint _depth, const glm::mat4& _reprojection, bool _reverseZ = false);
+
+	/// <summary> Delete the shader and history textures. </summary>
+	void clear();
+
+private:
+	/// <summary> Tracker the pipeline is bound through. </summary>
+	StateTracker* mpStateTracker;
+
+	/// <summary> Resolve program and its pipeline without depth. </summary>
+	Shader* mpResolveShader;
+	const PipelineState* mpResolvePipeline;
+
+	/// <summary> Is anti-aliasing enabled? </summary>
+	bool mEnabled;
+
+	/// <summary> History textures, written and read on alternate frames. </summary>
+	GLuint mHistory[2];
+
+	/// <summary> Size of the history textures. </summary>
+	GLint mWidth;
+	GLint mHeight;
+
+	/// <summary> History texture written this frame. </summary>
+	GLuint mCurrent;
+
+	/// <summary> Does the other history texture hold last frame's result? </summary>
+	bool mHistoryValid;
+
+	/// <summary> Were the history textures reallocated since the graph last saw them? </summary>
+	bool mHistoryChanged;
+
+	/// <summary> Number of frames begun, for the jitter sequence. </summary>
+	unsigned long long mFrameIndex;
+
+	/// <summary> Sub-pixel offset of this frame in pixels. </summary>
+	glm::vec2 mJitter;
+
+	/// <summary> Create the history textures at the current size. </summary>
+	void createHistory();
+
+	/// <summary> Delete the history textures. </summary>
+	void deleteHistory();
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+/// <summary> Position, rotation and scale of an object. </summary>
+struct Transform
+{
+	/// <summary> Position in world space, in double precision so objects far from the world origin keep their detail. </summary>
+	glm::dvec3 position = glm::dvec3(0.0);
+
+	/// <summary> Orientation in world space. </summary>
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+	/// <summary> Scale along each local axis. </summary>
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	/// <summary> Compose the model matrix (translate * rotate * scale) relative to an origin near the camera. The offset is taken in double precision, so the float matrix stays exact. </summary>
+	glm::mat4 toMatrix(const glm::dvec3& _origin = glm::dvec3(0.0)) const;
+
+	/// <summary> Blend between two transforms. </summary>
+	static Transform interpolate(const Transform& _previous, const Transform& _current, GLfloat _alpha);
+};
@@ -0,0 +1,30 @@
+#version 330
+
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+// Full resolution HDR color.
+uniform sampler2D uSource;
+
+// Size of one source texel.
+uniform vec2 uSourceTexel;
+
+// Brightness above which pixels bloom.
+uniform float uThreshold = 1.0;
+
+void main()
+{
+	// Four bilinear taps average the 4x4 source texels under this half resolution pixel.
+	vec3 color = texture(uSource, texCoord + uSourceTexel * vec2(-1.0, -1.0)).rgb;
+	color += texture(uSource, texCoord + uSourceTexel * vec2(1.0, -1.0)).rgb;
+	color += texture(uSource, texCoord + uSourceTexel * vec2(-1.0, 1.0)).rgb;
+	color += texture(uSource, texCoord + uSourceTexel * vec2(1.0, 1.0)).rgb;
+	color *= 0.25;
+
+	// Keep the part above the threshold, preserving hue.
+	float brightness = max(color.r, max(color.g, color.b));
+	float contribution = max(brightness - uThreshold, 0.0) / max(brightness, 0.0001);
+
+	fragColor = vec4(color * contribution, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 330
+
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+// Texture to blur.
+uniform sampler2D uSource;
+
+// One texel along the blur axis.
+uniform vec2 uDirection;
+
+// Nine tap gaussian folded into five bilinear taps.
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main()
+{
+	vec3 color = texture(uSource, texCoord).rgb * weights[0];
+
+	for (int counter = 1; counter < 3; counter++)
+	{
+		vec2 offset = uDirection * offsets[counter];
+
+		color += texture(uSource, texCoord + offset).rgb * weights[counter];
+		color += texture(uSource, texCoord - offset).rgb * weights[counter];
+	}
+
+	fragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 330
+
+in vec4 vertexColor;
+in vec3 viewPosition;
+in vec3 viewNormal;
+in vec4 currentClip;
+in vec4 previousClip;
+
+layout (location = 0) out vec4 fragColor;
+
+// Screen space motion since the last frame, for temporal anti-aliasing.
+layout (location = 1) out vec2 velocity;
+
+// Surface material.
+uniform float uRoughness = 0.5;
+uniform float uMetalness = 0.0;
+
+// Defined in clustered_lighting.frag.
+vec3 shadeClustered(vec3 viewPosition, vec3 normal, vec3 albedo, float roughness, float metalness);
+
+void main()
+{
+	// The mesh's interpolated normal, or a flat one from the screen space derivatives of the position without.
+	vec3 normal = dot(viewNormal, viewNormal) > 1e-8 ? normalize(viewNormal) : normalize(cross(dFdx(viewPosition), dFdy(viewPosition)));
+
+	fragColor = vec4(shadeClustered(viewPosition, normal, vertexColor.rgb, uRoughness, uMetalness), vertexColor.a);
+	velocity = (currentClip.xy / currentClip.w - previousClip.xy / previousClip.w) * 0.5;
+}
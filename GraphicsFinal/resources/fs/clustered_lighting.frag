@@ -0,0 +1,96 @@
+#version 330
+
+// Clustered light loop shared by the forward and deferred programs.
+
+// Two texels per light: (view position, radius) and (color * intensity, unused).
+uniform samplerBuffer uLightData;
+
+// Offset and count into the index list for every cluster.
+uniform usamplerBuffer uClusterGrid;
+
+// Light indices of every cluster packed together.
+uniform usamplerBuffer uLightIndices;
+
+// Number of clusters in x, y and z.
+uniform ivec3 uClusterCount;
+
+// Clusters per pixel in x and y.
+uniform vec2 uClusterTileScale;
+
+// Slice = log(depth) * x + y.
+uniform vec2 uClusterSlice;
+
+// Light applied everywhere.
+uniform vec3 uAmbient = vec3(0.05);
+
+// Direction towards the sun in view space and its color * intensity.
+uniform vec3 uSunDirection = vec3(0.0, 1.0, 0.0);
+uniform vec3 uSunColor = vec3(0.0);
+
+// Defined in shadows.frag.
+float sampleShadow(vec3 viewPosition, vec3 normal);
+
+vec3 shadeClustered(vec3 viewPosition, vec3 normal, vec3 albedo, float roughness, float metalness)
+{
+	vec3 viewDirection = normalize(-viewPosition);
+
+	// Find the cluster of this fragment.
+	ivec2 tile = ivec2(gl_FragCoord.xy * uClusterTileScale);
+	int slice = int(log(-viewPosition.z) * uClusterSlice.x + uClusterSlice.y);
+	ivec3 cell = clamp(ivec3(tile, slice), ivec3(0), uClusterCount - 1);
+	int cluster = (cell.z * uClusterCount.y + cell.y) * uClusterCount.x + cell.x;
+
+	uvec2 range = texelFetch(uClusterGrid, cluster).xy;
+
+	// Metals have no diffuse and tint their highlight.
+	vec3 diffuseColor = albedo * (1.0 - metalness);
+	vec3 specularColor = mix(vec3(0.04), albedo, metalness);
+
+	// Blinn-Phong exponent matching the roughness, normalized to conserve energy.
+	float alpha = max(roughness * roughness, 0.01);
+	float shininess = 2.0 / (alpha * alpha) - 2.0;
+	float normalization = (shininess + 8.0) / 25.1327;
+
+	vec3 color = albedo * uAmbient;
+
+	// Shadowed directional light.
+	float sunDiffuse = max(dot(normal, uSunDirection), 0.0);
+
+	if (sunDiffuse > 0.0 && any(greaterThan(uSunColor, vec3(0.0))))
+	{
+		float sunSpecular = pow(max(dot(normal, normalize(uSunDirection + viewDirection)), 0.0), shininess) * normalization;
+
+		color += (diffuseColor + specularColor * sunSpecular) * sunDiffuse * uSunColor * sampleShadow(viewPosition, normal);
+	}
+
+	// Only the lights assigned to this cluster.
+	for (uint counter = 0u; counter < range.y; counter++)
+	{
+		int light = int(texelFetch(uLightIndices, int(range.x + counter)).x);
+
+		vec4 positionRadius = texelFetch(uLightData, light * 2);
+		vec3 radiance = texelFetch(uLightData, light * 2 + 1).rgb;
+
+		vec3 toLight = positionRadius.xyz - viewPosition;
+		float distanceSquared = dot(toLight, toLight);
+		float radiusSquared = positionRadius.w * positionRadius.w;
+
+		if (distanceSquared >= radiusSquared)
+		{
+			continue;
+		}
+
+		vec3 lightDirection = toLight * inversesqrt(distanceSquared);
+
+		// Smooth falloff that reaches zero at the radius.
+		float falloff = 1.0 - distanceSquared / radiusSquared;
+		float attenuation = falloff * falloff / (1.0 + distanceSquared);
+
+		float diffuse = max(dot(normal, lightDirection), 0.0);
+		float specular = pow(max(dot(normal, normalize(lightDirection + viewDirection)), 0.0), shininess) * normalization;
+
+		color += (diffuseColor + specularColor * specular) * diffuse * radiance * attenuation;
+	}
+
+	return color;
+}
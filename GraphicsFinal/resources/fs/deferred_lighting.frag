@@ -0,0 +1,64 @@
+#version 330
+
+out vec4 fragColor;
+
+// G-buffer written by gbuffer.frag.
+uniform sampler2D uGAlbedoMaterial;
+uniform sampler2D uGNormal;
+uniform sampler2D uGDepth;
+
+// Clip to view space transform for rebuilding positions from depth.
+uniform mat4 uInverseProjection;
+
+// Size of the G-buffer in pixels.
+uniform vec2 uScreenSize;
+
+// Is depth reversed, one at the near plane and zero at infinity, with a zero to one clip range?
+uniform bool uReverseZ = false;
+
+// Defined in clustered_lighting.frag.
+vec3 shadeClustered(vec3 viewPosition, vec3 normal, vec3 albedo, float roughness, float metalness);
+
+vec3 decodeOctahedral(vec2 _encoded)
+{
+	_encoded = _encoded * 2.0 - 1.0;
+
+	vec3 normal = vec3(_encoded, 1.0 - abs(_encoded.x) - abs(_encoded.y));
+
+	// Unfold the lower half.
+	if (normal.z < 0.0)
+	{
+		vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+		normal.xy = (1.0 - abs(normal.yx)) * signs;
+	}
+
+	return normalize(normal);
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(uGDepth, pixel, 0).r;
+
+	// Nothing was drawn here.
+	if (depth == (uReverseZ ? 0.0 : 1.0))
+	{
+		fragColor = vec4(0.0, 0.0, 0.0, 1.0);
+		return;
+	}
+
+	// Rebuild the view space position from depth.
+	vec3 clip = vec3(gl_FragCoord.xy / uScreenSize * 2.0 - 1.0, uReverseZ ? depth : depth * 2.0 - 1.0);
+	vec4 view = uInverseProjection * vec4(clip, 1.0);
+	vec3 viewPosition = view.xyz / view.w;
+
+	vec4 albedoMaterial = texelFetch(uGAlbedoMaterial, pixel, 0);
+	vec3 normal = decodeOctahedral(texelFetch(uGNormal, pixel, 0).xy);
+
+	// Unpack the two 4 bit material values.
+	float material = floor(albedoMaterial.a * 255.0 + 0.5);
+	float roughness = floor(material / 16.0) / 15.0;
+	float metalness = mod(material, 16.0) / 15.0;
+
+	fragColor = vec4(shadeClustered(viewPosition, normal, albedoMaterial.rgb, roughness, metalness), 1.0);
+}
@@ -0,0 +1,48 @@
+#version 330
+
+in vec4 vertexColor;
+in vec3 viewPosition;
+in vec3 viewNormal;
+in vec4 currentClip;
+in vec4 previousClip;
+
+// Albedo and roughness/metalness packed into 4 bits each.
+layout (location = 0) out vec4 gAlbedoMaterial;
+
+// Octahedral view space normal.
+layout (location = 1) out vec2 gNormal;
+
+// Screen space motion since the last frame, for temporal anti-aliasing.
+layout (location = 2) out vec2 gVelocity;
+
+// Surface material.
+uniform float uRoughness = 0.5;
+uniform float uMetalness = 0.0;
+
+vec2 encodeOctahedral(vec3 _normal)
+{
+	// Project onto the octahedron and fold the lower half over.
+	_normal /= abs(_normal.x) + abs(_normal.y) + abs(_normal.z);
+
+	vec2 encoded = _normal.xy;
+
+	if (_normal.z < 0.0)
+	{
+		vec2 signs = vec2(_normal.x >= 0.0 ? 1.0 : -1.0, _normal.y >= 0.0 ? 1.0 : -1.0);
+		encoded = (1.0 - abs(_normal.yx)) * signs;
+	}
+
+	return encoded * 0.5 + 0.5;
+}
+
+void main()
+{
+	// The mesh's interpolated normal, or a flat one from the screen space derivatives of the position without.
+	vec3 normal = dot(viewNormal, viewNormal) > 1e-8 ? normalize(viewNormal) : normalize(cross(dFdx(viewPosition), dFdy(viewPosition)));
+
+	float material = floor(clamp(uRoughness, 0.0, 1.0) * 15.0 + 0.5) * 16.0 + floor(clamp(uMetalness, 0.0, 1.0) * 15.0 + 0.5);
+
+	gAlbedoMaterial = vec4(vertexColor.rgb, material / 255.0);
+	gNormal = encodeOctahedral(normal);
+	gVelocity = (currentClip.xy / currentClip.w - previousClip.xy / previousClip.w) * 0.5;
+}
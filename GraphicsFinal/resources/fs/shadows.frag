@@ -0,0 +1,44 @@
+#version 330
+
+// Cascaded shadow lookup shared by the lit programs.
+
+// Depth array with one layer per cascade (SHADOW_CASCADE_COUNT).
+uniform sampler2DArrayShadow uShadowMap;
+
+// View space to shadow texture space transform of every cascade.
+uniform mat4 uShadowMatrices[4];
+
+// Far view distance of every cascade.
+uniform vec4 uCascadeSplits;
+
+// World size of one texel in every cascade.
+uniform vec4 uShadowTexelSizes;
+
+float sampleShadow(vec3 viewPosition, vec3 normal)
+{
+	// Pick the first cascade containing the fragment.
+	int cascade = int(dot(vec4(greaterThan(vec4(-viewPosition.z), uCascadeSplits)), vec4(1.0)));
+
+	if (cascade >= 4)
+	{
+		return 1.0;
+	}
+
+	// Offset along the normal by the texel size to avoid acne without peter panning.
+	vec3 offsetPosition = viewPosition + normal * uShadowTexelSizes[cascade] * 1.5;
+	vec3 coord = (uShadowMatrices[cascade] * vec4(offsetPosition, 1.0)).xyz;
+
+	// 3x3 filter of hardware compared bilinear taps.
+	vec2 texel = 1.0 / vec2(textureSize(uShadowMap, 0).xy);
+	float lit = 0.0;
+
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			lit += texture(uShadowMap, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z));
+		}
+	}
+
+	return lit / 9.0;
+}
@@ -0,0 +1,156 @@
+#version 330
+
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+// This frame's jittered HDR color, its motion and depth.
+uniform sampler2D uColor;
+uniform sampler2D uVelocity;
+uniform sampler2D uDepth;
+
+// Last frame's resolved color.
+uniform sampler2D uHistory;
+
+// Weight of the history. Zero when there is none.
+uniform float uHistoryWeight = 0.9;
+
+// Current clip space to last frame's clip space, for pixels nothing was drawn at.
+uniform mat4 uReprojection;
+
+// Is depth reversed, one at the near plane and zero at infinity, with a zero to one clip range?
+uniform bool uReverseZ = false;
+
+vec3 toYCoCg(vec3 _color)
+{
+	return vec3(dot(_color, vec3(0.25, 0.5, 0.25)), dot(_color, vec3(0.5, 0.0, -0.5)), dot(_color, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 fromYCoCg(vec3 _color)
+{
+	return vec3(_color.x + _color.y - _color.z, _color.x + _color.z, _color.x - _color.y - _color.z);
+}
+
+// Catmull-Rom filtered history from five bilinear taps, which keeps it from blurring over time.
+vec3 sampleHistory(vec2 _uv)
+{
+	vec2 size = vec2(textureSize(uHistory, 0));
+	vec2 position = _uv * size;
+	vec2 centre = floor(position - 0.5) + 0.5;
+	vec2 fraction = position - centre;
+
+	vec2 weight0 = fraction * (-0.5 + fraction * (1.0 - 0.5 * fraction));
+	vec2 weight1 = 1.0 + fraction * fraction * (-2.5 + 1.5 * fraction);
+	vec2 weight2 = fraction * (0.5 + fraction * (2.0 - 1.5 * fraction));
+	vec2 weight3 = fraction * fraction * (-0.5 + 0.5 * fraction);
+
+	// The middle two taps are merged into one bilinear fetch.
+	vec2 weight12 = weight1 + weight2;
+	vec2 uv0 = (centre - 1.0) / size;
+	vec2 uv3 = (centre + 2.0) / size;
+	vec2 uv12 = (centre + weight2 / weight12) / size;
+
+	vec3 color = texture(uHistory, vec2(uv12.x, uv0.y)).rgb * weight12.x * weight0.y;
+	color += texture(uHistory, vec2(uv0.x, uv12.y)).rgb * weight0.x * weight12.y;
+	color += texture(uHistory, vec2(uv12.x, uv12.y)).rgb * weight12.x * weight12.y;
+	color += texture(uHistory, vec2(uv3.x, uv12.y)).rgb * weight3.x * weight12.y;
+	color += texture(uHistory, vec2(uv12.x, uv3.y)).rgb * weight12.x * weight3.y;
+
+	float weightSum = weight12.x * weight0.y + weight0.x * weight12.y + weight12.x * weight12.y + weight3.x * weight12.y + weight12.x * weight3.y;
+
+	return max(color / weightSum, vec3(0.0));
+}
+
+// Pull the history toward the neighbourhood mean until it is inside the box.
+vec3 clipToBox(vec3 _history, vec3 _minimum, vec3 _maximum)
+{
+	vec3 centre = 0.5 * (_maximum + _minimum);
+	vec3 extent = 0.5 * (_maximum - _minimum) + 0.0001;
+	vec3 offset = _history - centre;
+	vec3 units = abs(offset / extent);
+	float largest = max(units.x, max(units.y, units.z));
+
+	return largest > 1.0 ? centre + offset / largest : _history;
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	ivec2 limit = textureSize(uColor, 0) - 1;
+
+	vec3 current = texelFetch(uColor, pixel, 0).rgb;
+
+	if (uHistoryWeight == 0.0)
+	{
+		fragColor = vec4(current, 1.0);
+		return;
+	}
+
+	// Colour statistics of the 3x3 neighbourhood and its nearest depth.
+	vec3 moment1 = vec3(0.0);
+	vec3 moment2 = vec3(0.0);
+	vec3 minimum = vec3(1e9);
+	vec3 maximum = vec3(-1e9);
+	float farDepth = uReverseZ ? 0.0 : 1.0;
+	float closestDepth = farDepth;
+	ivec2 closestPixel = pixel;
+
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			ivec2 neighbour = clamp(pixel + ivec2(x, y), ivec2(0), limit);
+			vec3 color = toYCoCg(texelFetch(uColor, neighbour, 0).rgb);
+
+			moment1 += color;
+			moment2 += color * color;
+			minimum = min(minimum, color);
+			maximum = max(maximum, color);
+
+			float depth = texelFetch(uDepth, neighbour, 0).r;
+
+			if (uReverseZ ? depth > closestDepth : depth < closestDepth)
+			{
+				closestDepth = depth;
+				closestPixel = neighbour;
+			}
+		}
+	}
+
+	// Motion of the nearest surface, so edges move with the object in front.
+	vec2 velocity;
+
+	if (closestDepth != farDepth)
+	{
+		velocity = texelFetch(uVelocity, closestPixel, 0).xy;
+	}
+	else
+	{
+		// Background: only the camera moved.
+		vec4 previous = uReprojection * vec4(texCoord * 2.0 - 1.0, farDepth, 1.0);
+		velocity = texCoord - (previous.xy / previous.w * 0.5 + 0.5);
+	}
+
+	vec2 historyUV = texCoord - velocity;
+
+	// Nothing to reproject from outside the last frame.
+	if (any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0))))
+	{
+		fragColor = vec4(current, 1.0);
+		return;
+	}
+
+	// Variance box around the mean, kept inside the min/max box.
+	vec3 mean = moment1 / 9.0;
+	vec3 deviation = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0.0)));
+	vec3 boxMinimum = max(minimum, mean - deviation);
+	vec3 boxMaximum = min(maximum, mean + deviation);
+
+	vec3 history = fromYCoCg(clipToBox(toYCoCg(sampleHistory(historyUV)), boxMinimum, boxMaximum));
+
+	// Weight by inverse luminance so bright HDR samples do not flicker after tone mapping.
+	float currentWeight = (1.0 - uHistoryWeight) / (1.0 + toYCoCg(current).x);
+	float historyWeight = uHistoryWeight / (1.0 + toYCoCg(history).x);
+
+	fragColor = vec4((current * currentWeight + history * historyWeight) / (currentWeight + historyWeight), 1.0);
+}
@@ -0,0 +1,36 @@
+#version 330
+
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+// Scene color and its blurred bright parts.
+uniform sampler2D uHdr;
+uniform sampler2D uBloom;
+
+// Exposure multiplier applied before tone mapping.
+uniform float uExposure = 1.0;
+
+// Amount of bloom added. Zero when bloom is disabled.
+uniform float uBloomStrength = 0.0;
+
+// Fitted ACES filmic curve.
+vec3 tonemapACES(vec3 _color)
+{
+	return clamp((_color * (2.51 * _color + 0.03)) / (_color * (2.43 * _color + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+	vec3 color = texture(uHdr, texCoord).rgb;
+
+	if (uBloomStrength > 0.0)
+	{
+		color += texture(uBloom, texCoord).rgb * uBloomStrength;
+	}
+
+	// Map to the display and encode with gamma 2.2.
+	color = tonemapACES(color * uExposure);
+
+	fragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
@@ -0,0 +1,124 @@
+#version 330
+
+in vec2 texCoord;
+
+out vec4 fragColor;
+
+// Tone mapped image at the render resolution.
+uniform sampler2D uSource;
+
+// Size of the source in texels.
+uniform vec2 uSourceSize;
+
+// Use the edge adaptive kernel instead of bilinear filtering.
+uniform bool uEdgeAdaptive = true;
+
+float luma(vec3 _color)
+{
+	return dot(_color, vec3(0.299, 0.587, 0.114));
+}
+
+vec3 fetch(ivec2 _texel)
+{
+	return texelFetch(uSource, clamp(_texel, ivec2(0), ivec2(uSourceSize) - 1), 0).rgb;
+}
+
+// Gradient of one of the four centre texels from its neighbours, weighted by its bilinear weight.
+void accumulateEdge(inout vec2 direction, inout float edge, float weight, float left, float up, float centre, float right, float down)
+{
+	float dirX = right - left;
+	float dirY = down - up;
+
+	direction += vec2(dirX, dirY) * weight;
+
+	// How much of the change is a clean edge rather than a single bright texel.
+	float edgeX = clamp(abs(dirX) / max(max(abs(right - centre), abs(centre - left)), 1.0 / 65536.0), 0.0, 1.0);
+	float edgeY = clamp(abs(dirY) / max(max(abs(down - centre), abs(centre - up)), 1.0 / 65536.0), 0.0, 1.0);
+
+	edge += (edgeX * edgeX + edgeY * edgeY) * weight;
+}
+
+void main()
+{
+	if (!uEdgeAdaptive)
+	{
+		fragColor = vec4(texture(uSource, texCoord).rgb, 1.0);
+		return;
+	}
+
+	// Position in source texels relative to the top left of the centre 2x2.
+	vec2 position = texCoord * uSourceSize - 0.5;
+	vec2 base = floor(position);
+	vec2 fraction = position - base;
+	ivec2 origin = ivec2(base);
+
+	// Twelve taps: the 4x4 around the position without its corners.
+	//     b c
+	//   e f g h
+	//   i j k l
+	//     n o
+	const ivec2 offsets[12] = ivec2[](
+		ivec2(0, -1), ivec2(1, -1),
+		ivec2(-1, 0), ivec2(0, 0), ivec2(1, 0), ivec2(2, 0),
+		ivec2(-1, 1), ivec2(0, 1), ivec2(1, 1), ivec2(2, 1),
+		ivec2(0, 2), ivec2(1, 2));
+
+	vec3 colors[12];
+	float lumas[12];
+
+	for (int counter = 0; counter < 12; counter++)
+	{
+		colors[counter] = fetch(origin + offsets[counter]);
+		lumas[counter] = luma(colors[counter]);
+	}
+
+	// Edge direction and strength from the four centre texels f, g, j and k.
+	vec2 direction = vec2(0.0);
+	float edge = 0.0;
+
+	accumulateEdge(direction, edge, (1.0 - fraction.x) * (1.0 - fraction.y), lumas[2], lumas[0], lumas[3], lumas[4], lumas[7]);
+	accumulateEdge(direction, edge, fraction.x * (1.0 - fraction.y), lumas[3], lumas[1], lumas[4], lumas[5], lumas[8]);
+	accumulateEdge(direction, edge, (1.0 - fraction.x) * fraction.y, lumas[6], lumas[3], lumas[7], lumas[8], lumas[10]);
+	accumulateEdge(direction, edge, fraction.x * fraction.y, lumas[7], lumas[4], lumas[8], lumas[9], lumas[11]);
+
+	float directionSquared = dot(direction, direction);
+	direction = directionSquared < 1.0 / 32768.0 ? vec2(1.0, 0.0) : direction * inversesqrt(directionSquared);
+
+	edge *= 0.5;
+	edge *= edge;
+
+	// Stretch the kernel along the edge and narrow it across, sharper on strong edges.
+	float stretch = dot(direction, direction) / max(abs(direction.x), abs(direction.y));
+	vec2 axisScale = vec2(1.0 + (stretch - 1.0) * edge, 1.0 - 0.5 * edge);
+	float lobe = 0.5 + ((1.0 / 4.0 - 0.04) - 0.5) * edge;
+	float clip = 1.0 / lobe;
+
+	vec3 color = vec3(0.0);
+	float weightSum = 0.0;
+
+	for (int counter = 0; counter < 12; counter++)
+	{
+		vec2 offset = vec2(offsets[counter]) - fraction;
+
+		// Rotate into the edge frame and scale.
+		vec2 rotated = vec2(dot(offset, direction), dot(offset, vec2(-direction.y, direction.x))) * axisScale;
+		float distance2 = min(dot(rotated, rotated), clip);
+
+		// Polynomial approximation of a windowed Lanczos 2 kernel.
+		float lanczos = 2.0 / 5.0 * distance2 - 1.0;
+		float window = lobe * distance2 - 1.0;
+		lanczos = lanczos * lanczos * (25.0 / 16.0) - (25.0 / 16.0 - 1.0);
+		float weight = lanczos * window * window;
+
+		color += colors[counter] * weight;
+		weightSum += weight;
+	}
+
+	color /= weightSum;
+
+	// Remove ringing by clamping to the centre texels.
+	vec3 minimum = min(min(colors[3], colors[4]), min(colors[7], colors[8]));
+	vec3 maximum = max(max(colors[3], colors[4]), max(colors[7], colors[8]));
+
+	fragColor = vec4(clamp(color, minimum, maximum), 1.0);
+}
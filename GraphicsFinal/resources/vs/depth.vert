@@ -0,0 +1,24 @@
+#version 330
+
+layout (location = 0) in vec3 aPosition;
+
+uniform mat4 uModel;
+
+uniform mat4 uProjection;
+
+uniform mat4 uView;
+
+// Quantized meshes store positions across their box; float meshes keep the defaults.
+uniform vec3 uPositionScale = vec3(1.0);
+uniform vec3 uPositionOffset = vec3(0.0);
+
+// Must match lit.vert bit for bit so the color pass can test with GL_EQUAL.
+invariant gl_Position;
+
+void main()
+{
+	vec3 localPosition = aPosition * uPositionScale + uPositionOffset;
+	vec4 position = uView * uModel * vec4(localPosition, 1.0);
+
+	gl_Position = uProjection * position;
+}
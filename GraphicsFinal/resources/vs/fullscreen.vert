@@ -0,0 +1,12 @@
+#version 330
+
+out vec2 texCoord;
+
+void main()
+{
+	// One triangle covering the screen, without vertex buffers.
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	texCoord = position;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
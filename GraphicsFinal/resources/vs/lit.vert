@@ -0,0 +1,76 @@
+#version 330
+
+layout (location = 0) in vec3 aPosition;
+
+// Three floats, or an octahedral direction in xy. Unused when the mesh has no normals.
+layout (location = 1) in vec3 aNormal;
+
+out vec4 vertexColor;
+out vec3 viewPosition;
+
+// Zero when the mesh has no normals, so the fragment shader falls back to flat normals.
+out vec3 viewNormal;
+
+// Unjittered clip positions of this frame and the last, for motion vectors.
+out vec4 currentClip;
+out vec4 previousClip;
+
+uniform mat4 uModel;
+
+uniform mat4 uProjection;
+
+uniform mat4 uView;
+
+// Model transform of the last frame and the unjittered view projections of both frames.
+uniform mat4 uPreviousModel;
+uniform mat4 uViewProjection;
+uniform mat4 uPreviousViewProjection;
+
+// Quantized meshes store positions across their box; float meshes keep the defaults.
+uniform vec3 uPositionScale = vec3(1.0);
+uniform vec3 uPositionOffset = vec3(0.0);
+
+// NormalEncoding of the mesh: 0 none, 1 floats, 2 octahedral.
+uniform int uNormalEncoding = 0;
+
+// Must match depth.vert bit for bit so the color pass can test with GL_EQUAL.
+invariant gl_Position;
+
+vec3 decodeOctahedral(vec2 _encoded)
+{
+	vec3 normal = vec3(_encoded, 1.0 - abs(_encoded.x) - abs(_encoded.y));
+
+	// Unfold the lower half.
+	if (normal.z < 0.0)
+	{
+		vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+		normal.xy = (1.0 - abs(normal.yx)) * signs;
+	}
+
+	return normalize(normal);
+}
+
+void main()
+{
+	vec3 localPosition = aPosition * uPositionScale + uPositionOffset;
+	vec4 position = uView * uModel * vec4(localPosition, 1.0);
+
+	gl_Position = uProjection * position;
+	currentClip = uViewProjection * uModel * vec4(localPosition, 1.0);
+	previousClip = uPreviousViewProjection * uPreviousModel * vec4(localPosition, 1.0);
+	viewPosition = position.xyz;
+	vertexColor = vec4(clamp(localPosition, 0.0, 1.0), 1.0);
+	viewNormal = vec3(0.0);
+
+	if (uNormalEncoding != 0)
+	{
+		vec3 normal = uNormalEncoding == 2 ? decodeOctahedral(aNormal.xy) : aNormal;
+
+		// Dividing by the squared axis scales is the inverse transpose of a rotation and scale, so normals stay
+		// perpendicular under non-uniform scales without inverting a matrix per vertex.
+		mat3 normalTransform = mat3(uView * uModel);
+		vec3 axisScales = vec3(dot(normalTransform[0], normalTransform[0]), dot(normalTransform[1], normalTransform[1]), dot(normalTransform[2], normalTransform[2]));
+
+		viewNormal = normalize(normalTransform * (normal / axisScales));
+	}
+}
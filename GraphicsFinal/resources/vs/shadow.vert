@@ -0,0 +1,15 @@
+#version 330
+
+layout (location = 0) in vec3 aPosition;
+
+uniform mat4 uModel;
+
+// Quantized meshes store positions across their box; float meshes keep the defaults.
+uniform vec3 uPositionScale = vec3(1.0);
+uniform vec3 uPositionOffset = vec3(0.0);
+
+void main()
+{
+	// The geometry shader projects into every cascade.
+	gl_Position = uModel * vec4(aPosition * uPositionScale + uPositionOffset, 1.0);
+}